@@ -0,0 +1,155 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/io/logger.h"
+
+using percepto::accel::Bvh, percepto::accel::BvhBuildOptions, percepto::accel::TraversalStats;
+using percepto::common::BvhBuilder, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+
+namespace
+{
+// Arg: 0 = binned SAH, 1 = LBVH on 30-bit codes, 2 = LBVH on 63-bit codes, 3 = 63-bit LBVH with
+// treelet optimization.
+BvhBuildOptions builder_options(int64_t arg)
+{
+  BvhBuildOptions options;
+  if (arg == 0) return options;
+  options.builder = BvhBuilder::Lbvh;
+  options.morton_bits = arg == 1 ? 30 : 63;
+  options.treelet_optimization = arg == 3;
+  return options;
+}
+
+// A 1000 × 500 quad height field (1M triangles) seen from a sensor 3 m above its middle.
+percepto::geometry::TriangleMesh make_terrain()
+{
+  percepto::geometry::TriangleMeshBuilder builder;
+  auto vertex = [](int x, int y)
+  {
+    return Vec3(x * 0.2 - 100.0, y * 0.2 - 50.0,
+                std::sin(x * 0.05) * std::cos(y * 0.07) + 0.3 * std::sin(x * y * 0.001));
+  };
+  for (int y = 0; y < 500; ++y)
+  {
+    for (int x = 0; x < 1000; ++x)
+    {
+      builder.add_triangle(vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1));
+      builder.add_triangle(vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1));
+    }
+  }
+  return builder.build();
+}
+
+const percepto::geometry::TriangleMesh& terrain()
+{
+  static const auto mesh = make_terrain();
+  return mesh;
+}
+
+std::vector<percepto::geometry::AABB> terrain_bounds()
+{
+  const auto& mesh = terrain();
+  std::vector<percepto::geometry::AABB> bounds;
+  bounds.reserve(mesh.triangle_count());
+  for (size_t i = 0; i < mesh.triangle_count(); ++i) bounds.push_back(mesh.triangle(i).bounds());
+  return bounds;
+}
+
+// One revolution of a 64-channel sensor at 0.2° azimuth steps, all pointing downwards.
+std::vector<Ray> make_scan()
+{
+  std::vector<Ray> rays;
+  const Vec3 origin(0.0, 0.0, 3.0);
+  for (int a = 0; a < 1800; ++a)
+  {
+    const double az = a * M_PI / 900.0;
+    for (int c = 0; c < 64; ++c)
+    {
+      const double el = -0.05 - c * 0.01;
+      rays.emplace_back(origin,
+                        Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az),
+                             std::sin(el)),
+                        0.0, 200.0);
+    }
+  }
+  return rays;
+}
+
+// Expected cost per ray of the tree by the SAH, for unit traversal and intersection costs.
+double sah_cost(const Bvh& bvh)
+{
+  double cost = 0.0;
+  for (const auto& node : bvh.nodes())
+  {
+    cost += node.bounds.surface_area() * (node.is_leaf() ? node.count : 1.0);
+  }
+  return cost / bvh.nodes()[0].bounds.surface_area();
+}
+}  // namespace
+
+// Build time of the binary tree alone, reported per million triangles, plus the tree's SAH cost.
+static void BM_BvhBuild(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  const auto bounds = terrain_bounds();
+  const auto options = builder_options(state.range(0));
+
+  Bvh bvh;
+  for (auto _ : state)
+  {
+    bvh.build(bounds, options);
+    benchmark::DoNotOptimize(bvh.nodes().data());
+  }
+  const double millions = bounds.size() / 1e6;
+  state.counters["s/Mtri"] = benchmark::Counter(state.iterations() * millions,
+                                                benchmark::Counter::kIsRate |
+                                                    benchmark::Counter::kInvert);
+  state.counters["SAH"] = sah_cost(bvh);
+  state.counters["depth"] = bvh.depth();
+}
+
+// Closest-hit rays per second through the resulting tree, plus node visits per ray.
+static void BM_BvhTrace(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  Scene scene;
+  scene.set_accelerator(percepto::common::AcceleratorType::Bvh);
+  scene.set_bvh_options(builder_options(state.range(0)));
+  scene.add_mesh(terrain());
+  scene.commit();
+  const auto rays = make_scan();
+
+  for (auto _ : state)
+  {
+    for (const Ray& ray : rays)
+    {
+      HitRecord rec;
+      benchmark::DoNotOptimize(scene.intersect(ray, rec));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+
+  // Counts visits with leaves that never hit: an upper bound, but the same one for every tree.
+  TraversalStats stats;
+  for (const Ray& ray : rays)
+  {
+    scene.bvh().traverse(ray, ray.tMax(), [](uint32_t, double&) { return false; }, &stats);
+  }
+  state.counters["nodes/ray"] = static_cast<double>(stats.nodes) / rays.size();
+  state.counters["leaves/ray"] = static_cast<double>(stats.leaves) / rays.size();
+}
+
+BENCHMARK(BM_BvhBuild)->DenseRange(0, 3)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BvhTrace)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "percepto/io/csv_parser.h"
+#include "percepto/io/logger.h"
+
+namespace fs = std::filesystem;
+
+// 200k random triangles (~35 MB), written once per process to the temp directory.
+static const fs::path& scene_file()
+{
+  static const fs::path path = []
+  {
+    const fs::path file = fs::temp_directory_path() / "percepto_csv_loader_bench.csv";
+    std::ofstream out(file);
+    out << "x0,y0,z0,x1,y1,z1,x2,y2,z2\n";
+    out.precision(17);
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    for (int row = 0; row < 200000; ++row)
+    {
+      for (int k = 0; k < 9; ++k) out << (k ? "," : "") << coord(rng);
+      out << "\n";
+    }
+    return file;
+  }();
+  return path;
+}
+
+static void run_loader(benchmark::State& state, const percepto::io::CsvLoadOptions& options)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  const std::string file = scene_file().string();
+  const auto file_bytes = static_cast<int64_t>(fs::file_size(file));
+
+  percepto::io::CsvParser parser(options);
+  int64_t triangles = 0;
+  for (auto _ : state)
+  {
+    auto scene = parser.load_scene_from_csv(file);
+    triangles = scene->size();
+    benchmark::DoNotOptimize(scene.get());
+  }
+
+  state.SetBytesProcessed(state.iterations() * file_bytes);
+  state.counters["triangles/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * triangles), benchmark::Counter::kIsRate);
+}
+
+// Baseline: csv-parser's CSVReader with per-field get<double>().
+static void BM_LoadCsv_Reader(benchmark::State& state)
+{
+  percepto::io::CsvLoadOptions options;
+  options.memory_mapped = false;
+  run_loader(state, options);
+}
+
+// Memory-mapped, chunked from_chars parsing; the argument is the thread count.
+static void BM_LoadCsv_Mapped(benchmark::State& state)
+{
+  percepto::io::CsvLoadOptions options;
+  options.thread_count = static_cast<int>(state.range(0));
+  run_loader(state, options);
+}
+
+BENCHMARK(BM_LoadCsv_Reader)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadCsv_Mapped)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/io/logger.h"
+#include "percepto/math/intersection/moller_trumbore.h"
+
+using percepto::common::CullMode, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::Triangle;
+using percepto::math::intersection::moller_trumbore;
+
+namespace
+{
+// Thin walls seen from both sides, e.g. fences and partitions: 4000 upright quads scattered
+// around the sensor. `duplicate` adds each face again with the opposite winding so that a
+// back-face culling scene sees both sides; otherwise the scene is set to cull nothing.
+std::unique_ptr<Scene> make_walls(bool duplicate)
+{
+  auto scene = std::make_unique<Scene>();
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> xy(-80.0, 80.0), heading(0.0, M_PI), length(1.0, 6.0);
+  for (int i = 0; i < 4000; ++i)
+  {
+    const Vec3 a(xy(rng), xy(rng), -2.0);
+    const double h = heading(rng), l = length(rng);
+    const Vec3 b = a + Vec3(l * std::cos(h), l * std::sin(h), 0.0);
+    const Vec3 up(0.0, 0.0, 3.0);
+    for (const Triangle& tri : {Triangle(a, b, b + up), Triangle(a, b + up, a + up)})
+    {
+      scene->add_object(tri);
+      if (duplicate) scene->add_object(Triangle(tri.v0(), tri.v2(), tri.v1()));
+    }
+  }
+  if (!duplicate) scene->set_cull_mode(CullMode::None);
+  scene->commit();
+  return scene;
+}
+
+// One revolution at 0.2° azimuth steps over 32 channels.
+std::vector<Ray> make_scan()
+{
+  std::vector<Ray> rays;
+  for (int a = 0; a < 1800; ++a)
+  {
+    const double az = a * M_PI / 900.0;
+    for (int c = 0; c < 32; ++c)
+    {
+      const double el = -0.25 + c * 0.3 / 31;
+      rays.emplace_back(Vec3(0, 0, 0),
+                        Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az),
+                             std::sin(el)),
+                        0.0, 200.0);
+    }
+  }
+  return rays;
+}
+}  // namespace
+
+// Arg: 0 = every wall stored twice and back faces culled, 1 = stored once with CullMode::None.
+static void BM_DoubleSidedWalls(benchmark::State& state)
+{
+  auto scene = make_walls(state.range(0) == 0);
+  const auto rays = make_scan();
+  for (auto _ : state)
+  {
+    for (const Ray& ray : rays)
+    {
+      HitRecord rec;
+      benchmark::DoNotOptimize(scene->intersect(ray, rec));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+  const auto memory = scene->memory_usage();
+  state.counters["scene_MB"] = (memory.geometry() + memory.acceleration) / (1024.0 * 1024.0);
+}
+
+// The scalar kernel in each of its specializations, over rays that hit half of the triangles
+// from behind. Arg: 0 = culling, double; 1 = no culling, double; 2 = no culling, float.
+static void BM_MollerTrumboreVariant(benchmark::State& state)
+{
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> coord(-1.0, 1.0);
+  std::vector<Triangle> tris;
+  for (int i = 0; i < 256; ++i)
+  {
+    const Vec3 c(coord(rng), coord(rng), 5.0);
+    tris.emplace_back(c + Vec3(-1, -1, coord(rng)), c + Vec3(1, -1, coord(rng)),
+                      c + Vec3(0, 1, coord(rng)));
+    if (i % 2) tris.back() = Triangle(tris.back().v0(), tris.back().v2(), tris.back().v1());
+  }
+  const Ray ray(Vec3(0, 0, 0), Vec3(0.05, 0.05, 1.0));
+
+  for (auto _ : state)
+  {
+    for (const Triangle& tri : tris)
+    {
+      switch (state.range(0))
+      {
+        case 0:
+          benchmark::DoNotOptimize(moller_trumbore(tri.v0(), tri.v1(), tri.v2(), ray));
+          break;
+        case 1:
+          benchmark::DoNotOptimize(
+              moller_trumbore<CullMode::None>(tri.v0(), tri.v1(), tri.v2(), ray));
+          break;
+        default:
+          benchmark::DoNotOptimize(
+              moller_trumbore<CullMode::None, float>(tri.v0(), tri.v1(), tri.v2(), ray));
+          break;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tris.size()));
+}
+
+BENCHMARK(BM_DoubleSidedWalls)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MollerTrumboreVariant)->DenseRange(0, 2);
+
+int main(int argc, char** argv)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/io/logger.h"
+
+using percepto::core::Scene, percepto::core::Transform, percepto::core::Vec3;
+using percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+constexpr int kStaticTriangles = 400000;
+constexpr int kVehicles = 4000;
+
+// A static ground-level clutter of small triangles plus vehicles, as spheres, driving on it.
+Scene make_street()
+{
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<double> xy(-200.0, 200.0), z(-1.5, 3.0);
+  Scene scene;
+  scene.reserve(kStaticTriangles + kVehicles);
+  for (int i = 0; i < kStaticTriangles; ++i)
+  {
+    const Vec3 p(xy(rng), xy(rng), z(rng));
+    scene.add_object(Triangle(p, p + Vec3(0.3, 0.0, 0.0), p + Vec3(0.0, 0.0, 0.3)));
+  }
+  for (int i = 0; i < kVehicles; ++i) scene.add_object(Sphere(Vec3(xy(rng), xy(rng), 0.0), 1.5));
+  scene.commit();
+  return scene;
+}
+}  // namespace
+
+// One frame: arg vehicles drive 1 m on and the scene is committed, refitting their leaves.
+static void BM_FrameUpdate(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  Scene scene = make_street();
+  const auto moving = static_cast<Scene::ObjectHandle>(state.range(0));
+  int frame = 0;
+  for (auto _ : state)
+  {
+    // Alternate directions so the vehicles stay where the tree was built for them.
+    const Transform step = Transform::translation(Vec3(frame++ % 2 ? -1.0 : 1.0, 0.0, 0.0));
+    for (Scene::ObjectHandle v = 0; v < moving; ++v)
+    {
+      scene.transform_object(kStaticTriangles + v, step);
+    }
+    scene.commit();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The same frame without refitting: every commit rebuilds the whole tree.
+static void BM_FrameRebuild(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  Scene scene = make_street();
+  int frame = 0;
+  for (auto _ : state)
+  {
+    const Transform step = Transform::translation(Vec3(frame++ % 2 ? -1.0 : 1.0, 0.0, 0.0));
+    for (Scene::ObjectHandle v = 0; v < state.range(0); ++v)
+    {
+      scene.transform_object(kStaticTriangles + v, step);
+    }
+    scene.set_bvh_options(scene.bvh_options());
+    scene.commit();
+  }
+}
+
+BENCHMARK(BM_FrameUpdate)->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FrameRebuild)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "percepto/common/config_loader.h"
+#include "percepto/common/frame_scan.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/io/logger.h"
+#include "percepto/lidar/emitter.h"
+#include "percepto/lidar/simulator.h"
+
+// Every heap allocation in the process goes through these, so a benchmark can count the ones
+// made while its loop runs.
+static std::atomic<long> g_allocations{0};
+static std::atomic<long> g_allocated_bytes{0};
+
+static void* counted_alloc(std::size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Sensor shaped like the shipped configuration: 3600 azimuth steps × 32 channels.
+static percepto::common::LiDARConfig make_sensor()
+{
+  percepto::common::LiDARConfig cfg;
+  cfg.azimuth_steps = 3600;
+  for (int j = 0; j < 32; ++j) cfg.elevation_angles.push_back(0.1863 - 0.0232 * j);
+  return cfg;
+}
+
+// A closed-ish shell of triangles around the sensor, so most beams return.
+static std::unique_ptr<percepto::core::Scene> make_scene()
+{
+  using percepto::core::Vec3;
+  auto scene = std::make_unique<percepto::core::Scene>();
+  const int az_cells = 90, el_cells = 6;
+  const double radius = 20.0;
+  auto point = [&](double az, double el)
+  {
+    return Vec3(radius * std::cos(el) * std::cos(az), radius * std::cos(el) * std::sin(az),
+                radius * std::sin(el));
+  };
+  for (int a = 0; a < az_cells; ++a)
+  {
+    const double az0 = 2.0 * M_PI * a / az_cells, az1 = 2.0 * M_PI * (a + 1) / az_cells;
+    for (int e = 0; e < el_cells; ++e)
+    {
+      const double el0 = -0.6 + 1.2 * e / el_cells, el1 = -0.6 + 1.2 * (e + 1) / el_cells;
+      scene->add_object(percepto::geometry::Triangle{point(az0, el0), point(az0, el1),
+                                                     point(az1, el0)});
+      scene->add_object(percepto::geometry::Triangle{point(az1, el0), point(az0, el1),
+                                                     point(az1, el1)});
+    }
+  }
+  return scene;
+}
+
+static void report_allocations(benchmark::State& state, long allocations, long bytes, int revs)
+{
+  const double scanned = static_cast<double>(state.iterations()) * revs;
+  state.counters["allocs/rev"] = benchmark::Counter(allocations / scanned);
+  state.counters["bytes/rev"] = benchmark::Counter(bytes / scanned);
+}
+
+// Baseline: every call hands back freshly allocated frames.
+static void BM_RunScan_FreshFrames(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  const int revs = static_cast<int>(state.range(0));
+  percepto::lidar::LidarSimulator sim(
+      std::make_unique<percepto::lidar::LidarEmitter>(make_sensor()), make_scene());
+  benchmark::DoNotOptimize(sim.run_scan(1));  // Builds the scene's acceleration structures.
+
+  const long allocations = g_allocations.load();
+  const long bytes = g_allocated_bytes.load();
+  for (auto _ : state)
+  {
+    auto frames = sim.run_scan(revs);
+    benchmark::DoNotOptimize(frames.data());
+  }
+  report_allocations(state, g_allocations.load() - allocations, g_allocated_bytes.load() - bytes,
+                     revs);
+}
+
+// Frames are scanned into the same vector every call and recycled through the frame pool.
+static void BM_RunScan_PooledFrames(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  const int revs = static_cast<int>(state.range(0));
+  percepto::lidar::LidarSimulator sim(
+      std::make_unique<percepto::lidar::LidarEmitter>(make_sensor()), make_scene());
+  std::vector<percepto::common::FrameScan> frames;
+  // Warm-up: the first call builds the scene and the frames, the second sizes the pool.
+  for (int warm_up = 0; warm_up < 2; ++warm_up) sim.run_scan(revs, frames);
+
+  const long allocations = g_allocations.load();
+  const long bytes = g_allocated_bytes.load();
+  for (auto _ : state)
+  {
+    sim.run_scan(revs, frames);
+    benchmark::DoNotOptimize(frames.data());
+  }
+  report_allocations(state, g_allocations.load() - allocations, g_allocated_bytes.load() - bytes,
+                     revs);
+}
+
+BENCHMARK(BM_RunScan_FreshFrames)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RunScan_PooledFrames)->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
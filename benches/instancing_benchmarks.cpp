@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/io/logger.h"
+
+using percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Transform, percepto::core::Vec3;
+using percepto::geometry::Instance, percepto::geometry::InstancedMesh;
+using percepto::geometry::TriangleMesh, percepto::geometry::TriangleMeshBuilder;
+
+namespace
+{
+// A 2 × 24 × 12 triangle blob standing in for a tree or a parked car, about 2 m across.
+TriangleMesh make_prop()
+{
+  TriangleMeshBuilder builder;
+  auto point = [](int a, int e)
+  {
+    const double az = 2.0 * M_PI * (a % 24) / 24;
+    const double el = -M_PI / 2 + M_PI * e / 12;
+    const double r = 1.0 + 0.15 * std::sin(5 * az) * std::cos(3 * el);
+    return Vec3(r * std::cos(el) * std::cos(az), r * std::cos(el) * std::sin(az),
+                1.5 * r * std::sin(el) + 1.0);
+  };
+  for (int a = 0; a < 24; ++a)
+  {
+    for (int e = 0; e < 12; ++e)
+    {
+      builder.add_triangle(point(a, e), point(a + 1, e), point(a, e + 1));
+      builder.add_triangle(point(a + 1, e), point(a + 1, e + 1), point(a, e + 1));
+    }
+  }
+  return builder.build();
+}
+
+// 80 × 50 props lining a grid of streets around the sensor, each turned differently.
+std::vector<Transform> street_placements()
+{
+  std::vector<Transform> placements;
+  for (int x = 0; x < 80; ++x)
+  {
+    for (int y = 0; y < 50; ++y)
+    {
+      placements.push_back(Transform::translation(Vec3(x * 5.0 - 197.5, y * 6.0 - 147.0, -1.5)) *
+                           Transform::rotation(Vec3(0.0, 0.0, 1.0), 0.37 * (x * 50 + y)));
+    }
+  }
+  return placements;
+}
+
+// Arg 0: every prop flattened into one mesh; arg 1: one shared mesh and an instance per prop.
+std::unique_ptr<Scene> make_street(int64_t arg)
+{
+  const TriangleMesh prop = make_prop();
+  const auto placements = street_placements();
+  auto scene = std::make_unique<Scene>();
+  if (arg == 1)
+  {
+    auto shared = std::make_shared<const InstancedMesh>(prop);
+    for (const Transform& placement : placements) scene->add_object(Instance(shared, placement));
+    return scene;
+  }
+
+  TriangleMeshBuilder builder;
+  for (const Transform& placement : placements)
+  {
+    for (size_t t = 0; t < prop.triangle_count(); ++t)
+    {
+      builder.add_triangle(placement.point(prop.vertex(t, 0)), placement.point(prop.vertex(t, 1)),
+                           placement.point(prop.vertex(t, 2)));
+    }
+  }
+  scene->add_mesh(builder.build());
+  return scene;
+}
+
+// One revolution of a 64-channel sensor at 0.2° azimuth steps, around the horizon.
+std::vector<Ray> make_scan()
+{
+  std::vector<Ray> rays;
+  for (int a = 0; a < 1800; ++a)
+  {
+    const double az = a * M_PI / 900.0 + 0.001;
+    for (int c = 0; c < 64; ++c)
+    {
+      const double el = 0.2 - c * 0.007;
+      rays.emplace_back(Vec3(0.0, 0.0, 0.5),
+                        Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az),
+                             std::sin(el)),
+                        0.0, 200.0);
+    }
+  }
+  return rays;
+}
+}  // namespace
+
+// Time to assemble and commit the street, flattened or instanced, and the memory it then holds.
+static void BM_StreetCommit(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  size_t bytes = 0;
+  for (auto _ : state)
+  {
+    auto scene = make_street(state.range(0));
+    scene->commit();
+    bytes = scene->memory_usage().total();
+    benchmark::DoNotOptimize(scene.get());
+  }
+  state.counters["MB"] = bytes / (1024.0 * 1024.0);
+}
+
+// Closest-hit rays per second through the street.
+static void BM_StreetTrace(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  auto scene = make_street(state.range(0));
+  scene->commit();
+  const auto rays = make_scan();
+
+  int64_t hits = 0;
+  for (auto _ : state)
+  {
+    for (const Ray& ray : rays)
+    {
+      HitRecord rec;
+      hits += scene->intersect(ray, rec);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+  state.counters["hit%"] = 100.0 * hits / (state.iterations() * static_cast<double>(rays.size()));
+}
+
+BENCHMARK(BM_StreetCommit)->DenseRange(0, 1)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StreetTrace)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
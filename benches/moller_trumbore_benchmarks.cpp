@@ -2,9 +2,13 @@
 #include <optional>
 #include <vector>
 
+#include "percepto/common/types.h"
 #include "percepto/core/ray.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_block.h"
 #include "percepto/math/intersection/moller_trumbore.h"
+#include "percepto/math/intersection/moller_trumbore_block.h"
 
 static const percepto::core::Vec3 v0(0.0, 0.0, 1000.0);
 static const percepto::core::Vec3 v1(10.0, 0.0, 1000.0);
@@ -32,7 +36,86 @@ static void BM_MollerTrumbore_Miss(benchmark::State& state)
   }
 }
 
+// W copies of the benchmark triangle, each shifted along the ray so every lane is a candidate.
+template <int W>
+static percepto::geometry::TriangleBlock<W> make_block()
+{
+  percepto::geometry::TriangleBlock<W> block;
+  for (int lane = 0; lane < W; ++lane)
+  {
+    percepto::core::Vec3 shift(0.0, 0.0, 10.0 * lane);
+    block.push(percepto::geometry::Triangle(v0 + shift, v1 + shift, v2 + shift), lane);
+  }
+  return block;
+}
+
+static void report_triangles(benchmark::State& state, int triangles_per_iteration)
+{
+  const double triangles = static_cast<double>(state.iterations()) * triangles_per_iteration;
+  state.counters["triangles/s"] = benchmark::Counter(triangles, benchmark::Counter::kIsRate);
+}
+
+// Scalar baseline: W calls to moller_trumbore per iteration.
+template <int W>
+static void BM_MollerTrumbore_ScalarLoop(benchmark::State& state)
+{
+  const auto block = make_block<W>();
+  std::vector<percepto::geometry::Triangle> tris;
+  for (int lane = 0; lane < W; ++lane)
+  {
+    percepto::core::Vec3 a(block.v0x[lane], block.v0y[lane], block.v0z[lane]);
+    percepto::core::Vec3 e1(block.e1x[lane], block.e1y[lane], block.e1z[lane]);
+    percepto::core::Vec3 e2(block.e2x[lane], block.e2y[lane], block.e2z[lane]);
+    tris.emplace_back(a, a + e1, a + e2);
+  }
+
+  for (auto _ : state)
+  {
+    for (const auto& tri : tris)
+    {
+      benchmark::DoNotOptimize(
+          percepto::math::intersection::moller_trumbore(tri.v0(), tri.v1(), tri.v2(), hit_ray));
+    }
+  }
+  report_triangles(state, W);
+}
+
+template <int W>
+static void BM_MollerTrumboreBlock_Hit(benchmark::State& state)
+{
+  const auto block = make_block<W>();
+  percepto::common::TriangleHitResult hit{};
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(percepto::math::intersection::moller_trumbore_block(
+        block, hit_ray, hit_ray.tMax(), hit));
+  }
+  report_triangles(state, W);
+  state.SetLabel(percepto::math::intersection::moller_trumbore_block_isa());
+}
+
+template <int W>
+static void BM_MollerTrumboreBlock_Miss(benchmark::State& state)
+{
+  const auto block = make_block<W>();
+  percepto::common::TriangleHitResult hit{};
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(percepto::math::intersection::moller_trumbore_block(
+        block, miss_ray, miss_ray.tMax(), hit));
+  }
+  report_triangles(state, W);
+  state.SetLabel(percepto::math::intersection::moller_trumbore_block_isa());
+}
+
 BENCHMARK(BM_MollerTrumbore_Hit);
 BENCHMARK(BM_MollerTrumbore_Miss);
+BENCHMARK_TEMPLATE(BM_MollerTrumbore_ScalarLoop, 8);
+BENCHMARK_TEMPLATE(BM_MollerTrumboreBlock_Hit, 4);
+BENCHMARK_TEMPLATE(BM_MollerTrumboreBlock_Hit, 8);
+BENCHMARK_TEMPLATE(BM_MollerTrumboreBlock_Hit, 16);
+BENCHMARK_TEMPLATE(BM_MollerTrumboreBlock_Miss, 4);
+BENCHMARK_TEMPLATE(BM_MollerTrumboreBlock_Miss, 8);
+BENCHMARK_TEMPLATE(BM_MollerTrumboreBlock_Miss, 16);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/io/csv_parser.h"
+#include "percepto/io/logger.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene, percepto::core::Vec3;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+// Set by main from the executable's path, the way run_scan_full_duration finds its scenes.
+fs::path g_scene_path;
+
+std::unique_ptr<Scene> load_dense_scene(AcceleratorType accelerator)
+{
+  auto scene = percepto::io::CsvParser().load_scene_from_csv(g_scene_path.string());
+  scene->set_accelerator(accelerator);
+  scene->commit();
+  return scene;
+}
+
+// One revolution at 0.2° azimuth steps over 64 channels, all inside the dense shell's band, so
+// every ray is blocked somewhere before its full range.
+std::vector<Ray> make_scan()
+{
+  std::vector<Ray> rays;
+  for (int a = 0; a < 1800; ++a)
+  {
+    const double az = a * M_PI / 900.0;
+    for (int c = 0; c < 64; ++c)
+    {
+      const double el = -0.2 + c * 0.4 / 63;
+      rays.emplace_back(Vec3(0, 0, 0),
+                        Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az),
+                             std::sin(el)),
+                        0.0, 2000.0);
+    }
+  }
+  return rays;
+}
+
+AcceleratorType accelerator_arg(const benchmark::State& state)
+{
+  static const AcceleratorType kAccelerators[] = {AcceleratorType::Bvh, AcceleratorType::Bvh4,
+                                                  AcceleratorType::Bvh8};
+  return kAccelerators[state.range(0)];
+}
+}  // namespace
+
+// Closest hit for every ray, the baseline an occlusion query is compared against.
+// Arg: 0 = binary BVH, 1 = 4-wide, 2 = 8-wide.
+static void BM_DenseClosestHit(benchmark::State& state)
+{
+  auto scene = load_dense_scene(accelerator_arg(state));
+  const auto rays = make_scan();
+  for (auto _ : state)
+  {
+    for (const Ray& ray : rays)
+    {
+      HitRecord rec;
+      benchmark::DoNotOptimize(scene->intersect(ray, rec));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+}
+
+// The same rays through Scene::occluded, which stops at the first hit it meets.
+static void BM_DenseOccluded(benchmark::State& state)
+{
+  auto scene = load_dense_scene(accelerator_arg(state));
+  const auto rays = make_scan();
+  for (auto _ : state)
+  {
+    for (const Ray& ray : rays) benchmark::DoNotOptimize(scene->occluded(ray));
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+}
+
+// Packets of neighbouring rays: Arg 0 = closest hit, 1 = occlusion. Packets need the binary BVH.
+static void BM_DensePacket(benchmark::State& state)
+{
+  auto scene = load_dense_scene(AcceleratorType::Bvh);
+  const auto rays = make_scan();
+  std::vector<RayPacket> packets;
+  for (size_t first = 0; first < rays.size(); first += RayPacket::kMaxSize)
+  {
+    packets.emplace_back();
+    for (size_t i = first; i < first + RayPacket::kMaxSize && i < rays.size(); ++i)
+    {
+      packets.back().push(rays[i]);
+    }
+  }
+
+  HitRecord records[RayPacket::kMaxSize];
+  for (auto _ : state)
+  {
+    for (const RayPacket& packet : packets)
+    {
+      if (state.range(0) == 0)
+      {
+        benchmark::DoNotOptimize(scene->intersect_packet(packet, records));
+      }
+      else
+      {
+        benchmark::DoNotOptimize(scene->occluded_packet(packet));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+}
+
+BENCHMARK(BM_DenseClosestHit)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DenseOccluded)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DensePacket)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  g_scene_path = fs::canonical(fs::path(argv[0])).parent_path() / "../../scenes/dense_scene.csv";
+  if (!fs::exists(g_scene_path))
+  {
+    std::cerr << "Dense scene not found at " << g_scene_path
+              << "; generate it with scripts/gen_scene.py." << std::endl;
+    return 1;
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
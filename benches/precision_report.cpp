@@ -0,0 +1,157 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "percepto/common/config_loader.h"
+#include "percepto/common/frame_scan.h"
+#include "percepto/io/csv_parser.h"
+#include "percepto/io/logger.h"
+#include "percepto/lidar/emitter.h"
+#include "percepto/lidar/simulator.h"
+
+using namespace std::chrono;
+using percepto::common::Precision;
+namespace fs = std::filesystem;
+
+// Accuracy of `Precision::Single` against the double path: one revolution is traced with each,
+// beam by beam, and the returns are compared.
+
+fs::path resolve_scene_path(const std::string& arg, std::string file_name)
+{
+  try
+  {
+    fs::path exe_path = fs::canonical(fs::path(arg));
+    fs::path exe_dir = exe_path.parent_path();
+
+    return exe_dir / "../../scenes" / file_name;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "[PANIC] Failed to resolve path from arg: " << arg << "\n";
+    std::cerr << "Reason: " << e.what() << "\n";
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+struct PrecisionRun
+{
+  percepto::common::FrameScan frame{0, 0};
+  percepto::core::Vec3 origin;
+  double rays_per_second = 0.0;
+  size_t acceleration_bytes = 0;
+};
+
+PrecisionRun trace(const fs::path& scene_path, const percepto::common::LiDARConfig& lidar_cfg,
+                   const percepto::common::RayTracerConfig& tracer_cfg, Precision precision)
+{
+  auto emitter_ptr = std::make_unique<percepto::lidar::LidarEmitter>(lidar_cfg);
+  percepto::io::CsvParser parser;
+  auto scene_ptr = parser.load_scene_from_csv(scene_path.string());
+  scene_ptr->set_accelerator(tracer_cfg.accelerator);
+  scene_ptr->set_cull_mode(tracer_cfg.cull_mode);
+  scene_ptr->set_precision(precision);
+  scene_ptr->commit();
+
+  PrecisionRun run;
+  run.origin = emitter_ptr->origin();
+  run.acceleration_bytes = scene_ptr->memory_usage().acceleration;
+  const int total_rays = emitter_ptr->azimuth_steps() * emitter_ptr->elevation_angles().size();
+
+  percepto::lidar::LidarSimulator sim(std::move(emitter_ptr), std::move(scene_ptr));
+  percepto::lidar::ScanOptions scan_options;
+  scan_options.thread_count = tracer_cfg.thread_count;
+  scan_options.packet_size = tracer_cfg.packet_size;
+  scan_options.packet_layout = tracer_cfg.packet_layout;
+  sim.set_scan_options(scan_options);
+
+  auto start = high_resolution_clock::now();
+  auto frames = sim.run_scan();
+  auto end = high_resolution_clock::now();
+  run.rays_per_second = total_rays / duration<double>(end - start).count();
+  run.frame = std::move(frames[0]);
+  return run;
+}
+
+int main(int argc, char** argv)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+
+  if (argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " [dense|sparse]" << std::endl;
+    return 1;
+  }
+
+  std::string scene_type = argv[1];
+  if (scene_type != "dense" && scene_type != "sparse")
+  {
+    std::cerr << "Error: Invalid scene type. Use 'dense' or 'sparse'." << std::endl;
+    return 1;
+  }
+  const fs::path scene_path = resolve_scene_path(argv[0], scene_type + "_scene.csv");
+
+  percepto::common::LiDARConfig lidar_cfg;
+  percepto::common::RayTracerConfig tracer_cfg;
+  try
+  {
+    lidar_cfg = percepto::common::ConfigLoader::loadLiDARConfig();
+    tracer_cfg = percepto::common::ConfigLoader::loadRayTracerConfig();
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Failed to load configuration: " << e.what() << std::endl;
+    return 1;
+  }
+
+  const PrecisionRun reference = trace(scene_path, lidar_cfg, tracer_cfg, Precision::Double);
+  const PrecisionRun single = trace(scene_path, lidar_cfg, tracer_cfg, Precision::Single);
+
+  // Ranges are stored as float, so the distances are compared on the double hit points.
+  const auto& origin = reference.origin;
+  // Beams in the plane of an edge two triangles share can slip between them in double; the
+  // float kernel's edge slack closes that crack, so those are counted apart from real losses.
+  int double_only = 0, single_only = 0;
+  std::vector<double> errors;
+  for (size_t k = 0; k < reference.frame.ranges.size(); ++k)
+  {
+    const bool hit = reference.frame.ranges[k] > 0.0f;
+    const bool single_hit = single.frame.ranges[k] > 0.0f;
+    double_only += hit && !single_hit;
+    single_only += single_hit && !hit;
+    if (!hit || !single_hit) continue;
+    errors.push_back(std::abs((single.frame.points[k] - origin).length() -
+                              (reference.frame.points[k] - origin).length()));
+  }
+  std::sort(errors.begin(), errors.end());
+  double mean = 0.0;
+  for (double e : errors) mean += e;
+  if (!errors.empty()) mean /= errors.size();
+  const double p99 = errors.empty() ? 0.0 : errors[errors.size() * 99 / 100];
+  const double max = errors.empty() ? 0.0 : errors.back();
+
+  std::cout << "\n--- Percepto Precision Report (" << scene_type << " scene) ---" << std::endl;
+  std::cout << "  Total Rays Cast: " << reference.frame.ranges.size() << std::endl;
+  std::cout << "  Hits (double):   " << reference.frame.hits << std::endl;
+  std::cout << "  Hits (single):   " << single.frame.hits << std::endl;
+  std::cout << "  Lost in single:  " << double_only << std::endl;
+  std::cout << "  Edge Cracks:     " << single_only << " (hit in single only)" << std::endl;
+  std::cout << "  |dRange| max:    " << max << " m" << std::endl;
+  std::cout << "  |dRange| mean:   " << mean << " m" << std::endl;
+  std::cout << "  |dRange| p99:    " << p99 << " m" << std::endl;
+  std::cout << "  Accel (double):  " << reference.acceleration_bytes / (1024.0 * 1024.0) << " MB"
+            << std::endl;
+  std::cout << "  Accel (single):  " << single.acceleration_bytes / (1024.0 * 1024.0) << " MB"
+            << std::endl;
+  std::cout << "  Rays/s (double): " << reference.rays_per_second << std::endl;
+  std::cout << "  Rays/s (single): " << single.rays_per_second << std::endl;
+  std::cout << "--------------------------------------------------------" << std::endl;
+
+  return 0;
+}
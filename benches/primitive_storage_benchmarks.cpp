@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "percepto/accel/angular_grid.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/io/logger.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+constexpr int kTriangles = 300000;
+constexpr int kSpheres = 20000;
+constexpr int kAzimuthSteps = 1800;
+constexpr int kChannels = 32;
+
+percepto::accel::AngularGridLayout sensor_layout()
+{
+  percepto::accel::AngularGridLayout layout;
+  for (int a = 0; a < kAzimuthSteps; ++a) layout.azimuth_angles.push_back(a * M_PI / 900.0);
+  for (int c = 0; c < kChannels; ++c) layout.elevation_angles.push_back(-0.4 + c * 0.02);
+  return layout;
+}
+
+// Free triangles and spheres scattered around a sensor at the origin, all added with add_object.
+Scene make_clutter(AcceleratorType accelerator, bool angular_grid)
+{
+  std::mt19937 rng(23);
+  std::uniform_real_distribution<double> xy(-80.0, 80.0), z(-3.0, 4.0);
+  Scene scene;
+  scene.set_accelerator(accelerator);
+  scene.reserve(kTriangles + kSpheres);
+  for (int i = 0; i < kTriangles; ++i)
+  {
+    const Vec3 p(xy(rng), xy(rng), z(rng));
+    scene.add_object(Triangle(p, p + Vec3(0.4, 0.1, 0.0), p + Vec3(0.0, 0.1, 0.4)));
+  }
+  for (int i = 0; i < kSpheres; ++i) scene.add_object(Sphere(Vec3(xy(rng), xy(rng), z(rng)), 0.3));
+  if (angular_grid) scene.set_angular_grid(sensor_layout());
+  scene.commit();
+  return scene;
+}
+
+Ray sensor_ray(const percepto::accel::AngularGridLayout& layout, int a, int c)
+{
+  const double az = layout.azimuth_angles[a], el = layout.elevation_angles[c];
+  return Ray::fromUnitDirection(
+      layout.origin, Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)),
+      0.0, 200.0);
+}
+}  // namespace
+
+// Heap bytes the free objects take per object, with no tracing in the loop.
+static void BM_ObjectMemory(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  for (auto _ : state)
+  {
+    Scene scene = make_clutter(AcceleratorType::None, false);
+    state.counters["object_bytes/object"] =
+        static_cast<double>(scene.memory_usage().objects) / (kTriangles + kSpheres);
+  }
+}
+
+// One revolution of sensor rays. Arg: 0 = binary BVH, 1 = angular grid, which tests the
+// primitives of each cell straight from the scene's object storage.
+static void BM_ClutterScan(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  const bool grid = state.range(0) == 1;
+  Scene scene = make_clutter(AcceleratorType::Bvh, grid);
+  const auto layout = sensor_layout();
+  for (auto _ : state)
+  {
+    for (int a = 0; a < kAzimuthSteps; ++a)
+    {
+      for (int c = 0; c < kChannels; ++c)
+      {
+        HitRecord rec;
+        benchmark::DoNotOptimize(scene.intersect_sensor_ray(a, c, sensor_ray(layout, a, c), rec));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kAzimuthSteps * kChannels);
+}
+
+BENCHMARK(BM_ObjectMemory)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ClutterScan)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -10,7 +10,10 @@
 #include <toml++/toml.hpp>
 #include <vector>
 
+#include "percepto/accel/bvh.h"
 #include "percepto/common/config_loader.h"
+#include "percepto/common/cpu_features.h"
+#include "percepto/common/thread_pool.h"
 #include "percepto/io/csv_parser.h"
 #include "percepto/io/logger.h"
 #include "percepto/lidar/emitter.h"
@@ -40,11 +43,24 @@ int main(int argc, char** argv)
 {
   get_percepto_logger()->set_level(spdlog::level::off);
 
-  if (argc != 2)
+  if (argc != 2 && argc != 3)
   {
-    std::cerr << "Usage: " << argv[0] << " [dense|sparse]" << std::endl;
+    std::cerr << "Usage: " << argv[0] << " [dense|sparse] [scalar|avx2|avx512]" << std::endl;
     return 1;
   }
+  if (argc == 3)
+  {
+    // Benchmarks the SIMD kernels of one instruction set against another.
+    try
+    {
+      percepto::common::set_isa(percepto::common::parse_isa(argv[2]));
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return 1;
+    }
+  }
 
   std::string scene_type = argv[1];
   std::string file_name;
@@ -66,10 +82,12 @@ int main(int argc, char** argv)
   }
 
   percepto::common::LiDARConfig lidar_cfg;
+  percepto::common::RayTracerConfig tracer_cfg;
   resolve_scene_path(argv[0], file_name).string();
   try
   {
     lidar_cfg = percepto::common::ConfigLoader::loadLiDARConfig();
+    tracer_cfg = percepto::common::ConfigLoader::loadRayTracerConfig();
   }
   catch (const std::exception& e)
   {
@@ -84,9 +102,42 @@ int main(int argc, char** argv)
   auto scene_ptr = parser.load_scene_from_csv(resolve_scene_path(argv[0], file_name).string());
   std::cout << "Loaded " << scene_ptr->size() << " triangles." << std::endl;
 
+  scene_ptr->set_accelerator(tracer_cfg.accelerator);
+  scene_ptr->set_precision(tracer_cfg.precision);
+  auto bvh_options = scene_ptr->bvh_options();
+  bvh_options.builder = tracer_cfg.bvh_builder;
+  bvh_options.treelet_optimization = tracer_cfg.bvh_treelets;
+  scene_ptr->set_bvh_options(bvh_options);
+  if (tracer_cfg.angular_grid)
+  {
+    // Same layout run_scan sets, so the grid is built here and timed with the accelerator.
+    scene_ptr->set_angular_grid({emitter_ptr->origin(), emitter_ptr->azimuth_angles(),
+                                 emitter_ptr->elevation_angles()});
+  }
+  if (tracer_cfg.direction_table)
+  {
+    // Built outside the timed scan, like the accelerator.
+    emitter_ptr->enable_direction_table();
+  }
+  auto build_start = high_resolution_clock::now();
+  scene_ptr->commit();
+  auto build_end = high_resolution_clock::now();
+  double build_ms = duration<double, std::milli>(build_end - build_start).count();
+
   int total_rays = emitter_ptr->azimuth_steps() * emitter_ptr->elevation_angles().size();
 
   percepto::lidar::LidarSimulator sim(std::move(emitter_ptr), std::move(scene_ptr));
+  percepto::lidar::ScanOptions scan_options;
+  scan_options.thread_count = tracer_cfg.thread_count;
+  scan_options.azimuth_tile_size = tracer_cfg.azimuth_tile_size;
+  scan_options.angular_grid = tracer_cfg.angular_grid;
+  scan_options.direction_table = tracer_cfg.direction_table;
+  scan_options.packet_size = tracer_cfg.packet_size;
+  scan_options.packet_layout = tracer_cfg.packet_layout;
+  scan_options.backend = tracer_cfg.scan_backend;
+  scan_options.trace_rays = tracer_cfg.trace_rays;
+  scan_options.ray_trace_file = tracer_cfg.ray_trace_file;
+  sim.set_scan_options(scan_options);
 
   std::cout << "LiDARScanner initialized with " << sim.emitter().azimuth_steps()
             << " azimuth steps and " << sim.emitter().elevation_angles().size()
@@ -103,6 +154,63 @@ int main(int argc, char** argv)
   std::cout << "\n--- Percepto Scan Benchmark Results (" << scene_type << " scene) ---"
             << std::endl;
   std::cout << "  Scene Triangles: " << sim.scene().size() << std::endl;
+  static const char* const kAcceleratorNames[] = {"none", "bvh", "bvh4", "bvh8"};
+  std::cout << "  Accelerator:     " << kAcceleratorNames[static_cast<int>(tracer_cfg.accelerator)]
+            << std::endl;
+  if (percepto::common::uses_bvh(tracer_cfg.accelerator))
+  {
+    std::cout << "  BVH Builder:     "
+              << (tracer_cfg.bvh_builder == percepto::common::BvhBuilder::Lbvh
+                      ? (tracer_cfg.bvh_treelets ? "lbvh + treelets" : "lbvh")
+                      : "sah")
+              << std::endl;
+  }
+  std::cout << "  SIMD ISA:        " << percepto::common::isa_name(percepto::common::active_isa())
+            << std::endl;
+  std::cout << "  Precision:       "
+            << (tracer_cfg.precision == percepto::common::Precision::Single ? "single" : "double")
+            << std::endl;
+  std::cout << "  Scan Backend:    "
+            << (tracer_cfg.scan_backend == percepto::common::ScanBackend::Rasterize ? "rasterize"
+                                                                                     : "raytrace")
+            << std::endl;
+  std::cout << "  Angular Grid:    ";
+  if (sim.scene().has_angular_grid())
+  {
+    const auto& grid = sim.scene().angular_grid();
+    std::cout << grid.entry_count() << " entries, " << grid.memory_bytes() / (1024.0 * 1024.0)
+              << " MB" << std::endl;
+  }
+  else
+  {
+    std::cout << "off" << std::endl;
+  }
+  std::cout << "  Direction Table: ";
+  if (sim.emitter().has_direction_table())
+  {
+    std::cout << sim.emitter().direction_table_bytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+  }
+  else
+  {
+    std::cout << "off" << std::endl;
+  }
+  std::cout << "  Ray Packets:     ";
+  if (sim.scan_options().packet_size > 1 && !sim.scene().has_angular_grid())
+  {
+    std::cout << sim.scan_options().packet_size << " rays along "
+              << (sim.scan_options().packet_layout == percepto::common::PacketLayout::Column
+                      ? "columns"
+                      : "azimuth")
+              << std::endl;
+  }
+  else
+  {
+    std::cout << "off" << std::endl;
+  }
+  std::cout << "  Build Time:      " << build_ms << " ms" << std::endl;
+  std::cout << "  Scan Threads:    "
+            << percepto::common::ThreadPool::resolve_thread_count(tracer_cfg.thread_count)
+            << std::endl;
   std::cout << "  Total Rays Cast: " << total_rays << std::endl;
   std::cout << "  Hits Detected:   " << frames[0].hits << std::endl;
   std::cout << "  Total Runtime:   " << scan_seconds * 1000.0 << " ms (" << scan_seconds << " s)"
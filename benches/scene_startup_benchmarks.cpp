@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+#include "percepto/io/binary_scene.h"
+#include "percepto/io/bvh_cache.h"
+#include "percepto/io/csv_parser.h"
+#include "percepto/io/logger.h"
+
+namespace fs = std::filesystem;
+
+// A 500 × 1000 quad height field: 1M triangles sharing their vertices, written once per process
+// as CSV (~170 MB), converted to a binary scene with its BVH and given a BVH cache file.
+struct StartupScenes
+{
+  fs::path csv = fs::temp_directory_path() / "percepto_startup_bench.csv";
+  fs::path binary = fs::temp_directory_path() / "percepto_startup_bench.pscn";
+  fs::path bvh_cache = fs::temp_directory_path() / "percepto_startup_bench.csv.pbvh";
+};
+
+static const StartupScenes& scenes()
+{
+  static const StartupScenes files = []
+  {
+    get_percepto_logger()->set_level(spdlog::level::off);
+    StartupScenes s;
+    {
+      std::ofstream out(s.csv);
+      out << "x0,y0,z0,x1,y1,z1,x2,y2,z2\n";
+      out.precision(17);
+      auto vertex = [&](int x, int y)
+      { out << x * 0.1 << ',' << y * 0.1 << ',' << std::sin(x * 0.05) * std::cos(y * 0.07); };
+      for (int y = 0; y < 500; ++y)
+      {
+        for (int x = 0; x < 1000; ++x)
+        {
+          vertex(x, y), out << ',', vertex(x + 1, y), out << ',', vertex(x + 1, y + 1), out << '\n';
+          vertex(x, y), out << ',', vertex(x + 1, y + 1), out << ',', vertex(x, y + 1), out << '\n';
+        }
+      }
+    }
+    auto scene = percepto::io::CsvParser().load_scene_from_csv(s.csv.string());
+    percepto::io::BinarySceneWriter().write(*scene, s.binary.string());
+    fs::remove(s.bvh_cache);
+    percepto::io::commit_with_bvh_cache(*scene, s.bvh_cache.string());
+    return s;
+  }();
+  return files;
+}
+
+// Everything between the file and a scene ready to trace: parse, then build or install the BVH.
+static void BM_Startup_Csv(benchmark::State& state)
+{
+  const std::string file = scenes().csv.string();
+  for (auto _ : state)
+  {
+    auto scene = percepto::io::CsvParser().load_scene_from_csv(file);
+    scene->set_accelerator(percepto::common::AcceleratorType::Bvh);
+    scene->commit();
+    benchmark::DoNotOptimize(scene.get());
+  }
+}
+
+// The CSV parse again, with the BVH loaded from its cache file instead of built.
+static void BM_Startup_CsvCached(benchmark::State& state)
+{
+  const std::string file = scenes().csv.string();
+  const std::string cache = scenes().bvh_cache.string();
+  for (auto _ : state)
+  {
+    auto scene = percepto::io::CsvParser().load_scene_from_csv(file);
+    scene->set_accelerator(percepto::common::AcceleratorType::Bvh);
+    if (percepto::io::commit_with_bvh_cache(*scene, cache) != percepto::io::BvhCacheStatus::Hit)
+    {
+      state.SkipWithError("BVH cache miss");
+      break;
+    }
+    benchmark::DoNotOptimize(scene.get());
+  }
+}
+
+static void BM_Startup_Binary(benchmark::State& state)
+{
+  const std::string file = scenes().binary.string();
+  for (auto _ : state)
+  {
+    auto scene = percepto::io::BinarySceneParser().load_scene_from_binary(file);
+    scene->set_accelerator(percepto::common::AcceleratorType::Bvh);
+    scene->commit();
+    benchmark::DoNotOptimize(scene.get());
+  }
+}
+
+BENCHMARK(BM_Startup_Csv)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Startup_CsvCached)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Startup_Binary)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
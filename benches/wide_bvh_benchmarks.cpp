@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/io/logger.h"
+
+using percepto::accel::TraversalStats;
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+
+namespace
+{
+// A 400 × 400 quad height field (320k triangles) seen from a sensor 2 m above its centre.
+std::unique_ptr<Scene> make_terrain(AcceleratorType accelerator)
+{
+  percepto::geometry::TriangleMeshBuilder builder;
+  auto vertex = [](int x, int y)
+  {
+    return Vec3(x * 0.25 - 50.0, y * 0.25 - 50.0,
+                std::sin(x * 0.11) * std::cos(y * 0.07) + 0.3 * std::sin(x * y * 0.001));
+  };
+  for (int y = 0; y < 400; ++y)
+  {
+    for (int x = 0; x < 400; ++x)
+    {
+      builder.add_triangle(vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1));
+      builder.add_triangle(vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1));
+    }
+  }
+  auto scene = std::make_unique<Scene>();
+  scene->set_accelerator(accelerator);
+  scene->add_mesh(builder.build());
+  scene->commit();
+  return scene;
+}
+
+// One revolution of a 64-channel sensor at 0.2° azimuth steps, all pointing downwards.
+std::vector<Ray> make_scan()
+{
+  std::vector<Ray> rays;
+  const Vec3 origin(0.0, 0.0, 3.0);
+  for (int a = 0; a < 1800; ++a)
+  {
+    const double az = a * M_PI / 900.0;
+    for (int c = 0; c < 64; ++c)
+    {
+      const double el = -0.05 - c * 0.01;
+      rays.emplace_back(origin,
+                        Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az),
+                             std::sin(el)),
+                        0.0, 200.0);
+    }
+  }
+  return rays;
+}
+
+// Traverses the scene's tree for `accelerator` once more with counters on. Leaves are tested one
+// primitive at a time, which is slower but visits exactly the nodes the scene's traversal does.
+template <typename Tree>
+TraversalStats count_visits(const Scene& scene, const Tree& tree, const std::vector<Ray>& rays)
+{
+  TraversalStats stats;
+  const auto& bvh = scene.bvh();
+  for (const Ray& ray : rays)
+  {
+    tree.traverse(
+        ray, ray.tMax(),
+        [&](uint32_t leaf, double& t_max)
+        {
+          bool hit = false;
+          const auto& node = bvh.nodes()[leaf];
+          for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+          {
+            Ray clipped = ray;
+            clipped.setTMax(t_max);
+            HitRecord rec;
+            const auto prim = scene.primitive(bvh.prim_indices()[i]);
+            if (std::visit([&](const auto& p) { return p.intersect(clipped, rec); }, prim) &&
+                rec.t < t_max)
+            {
+              t_max = rec.t;
+              hit = true;
+            }
+          }
+          return hit;
+        },
+        &stats);
+  }
+  return stats;
+}
+}  // namespace
+
+// Closest-hit rays per second through Scene::intersect, plus node visits and box tests per ray.
+// Arg: 0 = binary BVH, 1 = 4-wide, 2 = 8-wide.
+static void BM_SceneIntersect(benchmark::State& state)
+{
+  get_percepto_logger()->set_level(spdlog::level::off);
+  static const AcceleratorType kAccelerators[] = {AcceleratorType::Bvh, AcceleratorType::Bvh4,
+                                                  AcceleratorType::Bvh8};
+  const auto accelerator = kAccelerators[state.range(0)];
+  auto scene = make_terrain(accelerator);
+  const auto rays = make_scan();
+
+  for (auto _ : state)
+  {
+    for (const Ray& ray : rays)
+    {
+      HitRecord rec;
+      benchmark::DoNotOptimize(scene->intersect(ray, rec));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+
+  TraversalStats stats;
+  if (accelerator == AcceleratorType::Bvh) stats = count_visits(*scene, scene->bvh(), rays);
+  if (accelerator == AcceleratorType::Bvh4) stats = count_visits(*scene, scene->bvh4(), rays);
+  if (accelerator == AcceleratorType::Bvh8) stats = count_visits(*scene, scene->bvh8(), rays);
+  const double n = static_cast<double>(rays.size());
+  state.counters["nodes/ray"] = stats.nodes / n;
+  state.counters["boxes/ray"] = stats.box_tests / n;
+  state.counters["leaves/ray"] = stats.leaves / n;
+}
+
+BENCHMARK(BM_SceneIntersect)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+namespace percepto::accel
+{
+/**
+ * @brief Solid angle a box subtends from a sensor origin, as azimuth and elevation intervals.
+ *
+ * The azimuth interval may extend below 0 or past 2π; `AngleTable::for_each_azimuth` handles
+ * the wrap-around.
+ */
+struct AngularFootprint
+{
+  bool full_azimuth = false;  // The box straddles the vertical axis through the origin.
+  double azimuth_lo = 0.0, azimuth_hi = 0.0;
+  double elevation_lo = 0.0, elevation_hi = 0.0;
+};
+
+/**
+ * @brief Conservative angular footprint of `box` seen from `origin`.
+ *
+ * Every point of the box lies inside the returned intervals, widened slightly so that rays
+ * lying exactly on an edge are not lost to atan2 rounding.
+ */
+AngularFootprint angular_footprint(const percepto::geometry::AABB& box,
+                                   const percepto::core::Vec3& origin);
+
+/// Sensor angle table sorted ascending, remembering each entry's position in the original table.
+class AngleTable
+{
+ public:
+  AngleTable() = default;
+  explicit AngleTable(const std::vector<double>& table);
+
+  /// Calls fn(original_index) for every angle in [lo, hi].
+  template <typename Fn>
+  void for_each_in(double lo, double hi, Fn&& fn) const
+  {
+    auto first = std::lower_bound(angles_.begin(), angles_.end(), lo);
+    auto last = std::upper_bound(first, angles_.end(), hi);
+    for (auto it = first; it != last; ++it) fn(index_[it - angles_.begin()]);
+  }
+
+  /// Calls fn(original_index) for every azimuth in [0, 2π) inside the footprint's azimuth range.
+  template <typename Fn>
+  void for_each_azimuth(const AngularFootprint& fp, Fn&& fn) const
+  {
+    constexpr double kTwoPi = 2.0 * M_PI;
+    const double width = fp.azimuth_hi - fp.azimuth_lo;
+    if (fp.full_azimuth || width >= kTwoPi)
+    {
+      for_each_in(-std::numeric_limits<double>::infinity(),
+                  std::numeric_limits<double>::infinity(), fn);
+      return;
+    }
+
+    const double lo = fp.azimuth_lo - kTwoPi * std::floor(fp.azimuth_lo / kTwoPi);
+    const double hi = lo + width;
+    for_each_in(lo, hi, fn);
+    if (hi >= kTwoPi) for_each_in(0.0, hi - kTwoPi, fn);
+  }
+
+  /// Calls fn(original_index) for every elevation inside the footprint's elevation range.
+  template <typename Fn>
+  void for_each_elevation(const AngularFootprint& fp, Fn&& fn) const
+  {
+    for_each_in(fp.elevation_lo, fp.elevation_hi, fn);
+  }
+
+ private:
+  std::vector<double> angles_;
+  std::vector<int> index_;
+};
+}  // namespace percepto::accel
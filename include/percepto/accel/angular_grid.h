@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+namespace percepto::accel
+{
+/**
+ * @brief Fixed set of sensor rays the angular grid is built for.
+ *
+ * Every ray starts at `origin` and points along one (azimuth, elevation) pair from the tables,
+ * as produced by `LidarEmitter::get_ray`.
+ */
+struct AngularGridLayout
+{
+  percepto::core::Vec3 origin;
+  std::vector<double> azimuth_angles;    // Radians, in [0, 2π).
+  std::vector<double> elevation_angles;  // Radians, in [-π/2, π/2].
+
+  bool operator==(const AngularGridLayout& other) const
+  {
+    return origin == other.origin && azimuth_angles == other.azimuth_angles &&
+           elevation_angles == other.elevation_angles;
+  }
+  bool operator!=(const AngularGridLayout& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Sensor-centric index with one cell per emitter ray.
+ *
+ * When every ray leaves the same origin along a fixed table of angles, a primitive can only be
+ * hit by the rays whose direction lies inside the solid angle it subtends from that origin. The
+ * grid bins each primitive once, by that angular footprint, into the cells of the (azimuth,
+ * elevation) rays it covers; tracing ray (i, j) then only tests the primitives of cell (i, j).
+ *
+ * Footprints are taken from primitive bounds, so binning is conservative: a cell may hold
+ * primitives its ray misses, but never lacks one it hits. The grid is only valid for rays from
+ * `layout().origin`; callers must fall back to a general structure for any other ray.
+ */
+class AngularGrid
+{
+ public:
+  /**
+   * @brief Bins every primitive into the cells of the sensor rays it may intersect.
+   *
+   * @param layout       Sensor origin and angle tables.
+   * @param prim_bounds  Bounds of every primitive; primitive ids are indices into this vector.
+   *                     Primitives with empty bounds are left out of every cell.
+   */
+  void build(const AngularGridLayout& layout,
+             const std::vector<percepto::geometry::AABB>& prim_bounds);
+
+  void clear();
+
+  bool empty() const { return cell_offsets_.empty(); }
+  const AngularGridLayout& layout() const noexcept { return layout_; }
+
+  int azimuth_count() const { return static_cast<int>(layout_.azimuth_angles.size()); }
+  int elevation_count() const { return static_cast<int>(layout_.elevation_angles.size()); }
+
+  /// Index of the cell traced by azimuth step `azimuth_index` and channel `elevation_index`.
+  size_t cell_index(int azimuth_index, int elevation_index) const
+  {
+    return static_cast<size_t>(azimuth_index) * layout_.elevation_angles.size() +
+           static_cast<size_t>(elevation_index);
+  }
+
+  /// Primitive ids binned into `cell`, in ascending order: [cell_begin(cell), cell_end(cell)).
+  const uint32_t* cell_begin(size_t cell) const
+  {
+    return prim_indices_.data() + cell_offsets_[cell];
+  }
+  const uint32_t* cell_end(size_t cell) const
+  {
+    return prim_indices_.data() + cell_offsets_[cell + 1];
+  }
+
+  /// Total number of (cell, primitive) entries; primitives spanning several rays count once each.
+  size_t entry_count() const { return prim_indices_.size(); }
+
+  /// Heap memory held by the grid, in bytes.
+  size_t memory_bytes() const;
+
+ private:
+  AngularGridLayout layout_;
+  std::vector<uint32_t> cell_offsets_;  // cell_count + 1 prefix offsets into prim_indices_.
+  std::vector<uint32_t> prim_indices_;
+};
+}  // namespace percepto::accel
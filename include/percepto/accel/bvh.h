@@ -0,0 +1,394 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+namespace percepto::accel
+{
+/**
+ * @brief Tuning knobs for the BVH builders.
+ *
+ * Costs are relative: only the ratio traversal_cost / intersection_cost matters. Both builders
+ * use them to decide where to stop splitting; the LBVH builder also uses them to pick treelet
+ * topologies.
+ */
+struct BvhBuildOptions
+{
+  percepto::common::BvhBuilder builder = percepto::common::BvhBuilder::Sah;
+  int bin_count = 16;              // SAH bins evaluated per axis.
+  int max_leaf_size = 4;           // Nodes above this size are always split.
+  double traversal_cost = 1.0;     // Cost of visiting one interior node.
+  double intersection_cost = 1.0;  // Cost of testing one primitive.
+
+  // LBVH only.
+  int morton_bits = 63;               // 30 (10 per axis, 4 sort passes) or 63 (21 per axis, 8).
+  bool treelet_optimization = false;  // Re-optimize small treelets for SAH after the build.
+  int thread_count = 0;               // Build threads; 0 = one per core.
+
+  // Dynamic scenes: once refits have grown `Bvh::sah_area()` past this multiple of its value
+  // after the last build, `Scene::commit()` rebuilds the degraded part of the tree.
+  double rebuild_ratio = 1.4;
+
+  bool operator==(const BvhBuildOptions& other) const
+  {
+    return builder == other.builder && bin_count == other.bin_count &&
+           max_leaf_size == other.max_leaf_size && traversal_cost == other.traversal_cost &&
+           intersection_cost == other.intersection_cost && morton_bits == other.morton_bits &&
+           treelet_optimization == other.treelet_optimization &&
+           thread_count == other.thread_count && rebuild_ratio == other.rebuild_ratio;
+  }
+  bool operator!=(const BvhBuildOptions& other) const { return !(*this == other); }
+};
+
+/// Counters filled in by `Bvh::traverse` and `WideBvh::traverse` when given a stats object.
+struct TraversalStats
+{
+  uint64_t nodes = 0;      // Interior nodes whose children were tested.
+  uint64_t box_tests = 0;  // Child bounding boxes slab-tested.
+  uint64_t leaves = 0;     // Leaves handed to the caller.
+};
+
+/**
+ * @brief Flattened BVH node (depth-first layout).
+ *
+ * For interior nodes the left child is stored immediately after its parent and `offset` is the
+ * index of the right child. For leaves `offset` is the first entry in `Bvh::prim_indices()` and
+ * `count` the number of primitives.
+ */
+struct BvhNode
+{
+  percepto::geometry::AABB bounds;
+  uint32_t offset = 0;
+  uint32_t count = 0;
+
+  bool is_leaf() const { return count > 0; }
+};
+
+/**
+ * @brief Binary bounding volume hierarchy over opaque primitives.
+ *
+ * The BVH only knows primitive bounds; the caller supplies the per-primitive intersection test
+ * at traversal time. This keeps it independent of how the scene stores its geometry.
+ *
+ * @code
+ * Bvh bvh;
+ * bvh.build(bounds);
+ * bool hit = bvh.traverse(ray, ray.tMax(), [&](uint32_t leaf, double& t_max) {
+ *   // test the primitives of nodes()[leaf]; on a closer hit shrink t_max and return true
+ * });
+ * @endcode
+ */
+class Bvh
+{
+ public:
+  // Upper bound on the traversal stack; the builder falls back to median splits well before
+  // the tree can get this deep.
+  static constexpr int kMaxDepth = 96;
+
+  /**
+   * @brief Builds the hierarchy with the builder selected in `options`.
+   *
+   * The default is a binned surface-area heuristic. The LBVH builder sorts the primitives along
+   * a Morton curve instead; should its tree come out deeper than `kMaxDepth`, the SAH builder
+   * runs instead.
+   *
+   * @param prim_bounds  Bounds of every primitive; primitive ids are indices into this vector.
+   * @param options      Builder parameters.
+   */
+  void build(const std::vector<percepto::geometry::AABB>& prim_bounds,
+             const BvhBuildOptions& options = {});
+
+  void clear();
+
+  /**
+   * @brief Adopts a hierarchy built earlier, e.g. one stored in a binary scene file.
+   *
+   * The arrays must have the layout `build` produces; they are not validated here. Trees read
+   * from outside the process should pass `valid_layout` first.
+   */
+  void assign(std::vector<BvhNode> nodes, std::vector<uint32_t> prim_indices);
+
+  /**
+   * @brief Whether the arrays form a tree over `primitive_count` primitives that traversal can
+   * walk safely, e.g. one read back from a file.
+   *
+   * Checks the layout `build` produces: no nodes exactly when there are no primitives, one
+   * primitive index per primitive and each below `primitive_count`, leaves within the index
+   * list, interior nodes with both children after them, every node but the root the child of
+   * exactly one other, and no leaf deeper than `kMaxDepth`, which bounds the traversal stack.
+   */
+  static bool valid_layout(const BvhNode* nodes, size_t node_count, const uint32_t* prim_indices,
+                           size_t prim_count, size_t primitive_count);
+
+  bool empty() const { return nodes_.empty(); }
+  const std::vector<BvhNode>& nodes() const noexcept { return nodes_; }
+  const std::vector<uint32_t>& prim_indices() const noexcept { return prim_indices_; }
+
+  /// Number of levels in the tree (0 when empty).
+  int depth() const;
+
+  /**
+   * @brief Finds the closest hit along `ray`, visiting nearer children first.
+   *
+   * `intersect_leaf(uint32_t node_index, double& t_max) -> bool` must test the primitives of the
+   * leaf `nodes()[node_index]` against the ray restricted to [ray.tMin(), t_max] and, on a hit,
+   * shrink `t_max` to the hit distance and return true. Leaves are handed over whole so callers
+   * can keep their own packed (e.g. SIMD) copy of each leaf's primitives. Subtrees that start
+   * beyond the current `t_max` are skipped.
+   *
+   * @return true if any leaf reported a hit.
+   */
+  template <typename IntersectLeaf>
+  bool traverse(const percepto::core::Ray& ray, double t_max, IntersectLeaf&& intersect_leaf,
+                TraversalStats* stats = nullptr) const;
+
+  /**
+   * @brief Whether anything lies along `ray` within [ray.tMin(), t_max]; stops at the first hit.
+   *
+   * `occluded_leaf(uint32_t node_index) -> bool` must return whether any primitive of the leaf
+   * is hit in that interval. Since the interval never shrinks, popped subtrees need no
+   * re-test, and the first leaf that reports a hit ends the walk.
+   */
+  template <typename OccludedLeaf>
+  bool traverse_any(const percepto::core::Ray& ray, double t_max, OccludedLeaf&& occluded_leaf,
+                    TraversalStats* stats = nullptr) const;
+
+  /**
+   * @brief Recomputes the box of `leaf` from its primitives, then of each ancestor in turn.
+   *
+   * `prim_bounds(uint32_t prim) -> AABB` returns a primitive's current box. The walk stops at the
+   * first node whose box is unchanged, so one moved primitive costs at most one box per level.
+   * Every node whose box changed is appended to `changed`.
+   *
+   * @return Change in `sah_area()`.
+   */
+  template <typename PrimBounds>
+  double refit_leaf(uint32_t leaf, PrimBounds&& prim_bounds, std::vector<uint32_t>& changed);
+
+  /**
+   * @brief SAH cost of the tree for unit costs, not normalized by the root's area.
+   *
+   * Sum of every interior node's surface area plus every leaf's area times its primitive count.
+   * Refits keep the topology a build chose for where the primitives used to be, so the ratio of
+   * this cost to its value after the last build measures how far they have degraded the tree.
+   */
+  double sah_area() const;
+
+  /// Deepest node whose subtree holds both `a` and `b`.
+  uint32_t common_ancestor(uint32_t a, uint32_t b);
+
+  /// Run [first, first + count) of `prim_indices()` holding the primitives under `node`.
+  std::pair<uint32_t, uint32_t> subtree_prims(uint32_t node) const;
+
+  /**
+   * @brief Rebuilds the subtree under `node` over the same primitives and splices it in.
+   *
+   * `prim_bounds[i]` is the box of `prim_indices()[first + i]`, for the run `subtree_prims(node)`
+   * returns. Nodes past the subtree move by the change in its node count, so node indices held
+   * elsewhere must be refreshed afterwards.
+   *
+   * @return false, leaving the tree untouched, if the new subtree would make the tree deeper
+   *         than `kMaxDepth`.
+   */
+  bool rebuild_subtree(uint32_t node, const std::vector<percepto::geometry::AABB>& prim_bounds,
+                       const BvhBuildOptions& options);
+
+  /// Replaces every primitive id `p` with `ids[p]`, e.g. after building over a subset.
+  void remap_primitives(const std::vector<uint32_t>& ids);
+
+ private:
+  void ensure_parents();
+  // One past the last node of the subtree under `node`.
+  uint32_t subtree_end(uint32_t node) const;
+
+  uint32_t build_recursive(uint32_t first, uint32_t count, int depth);
+  uint32_t split_median(uint32_t first, uint32_t count,
+                        const percepto::geometry::AABB& centroid_bounds);
+
+  std::vector<BvhNode> nodes_;
+  std::vector<uint32_t> prim_indices_;
+  std::vector<uint32_t> parents_;  // Built on first use by the refit functions; root = 0.
+
+  // Build-time scratch; released once the build completes.
+  const std::vector<percepto::geometry::AABB>* prim_bounds_ = nullptr;
+  std::vector<percepto::core::Vec3> centroids_;
+  BvhBuildOptions options_;
+};
+
+template <typename IntersectLeaf>
+bool Bvh::traverse(const percepto::core::Ray& ray, double t_max, IntersectLeaf&& intersect_leaf,
+                   TraversalStats* stats) const
+{
+  if (nodes_.empty()) return false;
+
+  const percepto::core::Vec3& origin = ray.origin();
+  const percepto::core::Vec3& dir = ray.direction();
+  const percepto::core::Vec3 inv_dir{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+  const double t_min = ray.tMin();
+
+  double t_entry;
+  if (stats) ++stats->box_tests;
+  if (!nodes_[0].bounds.intersect(origin, inv_dir, t_min, t_max, t_entry)) return false;
+
+  struct Entry
+  {
+    uint32_t node;
+    double t_entry;
+  };
+  Entry stack[kMaxDepth];
+  int sp = 0;
+
+  bool hit = false;
+  uint32_t node_index = 0;
+  while (true)
+  {
+    const BvhNode& node = nodes_[node_index];
+    if (node.is_leaf())
+    {
+      if (stats) ++stats->leaves;
+      if (intersect_leaf(node_index, t_max)) hit = true;
+    }
+    else
+    {
+      if (stats)
+      {
+        ++stats->nodes;
+        stats->box_tests += 2;
+      }
+      uint32_t near_child = node_index + 1;
+      uint32_t far_child = node.offset;
+      double t_near, t_far;
+      bool hit_near = nodes_[near_child].bounds.intersect(origin, inv_dir, t_min, t_max, t_near);
+      bool hit_far = nodes_[far_child].bounds.intersect(origin, inv_dir, t_min, t_max, t_far);
+
+      if (hit_near && hit_far)
+      {
+        if (t_far < t_near)
+        {
+          std::swap(near_child, far_child);
+          std::swap(t_near, t_far);
+        }
+        stack[sp++] = {far_child, t_far};
+        node_index = near_child;
+        continue;
+      }
+      if (hit_near || hit_far)
+      {
+        node_index = hit_near ? near_child : far_child;
+        continue;
+      }
+    }
+
+    // Pop the next pending subtree, dropping those that now start past the closest hit.
+    bool found = false;
+    while (sp > 0)
+    {
+      const Entry& e = stack[--sp];
+      if (e.t_entry <= t_max)
+      {
+        node_index = e.node;
+        found = true;
+        break;
+      }
+    }
+    if (!found) break;
+  }
+
+  return hit;
+}
+
+template <typename OccludedLeaf>
+bool Bvh::traverse_any(const percepto::core::Ray& ray, double t_max, OccludedLeaf&& occluded_leaf,
+                       TraversalStats* stats) const
+{
+  if (nodes_.empty()) return false;
+
+  const percepto::core::Vec3& origin = ray.origin();
+  const percepto::core::Vec3& dir = ray.direction();
+  const percepto::core::Vec3 inv_dir{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+  const double t_min = ray.tMin();
+
+  double t_entry;
+  if (stats) ++stats->box_tests;
+  if (!nodes_[0].bounds.intersect(origin, inv_dir, t_min, t_max, t_entry)) return false;
+
+  uint32_t stack[kMaxDepth];
+  int sp = 0;
+  uint32_t node_index = 0;
+  while (true)
+  {
+    const BvhNode& node = nodes_[node_index];
+    if (node.is_leaf())
+    {
+      if (stats) ++stats->leaves;
+      if (occluded_leaf(node_index)) return true;
+    }
+    else
+    {
+      if (stats)
+      {
+        ++stats->nodes;
+        stats->box_tests += 2;
+      }
+      uint32_t near_child = node_index + 1;
+      uint32_t far_child = node.offset;
+      double t_near, t_far;
+      bool hit_near = nodes_[near_child].bounds.intersect(origin, inv_dir, t_min, t_max, t_near);
+      bool hit_far = nodes_[far_child].bounds.intersect(origin, inv_dir, t_min, t_max, t_far);
+
+      // Nearer first still pays: blockers close to the origin end the walk soonest.
+      if (hit_near && hit_far)
+      {
+        if (t_far < t_near) std::swap(near_child, far_child);
+        stack[sp++] = far_child;
+        node_index = near_child;
+        continue;
+      }
+      if (hit_near || hit_far)
+      {
+        node_index = hit_near ? near_child : far_child;
+        continue;
+      }
+    }
+
+    if (sp == 0) return false;
+    node_index = stack[--sp];
+  }
+}
+
+template <typename PrimBounds>
+double Bvh::refit_leaf(uint32_t leaf, PrimBounds&& prim_bounds, std::vector<uint32_t>& changed)
+{
+  ensure_parents();
+
+  percepto::geometry::AABB box;
+  const BvhNode& leaf_node = nodes_[leaf];
+  for (uint32_t i = leaf_node.offset; i < leaf_node.offset + leaf_node.count; ++i)
+  {
+    box.expand(prim_bounds(prim_indices_[i]));
+  }
+
+  double delta = 0.0;
+  for (uint32_t index = leaf;;)
+  {
+    BvhNode& node = nodes_[index];
+    if (node.bounds.min == box.min && node.bounds.max == box.max) break;
+    delta += (box.surface_area() - node.bounds.surface_area()) *
+             (node.is_leaf() ? static_cast<double>(node.count) : 1.0);
+    node.bounds = box;
+    changed.push_back(index);
+    if (index == 0) break;
+
+    index = parents_[index];
+    box = nodes_[index + 1].bounds;
+    box.expand(nodes_[nodes_[index].offset].bounds);
+  }
+  return delta;
+}
+}  // namespace percepto::accel
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/geometry/aabb.h"
+
+namespace percepto::common
+{
+class ThreadPool;
+}
+
+namespace percepto::accel
+{
+/// Interleaves the low 10 bits of x, y and z into a 30-bit Morton code, x taking the top bit.
+uint32_t morton_code30(uint32_t x, uint32_t y, uint32_t z);
+
+/// Interleaves the low 21 bits of x, y and z into a 63-bit Morton code, x taking the top bit.
+uint64_t morton_code63(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * @brief Sorts `keys` ascending, permuting `values` alongside, by their low `key_bits` bits.
+ *
+ * Stable LSD radix sort on 8-bit digits. With a pool, every pass histograms and scatters
+ * contiguous chunks in parallel; passes whose digit is the same for every key are skipped.
+ */
+void radix_sort_pairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int key_bits,
+                      percepto::common::ThreadPool* pool = nullptr);
+
+/**
+ * @brief Builds a linear BVH (LBVH) over `prim_bounds` in the layout `Bvh::assign` expects.
+ *
+ * Primitive centroids are quantized to Morton codes and radix-sorted; every interior node of the
+ * hierarchy then finds its key range and split from the sorted codes alone, independently of the
+ * others (Karras 2012). A bottom-up pass computes bounds and
+ * SAH costs and, with `options.treelet_optimization`, rebuilds every treelet of up to five
+ * subtrees in its SAH-optimal shape (Karras & Aila 2013). Subtrees small and cheap enough by
+ * the SAH become leaves as the tree is flattened.
+ *
+ * The resulting tree is not depth-limited; `Bvh::build` checks it against `Bvh::kMaxDepth`.
+ */
+void build_lbvh(const std::vector<percepto::geometry::AABB>& prim_bounds,
+                const BvhBuildOptions& options, std::vector<BvhNode>& nodes,
+                std::vector<uint32_t>& prim_indices);
+}  // namespace percepto::accel
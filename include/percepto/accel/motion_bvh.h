@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+namespace percepto::accel
+{
+/**
+ * @brief BVH over moving primitives, with every node's box at both ends of the motion interval.
+ *
+ * A ray cast at time s (`Ray::time()`, in [0, 1]) is tested against the blend
+ * (1 - s)·start + s·end of each box. Any primitive whose points move on straight lines between
+ * its two poses stays inside the blended boxes of its nodes throughout, so one tree serves rays
+ * from every instant of the interval, e.g. all azimuth steps of a revolution, however far the
+ * primitives move.
+ *
+ * The topology is that of a `Bvh` built over the boxes swept from start to end; the tree keeps
+ * it, so leaf indices and `prim_indices()` mean what they do for a `Bvh`.
+ */
+class MotionBvh
+{
+ public:
+  /**
+   * @param start_bounds  Bounds of every primitive at time 0; primitive ids index this vector.
+   * @param end_bounds    Bounds of the same primitives at time 1.
+   */
+  void build(const std::vector<percepto::geometry::AABB>& start_bounds,
+             const std::vector<percepto::geometry::AABB>& end_bounds,
+             const BvhBuildOptions& options = {});
+  void clear();
+
+  bool empty() const { return tree_.empty(); }
+  /// Topology; each node's `bounds` is the box it sweeps over the whole interval.
+  const std::vector<BvhNode>& nodes() const noexcept { return tree_.nodes(); }
+  const std::vector<uint32_t>& prim_indices() const noexcept { return tree_.prim_indices(); }
+
+  /// Box of `node` at `time`.
+  percepto::geometry::AABB bounds_at(uint32_t node, double time) const
+  {
+    const percepto::geometry::AABB& a = start_[node];
+    const percepto::geometry::AABB& b = end_[node];
+    return {(1.0 - time) * a.min + time * b.min, (1.0 - time) * a.max + time * b.max};
+  }
+
+  size_t memory_bytes() const noexcept;
+
+  /**
+   * @brief Finds the closest hit along `ray` at `ray.time()`, visiting nearer children first.
+   *
+   * Same contract as `Bvh::traverse`; `intersect_leaf` must test the leaf's primitives where they
+   * are at the ray's time.
+   */
+  template <typename IntersectLeaf>
+  bool traverse(const percepto::core::Ray& ray, double t_max, IntersectLeaf&& intersect_leaf,
+                TraversalStats* stats = nullptr) const;
+
+  /// Any-hit walk at `ray.time()`, with the contract of `Bvh::traverse_any`.
+  template <typename OccludedLeaf>
+  bool traverse_any(const percepto::core::Ray& ray, double t_max, OccludedLeaf&& occluded_leaf,
+                    TraversalStats* stats = nullptr) const;
+
+ private:
+  Bvh tree_;
+  std::vector<percepto::geometry::AABB> start_, end_;  // Per node.
+};
+
+template <typename IntersectLeaf>
+bool MotionBvh::traverse(const percepto::core::Ray& ray, double t_max,
+                         IntersectLeaf&& intersect_leaf, TraversalStats* stats) const
+{
+  const auto& nodes = tree_.nodes();
+  if (nodes.empty()) return false;
+
+  const percepto::core::Vec3& origin = ray.origin();
+  const percepto::core::Vec3& dir = ray.direction();
+  const percepto::core::Vec3 inv_dir{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+  const double t_min = ray.tMin();
+  const double time = ray.time();
+
+  auto test = [&](uint32_t node, double& t_entry)
+  {
+    if (stats) ++stats->box_tests;
+    return bounds_at(node, time).intersect(origin, inv_dir, t_min, t_max, t_entry);
+  };
+
+  double t_entry;
+  if (!test(0, t_entry)) return false;
+
+  struct Entry
+  {
+    uint32_t node;
+    double t_entry;
+  };
+  Entry stack[Bvh::kMaxDepth];
+  int sp = 0;
+  stack[sp++] = {0, t_entry};
+
+  bool hit = false;
+  while (sp > 0)
+  {
+    const Entry entry = stack[--sp];
+    if (entry.t_entry > t_max) continue;  // Starts past the closest hit found since the push.
+
+    const BvhNode& node = nodes[entry.node];
+    if (node.is_leaf())
+    {
+      if (stats) ++stats->leaves;
+      if (intersect_leaf(entry.node, t_max)) hit = true;
+      continue;
+    }
+
+    if (stats) ++stats->nodes;
+    uint32_t near_child = entry.node + 1, far_child = node.offset;
+    double t_near = 0.0, t_far = 0.0;
+    const bool hit_near = test(near_child, t_near);
+    const bool hit_far = test(far_child, t_far);
+    if (hit_near && hit_far && t_far < t_near)
+    {
+      std::swap(near_child, far_child);
+      std::swap(t_near, t_far);
+    }
+    if (hit_far) stack[sp++] = {far_child, t_far};
+    if (hit_near) stack[sp++] = {near_child, t_near};
+  }
+  return hit;
+}
+
+template <typename OccludedLeaf>
+bool MotionBvh::traverse_any(const percepto::core::Ray& ray, double t_max,
+                             OccludedLeaf&& occluded_leaf, TraversalStats* stats) const
+{
+  const auto& nodes = tree_.nodes();
+  if (nodes.empty()) return false;
+
+  const percepto::core::Vec3& origin = ray.origin();
+  const percepto::core::Vec3& dir = ray.direction();
+  const percepto::core::Vec3 inv_dir{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+  const double t_min = ray.tMin();
+  const double time = ray.time();
+
+  auto test = [&](uint32_t node)
+  {
+    if (stats) ++stats->box_tests;
+    double t_entry;
+    return bounds_at(node, time).intersect(origin, inv_dir, t_min, t_max, t_entry);
+  };
+
+  if (!test(0)) return false;
+  uint32_t stack[Bvh::kMaxDepth];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0)
+  {
+    const uint32_t index = stack[--sp];
+    const BvhNode& node = nodes[index];
+    if (node.is_leaf())
+    {
+      if (stats) ++stats->leaves;
+      if (occluded_leaf(index)) return true;
+      continue;
+    }
+
+    if (stats) ++stats->nodes;
+    if (test(node.offset)) stack[sp++] = node.offset;
+    if (test(index + 1)) stack[sp++] = index + 1;
+  }
+  return false;
+}
+}  // namespace percepto::accel
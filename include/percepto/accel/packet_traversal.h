@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+namespace percepto::accel
+{
+/**
+ * @brief Conservative bound on every ray of a packet, for culling a box for all of them at once.
+ *
+ * Keeps the per-axis range of the packet's inverse directions. Since the rays share an origin,
+ * each ray's slab distances lie between those of the range's endpoints, so one interval test
+ * tells when no ray can enter a box. Axes where that bound is undefined (a direction component
+ * of zero on a slab plane) are left unconstrained.
+ */
+class PacketFrustum
+{
+ public:
+  /// Bounds the rays of `packet` selected by `active`, each restricted to [t_min, t_max[i]].
+  PacketFrustum(const percepto::core::RayPacket& packet, uint32_t active, const double* t_max);
+
+  /// False only if every ray the frustum was built from misses `box`.
+  bool may_hit(const percepto::geometry::AABB& box) const;
+
+ private:
+  percepto::core::Vec3 origin_;
+  percepto::core::Vec3 inv_min_, inv_max_;
+  double t_min_, t_max_;
+};
+
+/**
+ * @brief Slab-tests every active ray of `packet` against `box`.
+ *
+ * Matches `AABB::intersect` ray by ray, including its NaN handling for rays lying on a slab
+ * plane, so a packet enters exactly the boxes its rays would enter one at a time.
+ *
+ * @param t_max  Far end of each ray's interval; holds `RayPacket::kMaxSize` entries.
+ * @return Bit mask of the active rays that hit `box` inside [t_min, t_max].
+ */
+uint32_t intersect_packet_box(const percepto::geometry::AABB& box,
+                              const percepto::core::RayPacket& packet, uint32_t active,
+                              const double* t_max);
+
+/**
+ * @brief Closest hits of a packet of rays through a binary `Bvh`, traversed together.
+ *
+ * Each popped node is first tested against the packet's frustum and then ray by ray; the
+ * surviving rays carry on into both children, the one nearer along the packet's first ray
+ * first. `intersect_leaf(uint32_t node_index, uint32_t mask, double* t_max) -> uint32_t` must
+ * test the primitives of leaf `bvh.nodes()[node_index]` against the rays in `mask`, shrink
+ * `t_max[i]` of each ray that found a closer hit, and return the mask of those rays.
+ *
+ * @param t_max  Far end of each ray's interval, updated in place; `RayPacket::kMaxSize` entries.
+ * @return Bit mask of the rays that hit anything.
+ */
+template <typename IntersectLeaf>
+uint32_t traverse_packet(const Bvh& bvh, const percepto::core::RayPacket& packet, uint32_t active,
+                         double* t_max, IntersectLeaf&& intersect_leaf,
+                         TraversalStats* stats = nullptr)
+{
+  const auto& nodes = bvh.nodes();
+  if (nodes.empty() || !active) return 0;
+
+  const PacketFrustum frustum(packet, active, t_max);
+  const int lead = __builtin_ctz(active);
+  const percepto::core::Vec3 lead_dir(packet.dir_x[lead], packet.dir_y[lead],
+                                      packet.dir_z[lead]);
+
+  struct Entry
+  {
+    uint32_t node;
+    uint32_t mask;
+  };
+  // Every level leaves at most one sibling behind.
+  Entry stack[Bvh::kMaxDepth + 2];
+  int sp = 0;
+  stack[sp++] = {0, active};
+
+  uint32_t hits = 0;
+  while (sp > 0)
+  {
+    const Entry entry = stack[--sp];
+    const BvhNode& node = nodes[entry.node];
+    if (!frustum.may_hit(node.bounds)) continue;
+
+    // Rays are re-tested on pop, so those whose closest hit has moved in front of the node
+    // drop out here.
+    if (stats) stats->box_tests += __builtin_popcount(entry.mask);
+    const uint32_t mask = intersect_packet_box(node.bounds, packet, entry.mask, t_max);
+    if (!mask) continue;
+
+    if (node.is_leaf())
+    {
+      if (stats) ++stats->leaves;
+      hits |= intersect_leaf(entry.node, mask, t_max);
+      continue;
+    }
+
+    if (stats) ++stats->nodes;
+    uint32_t near_child = entry.node + 1;
+    uint32_t far_child = node.offset;
+    if (nodes[far_child].bounds.centroid().dot(lead_dir) <
+        nodes[near_child].bounds.centroid().dot(lead_dir))
+    {
+      std::swap(near_child, far_child);
+    }
+    stack[sp++] = {far_child, mask};
+    stack[sp++] = {near_child, mask};
+  }
+  return hits;
+}
+
+/**
+ * @brief Which rays of a packet hit anything in their interval, traversed together.
+ *
+ * The any-hit counterpart of `traverse_packet`. `occluded_leaf(uint32_t node_index, uint32_t
+ * mask) -> uint32_t` must return the rays in `mask` that hit a primitive of the leaf. Those rays
+ * are settled and drop out of every pending node; the walk ends once none is left.
+ *
+ * @param t_max  Far end of each ray's interval; `RayPacket::kMaxSize` entries, left untouched.
+ * @return Bit mask of the rays that hit anything.
+ */
+template <typename OccludedLeaf>
+uint32_t traverse_packet_any(const Bvh& bvh, const percepto::core::RayPacket& packet,
+                             uint32_t active, const double* t_max, OccludedLeaf&& occluded_leaf,
+                             TraversalStats* stats = nullptr)
+{
+  const auto& nodes = bvh.nodes();
+  if (nodes.empty() || !active) return 0;
+
+  const PacketFrustum frustum(packet, active, t_max);
+  const int lead = __builtin_ctz(active);
+  const percepto::core::Vec3 lead_dir(packet.dir_x[lead], packet.dir_y[lead],
+                                      packet.dir_z[lead]);
+
+  struct Entry
+  {
+    uint32_t node;
+    uint32_t mask;
+  };
+  Entry stack[Bvh::kMaxDepth + 2];
+  int sp = 0;
+  stack[sp++] = {0, active};
+
+  uint32_t pending = active;
+  while (sp > 0)
+  {
+    const Entry entry = stack[--sp];
+    const uint32_t live = entry.mask & pending;
+    if (!live) continue;
+    const BvhNode& node = nodes[entry.node];
+    if (!frustum.may_hit(node.bounds)) continue;
+
+    if (stats) stats->box_tests += __builtin_popcount(live);
+    const uint32_t mask = intersect_packet_box(node.bounds, packet, live, t_max);
+    if (!mask) continue;
+
+    if (node.is_leaf())
+    {
+      if (stats) ++stats->leaves;
+      pending &= ~occluded_leaf(entry.node, mask);
+      if (!pending) break;
+      continue;
+    }
+
+    if (stats) ++stats->nodes;
+    uint32_t near_child = entry.node + 1;
+    uint32_t far_child = node.offset;
+    if (nodes[far_child].bounds.centroid().dot(lead_dir) <
+        nodes[near_child].bounds.centroid().dot(lead_dir))
+    {
+      std::swap(near_child, far_child);
+    }
+    stack[sp++] = {far_child, mask};
+    stack[sp++] = {near_child, mask};
+  }
+  return active & ~pending;
+}
+}  // namespace percepto::accel
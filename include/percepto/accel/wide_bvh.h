@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+
+namespace percepto::accel
+{
+/**
+ * @brief W-ary BVH node with its children's bounds stored structure-of-arrays.
+ *
+ * Each bound component is contiguous across children, so one ray is slab-tested against all W
+ * boxes with a few vector instructions. A child reference is either another node's index or,
+ * with `kLeafBit` set, the index of a leaf of the binary `Bvh` the tree was collapsed from.
+ *
+ * @tparam T Bound type: double, or float for half the bytes and twice the boxes per vector.
+ */
+template <int W, typename T = double>
+struct alignas(64) WideBvhNode
+{
+  static_assert(W == 4 || W == 8, "WideBvhNode width must be 4 or 8");
+  static_assert(std::is_same_v<T, double> || std::is_same_v<T, float>,
+                "WideBvhNode bounds must be double or float");
+  static constexpr uint32_t kLeafBit = 0x80000000u;
+
+  T min_x[W], min_y[W], min_z[W];
+  T max_x[W], max_y[W], max_z[W];
+  uint32_t child[W] = {};
+  uint32_t child_count = 0;
+
+  static bool is_leaf(uint32_t ref) { return ref & kLeafBit; }
+  static uint32_t leaf_index(uint32_t ref) { return ref & ~kLeafBit; }
+};
+
+/**
+ * @brief Slab-tests `ray` against every child box of `node` at once.
+ *
+ * Matches `AABB::intersect` child by child, including its NaN handling for rays lying on a slab
+ * plane, so a wide traversal visits the same leaves as the binary one. Float nodes round the ray
+ * to float first; the padding their tree adds to every box absorbs that rounding.
+ *
+ * @param origin       Ray origin, relative to the tree's `center()`.
+ * @param inv_dir      Component-wise 1 / ray direction.
+ * @param[out] t_entry Entry distance of each child that is hit.
+ * @return Bit mask of the children hit inside [t_min, t_max].
+ */
+template <int W, typename T>
+uint32_t intersect_children(const WideBvhNode<W, T>& node, const percepto::core::Vec3& origin,
+                            const percepto::core::Vec3& inv_dir, double t_min, double t_max,
+                            T* t_entry);
+
+/**
+ * @brief 4- or 8-wide BVH collapsed from a binary `Bvh`.
+ *
+ * Every node adopts up to W descendants of a binary node, repeatedly opening the interior child
+ * with the largest surface area. Leaves are the binary tree's own leaves, so callers keep
+ * whatever per-leaf data they built for it. Traversal tests all children of a node in one SIMD
+ * slab test and descends nearest-first.
+ *
+ * A float tree stores its boxes relative to `center()`, the middle of the root box, rounded
+ * outward and grown by `padding()`, a few float ulps of the root box's radius. Rays are shifted
+ * to the same frame before they are rounded, so the slab test stays conservative, never
+ * missing a box the double test would enter, for ray origins up to about the root box's radius
+ * from its center, wherever the scene sits in world coordinates.
+ *
+ * @tparam W Branching factor (4 or 8).
+ * @tparam T Bound type (double or float).
+ */
+template <int W, typename T = double>
+class WideBvh
+{
+ public:
+  using Node = WideBvhNode<W, T>;
+  static constexpr int kWidth = W;
+
+  /// Collapses `binary`, which must outlive any traversal through its leaf indices.
+  void build(const Bvh& binary);
+  void clear()
+  {
+    nodes_.clear();
+    slots_.clear();
+  }
+
+  /**
+   * @brief Copies refitted boxes from `binary`, the tree this one was collapsed from.
+   *
+   * `changed` lists the binary nodes whose bounds changed since, as `Bvh::refit_leaf` reports
+   * them. Only their child slots are rewritten; the topology must not have changed.
+   */
+  void refit(const Bvh& binary, const std::vector<uint32_t>& changed);
+
+  bool empty() const { return nodes_.empty(); }
+  const percepto::core::Vec3& center() const noexcept { return center_; }
+  double padding() const noexcept { return padding_; }
+  const std::vector<Node>& nodes() const noexcept { return nodes_; }
+  size_t memory_bytes() const noexcept
+  {
+    return nodes_.capacity() * sizeof(Node) + slots_.capacity() * sizeof(uint32_t);
+  }
+
+  /**
+   * @brief Finds the closest hit along `ray`, visiting nearer children first.
+   *
+   * Same contract as `Bvh::traverse`: `intersect_leaf(uint32_t leaf, double& t_max) -> bool`
+   * receives the index of a leaf in the binary tree's `nodes()`.
+   */
+  template <typename IntersectLeaf>
+  bool traverse(const percepto::core::Ray& ray, double t_max, IntersectLeaf&& intersect_leaf,
+                TraversalStats* stats = nullptr) const;
+
+  /// Any-hit walk with the contract of `Bvh::traverse_any`; hit children are not sorted.
+  template <typename OccludedLeaf>
+  bool traverse_any(const percepto::core::Ray& ray, double t_max, OccludedLeaf&& occluded_leaf,
+                    TraversalStats* stats = nullptr) const;
+
+ private:
+  static constexpr uint32_t kNoSlot = ~0u;
+
+  uint32_t collapse(const Bvh& binary, uint32_t binary_index);
+  void set_child_bounds(uint32_t slot, const percepto::geometry::AABB& box);
+
+  std::vector<Node> nodes_;
+  // Wide node × W + child slot holding each binary node, or kNoSlot for nodes opened away.
+  std::vector<uint32_t> slots_;
+  // Frame of float bounds, set by build() and kept by refit(); zero for double trees.
+  percepto::core::Vec3 center_;
+  double padding_ = 0.0;
+};
+
+extern template class WideBvh<4>;
+extern template class WideBvh<8>;
+extern template class WideBvh<4, float>;
+extern template class WideBvh<8, float>;
+
+template <int W, typename T>
+template <typename IntersectLeaf>
+bool WideBvh<W, T>::traverse(const percepto::core::Ray& ray, double t_max,
+                          IntersectLeaf&& intersect_leaf, TraversalStats* stats) const
+{
+  if (nodes_.empty()) return false;
+
+  const percepto::core::Vec3 origin = ray.origin() - center_;
+  const percepto::core::Vec3& dir = ray.direction();
+  const percepto::core::Vec3 inv_dir{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+  const double t_min = ray.tMin();
+
+  struct Entry
+  {
+    uint32_t ref;
+    double t_entry;
+  };
+  // Each level leaves at most W - 1 siblings behind.
+  Entry stack[Bvh::kMaxDepth * (W - 1) + 1];
+  int sp = 0;
+  stack[sp++] = {0, t_min};
+
+  bool hit = false;
+  while (sp > 0)
+  {
+    const Entry entry = stack[--sp];
+    if (entry.t_entry > t_max) continue;  // Starts past the closest hit found since the push.
+
+    if (Node::is_leaf(entry.ref))
+    {
+      if (stats) ++stats->leaves;
+      if (intersect_leaf(Node::leaf_index(entry.ref), t_max)) hit = true;
+      continue;
+    }
+
+    const Node& node = nodes_[entry.ref];
+    alignas(64) T t_child[W];
+    uint32_t mask = intersect_children(node, origin, inv_dir, t_min, t_max, t_child);
+    if (stats)
+    {
+      ++stats->nodes;
+      stats->box_tests += node.child_count;
+    }
+
+    // Push the hit children farthest first, so the nearest is popped next.
+    const int base = sp;
+    for (; mask; mask &= mask - 1)
+    {
+      const int c = __builtin_ctz(mask);
+      Entry child{node.child[c], t_child[c]};
+      int k = sp++;
+      for (; k > base && stack[k - 1].t_entry < child.t_entry; --k) stack[k] = stack[k - 1];
+      stack[k] = child;
+    }
+  }
+
+  return hit;
+}
+
+template <int W, typename T>
+template <typename OccludedLeaf>
+bool WideBvh<W, T>::traverse_any(const percepto::core::Ray& ray, double t_max,
+                              OccludedLeaf&& occluded_leaf, TraversalStats* stats) const
+{
+  if (nodes_.empty()) return false;
+
+  const percepto::core::Vec3 origin = ray.origin() - center_;
+  const percepto::core::Vec3& dir = ray.direction();
+  const percepto::core::Vec3 inv_dir{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+  const double t_min = ray.tMin();
+
+  uint32_t stack[Bvh::kMaxDepth * (W - 1) + 1];
+  int sp = 0;
+  stack[sp++] = 0;
+
+  while (sp > 0)
+  {
+    const uint32_t ref = stack[--sp];
+    if (Node::is_leaf(ref))
+    {
+      if (stats) ++stats->leaves;
+      if (occluded_leaf(Node::leaf_index(ref))) return true;
+      continue;
+    }
+
+    const Node& node = nodes_[ref];
+    alignas(64) T t_child[W];
+    uint32_t mask = intersect_children(node, origin, inv_dir, t_min, t_max, t_child);
+    if (stats)
+    {
+      ++stats->nodes;
+      stats->box_tests += node.child_count;
+    }
+    // Sorting W children would cost more than the rare early exit it could bring forward.
+    for (; mask; mask &= mask - 1) stack[sp++] = node.child[__builtin_ctz(mask)];
+  }
+  return false;
+}
+}  // namespace percepto::accel
@@ -3,24 +3,43 @@
 #include <string>
 #include <vector>
 
+#include "percepto/common/types.h"
+
 namespace percepto::common
 {
 struct LiDARConfig
 {
   int azimuth_steps;                     // Number of discrete azimuth steps per 360°
   std::vector<double> elevation_angles;  // Elevation angles (radians) for each laser channel.
+  double rotation_rate = 10.0;           // Revolutions per second.
 };
 
 struct RayTracerConfig
 {
   double ray_t_min;
   double ray_t_max;
+  AcceleratorType accelerator = AcceleratorType::Bvh;  // Spatial index used by Scene::intersect.
+  BvhBuilder bvh_builder = BvhBuilder::Sah;            // Algorithm building the BVH.
+  CullMode cull_mode = CullMode::Back;                 // Triangle faces rays can hit.
+  Precision precision = Precision::Double;             // Of packed triangles and wide trees.
+  bool bvh_treelets = true;                            // LBVH: re-optimize treelets for SAH.
+  bool bvh_cache = false;                              // Reuse the BVH saved next to the scene.
+  int thread_count = 1;                                // Scan threads; 0 = one per core.
+  int azimuth_tile_size = 64;                          // Azimuth steps per parallel work item.
+  bool angular_grid = false;                           // Bin the scene per fixed-origin ray.
+  bool direction_table = true;                         // Precompute every beam direction.
+  int packet_size = 16;                                // Beams traced together; <= 1 = off.
+  PacketLayout packet_layout = PacketLayout::Azimuth;  // Beams grouped into one packet.
+  ScanBackend scan_backend = ScanBackend::RayTrace;    // How run_scan fills each frame.
+  bool trace_rays = false;                             // Write a record for every traced ray.
+  std::string ray_trace_file = "percepto_rays.log";    // Destination of the per-ray trace.
 };
 
 class ConfigLoader
 {
  public:
   static LiDARConfig loadLiDARConfig();
+  static RayTracerConfig loadRayTracerConfig();
   static RayTracerConfig loadRayTracerConfig(const std::string& filepath);
 
  private:
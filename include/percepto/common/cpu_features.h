@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <utility>
+
+// x86 builds with GCC or Clang compile every SIMD kernel whatever -march says, each function
+// marked with the instruction set it uses, and pick one at runtime. Other builds have only the
+// scalar kernels.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PERCEPTO_X86_SIMD 1
+#define PERCEPTO_TARGET_AVX2 __attribute__((target("avx2")))
+#define PERCEPTO_TARGET_AVX512 __attribute__((target("avx2,avx512f")))
+#else
+#define PERCEPTO_X86_SIMD 0
+#define PERCEPTO_TARGET_AVX2
+#define PERCEPTO_TARGET_AVX512
+#endif
+
+namespace percepto::common
+{
+/// Instruction sets the SIMD kernels come in, narrowest first.
+enum class Isa
+{
+  Scalar,  ///< Plain C++; the fallback on every CPU
+  Avx2,    ///< 256-bit vectors
+  Avx512   ///< 512-bit vectors and mask registers
+};
+
+/// Widest instruction set both this CPU and this build support.
+Isa detect_isa();
+
+namespace detail
+{
+extern std::atomic<Isa> active_isa;
+}
+
+/// Instruction set the kernels run with: `detect_isa()` unless `set_isa` forced another.
+inline Isa active_isa() noexcept { return detail::active_isa.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Forces the kernels onto `isa`, e.g. to benchmark one variant against another.
+ *
+ * Meant for start-up, before any tracing: kernels already running may finish on the previous
+ * instruction set.
+ *
+ * @throws std::invalid_argument if `isa` is wider than `detect_isa()`.
+ */
+void set_isa(Isa isa);
+
+/// "scalar", "avx2" or "avx512".
+const char* isa_name(Isa isa);
+
+/**
+ * @brief Inverse of `isa_name`.
+ * @throws std::invalid_argument for any other name.
+ */
+Isa parse_isa(const std::string& name);
+
+/**
+ * @brief Runs `Kernel::run<kIsa>(args...)` with the active instruction set.
+ *
+ * `Kernel` is a struct with a static member template `template <Isa kIsa> run(...)`. Its AVX2 and
+ * AVX-512 forms are called through functions compiled for that instruction set and flattened,
+ * so the lane helpers they reach (each marked `PERCEPTO_TARGET_*`) inline into one body just
+ * as in a build for that CPU. The choice costs one predictable branch per call.
+ */
+template <typename Kernel, typename... Args>
+decltype(auto) dispatch_isa(Args&&... args);
+
+namespace detail
+{
+#if PERCEPTO_X86_SIMD
+template <typename Kernel, typename... Args>
+PERCEPTO_TARGET_AVX512 __attribute__((flatten)) decltype(auto) run_avx512(Args&&... args)
+{
+  return Kernel::template run<Isa::Avx512>(std::forward<Args>(args)...);
+}
+
+template <typename Kernel, typename... Args>
+PERCEPTO_TARGET_AVX2 __attribute__((flatten)) decltype(auto) run_avx2(Args&&... args)
+{
+  return Kernel::template run<Isa::Avx2>(std::forward<Args>(args)...);
+}
+#endif
+}  // namespace detail
+
+template <typename Kernel, typename... Args>
+decltype(auto) dispatch_isa(Args&&... args)
+{
+#if PERCEPTO_X86_SIMD
+  switch (active_isa())
+  {
+    case Isa::Avx512:
+      return detail::run_avx512<Kernel>(std::forward<Args>(args)...);
+    case Isa::Avx2:
+      return detail::run_avx2<Kernel>(std::forward<Args>(args)...);
+    case Isa::Scalar:
+      break;
+  }
+#endif
+  return Kernel::template run<Isa::Scalar>(std::forward<Args>(args)...);
+}
+}  // namespace percepto::common
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "percepto/common/frame_scan.h"
+
+namespace percepto::common
+{
+/**
+ * @brief Free list of `FrameScan` buffers, so repeated scans stop allocating once warmed up.
+ *
+ * A frame owns one buffer per beam attribute; building a fresh one per revolution allocates and
+ * zero-fills all of them. Frames handed back with `release` are cleared with
+ * `FrameScan::reset()` and returned again by the next `acquire` of the same shape.
+ *
+ * @code
+ * FramePool pool;
+ * FrameScan frame = pool.acquire(3600, 32);  // allocates: the pool is empty
+ * pool.release(std::move(frame));
+ * frame = pool.acquire(3600, 32);            // reuses the buffers released above
+ * @endcode
+ */
+class FramePool
+{
+ public:
+  /// Returns a zeroed frame of the given shape, reusing a pooled one when available.
+  FrameScan acquire(int azimuth_steps, int channel_count);
+
+  /// Hands `frame` back to the pool.
+  void release(FrameScan&& frame);
+
+  /// Hands every frame in `frames` back to the pool and leaves `frames` empty, capacity intact.
+  void release(std::vector<FrameScan>& frames);
+
+  /// Number of frames waiting to be reused.
+  size_t size() const noexcept { return free_.size(); }
+
+  /// Frees every pooled frame.
+  void clear() noexcept { free_.clear(); }
+
+ private:
+  std::vector<FrameScan> free_;
+};
+}  // namespace percepto::common
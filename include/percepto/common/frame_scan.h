@@ -1,22 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
 #include "percepto/core/vec3.h"
 
 namespace percepto::common
 {
+/**
+ * @brief One LiDAR revolution.
+ *
+ * Per-beam data is stored row-major in flat buffers: beam (i, j) lives at `index(i, j)`, i.e.
+ * `i * channel_count + j`. A frame therefore owns a handful of allocations whatever its size, and
+ * `reset()` clears it for reuse without giving them back (see `FramePool`).
+ */
 struct FrameScan
 {
   // N = number of azimuth steps; M = number of channels
   int azimuth_steps;
   int channel_count;
 
-  // distance measurements [i][j]
-  std::vector<std::vector<float>> ranges;
+  // distance measurements, N × M row-major
+  std::vector<float> ranges;
 
-  // 3D points computed from ranges + directions
-  std::vector<std::vector<percepto::core::Vec3>> points;
+  // 3D points computed from ranges + directions, N × M row-major
+  std::vector<percepto::core::Vec3> points;
 
   // the actual azimuth elevation angles used
   std::vector<double> azimuth_angles;
@@ -24,25 +33,53 @@ struct FrameScan
   // the virtual laser angles used
   std::vector<double> elevation_angles;
 
-  // intensity per return
-  std::vector<std::vector<float>> intensities;
+  // intensity per return, N × M row-major
+  std::vector<float> intensities;
 
   // timestamp of the scan (e.g. start time)
   double timestamp;
 
+  // Time each azimuth step fired, in the clock of `timestamp`; the revolution sweeps them one by
+  // one, so points of moving objects are each captured at their own time.
+  std::vector<double> firing_times;
+
   // Count of valid intersections
   int hits;
 
   FrameScan(int N, int M)
       : azimuth_steps(N),
         channel_count(M),
-        ranges(N, std::vector<float>(M, 0.0f)),
-        points(N, std::vector<percepto::core::Vec3>(M)),
+        ranges(static_cast<size_t>(N) * M, 0.0f),
+        points(static_cast<size_t>(N) * M),
         azimuth_angles(N, 0.0),
-        intensities(N, std::vector<float>(M, 0.0f)),
-        hits(0),
-        timestamp(0.0)
+        intensities(static_cast<size_t>(N) * M, 0.0f),
+        timestamp(0.0),
+        firing_times(N, 0.0),
+        hits(0)
+  {
+  }
+
+  /// Offset of beam (azimuth step i, channel j) in the flat per-beam buffers.
+  size_t index(int i, int j) const noexcept { return static_cast<size_t>(i) * channel_count + j; }
+
+  float& range(int i, int j) noexcept { return ranges[index(i, j)]; }
+  float range(int i, int j) const noexcept { return ranges[index(i, j)]; }
+
+  percepto::core::Vec3& point(int i, int j) noexcept { return points[index(i, j)]; }
+  const percepto::core::Vec3& point(int i, int j) const noexcept { return points[index(i, j)]; }
+
+  float& intensity(int i, int j) noexcept { return intensities[index(i, j)]; }
+  float intensity(int i, int j) const noexcept { return intensities[index(i, j)]; }
+
+  /// Zeroes every beam, the hit count and the timestamps; buffers keep their capacity.
+  void reset() noexcept
   {
+    std::fill(ranges.begin(), ranges.end(), 0.0f);
+    std::fill(points.begin(), points.end(), percepto::core::Vec3());
+    std::fill(intensities.begin(), intensities.end(), 0.0f);
+    std::fill(firing_times.begin(), firing_times.end(), 0.0);
+    timestamp = 0.0;
+    hits = 0;
   }
 };
 }  // namespace percepto::common
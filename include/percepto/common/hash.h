@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace percepto::common
+{
+/**
+ * @brief 64-bit non-cryptographic hash of `size` bytes (the XXH64 algorithm).
+ *
+ * Reads eight bytes at a time in four independent lanes, so hashing runs at memory speed. Used to
+ * key and checksum cache files; not suitable where an adversary picks the input.
+ */
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+/**
+ * @brief Incremental hash over several buffers.
+ *
+ * Each `add` hashes its buffer seeded with the state so far, so the result depends on the bytes,
+ * their order and how they were split into buffers.
+ */
+class Hasher
+{
+ public:
+  explicit Hasher(uint64_t seed = 0) : state_(seed) {}
+
+  Hasher& add(const void* data, size_t size)
+  {
+    state_ = hash64(data, size, state_);
+    return *this;
+  }
+  template <typename T>
+  Hasher& add_value(const T& value)
+  {
+    return add(&value, sizeof(T));
+  }
+
+  uint64_t digest() const noexcept { return state_; }
+
+ private:
+  uint64_t state_;
+};
+}  // namespace percepto::common
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace percepto::common
+{
+/**
+ * @brief Fixed-size pool of persistent worker threads for fork-join loops.
+ *
+ * Workers are spawned once in the constructor and park on a condition variable between jobs, so
+ * repeated `parallel_for` calls (e.g. one per scan revolution) pay no thread start-up cost. The
+ * calling thread takes part in every job, so a pool of size N spawns N - 1 workers.
+ *
+ * @code
+ * ThreadPool pool(4);
+ * pool.parallel_for(tiles, [&](size_t t) { process(t); });  // blocks until all tiles are done
+ * @endcode
+ */
+class ThreadPool
+{
+ public:
+  /**
+   * @param thread_count  Total threads taking part in each job, including the caller.
+   *                      0 selects one per hardware thread.
+   */
+  explicit ThreadPool(int thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// Number of threads that execute tasks, including the calling thread.
+  int size() const noexcept { return static_cast<int>(workers_.size()) + 1; }
+
+  /// Resolves a configured thread count, mapping 0 (or less) to the hardware concurrency.
+  static int resolve_thread_count(int thread_count);
+
+  /**
+   * @brief Runs `task(i)` for every i in [0, task_count) and blocks until all have finished.
+   *
+   * Tasks are claimed dynamically, so uneven task costs balance across threads. If any task
+   * throws, the remaining unclaimed tasks are skipped and the first exception is rethrown here.
+   * Calls from several threads are serialized.
+   */
+  void parallel_for(size_t task_count, const std::function<void(size_t)>& task);
+
+ private:
+  void worker_loop();
+  void run_tasks();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex submit_mutex_;  // Serializes concurrent parallel_for callers.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+
+  const std::function<void(size_t)>* task_ = nullptr;
+  size_t task_count_ = 0;
+  std::atomic<size_t> next_task_{0};
+  size_t generation_ = 0;  // Bumped for every job so parked workers can tell a new one arrived.
+  int busy_workers_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+};
+}  // namespace percepto::common
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "percepto/core/vec3.h"
 
 namespace percepto::common
@@ -14,12 +16,48 @@ struct TriangleHitResult
   double v;  // Barycentric coordinate v.
 };
 
-// Describes detailed intersection information used throughout the ray tracing pipeline.
+/// Which faces of a triangle a ray can hit; the front face is the one its vertices wind CCW around.
+enum class CullMode
+{
+  Back,  ///< Front faces only, for closed or consistently wound geometry
+  None   ///< Both faces, for single-sided surfaces such as walls scanned from either side
+};
+
+/// What an intersection kernel reports.
+enum class HitQuery
+{
+  Closest,  ///< Distance and barycentrics of a hit, to keep the nearest one
+  Any       ///< Only whether anything is hit within the ray's interval
+};
+
+/// Floating-point width of the packed triangles and wide-tree bounds a scene traces through.
+enum class Precision
+{
+  Double,  ///< Every test in double precision
+  Single   ///< Float triangle blocks and wide-tree bounds; hits are resolved in double
+};
+
+// What traversal tracks of a hit: enough to tell it from the others and to resolve its surface
+// later, with `Scene::resolve`, once it is known to be the closest.
 struct HitRecord
 {
-  double t = 0.0;               // Distance from ray origin to intersection point.
+  double t = 0.0;  // Distance from ray origin to intersection point; the point is ray.at(t).
+
+  static constexpr uint32_t kNoPrimitive = ~0u;
+  // Scene primitive hit, numbered as `Scene::primitive` numbers them; set by `Scene` only.
+  uint32_t primitive = kNoPrimitive;
+  // Triangle of the instanced mesh hit, for an instance; left stale by other primitives.
+  uint32_t mesh_triangle = 0;
+  // Barycentrics of a triangle hit: point = (1 - u - v) v0 + u v1 + v v2. Zero for spheres; for
+  // an instance, those of the mesh triangle hit.
+  double u = 0.0, v = 0.0;
+};
+
+// Surface at a hit, computed by `Scene::resolve` for the hits a consumer asks about.
+struct SurfaceHit
+{
   percepto::core::Vec3 point;   // World-space position of the hit point.
-  percepto::core::Vec3 normal;  // Surface normal at the intersection.
+  percepto::core::Vec3 normal;  // Unit surface normal, facing back along the ray.
   bool front_face = true;       // True if ray hits front face; false if hitting from inside.
 };
 
@@ -27,9 +65,46 @@ struct HitRecord
 /// loading scene geometry and objects.
 enum class SceneFormat
 {
-  CSV,   ///< Custom CSV listing of objects
-  OBJ,   ///< Wavefront OBJ model
-  GLTF,  ///< glTF 2.0 format
-  JSON   ///< JSON‐based scene description
+  CSV,    ///< Custom CSV listing of objects
+  OBJ,    ///< Wavefront OBJ model
+  GLTF,   ///< glTF 2.0 format
+  JSON,   ///< JSON‐based scene description
+  Binary  ///< Percepto binary scene (.pscn): indexed triangles plus an optional prebuilt BVH
+};
+
+/// Selects the spatial index `Scene::intersect` uses to find the closest hit.
+enum class AcceleratorType
+{
+  None,  ///< Brute-force loop over every object
+  Bvh,   ///< Binary BVH built with a binned surface-area heuristic
+  Bvh4,  ///< The binary BVH collapsed to 4-wide nodes, traversed with a SIMD slab test
+  Bvh8   ///< The binary BVH collapsed to 8-wide nodes, traversed with a SIMD slab test
+};
+
+/// True for the accelerators built on the binary SAH BVH (`Bvh`, `Bvh4`, `Bvh8`).
+inline bool uses_bvh(AcceleratorType accelerator)
+{
+  return accelerator != AcceleratorType::None;
+}
+
+/// Algorithm `Bvh::build` uses to construct the binary BVH.
+enum class BvhBuilder
+{
+  Sah,  ///< Top-down binned surface-area heuristic: the best trees, built serially
+  Lbvh  ///< Linear BVH from sorted Morton codes: built in parallel, much faster on large scenes
+};
+
+/// Selects how `LidarSimulator::run_scan` turns the scene into a frame.
+enum class ScanBackend
+{
+  RayTrace,  ///< One closest-hit query per beam through `Scene`
+  Rasterize  ///< Project each object onto the beam grid and z-buffer the ranges
+};
+
+/// Which beams of a frame the ray-trace backend groups into one `RayPacket`.
+enum class PacketLayout
+{
+  Azimuth,  ///< Consecutive azimuth steps of one channel
+  Column    ///< Consecutive channels of one azimuth step
 };
 }  // namespace percepto::common
\ No newline at end of file
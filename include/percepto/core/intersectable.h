@@ -18,6 +18,9 @@ namespace percepto::core
  * - Elimination of virtual tables (vtables)
  * - Full compile-time dispatch
  * - Aggressive inlining and compiler optimization
+ *
+ * `PrimitiveStore` keeps each such type in an array of its own, so a loop over
+ * one type calls its `intercept` directly.
  */
 
 template <typename Derived>
@@ -26,11 +29,13 @@ class Intersectable
  public:
   // Dispatches the call to the derived class’s implementation of `intercept`
   // using CRTP. Returns true if the ray hits the object, and writes the hit
-  // record to `hit_record`.
+  // record to `hit_record`. `kCull` selects the triangle faces that can be hit
+  // at compile time, so a scene traced double-sided takes its own code path.
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
   [[nodiscard]]
   bool intersect(const percepto::core::Ray& ray, percepto::common::HitRecord& hit_record) const
   {
-    return static_cast<const Derived*>(this)->intercept(ray, hit_record);
+    return static_cast<const Derived*>(this)->template intercept<kCull>(ray, hit_record);
   }
 };
 
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "percepto/core/intersectable.h"
+
+namespace percepto::core
+{
+/**
+ * @brief Objects of several primitive types, each type in its own contiguous array.
+ *
+ * Objects are numbered in insertion order, as one list, but every type is stored apart in a
+ * vector of its own, so a triangle takes a triangle's size and not that of the largest type, and
+ * a loop over one type runs over a tight array with the call resolved at compile time. An 8-byte
+ * slot per object maps its number to its type and position.
+ *
+ * `Value` is the `std::variant` of the types, for passing a single object of any type around.
+ * Supporting another primitive type means adding it to the template arguments, plus a case in
+ * any code that handles types apart, such as the scene's BVH leaf packing.
+ *
+ * @tparam Ts Primitive types, each derived from `Intersectable` and listed once.
+ */
+template <typename... Ts>
+class PrimitiveStore
+{
+ public:
+  using Value = std::variant<Ts...>;
+  using Id = uint32_t;
+  static constexpr size_t kTypeCount = sizeof...(Ts);
+  static_assert(kTypeCount > 0 && kTypeCount < 256, "PrimitiveStore needs 1 to 255 types");
+  static_assert((std::is_base_of_v<Intersectable<Ts>, Ts> && ...),
+                "PrimitiveStore types must derive from Intersectable");
+
+  /// Index of `T` in the template arguments, which is also its index in `Value`.
+  template <typename T>
+  static constexpr uint8_t type_index()
+  {
+    constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+    for (size_t i = 0; i < kTypeCount; ++i)
+    {
+      if (matches[i]) return static_cast<uint8_t>(i);
+    }
+    return static_cast<uint8_t>(kTypeCount);
+  }
+
+  size_t size() const noexcept { return slots_.size(); }
+  bool empty() const noexcept { return slots_.empty(); }
+  void reserve(size_t count) { slots_.reserve(count); }
+
+  /// Releases the spare capacity the per-type arrays grew into while objects were added.
+  void shrink_to_fit()
+  {
+    std::apply([](auto&... arrays) { (arrays.shrink_to_fit(), ...); }, arrays_);
+    slots_.shrink_to_fit();
+  }
+
+  /// Appends `value` to its type's array; returns its number.
+  Id push(const Value& value)
+  {
+    const Id id = static_cast<Id>(slots_.size());
+    slots_.push_back(Slot());
+    std::visit([&](const auto& object) { slots_[id] = append(object, id); }, value);
+    return id;
+  }
+
+  /// Replaces object `id`, in place if the type stays the same.
+  void assign(Id id, const Value& value)
+  {
+    if (value.index() != slots_.at(id).type)
+    {
+      erase(id);
+      std::visit([&](const auto& object) { slots_[id] = append(object, id); }, value);
+      return;
+    }
+    std::visit(
+        [&](const auto& object)
+        {
+          using T = std::decay_t<decltype(object)>;
+          std::get<Array<T>>(arrays_).items[slots_[id].index] = object;
+        },
+        value);
+  }
+
+  /// Copy of object `id` as a variant.
+  Value operator[](Id id) const
+  {
+    return visit(id, [](const auto& object) { return Value(object); });
+  }
+
+  /// Type index of object `id`, as `Value::index()` would give.
+  uint8_t type(Id id) const { return slots_[id].type; }
+
+  /// Object `id` if it is a `T`, else null.
+  template <typename T>
+  const T* get_if(Id id) const
+  {
+    const Slot& slot = slots_[id];
+    if (slot.type != type_index<T>()) return nullptr;
+    return &std::get<Array<T>>(arrays_).items[slot.index];
+  }
+
+  /// Calls `f` with object `id` as its own type.
+  template <typename F>
+  decltype(auto) visit(Id id, F&& f) const
+  {
+    const Slot& slot = slots_[id];
+    return visit_type<0>(slot.type, slot.index, std::forward<F>(f));
+  }
+
+  /// Every object of type `T`, contiguous, in insertion order unless some were replaced.
+  template <typename T>
+  const std::vector<T>& items() const
+  {
+    return std::get<Array<T>>(arrays_).items;
+  }
+  /// Number of each object in `items<T>()`.
+  template <typename T>
+  const std::vector<Id>& ids() const
+  {
+    return std::get<Array<T>>(arrays_).ids;
+  }
+
+  /// Calls `f(items<T>(), ids<T>())` for each type in turn.
+  template <typename F>
+  void for_each_type(F&& f) const
+  {
+    std::apply([&](const auto&... arrays) { (f(arrays.items, arrays.ids), ...); }, arrays_);
+  }
+
+  /// Heap bytes of the slots and the per-type arrays.
+  size_t memory_bytes() const noexcept
+  {
+    return std::apply([](const auto&... arrays) { return (array_bytes(arrays) + ...); }, arrays_) +
+           slots_.capacity() * sizeof(Slot);
+  }
+
+ private:
+  struct Slot
+  {
+    uint32_t index = 0;  // Into the type's array.
+    uint8_t type = 0;
+  };
+
+  template <typename T>
+  struct Array
+  {
+    std::vector<T> items;
+    std::vector<Id> ids;
+
+    void shrink_to_fit()
+    {
+      items.shrink_to_fit();
+      ids.shrink_to_fit();
+    }
+  };
+
+  template <typename T>
+  static size_t array_bytes(const Array<T>& array) noexcept
+  {
+    return array.items.capacity() * sizeof(T) + array.ids.capacity() * sizeof(Id);
+  }
+
+  template <typename T>
+  Slot append(const T& object, Id id)
+  {
+    Array<T>& array = std::get<Array<T>>(arrays_);
+    array.items.push_back(object);
+    array.ids.push_back(id);
+    return Slot{static_cast<uint32_t>(array.items.size() - 1), type_index<T>()};
+  }
+
+  // Removes object `id` from its type's array by moving the last one of the type into its place.
+  void erase(Id id)
+  {
+    const Slot slot = slots_[id];
+    std::apply(
+        [&](auto&... arrays)
+        {
+          uint8_t type = 0;
+          ((type++ == slot.type ? erase_from(arrays, slot.index) : void()), ...);
+        },
+        arrays_);
+  }
+
+  template <typename T>
+  void erase_from(Array<T>& array, uint32_t index)
+  {
+    array.items[index] = std::move(array.items.back());
+    array.ids[index] = array.ids.back();
+    slots_[array.ids[index]].index = index;
+    array.items.pop_back();
+    array.ids.pop_back();
+  }
+
+  template <size_t I, typename F>
+  decltype(auto) visit_type(uint8_t type, uint32_t index, F&& f) const
+  {
+    if constexpr (I + 1 == kTypeCount)
+    {
+      return f(std::get<I>(arrays_).items[index]);
+    }
+    else
+    {
+      if (type == I) return f(std::get<I>(arrays_).items[index]);
+      return visit_type<I + 1>(type, index, std::forward<F>(f));
+    }
+  }
+
+  std::tuple<Array<Ts>...> arrays_;
+  std::vector<Slot> slots_;
+};
+}  // namespace percepto::core
@@ -13,6 +13,7 @@ namespace percepto::core
  * A `Ray` consists of:
  * - An origin point (`Vec3`)
  * - A normalized direction vector (`Vec3`)
+ * - A time within the scene's motion interval, for scenes with moving objects
  *
  * The class provides efficient methods to compute positions along the ray's path
  * using a scalar parameter \( t \), such as:
@@ -42,6 +43,19 @@ class Ray
     direction_ = direction.normalized();
   }
 
+  /**
+   * @brief Builds a ray from a direction that is already unit length, skipping validation.
+   *
+   * For hot loops whose directions come from a precomputed table, such as the emitter's
+   * direction table. Passing a direction that is not normalized breaks every `t` computed
+   * along the ray.
+   */
+  static Ray fromUnitDirection(const Vec3& origin, const Vec3& unit_direction,
+                               double t_min = 0.0, double t_max = 2000.0) noexcept
+  {
+    return Ray(origin, unit_direction, t_min, t_max, UncheckedTag{});
+  }
+
   const Vec3& origin() const { return origin_; }
   const Vec3& direction() const { return direction_; }
   double tMin() const { return t_min_; }
@@ -49,6 +63,14 @@ class Ray
 
   [[nodiscard]] Vec3 at(double t) const { return origin_ + t * direction_; }
 
+  // Narrows the far end of the valid interval. Traversal uses this to reject candidates that lie
+  // behind the closest hit found so far.
+  void setTMax(double t_max) { t_max_ = t_max; }
+
+  /// When the ray is cast, as a fraction of the scene's motion interval (see `Scene`); 0 default.
+  double time() const { return time_; }
+  void setTime(double time) { time_ = time; }
+
   // Validates that the direction vector is not zero-length or too small
   static void validateRayDirection(const Vec3& direction)
   {
@@ -59,9 +81,20 @@ class Ray
   }
 
  private:
+  struct UncheckedTag
+  {
+  };
+
+  Ray(const Vec3& origin, const Vec3& unit_direction, double t_min, double t_max,
+      UncheckedTag) noexcept
+      : origin_(origin), direction_(unit_direction), t_min_(t_min), t_max_(t_max)
+  {
+  }
+
   Vec3 origin_;
   Vec3 direction_;
   double t_min_;
   double t_max_;
+  double time_ = 0.0;
 };
 }  // namespace percepto::core
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+
+namespace percepto::core
+{
+/**
+ * @brief Rays for `Scene::intersect_batch`, as structure-of-arrays over caller-owned buffers.
+ *
+ * Every array holds `count` entries. Directions must be unit length: they are used as given,
+ * without the validation and normalization `Ray`'s constructor performs, so that millions of
+ * rays cost no more than reading them.
+ */
+struct RayBatch
+{
+  size_t count = 0;
+  const double* origin_x = nullptr;
+  const double* origin_y = nullptr;
+  const double* origin_z = nullptr;
+  const double* dir_x = nullptr;
+  const double* dir_y = nullptr;
+  const double* dir_z = nullptr;
+  const double* t_min = nullptr;
+  const double* t_max = nullptr;
+  const double* time = nullptr;  // Ray::time of each ray; null casts every ray at time 0.
+
+  Vec3 origin(size_t i) const { return Vec3(origin_x[i], origin_y[i], origin_z[i]); }
+
+  /// Ray `i` as a standalone ray.
+  Ray ray(size_t i) const
+  {
+    Ray r = Ray::fromUnitDirection(origin(i), Vec3(dir_x[i], dir_y[i], dir_z[i]), t_min[i],
+                                   t_max[i]);
+    if (time) r.setTime(time[i]);
+    return r;
+  }
+};
+
+/**
+ * @brief Closest hits written by `Scene::intersect_batch`, one entry per ray of the batch.
+ *
+ * A ray that hits nothing gets t = +infinity and `HitRecord::kNoPrimitive`; its barycentrics are
+ * left as they were.
+ */
+struct HitBatch
+{
+  double* t = nullptr;
+  uint32_t* primitive = nullptr;  // As `HitRecord::primitive`.
+  double* u = nullptr;            // Barycentrics, as `HitRecord::u` and `HitRecord::v`.
+  double* v = nullptr;
+};
+}  // namespace percepto::core
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+
+namespace percepto::core
+{
+/**
+ * @brief Up to `kMaxSize` rays leaving one origin, stored structure-of-arrays.
+ *
+ * Rays of one LiDAR column share the sensor origin and differ only slightly in direction, so
+ * they are traced together: a box or triangle is tested against every ray of the packet with a
+ * few vector instructions. Lane i holds the i-th pushed ray; lanes past `count` are zeroed and
+ * must be masked out by callers.
+ */
+struct alignas(64) RayPacket
+{
+  static constexpr int kMaxSize = 16;
+
+  Vec3 origin;
+  double dir_x[kMaxSize] = {}, dir_y[kMaxSize] = {}, dir_z[kMaxSize] = {};
+  double inv_x[kMaxSize] = {}, inv_y[kMaxSize] = {}, inv_z[kMaxSize] = {};  // 1 / direction
+  double t_min[kMaxSize] = {}, t_max[kMaxSize] = {};
+  double time[kMaxSize] = {};  // Ray::time of each ray.
+  int count = 0;
+
+  void clear() { count = 0; }
+  bool full() const { return count == kMaxSize; }
+
+  /// Bit mask with one bit set per occupied lane.
+  uint32_t lanes() const { return (1u << count) - 1; }
+
+  /// Appends `ray`, which must start at the origin of the rays already in the packet.
+  void push(const Ray& ray)
+  {
+    if (full()) throw std::length_error("RayPacket is full");
+    if (count == 0)
+    {
+      origin = ray.origin();
+    }
+    else if (!(ray.origin() == origin))
+    {
+      throw std::invalid_argument("RayPacket rays must share an origin");
+    }
+
+    const int lane = count++;
+    const Vec3& d = ray.direction();
+    dir_x[lane] = d.x;
+    dir_y[lane] = d.y;
+    dir_z[lane] = d.z;
+    inv_x[lane] = 1.0 / d.x;
+    inv_y[lane] = 1.0 / d.y;
+    inv_z[lane] = 1.0 / d.z;
+    t_min[lane] = ray.tMin();
+    t_max[lane] = ray.tMax();
+    time[lane] = ray.time();
+  }
+
+  /// Lane `i` as a standalone ray, bit-identical to the one pushed.
+  Ray ray(int i) const
+  {
+    Ray r = Ray::fromUnitDirection(origin, Vec3(dir_x[i], dir_y[i], dir_z[i]), t_min[i], t_max[i]);
+    r.setTime(time[i]);
+    return r;
+  }
+};
+}  // namespace percepto::core
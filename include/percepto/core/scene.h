@@ -1,29 +1,481 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "percepto/accel/angular_grid.h"
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/motion_bvh.h"
+#include "percepto/accel/wide_bvh.h"
 #include "percepto/common/types.h"
+#include "percepto/core/primitive_store.h"
 #include "percepto/core/ray.h"
+#include "percepto/core/ray_batch.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/transform.h"
+#include "percepto/geometry/instance.h"
 #include "percepto/geometry/sphere.h"
 #include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_block.h"
+#include "percepto/geometry/triangle_mesh.h"
 
-using percepto::geometry::Sphere, percepto::geometry::Triangle, percepto::core::Ray,
-    percepto::common::HitRecord;
+using percepto::geometry::Sphere, percepto::geometry::Triangle, percepto::geometry::Instance,
+    percepto::core::Ray, percepto::common::HitRecord, percepto::common::SurfaceHit;
+
+namespace percepto::common
+{
+class ThreadPool;
+}
 
 namespace percepto::core
 {
+/// Heap bytes held by a scene, split by what they store.
+struct SceneMemoryUsage
+{
+  size_t objects = 0;       // Free objects (`Scene::objects()`), instances included.
+  size_t meshes = 0;        // Mesh vertex and index buffers, each instanced mesh counted once.
+  size_t acceleration = 0;  // Packed triangle blocks, BVHs and angular grid.
+
+  size_t geometry() const { return objects + meshes; }
+  size_t total() const { return objects + meshes + acceleration; }
+};
+
+/**
+ * @brief Geometry to trace rays against, and the acceleration structures built over it.
+ *
+ * Free objects can be moved, replaced and removed through the handle `add_object` returns, e.g.
+ * to animate vehicles between scans. With a BVH accelerator the next `commit()` then refits only
+ * the leaves holding changed objects and the nodes above them, so its cost follows the changed
+ * geometry, not the scene. Refits keep the tree's topology, which slowly loses quality as objects
+ * drift from where it was built; once `BvhBuildOptions::rebuild_ratio` is exceeded the subtree
+ * spanning the changes is rebuilt. Mesh triangles are static.
+ *
+ * Free objects can also move during a frame, e.g. while a spinning sensor sweeps past them. The
+ * motion interval is normalized to [0, 1] and every ray is tested against moving objects where
+ * they are at its `Ray::time()`. Moving objects are kept out of the static accelerators, in a
+ * `MotionBvh` that blends its boxes to the ray's time, so no tree is built per instant.
+ */
 class Scene
 {
  public:
-  using Object = std::variant<Sphere, Triangle>;
+  /**
+   * Free objects, each type in an array of its own. An `Instance` is one primitive of the scene's
+   * BVH, which thereby becomes the top level over the bottom-level BVHs of the instanced meshes.
+   */
+  using Objects = PrimitiveStore<Sphere, Triangle, Instance>;
+  /// One free object of any type, e.g. to add or replace it.
+  using Object = Objects::Value;
+
+  // Lanes per SIMD triangle block. Both the brute-force path and the BVH leaves test triangles a
+  // block at a time with `moller_trumbore_block`.
+  static constexpr int kTriangleBlockWidth = 8;
+  using TriangleBlock = percepto::geometry::TriangleBlock<kTriangleBlockWidth>;
+  using FloatTriangleBlock = percepto::geometry::FloatTriangleBlock<kTriangleBlockWidth>;
+
+  /// Index of a free object in `objects()`; stays valid, and is never reused, after removal.
+  using ObjectHandle = uint32_t;
+
+  Scene();
+
+  /// Adds a free object. The next `commit()` rebuilds the acceleration structures.
+  ObjectHandle add_object(const Object& object);
+
+  /**
+   * @brief Replaces a free object, e.g. with the same one at its position in the next frame.
+   *
+   * An object of the same type is refitted into the BVH by the next `commit()`; changing the
+   * type makes it rebuild everything.
+   *
+   * @throws std::out_of_range if `handle` is not a handle of this scene or was removed.
+   */
+  void update_object(ObjectHandle handle, const Object& object);
+
+  /**
+   * @brief Applies `transform` to a free object, in world coordinates, as `update_object` would.
+   *
+   * Triangles and instances transform exactly. A sphere stays a sphere: its centre moves and its
+   * radius scales by the cube root of the volume change, so shear and non-uniform scaling are
+   * only approximated.
+   *
+   * @throws std::out_of_range as `update_object` does.
+   * @throws std::invalid_argument if an instance would get a singular transform.
+   */
+  void transform_object(ObjectHandle handle, const Transform& transform);
+
+  /**
+   * @brief Takes a free object out of the scene; rays no longer hit it after the next `commit()`.
+   *
+   * The object stays in `objects()`, so other handles keep their meaning, but is skipped by
+   * every accelerator. A full rebuild drops it from the BVH.
+   *
+   * @throws std::out_of_range as `update_object` does.
+   */
+  void remove_object(ObjectHandle handle);
+  bool is_removed(ObjectHandle handle) const
+  {
+    return handle < removed_.size() && removed_[handle];
+  }
+  /// Number of free objects removed so far.
+  size_t removed_count() const noexcept { return removed_count_; }
+
+  /**
+   * @brief Moves a free object over the motion interval.
+   *
+   * At time s the object is placed by `Transform::lerp(start, end, s)` applied to it as added or
+   * last updated, so each of its points moves on a straight line. A sphere's centre moves that
+   * way; its radius, scaled as by `transform_object`, is blended between the two ends. Only the
+   * small tree over the moving objects is rebuilt by the next `commit()`.
+   *
+   * @throws std::out_of_range as `update_object` does.
+   * @throws std::invalid_argument if an instance would get a singular transform at either end.
+   */
+  void set_object_motion(ObjectHandle handle, const Transform& start, const Transform& end);
+  /// Makes a moving object static again, in the pose it has as added or last updated.
+  void clear_object_motion(ObjectHandle handle);
+  bool is_moving(ObjectHandle handle) const
+  {
+    return handle < motion_of_.size() && motion_of_[handle] != kNoMotion;
+  }
+  size_t moving_count() const noexcept { return motions_.size(); }
+
+  /**
+   * @brief Free object `handle` where it is at `time`; static objects are returned as they are.
+   *
+   * @throws std::invalid_argument for an instance whose blended pose is singular at `time`.
+   */
+  Object object_at(ObjectHandle handle, double time) const;
+
+  /// Reserves room for `count` objects in total, e.g. before a bulk load.
+  void reserve(size_t count) { objects_.reserve(count); }
+
+  /// Adds an indexed mesh; each of its triangles becomes one primitive of the scene.
+  void add_mesh(percepto::geometry::TriangleMesh mesh);
+  const std::vector<percepto::geometry::TriangleMesh>& meshes() const noexcept { return meshes_; }
 
-  void add_object(const Object& object);
   bool intersect(const Ray& ray, HitRecord& hit_record);
+  /**
+   * @brief Surface of a hit `intersect`, or any other closest-hit query, returned for `ray`.
+   *
+   * Traversal tracks only t, the primitive and the barycentrics of each candidate; the point, the
+   * normal and the face hit are worked out here, once, for the hits a caller needs them for.
+   * Moving objects are taken where they are at `ray.time()`.
+   */
+  SurfaceHit resolve(const Ray& ray, const HitRecord& hit) const;
+  /// Number of primitives: free objects plus the triangles of every mesh, removed ones included.
   int size() const;
-  const std::vector<Object>& objects() const noexcept { return scene_; }
+  /// Free objects added with `add_object`, removed ones included; mesh triangles are not listed.
+  const Objects& objects() const noexcept { return objects_; }
+
+  /**
+   * @brief Primitive `id` as a standalone object.
+   *
+   * Primitives are numbered as the BVH and the angular grid index them: the free objects in
+   * insertion order, then the triangles of each mesh in turn.
+   */
+  Object primitive(uint32_t id) const;
+
+  SceneMemoryUsage memory_usage() const;
+
+  /// Selects the spatial index used by `intersect`. Changing it invalidates any built structure.
+  void set_accelerator(percepto::common::AcceleratorType accelerator);
+  percepto::common::AcceleratorType accelerator() const noexcept { return accelerator_; }
+
+  /**
+   * @brief Selects which triangle faces every query can hit; `CullMode::Back` by default.
+   *
+   * `CullMode::None` makes all triangles double-sided, so geometry seen from both sides needs no
+   * second, reversed copy of each face. Spheres are closed and unaffected. Nothing is rebuilt:
+   * the next query already runs with the new mode.
+   */
+  void set_cull_mode(percepto::common::CullMode mode) noexcept { cull_mode_ = mode; }
+  percepto::common::CullMode cull_mode() const noexcept { return cull_mode_; }
+
+  /**
+   * @brief Selects the precision of packed triangles and wide-tree bounds; double by default.
+   *
+   * `Precision::Single` packs triangles into float blocks and collapses the wide trees with float
+   * bounds, halving their memory and doubling the lanes of each SIMD test. The binary tree,
+   * spheres, instances and moving objects stay in double, and the triangle a ray hits is tested
+   * again in double, so reported hits carry double-precision t, u and v whenever that
+   * test agrees; only rays grazing an edge can hit or miss differently. Changing it makes the
+   * next `commit()` rebuild.
+   */
+  void set_precision(percepto::common::Precision precision);
+  percepto::common::Precision precision() const noexcept { return precision_; }
+
+  /// Makes the next `commit()` rebuild the BVH from scratch, unless a prebuilt tree is in use and
+  /// the options are unchanged.
+  void set_bvh_options(const percepto::accel::BvhBuildOptions& options);
+  const percepto::accel::BvhBuildOptions& bvh_options() const noexcept { return bvh_options_; }
+  /// Binary SAH tree; also the source of the wide trees and of every BVH leaf's primitives.
+  const percepto::accel::Bvh& bvh() const noexcept { return bvh_; }
+  /// Collapsed trees; built by `commit()` only for the matching accelerator.
+  const percepto::accel::WideBvh<4>& bvh4() const noexcept { return bvh4_; }
+  const percepto::accel::WideBvh<8>& bvh8() const noexcept { return bvh8_; }
+  /// Float-bounded counterparts, built instead of the above in `Precision::Single`.
+  const percepto::accel::WideBvh<4, float>& bvh4f() const noexcept { return bvh4f_; }
+  const percepto::accel::WideBvh<8, float>& bvh8f() const noexcept { return bvh8f_; }
+  /// Tree over the moving objects, whichever accelerator is selected; leaves index motions.
+  const percepto::accel::MotionBvh& motion_bvh() const noexcept { return motion_bvh_; }
+
+  /**
+   * @brief Installs a BVH built earlier over exactly the current primitives.
+   *
+   * Selects the BVH accelerator unless a wide one is already set; the next `commit()` packs the
+   * given tree (and collapses it for a wide accelerator) instead of running the SAH build.
+   * Adding objects or meshes, or changing the accelerator or BVH options discards it; setting
+   * the options the scene already has keeps it.
+   */
+  void set_prebuilt_bvh(percepto::accel::Bvh bvh);
+  /// True while the tree given to `set_prebuilt_bvh` is in use.
+  bool has_prebuilt_bvh() const noexcept { return bvh_prebuilt_; }
+
+  /**
+   * @brief Enables the sensor-centric angular grid for rays traced by `intersect_sensor_ray`.
+   *
+   * The grid is built by the next `commit()` on top of the general accelerator, which still
+   * serves `intersect` and any sensor ray that does not start at `layout.origin`. Setting the
+   * layout the grid already has is a no-op.
+   */
+  void set_angular_grid(const percepto::accel::AngularGridLayout& layout);
+  void clear_angular_grid();
+  bool has_angular_grid() const noexcept { return use_angular_grid_; }
+  /// Layout passed to the last `set_angular_grid`; the grid itself is built by `commit()`.
+  const percepto::accel::AngularGridLayout& angular_grid_layout() const noexcept
+  {
+    return angular_grid_layout_;
+  }
+  const percepto::accel::AngularGrid& angular_grid() const noexcept { return angular_grid_; }
+
+  /**
+   * @brief Closest hit for the sensor ray of azimuth step `azimuth_index` and channel `channel`.
+   *
+   * Only tests the primitives binned into that ray's angular-grid cell, then the moving objects,
+   * which the grid does not bin. Falls back to `intersect` when no grid is set or `ray` does not
+   * start at the grid origin, i.e. when the sensor has moved since the grid was built.
+   */
+  bool intersect_sensor_ray(int azimuth_index, int channel, const Ray& ray,
+                            HitRecord& hit_record);
+
+  /**
+   * @brief Closest hits of all rays of `packet`, traced together.
+   *
+   * Every BVH accelerator walks its binary tree once for the whole packet, culling nodes with
+   * the packet's frustum before testing them ray by ray; without an accelerator the packet is
+   * tested against all primitives. Triangles are tested against the rays in SIMD lanes, moving
+   * objects one ray at a time at its own time. Hit distances are bit-identical to calling
+   * `intersect` on each ray.
+   *
+   * @param[out] hit_records  Record i receives the hit of ray i; only written for rays that hit.
+   * @return Bit mask of the rays that hit.
+   */
+  uint32_t intersect_packet(const RayPacket& packet, HitRecord* hit_records);
+
+  /**
+   * @brief Closest hits of a batch of arbitrary rays, read and written as structure-of-arrays.
+   *
+   * The batch is cut into chunks of consecutive rays, which are shared out over `pool`, or
+   * traced on the calling thread without one. Within a chunk, runs of rays leaving the same
+   * point are traced as packets and the others one at a time; either way triangles are tested
+   * a SIMD block or packet at a time. Results match calling `intersect` on each ray.
+   *
+   * Commits first; the scene must not change while the batch is traced.
+   *
+   * @throws std::invalid_argument if `rays` or `hits` lacks an array other than `rays.time`.
+   */
+  void intersect_batch(const RayBatch& rays, const HitBatch& hits,
+                       percepto::common::ThreadPool* pool = nullptr);
+
+  /**
+   * @brief Whether anything lies along `ray` within [ray.tMin(), ray.tMax()].
+   *
+   * An any-hit query for line-of-sight checks. The walk through the selected accelerator ends
+   * at the first primitive hit, leaves are tested with any-hit kernels, and no hit distance is
+   * computed. Moving objects are tested where they are at the ray's time. Agrees with
+   * `intersect` except for a hit at exactly `ray.tMax()`, which counts here.
+   */
+  bool occluded(const Ray& ray);
+
+  /**
+   * @brief Any-hit counterpart of `intersect_packet`.
+   *
+   * Rays drop out of the shared walk as soon as they hit anything, and the walk ends once all
+   * have.
+   *
+   * @return Bit mask of the rays of `packet` that hit anything in their interval.
+   */
+  uint32_t occluded_packet(const RayPacket& packet);
+
+  /**
+   * @brief Builds the acceleration structure if the geometry changed since the last build.
+   *
+   * Objects changed through their handles are refitted instead where the structure allows it.
+   * The angular grid is always rebuilt over the whole scene. `intersect` commits lazily, but
+   * callers that trace from several threads must commit first.
+   */
+  void commit();
 
  private:
-  std::vector<Object> scene_;
+  // A run of packed primitives: one BVH leaf, or the whole scene for brute force. Every free-object
+  // type needs a run here and a branch in pack_range and repack_leaf, which fail to compile for a
+  // type they do not handle.
+  struct PrimRange
+  {
+    uint32_t first_block = 0;
+    uint32_t block_count = 0;
+    uint32_t first_sphere = 0;
+    uint32_t sphere_count = 0;
+    uint32_t first_instance = 0;
+    uint32_t instance_count = 0;
+  };
+
+  // Mesh and triangle of a primitive id past the free objects.
+  std::pair<const percepto::geometry::TriangleMesh*, size_t> locate_mesh_triangle(
+      uint32_t id) const;
+  percepto::geometry::AABB primitive_bounds(uint32_t id) const;
+  template <percepto::common::CullMode kCull>
+  bool intersect_primitive(uint32_t id, const Ray& ray, HitRecord& hit_record) const;
+  // Bodies of intersect, intersect_packet, occluded and occluded_packet, for a committed scene.
+  // Each public query picks the instance for cull_mode_ once; everything below runs in it.
+  template <percepto::common::CullMode kCull>
+  bool closest_hit(const Ray& ray, HitRecord& hit_record) const;
+  template <percepto::common::CullMode kCull>
+  uint32_t closest_hits(const RayPacket& packet, HitRecord* hit_records) const;
+  template <percepto::common::CullMode kCull>
+  bool any_hit(const Ray& ray) const;
+  template <percepto::common::CullMode kCull>
+  uint32_t any_hits(const RayPacket& packet) const;
+  // Traces rays [begin, end) of a batch.
+  template <percepto::common::CullMode kCull>
+  void intersect_batch_chunk(const RayBatch& rays, const HitBatch& hits, size_t begin,
+                             size_t end) const;
+
+  static constexpr uint32_t kNoNode = ~0u;
+  static constexpr uint32_t kNoMotion = ~0u;
+
+  struct ObjectMotion
+  {
+    ObjectHandle handle;
+    Transform start, end;
+  };
+
+  // In the static structures: neither removed nor moving.
+  bool is_static(uint32_t id) const
+  {
+    return id >= objects_.size() || (!removed_[id] && motion_of_[id] == kNoMotion);
+  }
+  void check_handle(ObjectHandle handle) const;
+  void drop_motion(ObjectHandle handle);
+  void build_motion_bvh();
+  template <percepto::common::CullMode kCull>
+  bool intersect_moving_object(const ObjectMotion& motion, const Ray& ray, double& t_max,
+                               HitRecord& hit_record) const;
+  // Adds the moving objects to a static result: `hit` says whether `hit_record` holds one.
+  template <percepto::common::CullMode kCull>
+  bool intersect_moving(const Ray& ray, bool hit, HitRecord& hit_record) const;
+  // Retests a triangle hit found in float blocks against the source triangle in double, and
+  // keeps the double t, u and v when that test hits too.
+  template <percepto::common::CullMode kCull>
+  void refine_hit(const Ray& ray, HitRecord& hit_record) const;
+  // Queues a changed free object for refitting, or marks the scene dirty when it cannot be.
+  void mark_moved(ObjectHandle handle);
+  // Builds every structure from scratch; the !dirty_ path of commit() refits instead.
+  void rebuild();
+  // Refits the BVH leaves of moved_ and everything above them.
+  void refit();
+  // Rebuilds the subtree spanning the refits since the last build, or the whole tree.
+  void rebuild_degraded();
+  // Bins the primitives into the angular grid by storage position: the free objects type by type
+  // in objects_ order, then the mesh triangles. `bounds` is indexed by primitive id.
+  void build_angular_grid(const std::vector<percepto::geometry::AABB>& bounds);
+  void pack_leaves();
+  // Rewrites the packed primitives of one leaf in place, leaving out removed objects.
+  void repack_leaf(uint32_t leaf);
+  PrimRange pack_range(const uint32_t* object_ids, uint32_t count);
+  bool intersect_spheres(const PrimRange& range, const Ray& ray, double& t_max,
+                         HitRecord& hit_record) const;
+  template <percepto::common::CullMode kCull>
+  bool intersect_blocks(const PrimRange& range, const Ray& ray, double& t_max,
+                        HitRecord& hit_record) const;
+  template <percepto::common::CullMode kCull, typename Block>
+  bool intersect_blocks(const std::vector<Block>& blocks, const PrimRange& range, const Ray& ray,
+                        double& t_max, HitRecord& hit_record) const;
+  template <percepto::common::CullMode kCull>
+  bool occluded_blocks(const PrimRange& range, const Ray& ray) const;
+  // Whether the rays in `mask` should each test the range's blocks, rather than the packet
+  // testing its triangles one by one.
+  bool test_blocks_per_ray(const PrimRange& range, uint32_t mask) const;
+  template <percepto::common::CullMode kCull>
+  bool intersect_instances(const PrimRange& range, const Ray& ray, double& t_max,
+                           HitRecord& hit_record) const;
+  template <percepto::common::CullMode kCull>
+  bool intersect_range(const PrimRange& range, const Ray& ray, double& t_max,
+                       HitRecord& hit_record) const;
+  // Packet counterpart of intersect_range: rays in `mask`, each with its own t_max. Returns the
+  // rays whose closest hit moved.
+  template <percepto::common::CullMode kCull>
+  uint32_t intersect_range_packet(const PrimRange& range, const RayPacket& packet, uint32_t mask,
+                                  double* t_max, HitRecord* hit_records) const;
+  template <percepto::common::CullMode kCull>
+  bool intersect_linear(const Ray& ray, HitRecord& hit_record) const;
+  // Any-hit counterparts of the above, over [ray.tMin(), ray.tMax()].
+  template <percepto::common::CullMode kCull>
+  bool occluded_range(const PrimRange& range, const Ray& ray) const;
+  template <percepto::common::CullMode kCull>
+  uint32_t occluded_range_packet(const PrimRange& range, const RayPacket& packet,
+                                 uint32_t mask) const;
+  template <percepto::common::CullMode kCull>
+  bool occluded_moving(const Ray& ray) const;
+  template <percepto::common::CullMode kCull, typename Tree>
+  bool intersect_bvh(const Tree& tree, const Ray& ray, HitRecord& hit_record) const;
+  template <percepto::common::CullMode kCull>
+  bool intersect_cell(size_t cell, const Ray& ray, HitRecord& hit_record) const;
+
+  Objects objects_;
+  std::vector<uint8_t> removed_;     // Per free object; grows with objects_.
+  std::vector<uint32_t> motion_of_;  // Per free object: index into motions_, or kNoMotion.
+  std::vector<ObjectMotion> motions_;
+  size_t removed_count_ = 0;
+  std::vector<percepto::geometry::TriangleMesh> meshes_;
+  std::vector<uint32_t> mesh_offsets_{0};  // Mesh triangles before each mesh; last = total.
+
+  // Packed copies of the primitives built by commit(), grouped by PrimRange. Triangles go to
+  // blocks_ or, in Precision::Single, float_blocks_; PrimRange indexes the one in use.
+  std::vector<TriangleBlock> blocks_;
+  std::vector<FloatTriangleBlock> float_blocks_;
+  std::vector<Sphere> spheres_;
+  std::vector<const Instance*> instances_;  // Into objects_; instances are not copied.
+  std::vector<uint32_t> sphere_ids_;        // Primitive id of each packed sphere.
+  std::vector<uint32_t> instance_ids_;      // Primitive id of each packed instance.
+  std::vector<PrimRange> ranges_;  // Indexed by BVH node; a single entry for brute force.
+
+  percepto::common::AcceleratorType accelerator_ = percepto::common::AcceleratorType::Bvh;
+  percepto::common::CullMode cull_mode_ = percepto::common::CullMode::Back;
+  percepto::common::Precision precision_ = percepto::common::Precision::Double;
+  percepto::accel::BvhBuildOptions bvh_options_;
+  percepto::accel::Bvh bvh_;
+  percepto::accel::WideBvh<4> bvh4_;
+  percepto::accel::WideBvh<8> bvh8_;
+  percepto::accel::WideBvh<4, float> bvh4f_;
+  percepto::accel::WideBvh<8, float> bvh8f_;
+  percepto::accel::MotionBvh motion_bvh_;  // Primitive ids index motions_.
+  percepto::accel::AngularGridLayout angular_grid_layout_;
+  percepto::accel::AngularGrid angular_grid_;
+  bool use_angular_grid_ = false;
+  bool bvh_prebuilt_ = false;  // bvh_ was installed by set_prebuilt_bvh; commit keeps it.
+  bool dirty_ = true;          // Geometry or settings changed since the last commit.
+
+  // Dynamic updates.
+  std::vector<ObjectHandle> moved_;  // Changed since the last commit; may repeat.
+  std::vector<uint32_t> prim_leaf_;  // BVH leaf of every primitive; built by the first refit.
+  uint32_t refit_root_ = kNoNode;    // Common ancestor of the leaves refitted since the build.
+  double bvh_cost_ = 0.0;            // bvh_.sah_area(), kept up to date by refits.
+  double bvh_built_cost_ = 0.0;      // bvh_.sah_area() right after the last build.
+  // Objects removed or set moving since the build still sit in bvh_, with empty boxes.
+  bool emptied_since_build_ = false;
+  bool motion_dirty_ = false;  // motions_ or a moving object changed since the last commit.
 };
-}  // namespace percepto::core
\ No newline at end of file
+}  // namespace percepto::core
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "percepto/core/vec3.h"
+
+namespace percepto::core
+{
+/**
+ * @file vec3f.h
+ * @brief Defines `Vec3f`, the single-precision counterpart of `Vec3`.
+ *
+ * Only the single-precision tracing path uses it: packed triangles and ray data are rounded to
+ * float once, and everything else stays in `Vec3`. Conversions are explicit so a rounding step
+ * is always visible at the call site.
+ *
+ * @code
+ * const Vec3f local(world_point - anchor);  // Round the difference, not the two points.
+ * float d = local.dot(Vec3f(ray.direction()));
+ * @endcode
+ */
+class Vec3f
+{
+ public:
+  float x, y, z;
+
+  Vec3f() : x(0.0f), y(0.0f), z(0.0f) {}
+  Vec3f(float x, float y, float z) : x(x), y(y), z(z) {}
+  explicit Vec3f(const Vec3& v)
+      : x(static_cast<float>(v.x)), y(static_cast<float>(v.y)), z(static_cast<float>(v.z))
+  {
+  }
+
+  Vec3 to_vec3() const { return Vec3(x, y, z); }
+
+  Vec3f operator-() const { return Vec3f(-x, -y, -z); }
+  Vec3f operator+(const Vec3f& v) const { return Vec3f(x + v.x, y + v.y, z + v.z); }
+  Vec3f operator-(const Vec3f& v) const { return Vec3f(x - v.x, y - v.y, z - v.z); }
+  Vec3f operator*(float t) const { return Vec3f(t * x, t * y, t * z); }
+  bool operator==(const Vec3f& v) const { return x == v.x && y == v.y && z == v.z; }
+
+  float dot(const Vec3f& v) const { return x * v.x + y * v.y + z * v.z; }
+
+  Vec3f cross(const Vec3f& v) const
+  {
+    return Vec3f(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+  }
+};
+}  // namespace percepto::core
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+
+namespace percepto::geometry
+{
+/**
+ * @brief Axis-aligned bounding box used by the acceleration structures.
+ *
+ * A default-constructed box is "empty" (min = +inf, max = -inf) so that it can be grown
+ * with `expand()` without special-casing the first point.
+ */
+struct AABB
+{
+  percepto::core::Vec3 min{std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::infinity()};
+  percepto::core::Vec3 max{-std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity()};
+
+  AABB() = default;
+  AABB(const percepto::core::Vec3& lo, const percepto::core::Vec3& hi) : min(lo), max(hi) {}
+
+  bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+  void expand(const percepto::core::Vec3& p)
+  {
+    min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+    max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+  }
+
+  void expand(const AABB& b)
+  {
+    min = {std::min(min.x, b.min.x), std::min(min.y, b.min.y), std::min(min.z, b.min.z)};
+    max = {std::max(max.x, b.max.x), std::max(max.y, b.max.y), std::max(max.z, b.max.z)};
+  }
+
+  percepto::core::Vec3 extent() const { return max - min; }
+  percepto::core::Vec3 centroid() const { return 0.5 * (min + max); }
+
+  // Surface area of the box; 0 for an empty box so it never contributes to SAH costs.
+  double surface_area() const
+  {
+    if (empty()) return 0.0;
+    percepto::core::Vec3 e = extent();
+    return 2.0 * (e.x * e.y + e.y * e.z + e.z * e.x);
+  }
+
+  // Index (0=x, 1=y, 2=z) of the longest side.
+  int largest_axis() const
+  {
+    percepto::core::Vec3 e = extent();
+    if (e.x >= e.y && e.x >= e.z) return 0;
+    return (e.y >= e.z) ? 1 : 2;
+  }
+
+  bool contains(const AABB& b) const
+  {
+    return b.min.x >= min.x && b.min.y >= min.y && b.min.z >= min.z && b.max.x <= max.x &&
+           b.max.y <= max.y && b.max.z <= max.z;
+  }
+
+  /**
+   * @brief Slab test against a ray given its precomputed reciprocal direction.
+   *
+   * @param origin   Ray origin.
+   * @param inv_dir  Component-wise 1 / direction (may contain ±inf for axis-parallel rays).
+   * @param t_min    Start of the valid interval.
+   * @param t_max    End of the valid interval (typically the closest hit found so far).
+   * @param[out] t_entry  Distance at which the ray enters the box, clamped to t_min.
+   * @return true if the ray overlaps the box inside [t_min, t_max].
+   */
+  bool intersect(const percepto::core::Vec3& origin, const percepto::core::Vec3& inv_dir,
+                 double t_min, double t_max, double& t_entry) const
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const double o = axis == 0 ? origin.x : axis == 1 ? origin.y : origin.z;
+      const double inv = axis == 0 ? inv_dir.x : axis == 1 ? inv_dir.y : inv_dir.z;
+      const double lo = axis == 0 ? min.x : axis == 1 ? min.y : min.z;
+      const double hi = axis == 0 ? max.x : axis == 1 ? max.y : max.z;
+
+      double t0 = (lo - o) * inv;
+      double t1 = (hi - o) * inv;
+      if (t0 > t1) std::swap(t0, t1);
+
+      // NaN (0 * inf when the origin lies on a slab plane) fails both comparisons and leaves
+      // the interval untouched, which treats the ray as inside that slab.
+      if (t0 > t_min) t_min = t0;
+      if (t1 < t_max) t_max = t1;
+      if (t_min > t_max) return false;
+    }
+    t_entry = t_min;
+    return true;
+  }
+};
+}  // namespace percepto::geometry
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/intersectable.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/transform.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle_block.h"
+#include "percepto/geometry/triangle_mesh.h"
+
+namespace percepto::geometry
+{
+/**
+ * @brief A mesh shared by many instances, with its own bottom-level BVH.
+ *
+ * The BVH is built once, in the mesh's own coordinates, and its leaves are packed into SIMD
+ * triangle blocks the way `Scene` packs its own leaves. Every `Instance` of the mesh traces
+ * through this one tree, so geometry and BVH memory are paid once per unique mesh.
+ */
+class InstancedMesh
+{
+ public:
+  static constexpr int kTriangleBlockWidth = 8;
+  using Block = TriangleBlock<kTriangleBlockWidth>;
+
+  /// Leaves of up to one block and block-sized primitive costs, as `Scene` builds its tree.
+  static percepto::accel::BvhBuildOptions default_bvh_options();
+
+  explicit InstancedMesh(TriangleMesh mesh,
+                         const percepto::accel::BvhBuildOptions& options = default_bvh_options());
+
+  const TriangleMesh& mesh() const noexcept { return mesh_; }
+  const percepto::accel::Bvh& bvh() const noexcept { return bvh_; }
+  /// Bounds of the mesh in its own coordinates.
+  const AABB& bounds() const noexcept { return bounds_; }
+
+  /**
+   * @brief Closest hit of `ray`, given in mesh coordinates, within [ray.tMin(), t_max].
+   *
+   * On a hit shrinks `t_max` to the hit distance and fills `hit.t`, in the ray's
+   * parametrization, the triangle hit `hit.mesh_triangle` and its barycentrics `hit.u` and
+   * `hit.v`. `kCull` selects the faces that can be hit, as for `moller_trumbore`.
+   */
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool intersect(const percepto::core::Ray& ray, double& t_max,
+                 percepto::common::HitRecord& hit) const;
+
+  /// Whether `ray`, in mesh coordinates, hits the mesh anywhere in [ray.tMin(), ray.tMax()].
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool occludes(const percepto::core::Ray& ray) const;
+
+  /// Heap bytes of the BVH and the packed triangle blocks; the mesh reports its own.
+  size_t acceleration_bytes() const noexcept;
+
+ private:
+  struct LeafRange
+  {
+    uint32_t first_block = 0;
+    uint32_t block_count = 0;
+  };
+
+  TriangleMesh mesh_;
+  percepto::accel::Bvh bvh_;
+  std::vector<Block> blocks_;
+  std::vector<LeafRange> ranges_;  // Indexed by BVH node.
+  AABB bounds_;
+};
+
+/**
+ * @brief One placement of an `InstancedMesh` in the scene.
+ *
+ * Holds a reference to the shared mesh and its transform, and nothing that grows with the mesh.
+ * Rays are carried into mesh coordinates instead of the mesh into the world: the transformed
+ * direction keeps its length, so hit distances stay in world units even under scaling.
+ *
+ * The mesh is tested in its own coordinates, so back faces are culled by the winding it was
+ * built with. A mirroring transform therefore keeps the instance's faces pointing outward, like
+ * the mirrored mesh with its winding reversed. Every test takes the cull mode as a template
+ * argument, which it hands down to the mesh.
+ */
+class Instance : public percepto::core::Intersectable<Instance>
+{
+ public:
+  /// @throws std::invalid_argument if `mesh` is null or `object_to_world` is not invertible.
+  Instance(std::shared_ptr<const InstancedMesh> mesh,
+           const percepto::core::Transform& object_to_world);
+
+  const InstancedMesh& mesh() const noexcept { return *mesh_; }
+  const std::shared_ptr<const InstancedMesh>& shared_mesh() const noexcept { return mesh_; }
+
+  /// Inverse of the transform given at construction; the only one stored.
+  const percepto::core::Transform& world_to_object() const noexcept { return world_to_object_; }
+  /// Recomputed from `world_to_object()` on every call.
+  percepto::core::Transform object_to_world() const { return world_to_object_.inverse(); }
+
+  using Intersectable<Instance>::intersect;
+
+  /// Closest hit within [ray.tMin(), t_max]; on a hit shrinks `t_max` to it.
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool intersect(const percepto::core::Ray& ray, double& t_max,
+                 percepto::common::HitRecord& hit_record) const
+  {
+    return intersect<kCull>(ray, world_to_object_, t_max, hit_record);
+  }
+
+  /// Same, placing the mesh with `world_to_object` instead, e.g. where it is at the ray's time.
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool intersect(const percepto::core::Ray& ray, const percepto::core::Transform& world_to_object,
+                 double& t_max, percepto::common::HitRecord& hit_record) const;
+
+  /// Any-hit test within [ray.tMin(), ray.tMax()].
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool occludes(const percepto::core::Ray& ray) const
+  {
+    return occludes<kCull>(ray, world_to_object_);
+  }
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool occludes(const percepto::core::Ray& ray,
+                const percepto::core::Transform& world_to_object) const;
+
+  /// World-space box around the transformed mesh bounds.
+  AABB bounds() const;
+
+  /// World-space unit normal of the front face of mesh triangle `triangle`, as culling sees it.
+  percepto::core::Vec3 normal(uint32_t triangle) const;
+
+ private:
+  std::shared_ptr<const InstancedMesh> mesh_;
+  percepto::core::Transform world_to_object_;
+
+  friend class percepto::core::Intersectable<Instance>;
+  template <percepto::common::CullMode kCull>
+  bool intercept(const percepto::core::Ray& ray, percepto::common::HitRecord& hit_record) const
+  {
+    double t_max = ray.tMax();
+    return intersect<kCull>(ray, t_max, hit_record);
+  }
+};
+}  // namespace percepto::geometry
@@ -6,6 +6,8 @@
 #include "percepto/core/intersectable.h"
 #include "percepto/core/ray.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/math/intersection/ray_sphere.h"
 #include "percepto/math/math_utils.h"
 
 using percepto::core::Vec3, percepto::core::Ray, percepto::common::HitRecord;
@@ -21,6 +23,35 @@ class Sphere : public percepto::core::Intersectable<Sphere>
   const Vec3& centre() const { return centre_; }
   const double radius() const { return radius_; }
 
+  /// Outward unit normal at `point`, a point on the surface.
+  Vec3 normal(const Vec3& point) const { return (point - centre_) / radius_; }
+
+  /// Axis-aligned box enclosing the whole sphere.
+  AABB bounds() const
+  {
+    Vec3 r{radius_, radius_, radius_};
+    return AABB(centre_ - r, centre_ + r);
+  }
+
+  /**
+   * @brief Any-hit test: whether the ray meets the sphere anywhere in [tMin, tMax].
+   *
+   * Uses the coefficients `intersect` does, so both agree on which rays graze the sphere, but
+   * rejects spheres wholly behind the origin before taking the square root and computes no hit
+   * point. A sphere has no back faces, so `kCull` changes nothing.
+   */
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  [[nodiscard]]
+  bool occludes(const Ray& ray) const
+  {
+    double unused;
+    return percepto::math::intersection::ray_sphere_test<percepto::common::HitQuery::Any, double>(
+        centre_, radius_, ray, unused);
+  }
+
+ private:
+  friend class percepto::core::Intersectable<Sphere>;
+
   /**
    * @brief Checks whether a given ray intersects this sphere and returns the closest valid hit
    * distance.
@@ -55,43 +86,33 @@ class Sphere : public percepto::core::Intersectable<Sphere>
    *   - = 0: One tangent intersection
    *   - > 0: Two intersections (enter/exit points)
    *
-   * The roots are computed using a helper function `solveQuadratic()`, which returns the
-   * real solutions (if any) in increasing order.
+   * `ray_sphere_test` solves for the roots, in double precision.
    *
    * The function returns the smallest positive t (i.e., closest visible intersection),
-   * or false if no valid intersection occurs in front of the ray origin.
+   * or false if no valid intersection occurs in front of the ray origin. A ray leaving from
+   * inside hits the far side whatever `kCull` says, as the sphere has no back faces.
    *
    * @param ray     The input ray to test against the sphere.
    * @param hit_record   Output parameter. If the ray intersects, this will contain the `HitRecord`
    * @return true if the ray intersects the sphere (in front of the ray origin); false otherwise.
    */
+  template <percepto::common::CullMode kCull>
   [[nodiscard]]
-  bool intersect(const Ray& ray, HitRecord& hit_record) const
+  bool intercept(const Ray& ray, HitRecord& hit_record) const
   {
-    QuadraticCoefficients q_coef = computeQuadraticCoefficients(ray, *this);
-
-    double t0, t1;
-    auto result = solveQuadratic(q_coef.a, q_coef.b, q_coef.c);
-    if (!result) return false;
-
-    t0 = result->first;
-    t1 = result->second;
-
-    if (t0 < 0.0)
+    double t;
+    if (!percepto::math::intersection::ray_sphere_test<percepto::common::HitQuery::Closest,
+                                                       double>(centre_, radius_, ray, t))
     {
-      // If the nearest root is negative, try the farther root
-      t0 = t1;
-      if (t0 < ray.tMin() || t0 > ray.tMax())
-        return false;  // No valid intersection in [tMin, tMax]
+      return false;
     }
 
-    hit_record.t = t0;
-    hit_record.point = ray.at(t0);
+    hit_record.t = t;
+    hit_record.u = hit_record.v = 0.0;
 
     return true;
   }
 
- private:
   Vec3 centre_;
   double radius_;
 };
@@ -3,6 +3,7 @@
 #include "percepto/core/intersectable.h"
 #include "percepto/core/ray.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
 #include "percepto/math/intersection/moller_trumbore.h"
 
 using percepto::core::Vec3, percepto::core::Ray, percepto::math::intersection::moller_trumbore,
@@ -15,32 +16,57 @@ class Triangle : public percepto::core::Intersectable<Triangle>
  public:
   Triangle(const Vec3& v0, const Vec3& v1, const Vec3& v2) : v0_(v0), v1_(v1), v2_(v2) {}
 
+  /// Any-hit test: whether `intersect<kCull>` would hit, without computing the hit.
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool occludes(const Ray& ray) const
+  {
+    return percepto::math::intersection::moller_trumbore_occluded<kCull>(v0_, v1_, v2_, ray);
+  }
+
+  const Vec3& v0() const { return v0_; }
+  const Vec3& v1() const { return v1_; }
+  const Vec3& v2() const { return v2_; }
+
+  /// Unit normal of the front face, the one `CullMode::Back` keeps: (v1 - v0) x (v2 - v0).
+  Vec3 normal() const { return (v1_ - v0_).cross(v2_ - v0_).normalized(); }
+
+  /// Axis-aligned box enclosing the three vertices.
+  AABB bounds() const
+  {
+    AABB box;
+    box.expand(v0_);
+    box.expand(v1_);
+    box.expand(v2_);
+    return box;
+  }
+
+ private:
+  friend class percepto::core::Intersectable<Triangle>;
+
   /**
    * @brief Check if a ray hits this triangle and return the hit distance.
    *
-   * Calls the Möller–Trumbore routine (with back-face culling) on vertices v0_, v1_, v2_.
+   * Calls the Möller–Trumbore routine on vertices v0_, v1_, v2_, culling back faces unless
+   * `kCull` is `CullMode::None`.
    *
    * @param[in]  ray    The ray to test.
    * @param[out] hit_record  If true is returned, holds the `HitRecord`
-   * @return true if the ray intersects the front face (t > 0), false otherwise.
+   * @return true if the ray intersects a face it can hit within [tMin, tMax], false otherwise.
    */
-  bool intersect(const Ray& ray, HitRecord& hit_record) const
+  template <percepto::common::CullMode kCull>
+  bool intercept(const Ray& ray, HitRecord& hit_record) const
   {
-    auto hit_data = moller_trumbore(v0_, v1_, v2_, ray);
+    auto hit_data = moller_trumbore<kCull>(v0_, v1_, v2_, ray);
     if (!hit_data.has_value()) return false;
 
     const auto& [t, u, v] = hit_data.value();
     hit_record.t = t;
-    hit_record.point = ray.at(t);
+    hit_record.u = u;
+    hit_record.v = v;
 
     return true;
   }
 
-  const Vec3& v0() const { return v0_; }
-  const Vec3& v1() const { return v1_; }
-  const Vec3& v2() const { return v2_; }
-
- private:
   Vec3 v0_;  // Triangle vertice A
   Vec3 v1_;  // Triangle vertice B
   Vec3 v2_;  // Triangle vertice C
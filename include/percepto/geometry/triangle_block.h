@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+#include "percepto/core/vec3.h"
+#include "percepto/core/vec3f.h"
+#include "percepto/geometry/triangle.h"
+
+namespace percepto::geometry
+{
+/**
+ * @brief Structure-of-arrays packet of up to W triangles with precomputed edges.
+ *
+ * Each component is stored contiguously across lanes, so the block kernel can load one vector
+ * register per component and test the ray against all W triangles at once. Edges are stored
+ * instead of the other two vertices because Möller–Trumbore only ever uses v0, v1 - v0 and
+ * v2 - v0.
+ *
+ * Unused lanes are left zeroed: their edges are degenerate (det = 0), so they can never report
+ * a hit and need no masking.
+ *
+ * @tparam W Number of lanes (4, 8 or 16).
+ */
+template <int W>
+struct alignas(64) TriangleBlock
+{
+  static_assert(W == 4 || W == 8 || W == 16, "TriangleBlock width must be 4, 8 or 16");
+  static constexpr int kWidth = W;
+
+  double v0x[W] = {}, v0y[W] = {}, v0z[W] = {};
+  double e1x[W] = {}, e1y[W] = {}, e1z[W] = {};  // v1 - v0
+  double e2x[W] = {}, e2y[W] = {}, e2z[W] = {};  // v2 - v0
+  uint32_t prim_id[W] = {};                      // Caller-defined id of each lane's triangle.
+  int count = 0;                                 // Number of occupied lanes.
+
+  bool full() const { return count == W; }
+
+  /// Appends a triangle to the next free lane. The block must not be full.
+  void push(const Triangle& tri, uint32_t id)
+  {
+    const int lane = count++;
+    const percepto::core::Vec3 e1 = tri.v1() - tri.v0();
+    const percepto::core::Vec3 e2 = tri.v2() - tri.v0();
+
+    v0x[lane] = tri.v0().x;
+    v0y[lane] = tri.v0().y;
+    v0z[lane] = tri.v0().z;
+    e1x[lane] = e1.x;
+    e1y[lane] = e1.y;
+    e1z[lane] = e1.z;
+    e2x[lane] = e2.x;
+    e2y[lane] = e2.y;
+    e2z[lane] = e2.z;
+    prim_id[lane] = id;
+  }
+};
+
+/**
+ * @brief Single-precision `TriangleBlock`, for `Precision::Single` scenes.
+ *
+ * Half the bytes per triangle, and twice the lanes per vector instruction. Vertices are stored
+ * relative to `anchor`, the first triangle's v0, which stays in double: the differences are
+ * small next to the block's distance from the world origin, so rounding them to float costs
+ * little. The kernel likewise moves the ray's start, in double, to the point nearest the anchor
+ * before rounding it. Neither the block's distance from the world origin, e.g. in map
+ * coordinates, nor its distance from the sensor costs precision.
+ *
+ * @tparam W Number of lanes (8 or 16).
+ */
+template <int W>
+struct alignas(64) FloatTriangleBlock
+{
+  static_assert(W == 8 || W == 16, "FloatTriangleBlock width must be 8 or 16");
+  static constexpr int kWidth = W;
+
+  float v0x[W] = {}, v0y[W] = {}, v0z[W] = {};  // v0 - anchor
+  float e1x[W] = {}, e1y[W] = {}, e1z[W] = {};  // v1 - v0
+  float e2x[W] = {}, e2y[W] = {}, e2z[W] = {};  // v2 - v0
+  percepto::core::Vec3 anchor;                  // After the lanes, which must stay aligned.
+  uint32_t prim_id[W] = {};
+  int count = 0;
+
+  bool full() const { return count == W; }
+
+  /// Appends a triangle to the next free lane. The block must not be full.
+  void push(const Triangle& tri, uint32_t id)
+  {
+    if (count == 0) anchor = tri.v0();
+    const int lane = count++;
+    // Differences are taken in double, so each stored value is rounded once.
+    const percepto::core::Vec3f v0(tri.v0() - anchor);
+    const percepto::core::Vec3f e1(tri.v1() - tri.v0());
+    const percepto::core::Vec3f e2(tri.v2() - tri.v0());
+
+    v0x[lane] = v0.x;
+    v0y[lane] = v0.y;
+    v0z[lane] = v0.z;
+    e1x[lane] = e1.x;
+    e1y[lane] = e1.y;
+    e1z[lane] = e1.z;
+    e2x[lane] = e2.x;
+    e2y[lane] = e2.y;
+    e2z[lane] = e2.z;
+    prim_id[lane] = id;
+  }
+};
+}  // namespace percepto::geometry
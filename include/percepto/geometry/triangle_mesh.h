@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/math/intersection/moller_trumbore.h"
+
+namespace percepto::geometry
+{
+/**
+ * @brief Indexed triangle mesh: a shared vertex buffer and three 32-bit indices per triangle.
+ *
+ * A vertex shared by several triangles is stored once, so a closed mesh costs about 24 bytes per
+ * triangle (half a vertex plus 12 bytes of indices) instead of the 72 bytes of three `Vec3` in a
+ * `Triangle`. Triangles keep the winding of their index triple.
+ */
+class TriangleMesh
+{
+ public:
+  TriangleMesh() = default;
+
+  /// @throws std::invalid_argument if `indices` is not a multiple of 3 or references a vertex
+  ///         out of range.
+  TriangleMesh(std::vector<percepto::core::Vec3> vertices, std::vector<uint32_t> indices);
+
+  size_t vertex_count() const noexcept { return vertices_.size(); }
+  size_t triangle_count() const noexcept { return indices_.size() / 3; }
+  bool empty() const noexcept { return indices_.empty(); }
+
+  const std::vector<percepto::core::Vec3>& vertices() const noexcept { return vertices_; }
+  const std::vector<uint32_t>& indices() const noexcept { return indices_; }
+
+  /// Vertex `k` (0, 1 or 2) of triangle `t`.
+  const percepto::core::Vec3& vertex(size_t t, int k) const
+  {
+    return vertices_[indices_[3 * t + k]];
+  }
+
+  /// Triangle `t` as a standalone primitive.
+  Triangle triangle(size_t t) const { return Triangle(vertex(t, 0), vertex(t, 1), vertex(t, 2)); }
+
+  AABB bounds(size_t t) const
+  {
+    AABB box;
+    box.expand(vertex(t, 0));
+    box.expand(vertex(t, 1));
+    box.expand(vertex(t, 2));
+    return box;
+  }
+
+  /// Same test as `Triangle::intersect`, reading the vertices through the index buffer.
+  template <percepto::common::CullMode kCull = percepto::common::CullMode::Back>
+  bool intersect(size_t t, const Ray& ray, HitRecord& hit_record) const
+  {
+    auto hit_data = moller_trumbore<kCull>(vertex(t, 0), vertex(t, 1), vertex(t, 2), ray);
+    if (!hit_data.has_value()) return false;
+
+    hit_record.t = hit_data->t;
+    hit_record.u = hit_data->u;
+    hit_record.v = hit_data->v;
+    return true;
+  }
+
+  /// Heap bytes held by the vertex and index buffers.
+  size_t memory_bytes() const noexcept
+  {
+    return vertices_.capacity() * sizeof(percepto::core::Vec3) +
+           indices_.capacity() * sizeof(uint32_t);
+  }
+
+ private:
+  std::vector<percepto::core::Vec3> vertices_;
+  std::vector<uint32_t> indices_;
+};
+
+/**
+ * @brief Builds a `TriangleMesh` from free triangles, storing every distinct vertex once.
+ *
+ * Vertices are merged only when their coordinates are bitwise equal, so the mesh traces exactly
+ * like the triangles it was built from.
+ */
+class TriangleMeshBuilder
+{
+ public:
+  /// Reserves room for `triangle_count` triangles.
+  void reserve(size_t triangle_count);
+
+  /// Index of `v`, appending it to the vertex buffer if it has not been seen yet.
+  uint32_t add_vertex(const percepto::core::Vec3& v);
+  void add_triangle(const percepto::core::Vec3& v0, const percepto::core::Vec3& v1,
+                    const percepto::core::Vec3& v2);
+  void add_triangle(const Triangle& tri) { add_triangle(tri.v0(), tri.v1(), tri.v2()); }
+
+  size_t vertex_count() const noexcept { return vertices_.size(); }
+  size_t triangle_count() const noexcept { return indices_.size() / 3; }
+
+  /// Hands the buffers over to a mesh and leaves the builder empty.
+  TriangleMesh build();
+
+ private:
+  struct VertexKey
+  {
+    uint64_t bits[3];
+    bool operator==(const VertexKey& other) const
+    {
+      return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+    }
+  };
+  struct VertexKeyHash
+  {
+    size_t operator()(const VertexKey& key) const noexcept;
+  };
+
+  std::vector<percepto::core::Vec3> vertices_;
+  std::vector<uint32_t> indices_;
+  std::unordered_map<VertexKey, uint32_t, VertexKeyHash> vertex_ids_;
+};
+}  // namespace percepto::geometry
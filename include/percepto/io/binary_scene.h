@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "percepto/core/scene.h"
+
+namespace percepto::io
+{
+/**
+ * @brief Percepto binary scene format (.pscn), version 1.
+ *
+ * Little-endian, every section aligned to 64 bytes:
+ *
+ *   header    magic "PRCPSCN\0", version, flags, section counts and byte offsets
+ *   vertices  vertex_count × 3 doubles (x, y, z)
+ *   indices   triangle_count × 3 uint32 vertex indices, same winding as the source triangles
+ *   bvh nodes optional: bounds (6 doubles) + offset + count per node, `Bvh::nodes()` layout
+ *   bvh prims optional: uint32 triangle index per BVH entry, `Bvh::prim_indices()` layout
+ *
+ * Loading maps the file and copies the vertex and index buffers into a single `TriangleMesh`;
+ * no text is parsed and, with the BVH section present, no acceleration structure is built.
+ */
+inline constexpr uint32_t kBinarySceneVersion = 1;
+inline constexpr const char* kBinarySceneExtension = ".pscn";
+
+/// Summary of a binary scene file, read from its header alone.
+struct BinarySceneInfo
+{
+  uint32_t version = 0;
+  uint64_t vertex_count = 0;
+  uint64_t triangle_count = 0;
+  bool has_bvh = false;
+  uint64_t file_bytes = 0;
+};
+
+class BinarySceneWriter
+{
+ public:
+  /**
+   * @brief Writes the triangles of `scene` to `filename`.
+   *
+   * Vertices shared by several triangles (bitwise-equal coordinates) are stored once. With
+   * `include_bvh` a BVH is built over them with the scene's BVH options and stored too, unless
+   * objects were removed from it. Removed objects are not written.
+   *
+   * @throws std::runtime_error if the scene holds non-triangle or moving objects or the file
+   *         cannot be written.
+   */
+  BinarySceneInfo write(const percepto::core::Scene& scene, const std::string& filename,
+                        bool include_bvh = true);
+};
+
+class BinarySceneParser
+{
+ public:
+  /**
+   * @brief Loads a scene written by `BinarySceneWriter`.
+   *
+   * @throws std::runtime_error if the file is missing, not a Percepto scene, of an unsupported
+   *         version, truncated, or references vertices or triangles out of range.
+   */
+  std::unique_ptr<percepto::core::Scene> load_scene_from_binary(const std::string& filename);
+
+  /// Reads and validates the header only.
+  BinarySceneInfo read_info(const std::string& filename);
+};
+}  // namespace percepto::io
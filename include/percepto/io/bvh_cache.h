@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/core/scene.h"
+
+namespace percepto::io
+{
+/**
+ * @brief Percepto BVH cache file (.pbvh), version 1.
+ *
+ * Holds one built binary BVH together with the key it was built for. Little-endian, every
+ * section aligned to 64 bytes:
+ *
+ *   header  magic "PRCPBVH\0", version, key, section counts and offsets, payload checksum
+ *   nodes   `Bvh::nodes()` verbatim (bounds as 6 doubles, offset, count)
+ *   prims   `Bvh::prim_indices()` verbatim
+ *
+ * A file is only used if its key matches the scene's, its checksum matches its payload and every
+ * node references valid children and primitives; anything else is treated as a miss.
+ */
+inline constexpr uint32_t kBvhCacheVersion = 1;
+inline constexpr const char* kBvhCacheExtension = ".pbvh";
+
+/// What a BVH cache file must match: the primitives' geometry and the builder settings.
+struct BvhCacheKey
+{
+  uint64_t content_hash = 0;  // Every primitive's defining data, in primitive order.
+  uint64_t options_hash = 0;  // BvhBuildOptions fields that affect the tree.
+  uint64_t primitive_count = 0;
+
+  bool operator==(const BvhCacheKey& other) const
+  {
+    return content_hash == other.content_hash && options_hash == other.options_hash &&
+           primitive_count == other.primitive_count;
+  }
+  bool operator!=(const BvhCacheKey& other) const { return !(*this == other); }
+};
+
+enum class BvhCacheStatus
+{
+  Hit,      ///< The cached tree was loaded
+  Missing,  ///< No cache file yet
+  Stale,    ///< The file was built for other geometry or builder settings
+  Corrupt,  ///< The file is truncated, fails its checksum or holds an invalid tree
+  Unused    ///< The scene does not use a BVH, has a prebuilt one, or removed or moving objects
+};
+
+/// Cache key of `scene` under its current BVH build options.
+BvhCacheKey bvh_cache_key(const percepto::core::Scene& scene);
+
+/// Cache file kept next to the scene file: `scene_file` with ".pbvh" appended.
+std::string bvh_cache_path(const std::string& scene_file);
+
+/**
+ * @brief Loads the tree in `path` into `bvh` if the file is valid for `key`.
+ *
+ * The file is memory-mapped and its sections copied straight into the tree's arrays. `bvh` is
+ * only modified on a hit.
+ */
+BvhCacheStatus read_bvh_cache(const std::string& path, const BvhCacheKey& key,
+                              percepto::accel::Bvh& bvh);
+
+/**
+ * @brief Writes `bvh` to `path` under `key`.
+ *
+ * The file is written next to its destination and renamed over it, so concurrent runs never
+ * read a partial file.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void write_bvh_cache(const std::string& path, const BvhCacheKey& key,
+                     const percepto::accel::Bvh& bvh);
+
+/**
+ * @brief Commits `scene`, taking its BVH from the cache file `path` when that is valid.
+ *
+ * On a miss the BVH is built as usual and written to `path` for the next run; failing to write
+ * it only logs a warning.
+ *
+ * @return How the cache was used.
+ */
+BvhCacheStatus commit_with_bvh_cache(percepto::core::Scene& scene, const std::string& path);
+}  // namespace percepto::io
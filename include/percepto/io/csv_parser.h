@@ -14,13 +14,24 @@ class CSVRow;
 
 namespace percepto::io
 {
+/// Selects how `CsvParser` reads a scene file.
+struct CsvLoadOptions
+{
+  // Map the file and parse newline-aligned chunks in parallel with std::from_chars. When false,
+  // or when the file contains quoted fields, rows go through csv-parser's CSVReader instead.
+  bool memory_mapped = true;
+  int thread_count = 0;  // Parsing threads for the mapped path; 0 = one per core.
+};
 
 class CsvParser
 {
  public:
+  explicit CsvParser(CsvLoadOptions options = {}) : options_(options) {}
+
   /**
    * @brief Parse a CSV file where each row is exactly 9 doubles (three 3D vertices),
-   *        build a Scene of Triangles, and return it as a unique_ptr.
+   *        build a Scene holding them as one indexed TriangleMesh (shared vertices stored
+   *        once), and return it as a unique_ptr.
    *
    * @param filename Path to the CSV file ("x0,y0,z0,x1,y1,z1,x2,y2,z2" per row).
    * @return std::unique_ptr<percepto::core::Scene> owning all successfully parsed triangles.
@@ -34,9 +45,14 @@ class CsvParser
   // Ensure file exists, is a regular file, and is readable.
   void ensure_file_readable(const std::string& filename);
 
+  // Row-by-row load through csv-parser's CSVReader.
+  std::unique_ptr<percepto::core::Scene> load_with_csv_reader(const std::string& filename);
+
   //  Parse exactly 9 fields from CSVRow → one Triangle. Throws on error.
   //    row_num is used in error messages.
   percepto::geometry::Triangle parse_triangle_from_csv_row(const csv::CSVRow& row, size_t row_num);
+
+  CsvLoadOptions options_;
 };
 
 }  // namespace percepto::io
@@ -1,6 +1,27 @@
+#pragma once
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 #include <memory>
+#include <string>
+
+// Set to 0 (CMake: -DPERCEPTO_RAY_TRACE=OFF) to compile every PERCEPTO_RAY_TRACE call out.
+#ifndef PERCEPTO_ENABLE_RAY_TRACE
+#define PERCEPTO_ENABLE_RAY_TRACE 1
+#endif
+
+/// Writes one per-ray trace record if `logger` is set; expands to nothing when compiled out.
+#if PERCEPTO_ENABLE_RAY_TRACE
+#define PERCEPTO_RAY_TRACE(logger, ...)       \
+  do                                          \
+  {                                           \
+    if (logger) (logger)->trace(__VA_ARGS__); \
+  } while (0)
+#else
+#define PERCEPTO_RAY_TRACE(logger, ...) static_cast<void>(0)
+#endif
 
 inline std::shared_ptr<spdlog::logger> get_percepto_logger()
 {
@@ -20,3 +41,28 @@ inline std::shared_ptr<spdlog::logger> get_percepto_logger()
 
   return logger;
 }
+
+/**
+ * @brief Returns the per-ray trace logger, creating it on first use.
+ *
+ * Records are handed to spdlog's background thread and written to `filepath`, so tracing
+ * threads only pay for formatting the message, never for the file I/O or a sink mutex. The
+ * file is truncated when the logger is created; later calls return the same logger whatever
+ * path they pass.
+ */
+inline std::shared_ptr<spdlog::logger> get_percepto_ray_logger(
+    const std::string& filepath = "percepto_rays.log")
+{
+  auto logger = spdlog::get("percepto.rays");
+  if (logger)
+  {
+    return logger;
+  }
+
+  logger = spdlog::create_async<spdlog::sinks::basic_file_sink_mt>("percepto.rays", filepath,
+                                                                  true);
+  logger->set_level(spdlog::level::trace);
+  logger->set_pattern("%v");  // Records are already structured.
+
+  return logger;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace percepto::io
+{
+/**
+ * @brief Read-only view of a whole file.
+ *
+ * Memory-mapped where the platform supports it, so loaders read the page cache directly instead
+ * of copying the file; elsewhere the file is read into memory. The mapping lives as long as the
+ * object.
+ */
+class MappedFile
+{
+ public:
+  /// @throws std::runtime_error if the file cannot be opened or mapped.
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const noexcept { return data_; }
+  size_t size() const noexcept { return size_; }
+
+ private:
+  const char* data_ = nullptr;  // Null for an empty file.
+  size_t size_ = 0;
+  std::string buffer_;  // File contents when mmap is unavailable.
+};
+}  // namespace percepto::io
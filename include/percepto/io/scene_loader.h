@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+
+namespace percepto::io
+{
+/**
+ * @brief Picks the scene format from the file extension (case-insensitive).
+ *
+ * ".csv", ".obj", ".gltf"/".glb", ".json" and ".pscn" are recognised.
+ *
+ * @throws std::runtime_error for any other extension.
+ */
+percepto::common::SceneFormat scene_format_from_path(const std::string& filename);
+
+/**
+ * @brief Loads a scene with the parser matching its file extension.
+ *
+ * @throws std::runtime_error if the format has no loader yet (OBJ, glTF, JSON) or the parser
+ *         rejects the file.
+ */
+std::unique_ptr<percepto::core::Scene> load_scene(const std::string& filename);
+}  // namespace percepto::io
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include "percepto/common/config_loader.h"
@@ -8,9 +9,31 @@
 
 namespace percepto::lidar
 {
+/**
+ * @brief Unit direction of every beam, structure-of-arrays.
+ *
+ * Entry k = i * channel_count + j holds beam (azimuth step i, channel j), the same row-major
+ * order as `FrameScan`.
+ */
+struct DirectionTable
+{
+  std::vector<double> x, y, z;
+
+  size_t size() const noexcept { return x.size(); }
+  bool empty() const noexcept { return x.empty(); }
+  size_t memory_bytes() const noexcept
+  {
+    return (x.capacity() + y.capacity() + z.capacity()) * sizeof(double);
+  }
+};
+
 /**
  * @brief Emits LiDAR rays by sweeping fixed elevation angles
  *        through one 360° revolution in discrete azimuth steps.
+ *
+ * Azimuth steps fire one after another as the head spins. Every ray carries the fraction of the
+ * revolution elapsed when its step fires as its `Ray::time()`, so a scene's motion interval
+ * spans one revolution and moving objects are seen where they are at each firing.
  */
 class LidarEmitter
 {
@@ -20,9 +43,26 @@ class LidarEmitter
    */
   LidarEmitter(percepto::common::LiDARConfig lidar_cfg);
 
+  /**
+   * @brief Switches to a new sensor configuration.
+   *
+   * A configuration equal to the current one is a no-op, so the direction table is only
+   * rebuilt when the angles actually change.
+   */
+  void configure(percepto::common::LiDARConfig lidar_cfg);
+
   /// Returns the number of azimuth steps this emitter was configured with.
   int azimuth_steps() const { return azimuth_angles_.size(); }
 
+  /// Revolutions per second.
+  double rotation_rate() const { return rotation_rate_; }
+  double revolution_period() const { return 1.0 / rotation_rate_; }
+
+  /// Fraction of the revolution elapsed when azimuth step `i` fires; the `Ray::time()` of its rays.
+  double firing_phase(int i) const { return static_cast<double>(i) / azimuth_steps(); }
+  /// Seconds from the start of the revolution to the firing of azimuth step `i`.
+  double firing_time(int i) const { return firing_phase(i) / rotation_rate_; }
+
   const std::vector<double>& elevation_angles() const { return elevation_angles_; }
 
   /// Returns the precomputed cosines of each elevation angle.
@@ -45,10 +85,59 @@ class LidarEmitter
 
   const std::vector<double>& azimuth_angles() const { return azimuth_angles_; }
 
+  /// Returns the point every ray is emitted from.
+  const percepto::core::Vec3& origin() const { return default_origin; }
+
+  /**
+   * @brief Precomputes the direction of every beam, enabling `ray` and `rays`.
+   *
+   * The table costs `3 × N × M` doubles and removes all trigonometry and index checks from ray
+   * generation. It is kept across revolutions and rebuilt by `configure` only when the angles
+   * change. Calling this again while the table exists is a no-op.
+   */
+  void enable_direction_table();
+
+  /// Frees the direction table; rays are computed per call again.
+  void disable_direction_table();
+
+  bool has_direction_table() const noexcept { return use_direction_table_; }
+  const DirectionTable& direction_table() const noexcept { return directions_; }
+
+  /// Bytes held by the direction table; 0 while it is disabled.
+  size_t direction_table_bytes() const noexcept { return directions_.memory_bytes(); }
+
+  /**
+   * @brief Ray of beam (i, j) read from the direction table.
+   *
+   * Unchecked: the table must be enabled and the indices in range. The ray is bit-identical to
+   * `get_ray(i, j)`.
+   */
+  percepto::core::Ray ray(int i, int j) const noexcept
+  {
+    const size_t k = static_cast<size_t>(i) * elevation_angles_.size() + j;
+    auto ray = percepto::core::Ray::fromUnitDirection(
+        default_origin, percepto::core::Vec3(directions_.x[k], directions_.y[k], directions_.z[k]));
+    ray.setTime(firing_phase(i));
+    return ray;
+  }
+
+  /**
+   * @brief Replaces the contents of `out` with the rays of table entries [first, first + count).
+   *
+   * A whole azimuth step is `channel_count` consecutive entries starting at `i * channel_count`.
+   * Unchecked like `ray`; reusing `out` across calls keeps its capacity.
+   */
+  void rays(size_t first, size_t count, std::vector<percepto::core::Ray>& out) const;
+
  private:
+  void build_direction_table();
+
   std::vector<double> elevation_angles_;
   std::vector<double> cos_elev_, sin_elev_;
   std::vector<double> azimuth_angles_;
+  double rotation_rate_ = 10.0;
+  DirectionTable directions_;  // Empty unless enabled.
+  bool use_direction_table_ = false;
   static constexpr double TWO_PI = 2.0 * M_PI;
   inline static const percepto::core::Vec3 default_origin{0.0, 0.0, 0.0};
 };
@@ -1,14 +1,37 @@
 #pragma once
 
+#include <spdlog/fwd.h>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "percepto/common/frame_pool.h"
 #include "percepto/common/frame_scan.h"
+#include "percepto/common/thread_pool.h"
+#include "percepto/core/ray_packet.h"
 #include "percepto/core/scene.h"
+#include "percepto/common/types.h"
 #include "percepto/lidar/emitter.h"
+#include "percepto/lidar/scan_rasterizer.h"
 
 namespace percepto::lidar
 {
+/// Controls how `LidarSimulator::run_scan` computes a revolution and spreads it over threads.
+struct ScanOptions
+{
+  int thread_count = 1;         // Threads tracing a revolution; 1 = serial, 0 = one per core.
+  int azimuth_tile_size = 64;   // Azimuth steps per work item handed to a thread.
+  bool angular_grid = false;    // Trace through the scene's per-ray angular grid.
+  bool direction_table = true;  // Read ray directions from the emitter's precomputed table.
+  percepto::common::ScanBackend backend = percepto::common::ScanBackend::RayTrace;
+  bool trace_rays = false;                          // Log every traced ray (ray-trace backend).
+  std::string ray_trace_file = "percepto_rays.log";  // Where the per-ray trace is written.
+  // Beams traced together as one packet by the ray-trace backend without the angular grid; at
+  // most RayPacket::kMaxSize, and 0 or 1 traces every beam on its own.
+  int packet_size = percepto::core::RayPacket::kMaxSize;
+  percepto::common::PacketLayout packet_layout = percepto::common::PacketLayout::Azimuth;
+};
+
 class LidarSimulator
 {
  public:
@@ -21,11 +44,46 @@ class LidarSimulator
   LidarEmitter& emitter() { return *lidar_emitter_; }
   percepto::core::Scene& scene() { return *scene_; }
 
+  /**
+   * @brief Sets the backend, threading and tracing options for subsequent scans.
+   *
+   * The worker pool is created here, once, and reused by every `run_scan` call. Results are
+   * bit-identical for any thread count or tile size.
+   */
+  void set_scan_options(const ScanOptions& options);
+  const ScanOptions& scan_options() const noexcept { return options_; }
+
   std::vector<percepto::common::FrameScan> run_scan(int revs = 1);
 
+  /**
+   * @brief Scans `revs` revolutions into `frames`, reusing its buffers.
+   *
+   * Whatever `frames` holds on entry goes back to the frame pool and is handed out again for the
+   * new revolutions, so calling this in a loop with the same vector does no heap allocation once
+   * the first call has sized the pool.
+   */
+  void run_scan(int revs, std::vector<percepto::common::FrameScan>& frames);
+
+  /// Returns frames from an earlier scan to the pool; `frames` is left empty.
+  void recycle(std::vector<percepto::common::FrameScan>& frames) { frame_pool_.release(frames); }
+
  private:
+  // Traces azimuth steps [first, last) of revolution `rev` into `scan`; returns the hit count.
+  int trace_azimuth_range(percepto::common::FrameScan& scan, int rev, int first, int last);
+  // Same, tracing packets of options_.packet_size beams laid out as options_.packet_layout.
+  int trace_azimuth_range_packets(percepto::common::FrameScan& scan, int rev, int first,
+                                  int last);
+
   std::unique_ptr<percepto::lidar::LidarEmitter> lidar_emitter_;
   std::unique_ptr<percepto::core::Scene> scene_;
+
+  ScanOptions options_;
+  std::unique_ptr<percepto::common::ThreadPool> pool_;  // Null while scanning serially.
+  ScanRasterizer rasterizer_;
+  percepto::common::FramePool frame_pool_;
+  std::vector<int> tile_hits_;  // Hits per azimuth tile of the revolution being traced.
+  double scan_clock_ = 0.0;     // Seconds from the first revolution to the start of the next.
+  std::shared_ptr<spdlog::logger> ray_logger_;  // Per-ray trace; null unless trace_rays is set.
 };
 
 }  // namespace percepto::lidar
@@ -10,7 +10,64 @@ using percepto::core::Ray, percepto::core::Vec3, percepto::common::TriangleHitRe
 
 namespace percepto::math::intersection
 {
+/**
+ * @brief Möller–Trumbore ray–triangle test, specialized at compile time.
+ *
+ * @tparam kCull   `CullMode::Back` rejects rays reaching the back face; `CullMode::None` hits
+ *                 both faces, reporting the same (t, u, v) from either side.
+ * @tparam kQuery  `HitQuery::Closest` writes (t, u, v) to `hit`; `HitQuery::Any` only answers
+ *                 whether there is a hit and leaves `hit` untouched.
+ * @tparam T       Scalar type the test runs in (`double` or `float`); the inputs are rounded to
+ *                 it, the results widened back.
+ * @return true if the ray hits the triangle within [ray.tMin(), ray.tMax()].
+ */
+template <common::CullMode kCull, common::HitQuery kQuery, typename T>
+bool moller_trumbore_test(const Vec3& v0, const Vec3& v1, const Vec3& v2, const Ray& ray,
+                          TriangleHitResult& hit);
+
+/// Closest-hit form of `moller_trumbore_test`: (t, u, v) of the hit, or nothing.
+template <common::CullMode kCull = common::CullMode::Back, typename T = double>
 std::optional<TriangleHitResult> moller_trumbore(const Vec3& v0, const Vec3& v1, const Vec3& v2,
-                                                 const Ray& ray);
+                                                 const Ray& ray)
+{
+  TriangleHitResult hit;
+  if (!moller_trumbore_test<kCull, common::HitQuery::Closest, T>(v0, v1, v2, ray, hit))
+  {
+    return std::nullopt;
+  }
+  return hit;
+}
+
+/// Any-hit form of `moller_trumbore`: whether it would hit, with the same arithmetic and culling.
+template <common::CullMode kCull = common::CullMode::Back, typename T = double>
+bool moller_trumbore_occluded(const Vec3& v0, const Vec3& v1, const Vec3& v2, const Ray& ray)
+{
+  TriangleHitResult unused;
+  return moller_trumbore_test<kCull, common::HitQuery::Any, T>(v0, v1, v2, ray, unused);
+}
 
+extern template bool
+moller_trumbore_test<common::CullMode::Back, common::HitQuery::Closest, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::Back, common::HitQuery::Any, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::None, common::HitQuery::Closest, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::None, common::HitQuery::Any, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::Back, common::HitQuery::Closest, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::Back, common::HitQuery::Any, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::None, common::HitQuery::Closest, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+extern template bool
+moller_trumbore_test<common::CullMode::None, common::HitQuery::Any, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
 }  // namespace percepto::math::intersection
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/geometry/triangle_block.h"
+
+namespace percepto::math::intersection
+{
+/**
+ * @brief Tests one ray against every lane of a triangle block.
+ *
+ * Runs the same arithmetic as `moller_trumbore`, in the same order, across the lanes with
+ * AVX-512 or AVX2 when `common::active_isa()` allows and with a scalar loop otherwise. Results
+ * are therefore bit-identical to calling `moller_trumbore` on each triangle, on any CPU.
+ *
+ * @tparam kCull  Faces that can be hit, as for `moller_trumbore`; back faces are culled by default.
+ * @param block  Triangles to test.
+ * @param ray    Ray to test; hits must lie in [ray.tMin(), t_max].
+ * @param t_max  Far end of the interval, typically the closest hit found so far.
+ * @param[out] hit  (t, u, v) of the nearest hit lane, written only on a hit.
+ * @return Index of the nearest hit lane (lowest lane on ties), or -1 if no lane was hit.
+ */
+template <common::CullMode kCull = common::CullMode::Back, int W>
+int moller_trumbore_block(const percepto::geometry::TriangleBlock<W>& block,
+                          const percepto::core::Ray& ray, double t_max,
+                          percepto::common::TriangleHitResult& hit);
+
+/**
+ * @brief Any-hit form of `moller_trumbore_block`: whether some lane is hit in [ray.tMin(), t_max].
+ *
+ * Lanes are tested with the same arithmetic, but no hit data is kept, lanes past `block.count`
+ * are skipped and the test stops at the first vector of lanes with a hit.
+ */
+template <common::CullMode kCull = common::CullMode::Back, int W>
+bool moller_trumbore_block_occluded(const percepto::geometry::TriangleBlock<W>& block,
+                                    const percepto::core::Ray& ray, double t_max);
+
+/**
+ * @brief Single-precision form of `moller_trumbore_block`, for `Precision::Single` scenes.
+ *
+ * Rounds the ray once per block (its start moved, in double, to the point nearest
+ * `block.anchor`), then runs the same steps in float: 16 lanes per AVX-512 instruction, 8 per
+ * AVX2 one. Barycentrics may
+ * exceed [0, 1] by 1e-5, so that a ray through an edge shared by two triangles cannot fall
+ * through the gap rounding opens between them; the cost is an equally thin rim around
+ * isolated triangles. Returned (t, u, v) carry float error and are meant to be refined by the
+ * caller when it needs more.
+ */
+template <common::CullMode kCull = common::CullMode::Back, int W>
+int moller_trumbore_block(const percepto::geometry::FloatTriangleBlock<W>& block,
+                          const percepto::core::Ray& ray, double t_max,
+                          percepto::common::TriangleHitResult& hit);
+
+/// Any-hit form of the single-precision block kernel.
+template <common::CullMode kCull = common::CullMode::Back, int W>
+bool moller_trumbore_block_occluded(const percepto::geometry::FloatTriangleBlock<W>& block,
+                                    const percepto::core::Ray& ray, double t_max);
+
+/// Instruction set the block kernels run with: "avx512", "avx2" or "scalar".
+const char* moller_trumbore_block_isa();
+
+extern template int moller_trumbore_block<common::CullMode::Back, 4>(
+    const percepto::geometry::TriangleBlock<4>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::Back, 8>(
+    const percepto::geometry::TriangleBlock<8>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::Back, 16>(
+    const percepto::geometry::TriangleBlock<16>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::None, 4>(
+    const percepto::geometry::TriangleBlock<4>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::None, 8>(
+    const percepto::geometry::TriangleBlock<8>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::None, 16>(
+    const percepto::geometry::TriangleBlock<16>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template bool moller_trumbore_block_occluded<common::CullMode::Back, 4>(
+    const percepto::geometry::TriangleBlock<4>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::Back, 8>(
+    const percepto::geometry::TriangleBlock<8>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::Back, 16>(
+    const percepto::geometry::TriangleBlock<16>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::None, 4>(
+    const percepto::geometry::TriangleBlock<4>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::None, 8>(
+    const percepto::geometry::TriangleBlock<8>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::None, 16>(
+    const percepto::geometry::TriangleBlock<16>&, const percepto::core::Ray&, double);
+extern template int moller_trumbore_block<common::CullMode::Back, 8>(
+    const percepto::geometry::FloatTriangleBlock<8>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::Back, 16>(
+    const percepto::geometry::FloatTriangleBlock<16>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::None, 8>(
+    const percepto::geometry::FloatTriangleBlock<8>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template int moller_trumbore_block<common::CullMode::None, 16>(
+    const percepto::geometry::FloatTriangleBlock<16>&, const percepto::core::Ray&, double,
+    percepto::common::TriangleHitResult&);
+extern template bool moller_trumbore_block_occluded<common::CullMode::Back, 8>(
+    const percepto::geometry::FloatTriangleBlock<8>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::Back, 16>(
+    const percepto::geometry::FloatTriangleBlock<16>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::None, 8>(
+    const percepto::geometry::FloatTriangleBlock<8>&, const percepto::core::Ray&, double);
+extern template bool moller_trumbore_block_occluded<common::CullMode::None, 16>(
+    const percepto::geometry::FloatTriangleBlock<16>&, const percepto::core::Ray&, double);
+}  // namespace percepto::math::intersection
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/geometry/triangle_block.h"
+
+namespace percepto::math::intersection
+{
+/**
+ * @brief Tests one triangle against every active ray of a packet.
+ *
+ * The transpose of `moller_trumbore_block`: the triangle is broadcast and the rays fill the
+ * vector lanes. The packet's shared origin makes half of Möller–Trumbore (s, q and the t
+ * numerator) scalar. Each ray runs the same arithmetic, in the same order, as `moller_trumbore`,
+ * so hit distances are bit-identical to tracing the rays one at a time.
+ *
+ * @tparam kCull  Faces that can be hit, as for `moller_trumbore`; back faces are culled by default.
+ * @param block   Block holding the triangle.
+ * @param lane    Lane of `block` to test; must be below `block.count`.
+ * @param packet  Rays to test.
+ * @param active  Bit mask of the packet lanes to test.
+ * @param t_max   Far end of each ray's interval, typically its closest hit so far.
+ * @param[out] t_hit  Hit distance of each ray in the returned mask; other lanes are clobbered.
+ *                    Like `t_max` it must hold `RayPacket::kMaxSize` entries.
+ * @param[out] u_hit, v_hit  If not null, the barycentrics of each hit, stored like `t_hit`.
+ * @return Bit mask of the active rays that hit the triangle inside [t_min, t_max].
+ */
+template <common::CullMode kCull = common::CullMode::Back, int W>
+uint32_t moller_trumbore_packet(const percepto::geometry::TriangleBlock<W>& block, int lane,
+                                const percepto::core::RayPacket& packet, uint32_t active,
+                                const double* t_max, double* t_hit, double* u_hit = nullptr,
+                                double* v_hit = nullptr);
+
+/// Rays `moller_trumbore_packet` tests per vector instruction with the active instruction set:
+/// 8 (AVX-512), 4 (AVX2) or 1.
+int moller_trumbore_packet_width();
+
+extern template uint32_t moller_trumbore_packet<common::CullMode::Back, 4>(
+    const percepto::geometry::TriangleBlock<4>&, int, const percepto::core::RayPacket&, uint32_t,
+    const double*, double*, double*, double*);
+extern template uint32_t moller_trumbore_packet<common::CullMode::Back, 8>(
+    const percepto::geometry::TriangleBlock<8>&, int, const percepto::core::RayPacket&, uint32_t,
+    const double*, double*, double*, double*);
+extern template uint32_t moller_trumbore_packet<common::CullMode::Back, 16>(
+    const percepto::geometry::TriangleBlock<16>&, int, const percepto::core::RayPacket&, uint32_t,
+    const double*, double*, double*, double*);
+extern template uint32_t moller_trumbore_packet<common::CullMode::None, 4>(
+    const percepto::geometry::TriangleBlock<4>&, int, const percepto::core::RayPacket&, uint32_t,
+    const double*, double*, double*, double*);
+extern template uint32_t moller_trumbore_packet<common::CullMode::None, 8>(
+    const percepto::geometry::TriangleBlock<8>&, int, const percepto::core::RayPacket&, uint32_t,
+    const double*, double*, double*, double*);
+extern template uint32_t moller_trumbore_packet<common::CullMode::None, 16>(
+    const percepto::geometry::TriangleBlock<16>&, int, const percepto::core::RayPacket&, uint32_t,
+    const double*, double*, double*, double*);
+}  // namespace percepto::math::intersection
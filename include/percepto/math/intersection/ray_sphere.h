@@ -0,0 +1,34 @@
+#pragma once
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+
+namespace percepto::math::intersection
+{
+/**
+ * @brief Analytic ray–sphere test, specialized at compile time.
+ *
+ * Solves |o + t·d - centre|² = radius² with the coefficients `computeQuadraticCoefficients`
+ * gives. A sphere is closed, so there are no faces to cull: a ray leaving from inside hits the
+ * far side.
+ *
+ * @tparam kQuery  `HitQuery::Closest` writes the distance of the hit to `t_hit`: the near root,
+ *                 or the far one if the near root lies behind the origin. `HitQuery::Any` only
+ *                 answers whether either root lies in [ray.tMin(), ray.tMax()], rejecting spheres
+ *                 wholly behind the origin before taking the square root.
+ * @tparam T       Scalar type the test runs in (`double` or `float`).
+ */
+template <common::HitQuery kQuery, typename T>
+bool ray_sphere_test(const percepto::core::Vec3& centre, double radius,
+                     const percepto::core::Ray& ray, double& t_hit);
+
+extern template bool ray_sphere_test<common::HitQuery::Closest, double>(
+    const percepto::core::Vec3&, double, const percepto::core::Ray&, double&);
+extern template bool ray_sphere_test<common::HitQuery::Any, double>(
+    const percepto::core::Vec3&, double, const percepto::core::Ray&, double&);
+extern template bool ray_sphere_test<common::HitQuery::Closest, float>(
+    const percepto::core::Vec3&, double, const percepto::core::Ray&, double&);
+extern template bool ray_sphere_test<common::HitQuery::Any, float>(
+    const percepto::core::Vec3&, double, const percepto::core::Ray&, double&);
+}  // namespace percepto::math::intersection
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "percepto/accel/angular_footprint.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+using percepto::core::Vec3, percepto::geometry::AABB;
+
+namespace percepto::accel
+{
+namespace
+{
+constexpr double kTwoPi = 2.0 * M_PI;
+
+// Footprints are widened by this many radians so a ray lying exactly on a footprint edge is not
+// dropped by atan2 rounding.
+constexpr double kAnglePadding = 1e-9;
+}  // namespace
+
+AngularFootprint angular_footprint(const AABB& box, const Vec3& origin)
+{
+  const double x0 = box.min.x - origin.x, x1 = box.max.x - origin.x;
+  const double y0 = box.min.y - origin.y, y1 = box.max.y - origin.y;
+  const double z0 = box.min.z - origin.z, z1 = box.max.z - origin.z;
+
+  // Nearest and farthest horizontal distance from the vertical axis to the box.
+  const double dx = x0 > 0.0 ? x0 : (x1 < 0.0 ? -x1 : 0.0);
+  const double dy = y0 > 0.0 ? y0 : (y1 < 0.0 ? -y1 : 0.0);
+  const double rx = std::max(-x0, x1), ry = std::max(-y0, y1);
+  const double r_min = std::sqrt(dx * dx + dy * dy);
+  const double r_max = std::sqrt(rx * rx + ry * ry);
+
+  // Elevation is highest where z is largest and the horizontal distance smallest (largest when
+  // z is negative), and symmetrically for the lowest.
+  AngularFootprint fp;
+  fp.elevation_hi = std::atan2(z1, z1 >= 0.0 ? r_min : r_max) + kAnglePadding;
+  fp.elevation_lo = std::atan2(z0, z0 >= 0.0 ? r_max : r_min) - kAnglePadding;
+
+  if (x0 <= 0.0 && x1 >= 0.0 && y0 <= 0.0 && y1 >= 0.0)
+  {
+    fp.full_azimuth = true;
+    return fp;
+  }
+
+  // Off the axis the box subtends less than π, so its corners are totally ordered by the sign of
+  // their 2D cross products. Only the two extreme corners then need an atan2.
+  const double xs[4] = {x0, x1, x0, x1};
+  const double ys[4] = {y0, y0, y1, y1};
+  int first = 0, last = 0;
+  for (int k = 1; k < 4; ++k)
+  {
+    if (xs[k] * ys[first] - ys[k] * xs[first] > 0.0) first = k;  // k is clockwise of first.
+    if (xs[last] * ys[k] - ys[last] * xs[k] > 0.0) last = k;     // k is counter-clockwise of last.
+  }
+  fp.azimuth_lo = std::atan2(ys[first], xs[first]) - kAnglePadding;
+  fp.azimuth_hi = std::atan2(ys[last], xs[last]) + kAnglePadding;
+  if (fp.azimuth_hi < fp.azimuth_lo) fp.azimuth_hi += kTwoPi;  // The box straddles the -x axis.
+  return fp;
+}
+
+AngleTable::AngleTable(const std::vector<double>& table) : index_(table.size())
+{
+  std::iota(index_.begin(), index_.end(), 0);
+  std::sort(index_.begin(), index_.end(), [&](int a, int b) { return table[a] < table[b]; });
+  angles_.reserve(table.size());
+  for (const int i : index_) angles_.push_back(table[i]);
+}
+}  // namespace percepto::accel
@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/accel/angular_footprint.h"
+#include "percepto/accel/angular_grid.h"
+#include "percepto/geometry/aabb.h"
+
+using percepto::geometry::AABB;
+
+namespace percepto::accel
+{
+void AngularGrid::clear()
+{
+  layout_ = {};
+  cell_offsets_.clear();
+  prim_indices_.clear();
+}
+
+void AngularGrid::build(const AngularGridLayout& layout, const std::vector<AABB>& prim_bounds)
+{
+  clear();
+  layout_ = layout;
+
+  const AngleTable azimuths(layout_.azimuth_angles);
+  const AngleTable elevations(layout_.elevation_angles);
+  const size_t cell_count = layout_.azimuth_angles.size() * layout_.elevation_angles.size();
+
+  std::vector<AngularFootprint> footprints;
+  footprints.reserve(prim_bounds.size());
+  for (const AABB& box : prim_bounds) footprints.push_back(angular_footprint(box, layout_.origin));
+
+  auto for_each_cell = [&](const AngularFootprint& fp, auto&& fn)
+  {
+    azimuths.for_each_azimuth(fp,
+                              [&](int a)
+                              {
+                                elevations.for_each_elevation(
+                                    fp, [&](int e) { fn(cell_index(a, e)); });
+                              });
+  };
+
+  // Counting pass, then a fill pass in primitive order so every cell lists its ids ascending.
+  // Empty boxes (primitives removed from a dynamic scene) go into no cell.
+  std::vector<size_t> counts(cell_count + 1, 0);
+  for (size_t prim = 0; prim < footprints.size(); ++prim)
+  {
+    if (prim_bounds[prim].empty()) continue;
+    for_each_cell(footprints[prim], [&](size_t cell) { ++counts[cell + 1]; });
+  }
+  std::partial_sum(counts.begin(), counts.end(), counts.begin());
+  if (counts.back() > std::numeric_limits<uint32_t>::max())
+  {
+    throw std::length_error("AngularGrid: too many cell entries");
+  }
+
+  cell_offsets_.assign(counts.begin(), counts.end());
+  prim_indices_.resize(counts.back());
+  for (size_t prim = 0; prim < footprints.size(); ++prim)
+  {
+    if (prim_bounds[prim].empty()) continue;
+    const auto id = static_cast<uint32_t>(prim);
+    for_each_cell(footprints[prim], [&](size_t cell) { prim_indices_[counts[cell]++] = id; });
+  }
+}
+
+size_t AngularGrid::memory_bytes() const
+{
+  return cell_offsets_.capacity() * sizeof(uint32_t) +
+         prim_indices_.capacity() * sizeof(uint32_t) +
+         (layout_.azimuth_angles.capacity() + layout_.elevation_angles.capacity()) *
+             sizeof(double);
+}
+}  // namespace percepto::accel
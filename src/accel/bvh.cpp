@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/lbvh.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+using percepto::core::Vec3, percepto::geometry::AABB;
+
+namespace percepto::accel
+{
+namespace
+{
+// Beyond this depth the builder stops evaluating the SAH and splits at the object median, which
+// bounds the remaining depth by log2(count) and keeps traversal inside its fixed-size stack.
+constexpr int kSahDepthLimit = 64;
+
+struct Bin
+{
+  AABB bounds;
+  uint32_t count = 0;
+};
+
+double component(const Vec3& v, int axis)
+{
+  return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+}  // namespace
+
+void Bvh::clear()
+{
+  nodes_.clear();
+  prim_indices_.clear();
+  parents_.clear();
+}
+
+void Bvh::assign(std::vector<BvhNode> nodes, std::vector<uint32_t> prim_indices)
+{
+  nodes_ = std::move(nodes);
+  prim_indices_ = std::move(prim_indices);
+  parents_.clear();
+}
+
+bool Bvh::valid_layout(const BvhNode* nodes, size_t node_count, const uint32_t* prim_indices,
+                       size_t prim_count, size_t primitive_count)
+{
+  if ((node_count == 0) != (prim_count == 0) || prim_count != primitive_count) return false;
+  for (size_t i = 0; i < prim_count; ++i)
+  {
+    if (prim_indices[i] >= primitive_count) return false;
+  }
+
+  // Children come after their parent, so one pass in index order reaches every parent before
+  // its children and gives each node its depth. A node reached twice, or never, is not part of
+  // a tree; a shared subtree would also make the walk below exponential.
+  std::vector<int> depth(node_count, 0);
+  if (node_count > 0) depth[0] = 1;
+  for (size_t n = 0; n < node_count; ++n)
+  {
+    const BvhNode& node = nodes[n];
+    if (depth[n] == 0) return false;
+    if (node.is_leaf())
+    {
+      if (uint64_t(node.offset) + node.count > prim_count) return false;
+      continue;
+    }
+    if (!(node.offset > n + 1 && node.offset < node_count) || depth[n] == kMaxDepth) return false;
+    for (const size_t child : {n + 1, size_t(node.offset)})
+    {
+      if (depth[child] != 0) return false;
+      depth[child] = depth[n] + 1;
+    }
+  }
+  return true;
+}
+
+void Bvh::build(const std::vector<AABB>& prim_bounds, const BvhBuildOptions& options)
+{
+  clear();
+  if (prim_bounds.empty()) return;
+
+  options_ = options;
+  options_.bin_count = std::max(2, options_.bin_count);
+  options_.max_leaf_size = std::max(1, options_.max_leaf_size);
+
+  if (options_.builder == common::BvhBuilder::Lbvh)
+  {
+    build_lbvh(prim_bounds, options_, nodes_, prim_indices_);
+    if (depth() < kMaxDepth) return;
+    clear();
+  }
+
+  prim_bounds_ = &prim_bounds;
+  centroids_.resize(prim_bounds.size());
+  for (size_t i = 0; i < prim_bounds.size(); ++i)
+  {
+    centroids_[i] = prim_bounds[i].centroid();
+  }
+
+  prim_indices_.resize(prim_bounds.size());
+  std::iota(prim_indices_.begin(), prim_indices_.end(), 0u);
+
+  // A binary tree over n leaves has at most 2n - 1 nodes.
+  nodes_.reserve(2 * prim_bounds.size() - 1);
+  build_recursive(0, static_cast<uint32_t>(prim_bounds.size()), 0);
+  nodes_.shrink_to_fit();
+
+  prim_bounds_ = nullptr;
+  centroids_.clear();
+  centroids_.shrink_to_fit();
+}
+
+uint32_t Bvh::build_recursive(uint32_t first, uint32_t count, int depth)
+{
+  const auto& bounds = *prim_bounds_;
+
+  const uint32_t node_index = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+
+  AABB node_bounds, centroid_bounds;
+  for (uint32_t i = first; i < first + count; ++i)
+  {
+    node_bounds.expand(bounds[prim_indices_[i]]);
+    centroid_bounds.expand(centroids_[prim_indices_[i]]);
+  }
+  nodes_[node_index].bounds = node_bounds;
+
+  auto make_leaf = [&]
+  {
+    nodes_[node_index].offset = first;
+    nodes_[node_index].count = count;
+    return node_index;
+  };
+
+  if (count == 1) return make_leaf();
+
+  uint32_t mid = first;
+  const Vec3 centroid_extent = centroid_bounds.extent();
+  const bool degenerate = centroid_extent.x <= 0.0 && centroid_extent.y <= 0.0 &&
+                          centroid_extent.z <= 0.0;
+
+  if (degenerate)
+  {
+    // Every centroid coincides: no spatial split can separate them.
+    if (count <= static_cast<uint32_t>(options_.max_leaf_size)) return make_leaf();
+    mid = first + count / 2;
+  }
+  else if (depth >= kSahDepthLimit)
+  {
+    if (count <= static_cast<uint32_t>(options_.max_leaf_size)) return make_leaf();
+    mid = split_median(first, count, centroid_bounds);
+  }
+  else
+  {
+    const int bin_count = options_.bin_count;
+    std::vector<Bin> bins(bin_count);
+    std::vector<double> right_cost(bin_count);
+
+    double best_cost = std::numeric_limits<double>::infinity();
+    int best_axis = -1;
+    int best_split = -1;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const double lo = component(centroid_bounds.min, axis);
+      const double extent = component(centroid_extent, axis);
+      if (extent <= 0.0) continue;
+
+      const double scale = bin_count * (1.0 - 1e-9) / extent;
+      std::fill(bins.begin(), bins.end(), Bin{});
+      for (uint32_t i = first; i < first + count; ++i)
+      {
+        const uint32_t prim = prim_indices_[i];
+        int b = static_cast<int>((component(centroids_[prim], axis) - lo) * scale);
+        b = std::clamp(b, 0, bin_count - 1);
+        bins[b].count++;
+        bins[b].bounds.expand(bounds[prim]);
+      }
+
+      // Sweep right-to-left to accumulate the right partition costs, then left-to-right to
+      // evaluate every split plane between bins.
+      AABB acc;
+      uint32_t acc_count = 0;
+      for (int b = bin_count - 1; b > 0; --b)
+      {
+        acc.expand(bins[b].bounds);
+        acc_count += bins[b].count;
+        right_cost[b] = acc.surface_area() * acc_count;
+      }
+
+      acc = AABB{};
+      acc_count = 0;
+      for (int b = 0; b < bin_count - 1; ++b)
+      {
+        acc.expand(bins[b].bounds);
+        acc_count += bins[b].count;
+        const double cost = acc.surface_area() * acc_count + right_cost[b + 1];
+        if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_axis = axis;
+          best_split = b;
+        }
+      }
+    }
+
+    const double parent_area = node_bounds.surface_area();
+    const double split_cost =
+        options_.traversal_cost +
+        options_.intersection_cost * (parent_area > 0.0 ? best_cost / parent_area : count);
+    const double leaf_cost = options_.intersection_cost * count;
+
+    if (count <= static_cast<uint32_t>(options_.max_leaf_size) && leaf_cost <= split_cost)
+    {
+      return make_leaf();
+    }
+
+    const double lo = component(centroid_bounds.min, best_axis);
+    const double scale = bin_count * (1.0 - 1e-9) / component(centroid_extent, best_axis);
+    auto* split = std::partition(prim_indices_.data() + first, prim_indices_.data() + first + count,
+                                 [&](uint32_t prim)
+                                 {
+                                   int b = static_cast<int>(
+                                       (component(centroids_[prim], best_axis) - lo) * scale);
+                                   return std::clamp(b, 0, bin_count - 1) <= best_split;
+                                 });
+    mid = static_cast<uint32_t>(split - prim_indices_.data());
+
+    if (mid == first || mid == first + count)
+    {
+      mid = split_median(first, count, centroid_bounds);
+    }
+  }
+
+  build_recursive(first, mid - first, depth + 1);
+  const uint32_t right = build_recursive(mid, first + count - mid, depth + 1);
+  nodes_[node_index].offset = right;
+  return node_index;
+}
+
+uint32_t Bvh::split_median(uint32_t first, uint32_t count, const AABB& centroid_bounds)
+{
+  const int axis = centroid_bounds.largest_axis();
+  const uint32_t mid = first + count / 2;
+  std::nth_element(prim_indices_.begin() + first, prim_indices_.begin() + mid,
+                   prim_indices_.begin() + first + count,
+                   [&](uint32_t a, uint32_t b)
+                   { return component(centroids_[a], axis) < component(centroids_[b], axis); });
+  return mid;
+}
+
+int Bvh::depth() const
+{
+  if (nodes_.empty()) return 0;
+
+  int max_depth = 0;
+  std::vector<std::pair<uint32_t, int>> stack{{0u, 1}};
+  while (!stack.empty())
+  {
+    auto [index, d] = stack.back();
+    stack.pop_back();
+    max_depth = std::max(max_depth, d);
+    const BvhNode& node = nodes_[index];
+    if (!node.is_leaf())
+    {
+      stack.emplace_back(index + 1, d + 1);
+      stack.emplace_back(node.offset, d + 1);
+    }
+  }
+  return max_depth;
+}
+
+void Bvh::ensure_parents()
+{
+  if (parents_.size() == nodes_.size()) return;
+  parents_.assign(nodes_.size(), 0);
+  for (uint32_t n = 0; n < nodes_.size(); ++n)
+  {
+    if (nodes_[n].is_leaf()) continue;
+    parents_[n + 1] = n;
+    parents_[nodes_[n].offset] = n;
+  }
+}
+
+double Bvh::sah_area() const
+{
+  double cost = 0.0;
+  for (const BvhNode& node : nodes_)
+  {
+    cost += node.bounds.surface_area() * (node.is_leaf() ? static_cast<double>(node.count) : 1.0);
+  }
+  return cost;
+}
+
+uint32_t Bvh::common_ancestor(uint32_t a, uint32_t b)
+{
+  ensure_parents();
+  auto depth_of = [&](uint32_t n)
+  {
+    int d = 0;
+    for (; n != 0; n = parents_[n]) ++d;
+    return d;
+  };
+  int da = depth_of(a), db = depth_of(b);
+  for (; da > db; --da) a = parents_[a];
+  for (; db > da; --db) b = parents_[b];
+  while (a != b)
+  {
+    a = parents_[a];
+    b = parents_[b];
+  }
+  return a;
+}
+
+uint32_t Bvh::subtree_end(uint32_t node) const
+{
+  // The right spine ends at the subtree's last node in depth-first order.
+  while (!nodes_[node].is_leaf()) node = nodes_[node].offset;
+  return node + 1;
+}
+
+std::pair<uint32_t, uint32_t> Bvh::subtree_prims(uint32_t node) const
+{
+  // Both builders emit leaves depth-first and append their primitives as they go, so a subtree's
+  // primitives run from its leftmost leaf to the end of its rightmost one.
+  uint32_t first = node;
+  while (!nodes_[first].is_leaf()) ++first;
+  const BvhNode& last = nodes_[subtree_end(node) - 1];
+  return {nodes_[first].offset, last.offset + last.count - nodes_[first].offset};
+}
+
+bool Bvh::rebuild_subtree(uint32_t node, const std::vector<AABB>& prim_bounds,
+                          const BvhBuildOptions& options)
+{
+  const auto [first, count] = subtree_prims(node);
+  Bvh subtree;
+  subtree.build(prim_bounds, options);
+
+  ensure_parents();
+  int node_depth = 1;
+  for (uint32_t n = node; n != 0; n = parents_[n]) ++node_depth;
+  if (node_depth - 1 + subtree.depth() >= kMaxDepth) return false;
+
+  // The subtree was built over positions in the run; map them back to primitive ids.
+  const std::vector<uint32_t> run(prim_indices_.begin() + first,
+                                  prim_indices_.begin() + first + count);
+  for (uint32_t i = 0; i < count; ++i) prim_indices_[first + i] = run[subtree.prim_indices_[i]];
+
+  const uint32_t old_end = subtree_end(node);
+  const auto new_size = static_cast<uint32_t>(subtree.nodes_.size());
+  for (BvhNode& n : subtree.nodes_) n.offset += n.is_leaf() ? first : node;
+
+  // Every right-child link past the old subtree moves with the nodes behind it.
+  for (BvhNode& n : nodes_)
+  {
+    if (!n.is_leaf() && n.offset >= old_end) n.offset = n.offset - old_end + node + new_size;
+  }
+  nodes_.erase(nodes_.begin() + node, nodes_.begin() + old_end);
+  nodes_.insert(nodes_.begin() + node, subtree.nodes_.begin(), subtree.nodes_.end());
+  parents_.clear();
+  return true;
+}
+
+void Bvh::remap_primitives(const std::vector<uint32_t>& ids)
+{
+  for (uint32_t& prim : prim_indices_) prim = ids[prim];
+}
+}  // namespace percepto::accel
@@ -0,0 +1,84 @@
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/motion_bvh.h"
+#include "percepto/geometry/aabb.h"
+
+using percepto::geometry::AABB;
+
+namespace percepto::accel
+{
+namespace
+{
+// Blended boxes are computed in a different order than the blended geometry they enclose, so
+// each may come out an ulp or two tighter; pad the leaves so every hit stays inside.
+AABB padded(AABB box)
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const double pad = 1e-12 * (std::abs(box.min[axis]) + std::abs(box.max[axis]));
+    box.min[axis] -= pad;
+    box.max[axis] += pad;
+  }
+  return box;
+}
+}  // namespace
+
+void MotionBvh::build(const std::vector<AABB>& start_bounds, const std::vector<AABB>& end_bounds,
+                      const BvhBuildOptions& options)
+{
+  if (start_bounds.size() != end_bounds.size())
+  {
+    throw std::invalid_argument("MotionBvh: start and end bounds differ in count");
+  }
+  clear();
+
+  std::vector<AABB> swept(start_bounds);
+  for (size_t i = 0; i < swept.size(); ++i) swept[i].expand(end_bounds[i]);
+  tree_.build(swept, options);
+
+  // Children follow their parent, so a backward pass sees both before the parent.
+  const auto& nodes = tree_.nodes();
+  start_.resize(nodes.size());
+  end_.resize(nodes.size());
+  for (size_t n = nodes.size(); n-- > 0;)
+  {
+    AABB start, end;
+    if (nodes[n].is_leaf())
+    {
+      for (uint32_t i = nodes[n].offset; i < nodes[n].offset + nodes[n].count; ++i)
+      {
+        start.expand(start_bounds[tree_.prim_indices()[i]]);
+        end.expand(end_bounds[tree_.prim_indices()[i]]);
+      }
+      start = padded(start);
+      end = padded(end);
+    }
+    else
+    {
+      start = start_[n + 1];
+      start.expand(start_[nodes[n].offset]);
+      end = end_[n + 1];
+      end.expand(end_[nodes[n].offset]);
+    }
+    start_[n] = start;
+    end_[n] = end;
+  }
+}
+
+void MotionBvh::clear()
+{
+  tree_.clear();
+  start_.clear();
+  end_.clear();
+}
+
+size_t MotionBvh::memory_bytes() const noexcept
+{
+  return tree_.nodes().size() * sizeof(BvhNode) + tree_.prim_indices().size() * sizeof(uint32_t) +
+         (start_.capacity() + end_.capacity()) * sizeof(AABB);
+}
+}  // namespace percepto::accel
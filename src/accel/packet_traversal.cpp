@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "percepto/accel/packet_traversal.h"
+#include "percepto/common/cpu_features.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+using percepto::common::Isa, percepto::core::RayPacket, percepto::core::Vec3,
+    percepto::geometry::AABB;
+
+namespace percepto::accel
+{
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Scalar reference for one ray; mirrors AABB::intersect operation for operation.
+inline bool test_ray_scalar(const AABB& box, const RayPacket& p, int i, double t_max)
+{
+  double t_entry;
+  return box.intersect(p.origin, Vec3(p.inv_x[i], p.inv_y[i], p.inv_z[i]), p.t_min[i], t_max,
+                       t_entry);
+}
+
+#if PERCEPTO_X86_SIMD
+// Tests rays [base, base + 8). As in the wide BVH kernel, the min/max operand order makes a NaN
+// slab distance leave the interval untouched, like the scalar comparisons.
+PERCEPTO_TARGET_AVX512 inline uint32_t test_rays_avx512(const AABB& box, const RayPacket& p,
+                                                        int base, const double* t_max)
+{
+  __m512d entry = _mm512_loadu_pd(p.t_min + base);
+  __m512d exit = _mm512_loadu_pd(t_max + base);
+
+  auto slab = [&](double lo, double hi, double origin, const double* inv) PERCEPTO_TARGET_AVX512
+  {
+    const __m512d id = _mm512_loadu_pd(inv + base);
+    const __m512d t0 = _mm512_mul_pd(_mm512_set1_pd(lo - origin), id);
+    const __m512d t1 = _mm512_mul_pd(_mm512_set1_pd(hi - origin), id);
+    entry = _mm512_max_pd(_mm512_min_pd(t1, t0), entry);
+    exit = _mm512_min_pd(_mm512_max_pd(t0, t1), exit);
+  };
+  slab(box.min.x, box.max.x, p.origin.x, p.inv_x);
+  slab(box.min.y, box.max.y, p.origin.y, p.inv_y);
+  slab(box.min.z, box.max.z, p.origin.z, p.inv_z);
+
+  return static_cast<uint32_t>(_mm512_cmp_pd_mask(entry, exit, _CMP_LE_OQ)) << base;
+}
+
+// Tests rays [base, base + 4).
+PERCEPTO_TARGET_AVX2 inline uint32_t test_rays_avx2(const AABB& box, const RayPacket& p,
+                                                    int base, const double* t_max)
+{
+  __m256d entry = _mm256_loadu_pd(p.t_min + base);
+  __m256d exit = _mm256_loadu_pd(t_max + base);
+
+  auto slab = [&](double lo, double hi, double origin, const double* inv) PERCEPTO_TARGET_AVX2
+  {
+    const __m256d id = _mm256_loadu_pd(inv + base);
+    const __m256d t0 = _mm256_mul_pd(_mm256_set1_pd(lo - origin), id);
+    const __m256d t1 = _mm256_mul_pd(_mm256_set1_pd(hi - origin), id);
+    entry = _mm256_max_pd(_mm256_min_pd(t1, t0), entry);
+    exit = _mm256_min_pd(_mm256_max_pd(t0, t1), exit);
+  };
+  slab(box.min.x, box.max.x, p.origin.x, p.inv_x);
+  slab(box.min.y, box.max.y, p.origin.y, p.inv_y);
+  slab(box.min.z, box.max.z, p.origin.z, p.inv_z);
+
+  return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(entry, exit, _CMP_LE_OQ)))
+         << base;
+}
+#endif
+
+// Range of (lo - o) * inv and (hi - o) * inv over inv in [inv_min, inv_max]. Multiplying by a
+// fixed factor is monotonic even after rounding, so the endpoints bound every ray in between.
+// Returns false if the bound is undefined (0 * inf), leaving the axis unconstrained.
+inline bool slab_bounds(double lo, double hi, double o, double inv_min, double inv_max,
+                        double& near, double& far)
+{
+  const double a = (lo - o) * inv_min, b = (lo - o) * inv_max;
+  const double c = (hi - o) * inv_min, d = (hi - o) * inv_max;
+  if (std::isnan(a) || std::isnan(b) || std::isnan(c) || std::isnan(d)) return false;
+  near = std::min(std::min(a, b), std::min(c, d));
+  far = std::max(std::max(a, b), std::max(c, d));
+  return true;
+}
+
+// intersect_packet_box in the form common::dispatch_isa runs.
+struct PacketBoxKernel
+{
+  template <Isa kIsa>
+  static uint32_t run(const AABB& box, const RayPacket& packet, uint32_t active,
+                      const double* t_max)
+  {
+    uint32_t hits = 0;
+    int base = 0;
+    const int end = packet.count;
+#if PERCEPTO_X86_SIMD
+    if constexpr (kIsa == Isa::Avx512)
+    {
+      for (; base < end; base += 8)
+      {
+        if ((active >> base) & 0xFFu) hits |= test_rays_avx512(box, packet, base, t_max);
+      }
+    }
+    else if constexpr (kIsa == Isa::Avx2)
+    {
+      for (; base < end; base += 4)
+      {
+        if ((active >> base) & 0xFu) hits |= test_rays_avx2(box, packet, base, t_max);
+      }
+    }
+#endif
+    for (; base < end; ++base)
+    {
+      if ((active >> base) & 1u && test_ray_scalar(box, packet, base, t_max[base]))
+      {
+        hits |= 1u << base;
+      }
+    }
+    return hits & active;
+  }
+};
+}  // namespace
+
+PacketFrustum::PacketFrustum(const RayPacket& packet, uint32_t active, const double* t_max)
+    : origin_(packet.origin),
+      inv_min_(kInf, kInf, kInf),
+      inv_max_(-kInf, -kInf, -kInf),
+      t_min_(kInf),
+      t_max_(-kInf)
+{
+  for (uint32_t mask = active; mask; mask &= mask - 1)
+  {
+    const int i = __builtin_ctz(mask);
+    inv_min_ = {std::min(inv_min_.x, packet.inv_x[i]), std::min(inv_min_.y, packet.inv_y[i]),
+                std::min(inv_min_.z, packet.inv_z[i])};
+    inv_max_ = {std::max(inv_max_.x, packet.inv_x[i]), std::max(inv_max_.y, packet.inv_y[i]),
+                std::max(inv_max_.z, packet.inv_z[i])};
+    t_min_ = std::min(t_min_, packet.t_min[i]);
+    t_max_ = std::max(t_max_, t_max[i]);
+  }
+}
+
+bool PacketFrustum::may_hit(const AABB& box) const
+{
+  // Every ray enters no earlier than `entry` and leaves no later than `exit`.
+  double entry = t_min_, exit = t_max_;
+  double near, far;
+  if (slab_bounds(box.min.x, box.max.x, origin_.x, inv_min_.x, inv_max_.x, near, far))
+  {
+    entry = std::max(entry, near);
+    exit = std::min(exit, far);
+  }
+  if (slab_bounds(box.min.y, box.max.y, origin_.y, inv_min_.y, inv_max_.y, near, far))
+  {
+    entry = std::max(entry, near);
+    exit = std::min(exit, far);
+  }
+  if (slab_bounds(box.min.z, box.max.z, origin_.z, inv_min_.z, inv_max_.z, near, far))
+  {
+    entry = std::max(entry, near);
+    exit = std::min(exit, far);
+  }
+  return entry <= exit;
+}
+
+uint32_t intersect_packet_box(const AABB& box, const RayPacket& packet, uint32_t active,
+                              const double* t_max)
+{
+  return common::dispatch_isa<PacketBoxKernel>(box, packet, active, t_max);
+}
+}  // namespace percepto::accel
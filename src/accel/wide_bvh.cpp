@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/wide_bvh.h"
+#include "percepto/common/cpu_features.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+
+using percepto::common::Isa, percepto::core::Vec3, percepto::geometry::AABB;
+
+namespace percepto::accel
+{
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Float boxes grow by this fraction of the root box's radius: 64 float ulps of it, several
+// times the error of rounding a ray origin inside the root box and slab-testing in float.
+constexpr double kFloatPadding = 0x1p-17;
+
+// Scalar reference for one child; mirrors AABB::intersect operation for operation.
+template <int W, typename T>
+inline bool test_child_scalar(const WideBvhNode<W, T>& n, int c, const Vec3& o, const Vec3& inv,
+                              double t_min, double t_max, T& t_entry)
+{
+  const T lo[3] = {n.min_x[c], n.min_y[c], n.min_z[c]};
+  const T hi[3] = {n.max_x[c], n.max_y[c], n.max_z[c]};
+  const T org[3] = {static_cast<T>(o.x), static_cast<T>(o.y), static_cast<T>(o.z)};
+  const T inv_d[3] = {static_cast<T>(inv.x), static_cast<T>(inv.y), static_cast<T>(inv.z)};
+  T near = static_cast<T>(t_min), far = static_cast<T>(t_max);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    T t0 = (lo[axis] - org[axis]) * inv_d[axis];
+    T t1 = (hi[axis] - org[axis]) * inv_d[axis];
+    if (t0 > t1) std::swap(t0, t1);
+    if (t0 > near) near = t0;
+    if (t1 < far) far = t1;
+    if (near > far) return false;
+  }
+  t_entry = near;
+  return true;
+}
+
+#if PERCEPTO_X86_SIMD
+// Tests children [base, base + 4). The operand order of min/max is chosen so that a NaN slab
+// distance (0 * inf) leaves the interval untouched, exactly as the scalar comparisons do:
+// _mm256_min_pd/_mm256_max_pd return their second operand when either one is NaN.
+template <int W>
+PERCEPTO_TARGET_AVX2 inline uint32_t test_children_avx2(const WideBvhNode<W>& n, int base,
+                                                        const Vec3& o, const Vec3& inv,
+                                                        double t_min, double t_max,
+                                                        double* t_entry)
+{
+  __m256d entry = _mm256_set1_pd(t_min);
+  __m256d exit = _mm256_set1_pd(t_max);
+
+  auto slab = [&](const double* lo, const double* hi, double origin,
+                  double inv_d) PERCEPTO_TARGET_AVX2
+  {
+    const __m256d org = _mm256_set1_pd(origin), id = _mm256_set1_pd(inv_d);
+    const __m256d t0 = _mm256_mul_pd(_mm256_sub_pd(_mm256_load_pd(lo + base), org), id);
+    const __m256d t1 = _mm256_mul_pd(_mm256_sub_pd(_mm256_load_pd(hi + base), org), id);
+    entry = _mm256_max_pd(_mm256_min_pd(t1, t0), entry);  // near = t0 > t1 ? t1 : t0
+    exit = _mm256_min_pd(_mm256_max_pd(t0, t1), exit);    // far  = t0 > t1 ? t0 : t1
+  };
+  slab(n.min_x, n.max_x, o.x, inv.x);
+  slab(n.min_y, n.max_y, o.y, inv.y);
+  slab(n.min_z, n.max_z, o.z, inv.z);
+
+  _mm256_store_pd(t_entry + base, entry);
+  return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(entry, exit, _CMP_LE_OQ)))
+         << base;
+}
+
+PERCEPTO_TARGET_AVX512 inline uint32_t test_children_avx512(const WideBvhNode<8>& n,
+                                                            const Vec3& o, const Vec3& inv,
+                                                            double t_min, double t_max,
+                                                            double* t_entry)
+{
+  __m512d entry = _mm512_set1_pd(t_min);
+  __m512d exit = _mm512_set1_pd(t_max);
+
+  auto slab = [&](const double* lo, const double* hi, double origin,
+                  double inv_d) PERCEPTO_TARGET_AVX512
+  {
+    const __m512d org = _mm512_set1_pd(origin), id = _mm512_set1_pd(inv_d);
+    const __m512d t0 = _mm512_mul_pd(_mm512_sub_pd(_mm512_load_pd(lo), org), id);
+    const __m512d t1 = _mm512_mul_pd(_mm512_sub_pd(_mm512_load_pd(hi), org), id);
+    entry = _mm512_max_pd(_mm512_min_pd(t1, t0), entry);
+    exit = _mm512_min_pd(_mm512_max_pd(t0, t1), exit);
+  };
+  slab(n.min_x, n.max_x, o.x, inv.x);
+  slab(n.min_y, n.max_y, o.y, inv.y);
+  slab(n.min_z, n.max_z, o.z, inv.z);
+
+  _mm512_store_pd(t_entry, entry);
+  return _mm512_cmp_pd_mask(entry, exit, _CMP_LE_OQ);
+}
+
+// Float nodes: all four children in one SSE vector, or all eight in one AVX one, with the same
+// operand order as the double tests.
+PERCEPTO_TARGET_AVX2 inline uint32_t test_children_float(const WideBvhNode<4, float>& n,
+                                                         const Vec3& o, const Vec3& inv,
+                                                         double t_min, double t_max,
+                                                         float* t_entry)
+{
+  __m128 entry = _mm_set1_ps(static_cast<float>(t_min));
+  __m128 exit = _mm_set1_ps(static_cast<float>(t_max));
+
+  auto slab = [&](const float* lo, const float* hi, double origin,
+                  double inv_d) PERCEPTO_TARGET_AVX2
+  {
+    const __m128 org = _mm_set1_ps(static_cast<float>(origin));
+    const __m128 id = _mm_set1_ps(static_cast<float>(inv_d));
+    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(lo), org), id);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(hi), org), id);
+    entry = _mm_max_ps(_mm_min_ps(t1, t0), entry);
+    exit = _mm_min_ps(_mm_max_ps(t0, t1), exit);
+  };
+  slab(n.min_x, n.max_x, o.x, inv.x);
+  slab(n.min_y, n.max_y, o.y, inv.y);
+  slab(n.min_z, n.max_z, o.z, inv.z);
+
+  _mm_store_ps(t_entry, entry);
+  return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(entry, exit)));
+}
+
+PERCEPTO_TARGET_AVX2 inline uint32_t test_children_float(const WideBvhNode<8, float>& n,
+                                                         const Vec3& o, const Vec3& inv,
+                                                         double t_min, double t_max,
+                                                         float* t_entry)
+{
+  __m256 entry = _mm256_set1_ps(static_cast<float>(t_min));
+  __m256 exit = _mm256_set1_ps(static_cast<float>(t_max));
+
+  auto slab = [&](const float* lo, const float* hi, double origin,
+                  double inv_d) PERCEPTO_TARGET_AVX2
+  {
+    const __m256 org = _mm256_set1_ps(static_cast<float>(origin));
+    const __m256 id = _mm256_set1_ps(static_cast<float>(inv_d));
+    const __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(lo), org), id);
+    const __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(hi), org), id);
+    entry = _mm256_max_ps(_mm256_min_ps(t1, t0), entry);
+    exit = _mm256_min_ps(_mm256_max_ps(t0, t1), exit);
+  };
+  slab(n.min_x, n.max_x, o.x, inv.x);
+  slab(n.min_y, n.max_y, o.y, inv.y);
+  slab(n.min_z, n.max_z, o.z, inv.z);
+
+  _mm256_store_ps(t_entry, entry);
+  return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ)));
+}
+#endif
+
+// Rounds a double to the float at or below (above) it, and one step further, so that a float box
+// still contains the double one whatever the rounding mode did.
+inline float round_down(double v)
+{
+  return std::nextafter(static_cast<float>(v), -std::numeric_limits<float>::infinity());
+}
+inline float round_up(double v)
+{
+  return std::nextafter(static_cast<float>(v), std::numeric_limits<float>::infinity());
+}
+
+// intersect_children in the form common::dispatch_isa runs.
+template <int W, typename T>
+struct ChildrenKernel
+{
+  template <Isa kIsa>
+  static uint32_t run(const WideBvhNode<W, T>& node, const Vec3& origin, const Vec3& inv_dir,
+                      double t_min, double t_max, T* t_entry)
+  {
+    // Unused slots hold empty boxes, which a slab test does not reject on its own.
+    const uint32_t used = (1u << node.child_count) - 1;
+
+#if PERCEPTO_X86_SIMD
+    if constexpr (kIsa != Isa::Scalar)
+    {
+      if constexpr (std::is_same_v<T, float>)
+      {
+        return test_children_float(node, origin, inv_dir, t_min, t_max, t_entry) & used;
+      }
+      else if constexpr (kIsa == Isa::Avx512 && W == 8)
+      {
+        return test_children_avx512(node, origin, inv_dir, t_min, t_max, t_entry) & used;
+      }
+      else
+      {
+        uint32_t mask = 0;
+        for (int base = 0; base < W; base += 4)
+        {
+          mask |= test_children_avx2(node, base, origin, inv_dir, t_min, t_max, t_entry);
+        }
+        return mask & used;
+      }
+    }
+#endif
+    uint32_t mask = 0;
+    for (uint32_t c = 0; c < node.child_count; ++c)
+    {
+      if (test_child_scalar(node, c, origin, inv_dir, t_min, t_max, t_entry[c])) mask |= 1u << c;
+    }
+    return mask;
+  }
+};
+}  // namespace
+
+template <int W, typename T>
+uint32_t intersect_children(const WideBvhNode<W, T>& node, const Vec3& origin,
+                            const Vec3& inv_dir, double t_min, double t_max, T* t_entry)
+{
+  return common::dispatch_isa<ChildrenKernel<W, T>>(node, origin, inv_dir, t_min, t_max,
+                                                    t_entry);
+}
+
+template <int W, typename T>
+void WideBvh<W, T>::build(const Bvh& binary)
+{
+  nodes_.clear();
+  slots_.assign(binary.nodes().size(), kNoSlot);
+  if (binary.empty()) return;
+  if constexpr (std::is_same_v<T, float>)
+  {
+    const AABB& root = binary.nodes()[0].bounds;
+    center_ = (root.min + root.max) * 0.5;
+    padding_ = 0.5 * root.extent().length() * kFloatPadding;
+  }
+  collapse(binary, 0);
+}
+
+template <int W, typename T>
+void WideBvh<W, T>::refit(const Bvh& binary, const std::vector<uint32_t>& changed)
+{
+  for (uint32_t n : changed)
+  {
+    if (slots_[n] != kNoSlot) set_child_bounds(slots_[n], binary.nodes()[n].bounds);
+  }
+}
+
+template <int W, typename T>
+void WideBvh<W, T>::set_child_bounds(uint32_t slot, const AABB& box)
+{
+  Node& node = nodes_[slot / W];
+  const uint32_t c = slot % W;
+  if constexpr (std::is_same_v<T, float>)
+  {
+    const Vec3 lo = box.min - center_, hi = box.max - center_;
+    node.min_x[c] = round_down(lo.x - padding_);
+    node.min_y[c] = round_down(lo.y - padding_);
+    node.min_z[c] = round_down(lo.z - padding_);
+    node.max_x[c] = round_up(hi.x + padding_);
+    node.max_y[c] = round_up(hi.y + padding_);
+    node.max_z[c] = round_up(hi.z + padding_);
+  }
+  else
+  {
+    node.min_x[c] = box.min.x;
+    node.min_y[c] = box.min.y;
+    node.min_z[c] = box.min.z;
+    node.max_x[c] = box.max.x;
+    node.max_y[c] = box.max.y;
+    node.max_z[c] = box.max.z;
+  }
+}
+
+template <int W, typename T>
+uint32_t WideBvh<W, T>::collapse(const Bvh& binary, uint32_t binary_index)
+{
+  const auto& bin = binary.nodes();
+  const auto node_index = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+
+  // Open the binary subtree until W children are gathered, always splitting the interior child
+  // with the largest surface area: it is the one most rays would otherwise descend into.
+  uint32_t kids[W];
+  int count = 0;
+  if (bin[binary_index].is_leaf())
+  {
+    kids[count++] = binary_index;  // A single-leaf tree: the root node holds just that leaf.
+  }
+  else
+  {
+    kids[count++] = binary_index + 1;
+    kids[count++] = bin[binary_index].offset;
+  }
+  while (count < W)
+  {
+    int best = -1;
+    double best_area = -1.0;
+    for (int c = 0; c < count; ++c)
+    {
+      const BvhNode& kid = bin[kids[c]];
+      if (!kid.is_leaf() && kid.bounds.surface_area() > best_area)
+      {
+        best = c;
+        best_area = kid.bounds.surface_area();
+      }
+    }
+    if (best < 0) break;
+    const uint32_t opened = kids[best];
+    kids[best] = opened + 1;
+    kids[count++] = bin[opened].offset;
+  }
+
+  // Children go in binary depth-first order, which keeps the collapsed layout depth-first too.
+  std::sort(kids, kids + count);
+
+  uint32_t refs[W];
+  for (int c = 0; c < count; ++c)
+  {
+    refs[c] = bin[kids[c]].is_leaf() ? (kids[c] | Node::kLeafBit) : collapse(binary, kids[c]);
+  }
+
+  Node& node = nodes_[node_index];
+  node.child_count = static_cast<uint32_t>(count);
+  for (int c = 0; c < W; ++c)
+  {
+    const uint32_t slot = node_index * W + c;
+    set_child_bounds(slot, c < count ? bin[kids[c]].bounds : AABB());
+    node.child[c] = c < count ? refs[c] : 0;
+    if (c < count) slots_[kids[c]] = slot;
+  }
+  return node_index;
+}
+
+template uint32_t intersect_children<4, double>(const WideBvhNode<4>&, const Vec3&, const Vec3&,
+                                                double, double, double*);
+template uint32_t intersect_children<8, double>(const WideBvhNode<8>&, const Vec3&, const Vec3&,
+                                                double, double, double*);
+template uint32_t intersect_children<4, float>(const WideBvhNode<4, float>&, const Vec3&,
+                                               const Vec3&, double, double, float*);
+template uint32_t intersect_children<8, float>(const WideBvhNode<8, float>&, const Vec3&,
+                                               const Vec3&, double, double, float*);
+template class WideBvh<4>;
+template class WideBvh<8>;
+template class WideBvh<4, float>;
+template class WideBvh<8, float>;
+}  // namespace percepto::accel
@@ -6,10 +6,63 @@
 #include "percepto/common/config_loader.h"
 #include "percepto/io/logger.h"
 
-using percepto::common::ConfigLoader, percepto::common::LiDARConfig;
+using percepto::common::ConfigLoader, percepto::common::LiDARConfig,
+    percepto::common::RayTracerConfig, percepto::common::AcceleratorType,
+    percepto::common::BvhBuilder, percepto::common::CullMode, percepto::common::PacketLayout,
+    percepto::common::Precision, percepto::common::ScanBackend;
 
 constexpr const char* DEFAULT_CONFIG = "config.toml";
 
+namespace
+{
+AcceleratorType parse_accelerator(const std::string& name)
+{
+  if (name == "none") return AcceleratorType::None;
+  if (name == "bvh") return AcceleratorType::Bvh;
+  if (name == "bvh4") return AcceleratorType::Bvh4;
+  if (name == "bvh8") return AcceleratorType::Bvh8;
+  throw std::runtime_error("Unknown accelerator '" + name +
+                           "' (expected \"none\", \"bvh\", \"bvh4\" or \"bvh8\")");
+}
+
+BvhBuilder parse_bvh_builder(const std::string& name)
+{
+  if (name == "sah") return BvhBuilder::Sah;
+  if (name == "lbvh") return BvhBuilder::Lbvh;
+  throw std::runtime_error("Unknown BVH builder '" + name + "' (expected \"sah\" or \"lbvh\")");
+}
+
+CullMode parse_cull_mode(const std::string& name)
+{
+  if (name == "back") return CullMode::Back;
+  if (name == "none") return CullMode::None;
+  throw std::runtime_error("Unknown cull mode '" + name + "' (expected \"back\" or \"none\")");
+}
+
+Precision parse_precision(const std::string& name)
+{
+  if (name == "double") return Precision::Double;
+  if (name == "single") return Precision::Single;
+  throw std::runtime_error("Unknown precision '" + name + "' (expected \"double\" or \"single\")");
+}
+
+ScanBackend parse_scan_backend(const std::string& name)
+{
+  if (name == "raytrace") return ScanBackend::RayTrace;
+  if (name == "rasterize") return ScanBackend::Rasterize;
+  throw std::runtime_error("Unknown scan backend '" + name +
+                           "' (expected \"raytrace\" or \"rasterize\")");
+}
+
+PacketLayout parse_packet_layout(const std::string& name)
+{
+  if (name == "azimuth") return PacketLayout::Azimuth;
+  if (name == "column") return PacketLayout::Column;
+  throw std::runtime_error("Unknown packet layout '" + name +
+                           "' (expected \"azimuth\" or \"column\")");
+}
+}  // namespace
+
 namespace percepto::common
 {
 // Helper function to find the config file, useful if executable isn't run from root
@@ -81,6 +134,56 @@ LiDARConfig ConfigLoader::loadLiDARConfig()
     config_data.elevation_angles = {};  // defualt to empty array
   }
 
+  config_data.rotation_rate = tbl["LIDAR_SENSOR"]["rotation_rate"].value_or(10.0);
+
+  return config_data;
+}
+
+RayTracerConfig ConfigLoader::loadRayTracerConfig()
+{
+  return loadRayTracerConfig(get_config_filepath());
+}
+
+RayTracerConfig ConfigLoader::loadRayTracerConfig(const std::string& filepath)
+{
+  RayTracerConfig config_data;
+
+  auto logger = get_percepto_logger();
+
+  toml::table tbl;
+  try
+  {
+    tbl = toml::parse_file(filepath);
+  }
+  catch (const toml::parse_error& err)
+  {
+    logger->error("Error parsing file {}: {}", filepath, err.description());
+  }
+
+  config_data.ray_t_min = tbl["RAY_TRACER"]["ray_t_min"].value_or(0.0);
+  config_data.ray_t_max = tbl["RAY_TRACER"]["ray_t_max"].value_or(2000.0);
+  config_data.accelerator =
+      parse_accelerator(tbl["RAY_TRACER"]["accelerator"].value_or(std::string("bvh")));
+  config_data.bvh_builder =
+      parse_bvh_builder(tbl["RAY_TRACER"]["bvh_builder"].value_or(std::string("sah")));
+  config_data.bvh_treelets = tbl["RAY_TRACER"]["bvh_treelets"].value_or(true);
+  config_data.cull_mode = parse_cull_mode(tbl["RAY_TRACER"]["cull"].value_or(std::string("back")));
+  config_data.precision =
+      parse_precision(tbl["RAY_TRACER"]["precision"].value_or(std::string("double")));
+  config_data.bvh_cache = tbl["RAY_TRACER"]["bvh_cache"].value_or(false);
+  config_data.thread_count = tbl["RAY_TRACER"]["threads"].value_or(1);
+  config_data.azimuth_tile_size = tbl["RAY_TRACER"]["azimuth_tile_size"].value_or(64);
+  config_data.angular_grid = tbl["RAY_TRACER"]["angular_grid"].value_or(false);
+  config_data.direction_table = tbl["RAY_TRACER"]["direction_table"].value_or(true);
+  config_data.packet_size = tbl["RAY_TRACER"]["packet_size"].value_or(16);
+  config_data.packet_layout =
+      parse_packet_layout(tbl["RAY_TRACER"]["packet_layout"].value_or(std::string("azimuth")));
+  config_data.scan_backend =
+      parse_scan_backend(tbl["RAY_TRACER"]["scan_backend"].value_or(std::string("raytrace")));
+  config_data.trace_rays = tbl["RAY_TRACER"]["trace_rays"].value_or(false);
+  config_data.ray_trace_file =
+      tbl["RAY_TRACER"]["ray_trace_file"].value_or(std::string("percepto_rays.log"));
+
   return config_data;
 }
 }  // namespace percepto::common
\ No newline at end of file
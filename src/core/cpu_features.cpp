@@ -0,0 +1,53 @@
+#include <stdexcept>
+#include <string>
+
+#include "percepto/common/cpu_features.h"
+
+namespace percepto::common
+{
+Isa detect_isa()
+{
+#if PERCEPTO_X86_SIMD
+  // Also checks that the OS saves the wider registers. May run before main, hence the init.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+  if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+#endif
+  return Isa::Scalar;
+}
+
+std::atomic<Isa> detail::active_isa{detect_isa()};
+
+void set_isa(Isa isa)
+{
+  if (isa > detect_isa())
+  {
+    throw std::invalid_argument(std::string("This CPU or build does not support ") +
+                                isa_name(isa) + " (best is " + isa_name(detect_isa()) + ")");
+  }
+  detail::active_isa.store(isa, std::memory_order_relaxed);
+}
+
+const char* isa_name(Isa isa)
+{
+  switch (isa)
+  {
+    case Isa::Avx512:
+      return "avx512";
+    case Isa::Avx2:
+      return "avx2";
+    case Isa::Scalar:
+      break;
+  }
+  return "scalar";
+}
+
+Isa parse_isa(const std::string& name)
+{
+  if (name == "scalar") return Isa::Scalar;
+  if (name == "avx2") return Isa::Avx2;
+  if (name == "avx512") return Isa::Avx512;
+  throw std::invalid_argument("Unknown ISA '" + name +
+                              "' (expected \"scalar\", \"avx2\" or \"avx512\")");
+}
+}  // namespace percepto::common
@@ -0,0 +1,40 @@
+#include <utility>
+#include <vector>
+
+#include "percepto/common/frame_pool.h"
+#include "percepto/common/frame_scan.h"
+
+namespace percepto::common
+{
+FrameScan FramePool::acquire(int azimuth_steps, int channel_count)
+{
+  // Most recently released first: its buffers are the likeliest to still be in cache.
+  for (size_t k = free_.size(); k-- > 0;)
+  {
+    if (free_[k].azimuth_steps != azimuth_steps || free_[k].channel_count != channel_count)
+    {
+      continue;
+    }
+
+    FrameScan frame = std::move(free_[k]);
+    if (k + 1 != free_.size()) free_[k] = std::move(free_.back());
+    free_.pop_back();
+
+    frame.reset();
+    return frame;
+  }
+  return FrameScan(azimuth_steps, channel_count);
+}
+
+void FramePool::release(FrameScan&& frame)
+{
+  free_.push_back(std::move(frame));
+}
+
+void FramePool::release(std::vector<FrameScan>& frames)
+{
+  free_.reserve(free_.size() + frames.size());
+  for (auto& frame : frames) free_.push_back(std::move(frame));
+  frames.clear();
+}
+}  // namespace percepto::common
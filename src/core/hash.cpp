@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <cstring>
+
+#include "percepto/common/hash.h"
+
+namespace percepto::common
+{
+namespace
+{
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+uint64_t rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+uint64_t read64(const unsigned char* p)
+{
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t read32(const unsigned char* p)
+{
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint64_t round(uint64_t acc, uint64_t input)
+{
+  acc += input * kPrime2;
+  acc = rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+uint64_t merge_round(uint64_t acc, uint64_t lane)
+{
+  acc ^= round(0, lane);
+  return acc * kPrime1 + kPrime4;
+}
+}  // namespace
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed)
+{
+  const auto* p = static_cast<const unsigned char*>(data);
+  const unsigned char* const end = p + size;
+
+  uint64_t h;
+  if (size >= 32)
+  {
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+    for (const unsigned char* limit = end - 32; p <= limit; p += 32)
+    {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+    }
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    h = merge_round(h, v4);
+  }
+  else
+  {
+    h = seed + kPrime5;
+  }
+  h += size;
+
+  for (; p + 8 <= end; p += 8)
+  {
+    h ^= round(0, read64(p));
+    h = rotl(h, 27) * kPrime1 + kPrime4;
+  }
+  if (p + 4 <= end)
+  {
+    h ^= read32(p) * kPrime1;
+    h = rotl(h, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p)
+  {
+    h ^= *p * kPrime5;
+    h = rotl(h, 11) * kPrime1;
+  }
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+}  // namespace percepto::common
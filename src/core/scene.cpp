@@ -1,46 +1,1441 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
 #include <variant>
+#include <vector>
 
+#include "percepto/accel/angular_grid.h"
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/packet_traversal.h"
+#include "percepto/common/thread_pool.h"
 #include "percepto/common/types.h"
 #include "percepto/core/ray.h"
+#include "percepto/core/ray_batch.h"
+#include "percepto/core/ray_packet.h"
 #include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/math/intersection/moller_trumbore.h"
+#include "percepto/math/intersection/moller_trumbore_block.h"
+#include "percepto/math/intersection/moller_trumbore_packet.h"
 
 using percepto::core::Scene, percepto::core::Ray, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::TriangleMesh;
+using percepto::common::AcceleratorType, percepto::common::CullMode, percepto::common::Precision,
+    percepto::common::ThreadPool, percepto::common::TriangleHitResult, percepto::common::uses_bvh;
+using percepto::math::intersection::moller_trumbore,
+    percepto::math::intersection::moller_trumbore_block,
+    percepto::math::intersection::moller_trumbore_block_occluded,
+    percepto::math::intersection::moller_trumbore_packet;
 
 namespace percepto::core
 {
-void Scene::add_object(const Object& object)
+namespace
 {
-  scene_.push_back(object);
+// Rays per task of intersect_batch: enough to amortize claiming a task, few enough to balance.
+constexpr size_t kBatchChunkSize = 1024;
+// Shortest run of rays from one origin that intersect_batch traces as a packet.
+constexpr size_t kMinBatchPacketRays = 4;
+
+// Vector instructions moller_trumbore_packet needs for the rays in `mask`.
+int packet_chunks(uint32_t mask)
+{
+  const int width = percepto::math::intersection::moller_trumbore_packet_width();
+  int chunks = 0;
+  for (int base = 0; base < RayPacket::kMaxSize; base += width)
+  {
+    if ((mask >> base) & ((1u << width) - 1)) ++chunks;
+  }
+  return chunks;
+}
+
+// Hands free object `id` to the push for its part of a BVH leaf (Scene::PrimRange): triangles go
+// into blocks, instances and spheres into arrays of their own. Other types fail to compile.
+template <typename T, typename PushTriangle, typename PushInstance, typename PushSphere>
+void pack_object(const T& object, uint32_t id, PushTriangle& push_triangle,
+                 PushInstance& push_instance, PushSphere& push_sphere)
+{
+  if constexpr (std::is_same_v<T, Triangle>)
+  {
+    push_triangle(object, id);
+  }
+  else if constexpr (std::is_same_v<T, Instance>)
+  {
+    push_instance(object, id);
+  }
+  else
+  {
+    static_assert(std::is_same_v<T, Sphere>, "BVH leaves hold triangles, instances and spheres");
+    push_sphere(object, id);
+  }
+}
+
+// `object` with `transform` applied in world coordinates; see Scene::transform_object.
+Scene::Object transformed(const Scene::Object& object, const Transform& transform)
+{
+  if (const auto* tri = std::get_if<Triangle>(&object))
+  {
+    return Triangle(transform.point(tri->v0()), transform.point(tri->v1()),
+                    transform.point(tri->v2()));
+  }
+  if (const auto* sphere = std::get_if<Sphere>(&object))
+  {
+    return Sphere(transform.point(sphere->centre()),
+                  sphere->radius() * std::cbrt(std::abs(transform.determinant())));
+  }
+  const auto& instance = std::get<Instance>(object);
+  return Instance(instance.shared_mesh(), transform * instance.object_to_world());
+}
+}  // namespace
+
+Scene::Scene()
+{
+  // A leaf of up to one block costs about as much as a single triangle test, so let leaves
+  // grow to the block width and weight primitive tests accordingly.
+  bvh_options_.max_leaf_size = kTriangleBlockWidth;
+  bvh_options_.intersection_cost = 0.5;
+}
+
+Scene::ObjectHandle Scene::add_object(const Object& object)
+{
+  const ObjectHandle handle = objects_.push(object);
+  removed_.push_back(0);
+  motion_of_.push_back(kNoMotion);
+  bvh_prebuilt_ = false;
+  dirty_ = true;
+  return handle;
+}
+
+void Scene::check_handle(ObjectHandle handle) const
+{
+  if (handle >= objects_.size())
+  {
+    throw std::out_of_range("Scene: no object with handle " + std::to_string(handle));
+  }
+  if (removed_[handle])
+  {
+    throw std::out_of_range("Scene: object " + std::to_string(handle) + " was removed");
+  }
+}
+
+void Scene::mark_moved(ObjectHandle handle)
+{
+  if (is_moving(handle))
+  {
+    motion_dirty_ = true;
+    return;
+  }
+  // The tree no longer matches what set_prebuilt_bvh was given, so a later full commit must
+  // build a fresh one.
+  bvh_prebuilt_ = false;
+  if (uses_bvh(accelerator_) && !dirty_)
+  {
+    moved_.push_back(handle);
+  }
+  else
+  {
+    dirty_ = true;
+  }
+}
+
+void Scene::update_object(ObjectHandle handle, const Object& object)
+{
+  check_handle(handle);
+  // A leaf's packed primitives are rewritten in place, which only works while every type keeps
+  // its count.
+  if (object.index() != objects_.type(handle)) dirty_ = true;
+  objects_.assign(handle, object);
+  mark_moved(handle);
+}
+
+void Scene::transform_object(ObjectHandle handle, const Transform& transform)
+{
+  check_handle(handle);
+  objects_.assign(handle, transformed(objects_[handle], transform));
+  mark_moved(handle);
+}
+
+void Scene::remove_object(ObjectHandle handle)
+{
+  check_handle(handle);
+  drop_motion(handle);
+  removed_[handle] = 1;
+  ++removed_count_;
+  emptied_since_build_ = true;
+  mark_moved(handle);
+}
+
+void Scene::set_object_motion(ObjectHandle handle, const Transform& start, const Transform& end)
+{
+  check_handle(handle);
+  // Placing an instance inverts its transform, which throws for a singular pose.
+  const Object object = objects_[handle];
+  transformed(object, start);
+  transformed(object, end);
+
+  if (!is_moving(handle))
+  {
+    // Its box in the static tree empties at the next refit, as for a removed object.
+    mark_moved(handle);
+    emptied_since_build_ = true;
+    motion_of_[handle] = static_cast<uint32_t>(motions_.size());
+    motions_.push_back({handle, start, end});
+  }
+  else
+  {
+    motions_[motion_of_[handle]] = {handle, start, end};
+  }
+  motion_dirty_ = true;
+}
+
+void Scene::clear_object_motion(ObjectHandle handle)
+{
+  check_handle(handle);
+  if (!is_moving(handle)) return;
+  drop_motion(handle);
+  // It may have been left out of the static tree altogether.
+  dirty_ = true;
+}
+
+void Scene::drop_motion(ObjectHandle handle)
+{
+  if (!is_moving(handle)) return;
+  const uint32_t index = motion_of_[handle];
+  motions_[index] = motions_.back();
+  motion_of_[motions_[index].handle] = index;
+  motions_.pop_back();
+  motion_of_[handle] = kNoMotion;
+  motion_dirty_ = true;
+}
+
+Scene::Object Scene::object_at(ObjectHandle handle, double time) const
+{
+  if (handle >= objects_.size())
+  {
+    throw std::out_of_range("Scene: no object with handle " + std::to_string(handle));
+  }
+  const Object object = objects_[handle];
+  if (!is_moving(handle)) return object;
+
+  const ObjectMotion& motion = motions_[motion_of_[handle]];
+  const Transform pose = Transform::lerp(motion.start, motion.end, time);
+  if (const auto* sphere = std::get_if<Sphere>(&object))
+  {
+    auto scale = [](const Transform& t) { return std::cbrt(std::abs(t.determinant())); };
+    const double s = (1.0 - time) * scale(motion.start) + time * scale(motion.end);
+    return Sphere(pose.point(sphere->centre()), sphere->radius() * s);
+  }
+  return transformed(object, pose);
+}
+
+void Scene::add_mesh(TriangleMesh mesh)
+{
+  if (mesh.empty()) return;
+  mesh_offsets_.push_back(mesh_offsets_.back() + static_cast<uint32_t>(mesh.triangle_count()));
+  meshes_.push_back(std::move(mesh));
+  bvh_prebuilt_ = false;
+  dirty_ = true;
+}
+
+std::pair<const TriangleMesh*, size_t> Scene::locate_mesh_triangle(uint32_t id) const
+{
+  const uint32_t mesh_triangle = id - static_cast<uint32_t>(objects_.size());
+  // Nearly every scene holds a single mesh; skip the search for it.
+  const size_t mesh =
+      meshes_.size() == 1
+          ? 0
+          : std::upper_bound(mesh_offsets_.begin(), mesh_offsets_.end(), mesh_triangle) -
+                mesh_offsets_.begin() - 1;
+  return {&meshes_[mesh], mesh_triangle - mesh_offsets_[mesh]};
+}
+
+Scene::Object Scene::primitive(uint32_t id) const
+{
+  if (id < objects_.size()) return objects_[id];
+  const auto [mesh, triangle] = locate_mesh_triangle(id);
+  return mesh->triangle(triangle);
+}
+
+SurfaceHit Scene::resolve(const Ray& ray, const HitRecord& hit) const
+{
+  SurfaceHit surface;
+  surface.point = ray.at(hit.t);
+  Vec3 outward;
+  if (hit.primitive < objects_.size())
+  {
+    const Object object = object_at(hit.primitive, ray.time());
+    if (const auto* tri = std::get_if<Triangle>(&object))
+    {
+      outward = tri->normal();
+    }
+    else if (const auto* sphere = std::get_if<Sphere>(&object))
+    {
+      outward = sphere->normal(surface.point);
+    }
+    else
+    {
+      outward = std::get<Instance>(object).normal(hit.mesh_triangle);
+    }
+  }
+  else
+  {
+    const auto [mesh, triangle] = locate_mesh_triangle(hit.primitive);
+    outward = mesh->triangle(triangle).normal();
+  }
+  surface.front_face = ray.direction().dot(outward) < 0.0;
+  surface.normal = surface.front_face ? outward : -outward;
+  return surface;
+}
+
+AABB Scene::primitive_bounds(uint32_t id) const
+{
+  if (id < objects_.size())
+  {
+    if (!is_static(id)) return AABB();
+    return objects_.visit(id, [](const auto& obj) { return obj.bounds(); });
+  }
+  const auto [mesh, triangle] = locate_mesh_triangle(id);
+  return mesh->bounds(triangle);
+}
+
+template <CullMode kCull>
+bool Scene::intersect_primitive(uint32_t id, const Ray& ray, HitRecord& hit_record) const
+{
+  bool hit;
+  if (id < objects_.size())
+  {
+    hit = objects_.visit(id, [&](const auto& obj)
+                         { return obj.template intersect<kCull>(ray, hit_record); });
+  }
+  else
+  {
+    const auto [mesh, triangle] = locate_mesh_triangle(id);
+    hit = mesh->intersect<kCull>(triangle, ray, hit_record);
+  }
+  if (hit) hit_record.primitive = id;
+  return hit;
+}
+
+SceneMemoryUsage Scene::memory_usage() const
+{
+  SceneMemoryUsage usage;
+  usage.objects = objects_.memory_bytes() +
+                  motions_.capacity() * sizeof(ObjectMotion) +
+                  (removed_.capacity() + motion_of_.capacity() * sizeof(uint32_t));
+  for (const auto& mesh : meshes_) usage.meshes += mesh.memory_bytes();
+  std::unordered_set<const percepto::geometry::InstancedMesh*> instanced;
+  for (const Instance& instance : objects_.items<Instance>())
+  {
+    if (instanced.insert(&instance.mesh()).second)
+    {
+      usage.meshes += instance.mesh().mesh().memory_bytes();
+      usage.acceleration += instance.mesh().acceleration_bytes();
+    }
+  }
+  usage.acceleration += blocks_.capacity() * sizeof(TriangleBlock) +
+                        float_blocks_.capacity() * sizeof(FloatTriangleBlock) +
+                        spheres_.capacity() * sizeof(Sphere) +
+                        instances_.capacity() * sizeof(const Instance*) +
+                        (sphere_ids_.capacity() + instance_ids_.capacity()) * sizeof(uint32_t) +
+                        ranges_.capacity() * sizeof(PrimRange) +
+                        bvh_.nodes().size() * sizeof(percepto::accel::BvhNode) +
+                        bvh_.prim_indices().size() * sizeof(uint32_t) + bvh4_.memory_bytes() +
+                        bvh8_.memory_bytes() + bvh4f_.memory_bytes() + bvh8f_.memory_bytes() +
+                        motion_bvh_.memory_bytes() + angular_grid_.memory_bytes();
+  return usage;
+}
+
+void Scene::set_accelerator(AcceleratorType accelerator)
+{
+  if (accelerator == accelerator_) return;
+  // The wide trees are collapsed from the binary one, so a prebuilt binary tree survives a switch
+  // between them.
+  if (!uses_bvh(accelerator) || !uses_bvh(accelerator_))
+  {
+    bvh_.clear();
+    bvh_prebuilt_ = false;
+  }
+  accelerator_ = accelerator;
+  bvh4_.clear();
+  bvh8_.clear();
+  bvh4f_.clear();
+  bvh8f_.clear();
+  dirty_ = true;
+}
+
+void Scene::set_precision(Precision precision)
+{
+  if (precision == precision_) return;
+  precision_ = precision;
+  // Release what the old precision packed; the rebuild fills the other set.
+  blocks_.clear();
+  blocks_.shrink_to_fit();
+  float_blocks_.clear();
+  float_blocks_.shrink_to_fit();
+  bvh4_ = {};
+  bvh8_ = {};
+  bvh4f_ = {};
+  bvh8f_ = {};
+  dirty_ = true;
+}
+
+void Scene::set_bvh_options(const percepto::accel::BvhBuildOptions& options)
+{
+  // The loaded tree was built with the options the scene already has.
+  if (bvh_prebuilt_ && options == bvh_options_) return;
+  bvh_options_ = options;
+  bvh_prebuilt_ = false;
+  dirty_ = true;
+}
+
+void Scene::set_prebuilt_bvh(percepto::accel::Bvh bvh)
+{
+  if (!uses_bvh(accelerator_)) accelerator_ = AcceleratorType::Bvh;
+  bvh_ = std::move(bvh);
+  bvh_prebuilt_ = true;
+  dirty_ = true;
+}
+
+void Scene::set_angular_grid(const percepto::accel::AngularGridLayout& layout)
+{
+  if (use_angular_grid_ && layout == angular_grid_layout_) return;
+  angular_grid_layout_ = layout;
+  use_angular_grid_ = true;
+  dirty_ = true;
+}
+
+void Scene::clear_angular_grid()
+{
+  if (!use_angular_grid_) return;
+  use_angular_grid_ = false;
+  angular_grid_.clear();
+}
+
+void Scene::commit()
+{
+  if (dirty_)
+  {
+    rebuild();
+    return;
+  }
+  if (!moved_.empty()) refit();
+  if (motion_dirty_) build_motion_bvh();
+}
+
+void Scene::rebuild()
+{
+  objects_.shrink_to_fit();
+  blocks_.clear();
+  float_blocks_.clear();
+  spheres_.clear();
+  instances_.clear();
+  sphere_ids_.clear();
+  instance_ids_.clear();
+  ranges_.clear();
+  angular_grid_.clear();
+
+  const bool build_bvh = uses_bvh(accelerator_) && !bvh_prebuilt_;
+  const auto prim_count = static_cast<uint32_t>(size());
+  std::vector<AABB> bounds;
+  if (build_bvh || use_angular_grid_)
+  {
+    bounds.reserve(prim_count);
+    for (uint32_t id = 0; id < prim_count; ++id) bounds.push_back(primitive_bounds(id));
+  }
+
+  if (use_angular_grid_) build_angular_grid(bounds);
+
+  bvh4_.clear();
+  bvh8_.clear();
+  bvh4f_.clear();
+  bvh8f_.clear();
+  if (uses_bvh(accelerator_))
+  {
+    if (build_bvh && removed_count_ == 0 && motions_.empty())
+    {
+      bvh_.build(bounds, bvh_options_);
+    }
+    else if (build_bvh)
+    {
+      // Removed and moving objects have empty bounds, which the builders cannot place; build
+      // over the static primitives and map the tree back to their ids.
+      std::vector<uint32_t> live;
+      std::vector<AABB> live_bounds;
+      for (uint32_t id = 0; id < prim_count; ++id)
+      {
+        if (bounds[id].empty()) continue;
+        live.push_back(id);
+        live_bounds.push_back(bounds[id]);
+      }
+      bvh_.build(live_bounds, bvh_options_);
+      bvh_.remap_primitives(live);
+    }
+    const bool single = precision_ == Precision::Single;
+    if (accelerator_ == AcceleratorType::Bvh4 && !single) bvh4_.build(bvh_);
+    if (accelerator_ == AcceleratorType::Bvh8 && !single) bvh8_.build(bvh_);
+    if (accelerator_ == AcceleratorType::Bvh4 && single) bvh4f_.build(bvh_);
+    if (accelerator_ == AcceleratorType::Bvh8 && single) bvh8f_.build(bvh_);
+    pack_leaves();
+    bvh_cost_ = bvh_built_cost_ = bvh_.sah_area();
+  }
+  else
+  {
+    std::vector<uint32_t> all(prim_count);
+    std::iota(all.begin(), all.end(), 0u);
+    ranges_.push_back(pack_range(all.data(), static_cast<uint32_t>(all.size())));
+  }
+
+  build_motion_bvh();
+  moved_.clear();
+  prim_leaf_.clear();
+  refit_root_ = kNoNode;
+  emptied_since_build_ = false;
+  dirty_ = false;
+}
+
+void Scene::build_motion_bvh()
+{
+  std::vector<AABB> start, end;
+  start.reserve(motions_.size());
+  end.reserve(motions_.size());
+  for (const ObjectMotion& motion : motions_)
+  {
+    auto bounds = [](const Object& object)
+    { return std::visit([](const auto& obj) { return obj.bounds(); }, object); };
+    start.push_back(bounds(object_at(motion.handle, 0.0)));
+    end.push_back(bounds(object_at(motion.handle, 1.0)));
+  }
+  motion_bvh_.build(start, end, bvh_options_);
+  motion_dirty_ = false;
+}
+
+void Scene::pack_leaves()
+{
+  // Repack every leaf's primitives in traversal order so a leaf is a contiguous run of blocks.
+  blocks_.clear();
+  float_blocks_.clear();
+  spheres_.clear();
+  instances_.clear();
+  sphere_ids_.clear();
+  instance_ids_.clear();
+  const auto& nodes = bvh_.nodes();
+  ranges_.assign(nodes.size(), PrimRange());
+  for (size_t n = 0; n < nodes.size(); ++n)
+  {
+    if (nodes[n].is_leaf())
+    {
+      ranges_[n] = pack_range(bvh_.prim_indices().data() + nodes[n].offset, nodes[n].count);
+    }
+  }
+}
+
+void Scene::refit()
+{
+  const auto& nodes = bvh_.nodes();
+  if (prim_leaf_.empty())
+  {
+    prim_leaf_.assign(static_cast<size_t>(size()), kNoNode);
+    for (uint32_t n = 0; n < nodes.size(); ++n)
+    {
+      if (!nodes[n].is_leaf()) continue;
+      for (uint32_t i = nodes[n].offset; i < nodes[n].offset + nodes[n].count; ++i)
+      {
+        prim_leaf_[bvh_.prim_indices()[i]] = n;
+      }
+    }
+  }
+
+  std::vector<uint32_t> leaves;
+  leaves.reserve(moved_.size());
+  for (ObjectHandle handle : moved_)
+  {
+    // Objects removed before the last build are not in the tree.
+    if (prim_leaf_[handle] != kNoNode) leaves.push_back(prim_leaf_[handle]);
+  }
+  std::sort(leaves.begin(), leaves.end());
+  leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+  moved_.clear();
+
+  std::vector<uint32_t> changed;
+  for (uint32_t leaf : leaves)
+  {
+    bvh_cost_ += bvh_.refit_leaf(leaf, [&](uint32_t id) { return primitive_bounds(id); }, changed);
+    repack_leaf(leaf);
+    refit_root_ = refit_root_ == kNoNode ? leaf : bvh_.common_ancestor(refit_root_, leaf);
+  }
+  if (!bvh4_.empty()) bvh4_.refit(bvh_, changed);
+  if (!bvh8_.empty()) bvh8_.refit(bvh_, changed);
+  if (!bvh4f_.empty()) bvh4f_.refit(bvh_, changed);
+  if (!bvh8f_.empty()) bvh8f_.refit(bvh_, changed);
+
+  if (use_angular_grid_)
+  {
+    std::vector<AABB> bounds;
+    bounds.reserve(prim_leaf_.size());
+    for (uint32_t id = 0; id < prim_leaf_.size(); ++id) bounds.push_back(primitive_bounds(id));
+    build_angular_grid(bounds);
+  }
+
+  if (bvh_cost_ > bvh_options_.rebuild_ratio * bvh_built_cost_) rebuild_degraded();
+}
+
+void Scene::build_angular_grid(const std::vector<AABB>& bounds)
+{
+  std::vector<AABB> stored;
+  stored.reserve(bounds.size());
+  objects_.for_each_type(
+      [&](const auto&, const std::vector<uint32_t>& ids)
+      {
+        for (uint32_t id : ids) stored.push_back(bounds[id]);
+      });
+  stored.insert(stored.end(), bounds.begin() + static_cast<std::ptrdiff_t>(objects_.size()),
+                bounds.end());
+  angular_grid_.build(angular_grid_layout_, stored);
+}
+
+void Scene::rebuild_degraded()
+{
+  // A subtree over more than half the primitives costs nearly a full build; a full build also
+  // drops removed objects, which the builders cannot place inside a subtree.
+  const auto [first, count] = bvh_.subtree_prims(refit_root_);
+  if (refit_root_ == 0 || emptied_since_build_ || 2 * count > bvh_.prim_indices().size())
+  {
+    rebuild();
+    return;
+  }
+
+  std::vector<AABB> bounds;
+  bounds.reserve(count);
+  for (uint32_t i = first; i < first + count; ++i)
+  {
+    bounds.push_back(primitive_bounds(bvh_.prim_indices()[i]));
+  }
+  if (!bvh_.rebuild_subtree(refit_root_, bounds, bvh_options_))
+  {
+    rebuild();
+    return;
+  }
+
+  // Node indices past the subtree have moved, so everything indexed by node is redone. These
+  // are linear passes over packed data; the build itself only covered the subtree.
+  if (!bvh4_.empty()) bvh4_.build(bvh_);
+  if (!bvh8_.empty()) bvh8_.build(bvh_);
+  if (!bvh4f_.empty()) bvh4f_.build(bvh_);
+  if (!bvh8f_.empty()) bvh8f_.build(bvh_);
+  pack_leaves();
+  prim_leaf_.clear();
+  refit_root_ = kNoNode;
+  bvh_cost_ = bvh_built_cost_ = bvh_.sah_area();
+}
+
+void Scene::repack_leaf(uint32_t leaf)
+{
+  // A leaf holds no more live primitives of each type than when it was packed, so its blocks,
+  // spheres and instances fit where they were.
+  PrimRange& range = ranges_[leaf];
+  uint32_t blocks = 0, spheres = 0, instances = 0;
+  auto push_into = [&](auto& packed, const Triangle& tri, uint32_t id)
+  {
+    if (blocks == 0 || packed[range.first_block + blocks - 1].full())
+    {
+      packed[range.first_block + blocks++] = {};
+    }
+    packed[range.first_block + blocks - 1].push(tri, id);
+  };
+  auto push_triangle = [&](const Triangle& tri, uint32_t id)
+  {
+    if (precision_ == Precision::Single)
+    {
+      push_into(float_blocks_, tri, id);
+    }
+    else
+    {
+      push_into(blocks_, tri, id);
+    }
+  };
+  auto push_instance = [&](const Instance& instance, uint32_t id)
+  {
+    instance_ids_[range.first_instance + instances] = id;
+    instances_[range.first_instance + instances++] = &instance;
+  };
+  auto push_sphere = [&](const Sphere& sphere, uint32_t id)
+  {
+    sphere_ids_[range.first_sphere + spheres] = id;
+    spheres_[range.first_sphere + spheres++] = sphere;
+  };
+
+  const percepto::accel::BvhNode& node = bvh_.nodes()[leaf];
+  for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+  {
+    const uint32_t id = bvh_.prim_indices()[i];
+    if (id >= objects_.size())
+    {
+      const auto [mesh, triangle] = locate_mesh_triangle(id);
+      push_triangle(mesh->triangle(triangle), id);
+    }
+    else if (!is_static(id))
+    {
+      continue;
+    }
+    else
+    {
+      objects_.visit(id, [&](const auto& object)
+                     { pack_object(object, id, push_triangle, push_instance, push_sphere); });
+    }
+  }
+  range.block_count = blocks;
+  range.sphere_count = spheres;
+  range.instance_count = instances;
+}
+
+Scene::PrimRange Scene::pack_range(const uint32_t* object_ids, uint32_t count)
+{
+  const bool single = precision_ == Precision::Single;
+  auto block_total = [&]
+  { return static_cast<uint32_t>(single ? float_blocks_.size() : blocks_.size()); };
+  PrimRange range;
+  range.first_block = block_total();
+  range.first_sphere = static_cast<uint32_t>(spheres_.size());
+  range.first_instance = static_cast<uint32_t>(instances_.size());
+
+  auto push_into = [&](auto& packed, const Triangle& tri, uint32_t id)
+  {
+    if (packed.size() == range.first_block || packed.back().full()) packed.emplace_back();
+    packed.back().push(tri, id);
+  };
+  auto push_triangle = [&](const Triangle& tri, uint32_t id)
+  {
+    if (single)
+    {
+      push_into(float_blocks_, tri, id);
+    }
+    else
+    {
+      push_into(blocks_, tri, id);
+    }
+  };
+  auto push_instance = [&](const Instance& instance, uint32_t id)
+  {
+    instances_.push_back(&instance);
+    instance_ids_.push_back(id);
+  };
+  auto push_sphere = [&](const Sphere& sphere, uint32_t id)
+  {
+    spheres_.push_back(sphere);
+    sphere_ids_.push_back(id);
+  };
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const uint32_t id = object_ids[i];
+    if (id >= objects_.size())
+    {
+      const auto [mesh, triangle] = locate_mesh_triangle(id);
+      push_triangle(mesh->triangle(triangle), id);
+    }
+    else if (!is_static(id))
+    {
+      continue;
+    }
+    else
+    {
+      objects_.visit(id, [&](const auto& object)
+                     { pack_object(object, id, push_triangle, push_instance, push_sphere); });
+    }
+  }
+
+  range.block_count = block_total() - range.first_block;
+  range.sphere_count = static_cast<uint32_t>(spheres_.size()) - range.first_sphere;
+  range.instance_count = static_cast<uint32_t>(instances_.size()) - range.first_instance;
+  return range;
 }
 
 bool Scene::intersect(const Ray& ray, HitRecord& hit_record)
 {
-  double closest_hit = std::numeric_limits<double>::infinity();
-  bool hit_object = false;
+  commit();
+  if (cull_mode_ == CullMode::None) return closest_hit<CullMode::None>(ray, hit_record);
+  return closest_hit<CullMode::Back>(ray, hit_record);
+}
+
+template <CullMode kCull>
+bool Scene::closest_hit(const Ray& ray, HitRecord& hit_record) const
+{
+  const bool single = precision_ == Precision::Single;
+  bool hit = false;
+  switch (accelerator_)
+  {
+    case AcceleratorType::Bvh:
+      hit = intersect_bvh<kCull>(bvh_, ray, hit_record);
+      break;
+    case AcceleratorType::Bvh4:
+      hit = single ? intersect_bvh<kCull>(bvh4f_, ray, hit_record)
+                   : intersect_bvh<kCull>(bvh4_, ray, hit_record);
+      break;
+    case AcceleratorType::Bvh8:
+      hit = single ? intersect_bvh<kCull>(bvh8f_, ray, hit_record)
+                   : intersect_bvh<kCull>(bvh8_, ray, hit_record);
+      break;
+    case AcceleratorType::None:
+    default:
+      hit = intersect_linear<kCull>(ray, hit_record);
+      break;
+  }
+  // Only the closest hit is refined: a float t that wins by less than its error still names a
+  // triangle the ray hits, and one at the same distance as the double winner.
+  if (hit && single) refine_hit<kCull>(ray, hit_record);
+  return intersect_moving<kCull>(ray, hit, hit_record);
+}
+
+template <CullMode kCull>
+void Scene::refine_hit(const Ray& ray, HitRecord& hit_record) const
+{
+  const uint32_t id = hit_record.primitive;
+  const Triangle* free_triangle = id < objects_.size() ? objects_.get_if<Triangle>(id) : nullptr;
+  if (id < objects_.size() && !free_triangle) return;  // Spheres and instances run in double.
+
+  const Triangle tri = free_triangle ? *free_triangle
+                                     : [&]
+                                     {
+                                       const auto [mesh, triangle] = locate_mesh_triangle(id);
+                                       return mesh->triangle(triangle);
+                                     }();
+  // The double test can reject a hit the float edge slack let through; that one keeps its
+  // float values.
+  if (const auto exact = moller_trumbore<kCull>(tri.v0(), tri.v1(), tri.v2(), ray))
+  {
+    hit_record.t = exact->t;
+    hit_record.u = exact->u;
+    hit_record.v = exact->v;
+  }
+}
+
+template <CullMode kCull>
+bool Scene::intersect_moving(const Ray& ray, bool hit, HitRecord& hit_record) const
+{
+  if (motion_bvh_.empty()) return hit;
+
+  const bool moving_hit = motion_bvh_.traverse(
+      ray, hit ? hit_record.t : ray.tMax(),
+      [&](uint32_t leaf, double& t_max)
+      {
+        const percepto::accel::BvhNode& node = motion_bvh_.nodes()[leaf];
+        bool leaf_hit = false;
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+        {
+          const ObjectMotion& motion = motions_[motion_bvh_.prim_indices()[i]];
+          if (intersect_moving_object<kCull>(motion, ray, t_max, hit_record)) leaf_hit = true;
+        }
+        return leaf_hit;
+      });
+  return hit || moving_hit;
+}
+
+template <CullMode kCull>
+bool Scene::intersect_moving_object(const ObjectMotion& motion, const Ray& ray, double& t_max,
+                                    HitRecord& hit_record) const
+{
+  if (const auto* instance = objects_.get_if<Instance>(motion.handle))
+  {
+    // Carry the ray back through the pose, then into the mesh, without placing a new instance.
+    const Transform pose = Transform::lerp(motion.start, motion.end, ray.time());
+    if (!(std::abs(pose.determinant()) > 0.0)) return false;
+    if (!instance->intersect<kCull>(ray, instance->world_to_object() * pose.inverse(), t_max,
+                                    hit_record))
+    {
+      return false;
+    }
+    hit_record.primitive = motion.handle;
+    return true;
+  }
+
+  Ray clipped = ray;
+  clipped.setTMax(t_max);
+  HitRecord temp_hit_record;
+  const bool hit =
+      std::visit([&](const auto& obj)
+                 { return obj.template intersect<kCull>(clipped, temp_hit_record); },
+                 object_at(motion.handle, ray.time()));
+  if (!hit || !(temp_hit_record.t < t_max)) return false;
+  t_max = temp_hit_record.t;
+  hit_record = temp_hit_record;
+  hit_record.primitive = motion.handle;
+  return true;
+}
+
+uint32_t Scene::intersect_packet(const RayPacket& packet, HitRecord* hit_records)
+{
+  commit();
+  if (cull_mode_ == CullMode::None) return closest_hits<CullMode::None>(packet, hit_records);
+  return closest_hits<CullMode::Back>(packet, hit_records);
+}
+
+template <CullMode kCull>
+uint32_t Scene::closest_hits(const RayPacket& packet, HitRecord* hit_records) const
+{
+  alignas(64) double t_max[RayPacket::kMaxSize];
+  std::copy(packet.t_max, packet.t_max + RayPacket::kMaxSize, t_max);
+  const uint32_t active = packet.lanes();
+
+  uint32_t hits = 0;
+  if (!uses_bvh(accelerator_))
+  {
+    if (!ranges_.empty())
+    {
+      hits = intersect_range_packet<kCull>(ranges_.front(), packet, active, t_max, hit_records);
+    }
+  }
+  else
+  {
+    // The wide trees share the binary tree's leaves; a packet walks the binary tree, whose
+    // two-way nodes keep more of its rays together below each split.
+    hits = percepto::accel::traverse_packet(
+        bvh_, packet, active, t_max,
+        [&](uint32_t leaf, uint32_t mask, double* t)
+        { return intersect_range_packet<kCull>(ranges_[leaf], packet, mask, t, hit_records); });
+  }
+  if (precision_ == Precision::Single)
+  {
+    for (uint32_t m = hits; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      refine_hit<kCull>(packet.ray(i), hit_records[i]);
+    }
+  }
+
+  // Rays of one packet may be cast at different times, so moving objects are traced per ray.
+  if (!motion_bvh_.empty())
+  {
+    for (uint32_t m = active; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      if (intersect_moving<kCull>(packet.ray(i), hits & (1u << i), hit_records[i])) hits |= 1u << i;
+    }
+  }
+  return hits;
+}
+
+void Scene::intersect_batch(const RayBatch& rays, const HitBatch& hits, ThreadPool* pool)
+{
+  if (rays.count == 0) return;
+  if (!rays.origin_x || !rays.origin_y || !rays.origin_z || !rays.dir_x || !rays.dir_y ||
+      !rays.dir_z || !rays.t_min || !rays.t_max)
+  {
+    throw std::invalid_argument("RayBatch is missing an origin, direction or t-range array.");
+  }
+  if (!hits.t || !hits.primitive || !hits.u || !hits.v)
+  {
+    throw std::invalid_argument("HitBatch is missing an output array.");
+  }
+
+  commit();
+  const size_t chunks = (rays.count + kBatchChunkSize - 1) / kBatchChunkSize;
+  auto trace_chunk = [&](size_t c)
+  {
+    const size_t begin = c * kBatchChunkSize;
+    const size_t end = std::min(rays.count, (c + 1) * kBatchChunkSize);
+    if (cull_mode_ == CullMode::None)
+    {
+      intersect_batch_chunk<CullMode::None>(rays, hits, begin, end);
+    }
+    else
+    {
+      intersect_batch_chunk<CullMode::Back>(rays, hits, begin, end);
+    }
+  };
+  if (pool && chunks > 1)
+  {
+    pool->parallel_for(chunks, trace_chunk);
+  }
+  else
+  {
+    for (size_t c = 0; c < chunks; ++c) trace_chunk(c);
+  }
+}
+
+template <CullMode kCull>
+void Scene::intersect_batch_chunk(const RayBatch& rays, const HitBatch& hits, size_t begin,
+                                  size_t end) const
+{
+  auto store = [&](size_t i, bool hit, const HitRecord& record)
+  {
+    if (!hit)
+    {
+      hits.t[i] = std::numeric_limits<double>::infinity();
+      hits.primitive[i] = HitRecord::kNoPrimitive;
+      return;
+    }
+    hits.t[i] = record.t;
+    hits.primitive[i] = record.primitive;
+    hits.u[i] = record.u;
+    hits.v[i] = record.v;
+  };
+
+  RayPacket packet;
+  HitRecord records[RayPacket::kMaxSize];
+  for (size_t i = begin; i < end;)
+  {
+    // Rays cast from one point, e.g. by one sensor, tend to come in runs; those share a packet.
+    size_t run = 1;
+    const Vec3 origin = rays.origin(i);
+    while (i + run < end && run < RayPacket::kMaxSize && rays.origin(i + run) == origin) ++run;
+
+    if (run < kMinBatchPacketRays)
+    {
+      HitRecord record;
+      store(i, closest_hit<kCull>(rays.ray(i), record), record);
+      ++i;
+      continue;
+    }
+
+    packet.clear();
+    for (size_t k = 0; k < run; ++k) packet.push(rays.ray(i + k));
+    const uint32_t mask = closest_hits<kCull>(packet, records);
+    for (size_t k = 0; k < run; ++k) store(i + k, mask & (1u << k), records[k]);
+    i += run;
+  }
+}
+
+bool Scene::occluded(const Ray& ray)
+{
+  commit();
+  if (cull_mode_ == CullMode::None) return any_hit<CullMode::None>(ray);
+  return any_hit<CullMode::Back>(ray);
+}
+
+template <CullMode kCull>
+bool Scene::any_hit(const Ray& ray) const
+{
+  // Wide trees hand over the binary tree's leaf indices, as for intersect.
+  auto occluded_leaf = [&](uint32_t leaf) { return occluded_range<kCull>(ranges_[leaf], ray); };
+  const bool single = precision_ == Precision::Single;
+  bool hit = false;
+  switch (accelerator_)
+  {
+    case AcceleratorType::Bvh:
+      hit = bvh_.traverse_any(ray, ray.tMax(), occluded_leaf);
+      break;
+    case AcceleratorType::Bvh4:
+      hit = single ? bvh4f_.traverse_any(ray, ray.tMax(), occluded_leaf)
+                   : bvh4_.traverse_any(ray, ray.tMax(), occluded_leaf);
+      break;
+    case AcceleratorType::Bvh8:
+      hit = single ? bvh8f_.traverse_any(ray, ray.tMax(), occluded_leaf)
+                   : bvh8_.traverse_any(ray, ray.tMax(), occluded_leaf);
+      break;
+    case AcceleratorType::None:
+    default:
+      hit = !ranges_.empty() && occluded_range<kCull>(ranges_.front(), ray);
+      break;
+  }
+  return hit || occluded_moving<kCull>(ray);
+}
+
+uint32_t Scene::occluded_packet(const RayPacket& packet)
+{
+  commit();
+  if (cull_mode_ == CullMode::None) return any_hits<CullMode::None>(packet);
+  return any_hits<CullMode::Back>(packet);
+}
+
+template <CullMode kCull>
+uint32_t Scene::any_hits(const RayPacket& packet) const
+{
+  const uint32_t active = packet.lanes();
+  uint32_t hits = 0;
+  if (!uses_bvh(accelerator_))
+  {
+    if (!ranges_.empty()) hits = occluded_range_packet<kCull>(ranges_.front(), packet, active);
+  }
+  else
+  {
+    hits = percepto::accel::traverse_packet_any(
+        bvh_, packet, active, packet.t_max,
+        [&](uint32_t leaf, uint32_t mask)
+        { return occluded_range_packet<kCull>(ranges_[leaf], packet, mask); });
+  }
+
+  if (!motion_bvh_.empty())
+  {
+    for (uint32_t m = active & ~hits; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      if (occluded_moving<kCull>(packet.ray(i))) hits |= 1u << i;
+    }
+  }
+  return hits;
+}
+
+template <CullMode kCull>
+bool Scene::occluded_moving(const Ray& ray) const
+{
+  return motion_bvh_.traverse_any(
+      ray, ray.tMax(),
+      [&](uint32_t leaf)
+      {
+        const percepto::accel::BvhNode& node = motion_bvh_.nodes()[leaf];
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+        {
+          const ObjectMotion& motion = motions_[motion_bvh_.prim_indices()[i]];
+          const Transform pose = Transform::lerp(motion.start, motion.end, ray.time());
+          if (const auto* instance = objects_.get_if<Instance>(motion.handle))
+          {
+            if (std::abs(pose.determinant()) > 0.0 &&
+                instance->occludes<kCull>(ray, instance->world_to_object() * pose.inverse()))
+            {
+              return true;
+            }
+          }
+          else if (std::visit([&](const auto& obj)
+                              { return obj.template occludes<kCull>(ray); },
+                              object_at(motion.handle, ray.time())))
+          {
+            return true;
+          }
+        }
+        return false;
+      });
+}
+
+bool Scene::intersect_sensor_ray(int azimuth_index, int channel, const Ray& ray,
+                                 HitRecord& hit_record)
+{
+  commit();
 
-  for (const auto& object : scene_)
+  if (!use_angular_grid_ || !(ray.origin() == angular_grid_.layout().origin))
   {
-    std::visit(
-        [&](const auto& obj)
+    return intersect(ray, hit_record);
+  }
+  const size_t cell = angular_grid_.cell_index(azimuth_index, channel);
+  if (cull_mode_ == CullMode::None)
+  {
+    const bool hit = intersect_cell<CullMode::None>(cell, ray, hit_record);
+    return intersect_moving<CullMode::None>(ray, hit, hit_record);
+  }
+  const bool hit = intersect_cell<CullMode::Back>(cell, ray, hit_record);
+  return intersect_moving<CullMode::Back>(ray, hit, hit_record);
+}
+
+template <CullMode kCull>
+bool Scene::intersect_cell(size_t cell, const Ray& ray, HitRecord& hit_record) const
+{
+  // Cells hold a handful of primitives, so they are tested directly rather than through packed
+  // blocks, which would have to be duplicated for every cell a triangle spans. Entries are
+  // storage positions in ascending order, so each type's run is read straight from its array.
+  Ray clipped = ray;
+  bool hit = false;
+  const uint32_t* entry = angular_grid_.cell_begin(cell);
+  const uint32_t* const end = angular_grid_.cell_end(cell);
+  auto keep = [&](const HitRecord& candidate, uint32_t id)
+  {
+    clipped.setTMax(candidate.t);
+    hit_record = candidate;
+    hit_record.primitive = id;
+    hit = true;
+  };
+
+  uint32_t first = 0;
+  objects_.for_each_type(
+      [&](const auto& items, const std::vector<uint32_t>& ids)
+      {
+        const auto last = static_cast<uint32_t>(first + items.size());
+        for (; entry != end && *entry < last; ++entry)
         {
           HitRecord temp_hit_record;
-          if (obj.intersect(ray, temp_hit_record) && temp_hit_record.t < closest_hit)
+          if (items[*entry - first].template intersect<kCull>(clipped, temp_hit_record) &&
+              temp_hit_record.t < clipped.tMax())
           {
-            closest_hit = temp_hit_record.t;
-            hit_record = temp_hit_record;
-            hit_object = true;
+            keep(temp_hit_record, ids[*entry - first]);
           }
-        },
-        object);
+        }
+        first = last;
+      });
+  for (; entry != end; ++entry)
+  {
+    HitRecord temp_hit_record;
+    if (intersect_primitive<kCull>(*entry, clipped, temp_hit_record) &&
+        temp_hit_record.t < clipped.tMax())
+    {
+      keep(temp_hit_record, *entry);
+    }
+  }
+  return hit;
+}
+
+bool Scene::intersect_spheres(const PrimRange& range, const Ray& ray, double& t_max,
+                              HitRecord& hit_record) const
+{
+  // The local copy's t_max tracks the closest hit so spheres behind it are rejected early.
+  Ray clipped = ray;
+  clipped.setTMax(t_max);
+  bool hit = false;
+  for (uint32_t s = range.first_sphere; s < range.first_sphere + range.sphere_count; ++s)
+  {
+    HitRecord temp_hit_record;
+    if (spheres_[s].intersect(clipped, temp_hit_record) && temp_hit_record.t < t_max)
+    {
+      t_max = temp_hit_record.t;
+      clipped.setTMax(t_max);
+      hit_record = temp_hit_record;
+      hit_record.primitive = sphere_ids_[s];
+      hit = true;
+    }
+  }
+  return hit;
+}
+
+template <CullMode kCull>
+bool Scene::intersect_instances(const PrimRange& range, const Ray& ray, double& t_max,
+                                HitRecord& hit_record) const
+{
+  // Each instance descends into its mesh's BVH with the closest hit so far as its t_max.
+  bool hit = false;
+  for (uint32_t i = range.first_instance; i < range.first_instance + range.instance_count; ++i)
+  {
+    if (instances_[i]->intersect<kCull>(ray, t_max, hit_record))
+    {
+      hit_record.primitive = instance_ids_[i];
+      hit = true;
+    }
+  }
+  return hit;
+}
+
+template <CullMode kCull>
+bool Scene::intersect_range(const PrimRange& range, const Ray& ray, double& t_max,
+                            HitRecord& hit_record) const
+{
+  bool hit = range.sphere_count > 0 && intersect_spheres(range, ray, t_max, hit_record);
+  if (range.instance_count > 0 && intersect_instances<kCull>(range, ray, t_max, hit_record))
+  {
+    hit = true;
   }
+  if (intersect_blocks<kCull>(range, ray, t_max, hit_record)) hit = true;
+  return hit;
+}
+
+template <CullMode kCull>
+bool Scene::intersect_blocks(const PrimRange& range, const Ray& ray, double& t_max,
+                             HitRecord& hit_record) const
+{
+  if (precision_ == Precision::Single)
+  {
+    return intersect_blocks<kCull>(float_blocks_, range, ray, t_max, hit_record);
+  }
+  return intersect_blocks<kCull>(blocks_, range, ray, t_max, hit_record);
+}
+
+template <CullMode kCull, typename Block>
+bool Scene::intersect_blocks(const std::vector<Block>& blocks, const PrimRange& range,
+                             const Ray& ray, double& t_max, HitRecord& hit_record) const
+{
+  bool hit = false;
+  for (uint32_t b = range.first_block; b < range.first_block + range.block_count; ++b)
+  {
+    TriangleHitResult tri_hit;
+    const int lane = moller_trumbore_block<kCull>(blocks[b], ray, t_max, tri_hit);
+    if (lane >= 0 && tri_hit.t < t_max)
+    {
+      t_max = tri_hit.t;
+      hit_record.t = tri_hit.t;
+      hit_record.primitive = blocks[b].prim_id[lane];
+      hit_record.u = tri_hit.u;
+      hit_record.v = tri_hit.v;
+      hit = true;
+    }
+  }
+
+  return hit;
+}
 
-  return hit_object;
+template <CullMode kCull>
+uint32_t Scene::intersect_range_packet(const PrimRange& range, const RayPacket& packet,
+                                       uint32_t mask, double* t_max,
+                                       HitRecord* hit_records) const
+{
+  uint32_t hits = 0;
+
+  // Spheres are few and rarely share a leaf with many rays; they are tested one ray at a time,
+  // as are instances, whose rays each need their own transform into mesh space.
+  if (range.sphere_count > 0)
+  {
+    for (uint32_t m = mask; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      if (intersect_spheres(range, packet.ray(i), t_max[i], hit_records[i])) hits |= 1u << i;
+    }
+  }
+  if (range.instance_count > 0)
+  {
+    for (uint32_t m = mask; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      if (intersect_instances<kCull>(range, packet.ray(i), t_max[i], hit_records[i]))
+      {
+        hits |= 1u << i;
+      }
+    }
+  }
+
+  if (test_blocks_per_ray(range, mask))
+  {
+    for (uint32_t m = mask; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      if (intersect_blocks<kCull>(range, packet.ray(i), t_max[i], hit_records[i])) hits |= 1u << i;
+    }
+    return hits;
+  }
+
+  // Triangle by triangle in block order, so each ray keeps the first of equally close hits just
+  // as the per-ray block kernel does.
+  alignas(64) double t_hit[RayPacket::kMaxSize], u_hit[RayPacket::kMaxSize],
+      v_hit[RayPacket::kMaxSize];
+  for (uint32_t b = range.first_block; b < range.first_block + range.block_count; ++b)
+  {
+    const TriangleBlock& block = blocks_[b];
+    for (int lane = 0; lane < block.count; ++lane)
+    {
+      for (uint32_t m = moller_trumbore_packet<kCull>(block, lane, packet, mask, t_max, t_hit,
+                                                      u_hit, v_hit);
+           m; m &= m - 1)
+      {
+        const int i = __builtin_ctz(m);
+        if (t_hit[i] < t_max[i])
+        {
+          t_max[i] = t_hit[i];
+          hit_records[i].t = t_hit[i];
+          hit_records[i].primitive = block.prim_id[lane];
+          hit_records[i].u = u_hit[i];
+          hit_records[i].v = v_hit[i];
+          hits |= 1u << i;
+        }
+      }
+    }
+  }
+
+  return hits;
+}
+
+bool Scene::test_blocks_per_ray(const PrimRange& range, uint32_t mask) const
+{
+  // The packet kernel has no single-precision form; float blocks are always tested per ray.
+  if (precision_ == Precision::Single) return true;
+
+  // Once only a few rays reach a leaf, testing each against whole blocks of triangles beats
+  // testing each triangle against a mostly empty packet.
+  const int ray_count = __builtin_popcount(mask);
+  const uint32_t triangle_count =
+      range.block_count == 0
+          ? 0
+          : (range.block_count - 1) * kTriangleBlockWidth +
+                blocks_[range.first_block + range.block_count - 1].count;
+  return static_cast<uint32_t>(ray_count) * range.block_count <=
+         triangle_count * packet_chunks(mask);
+}
+
+template <CullMode kCull>
+bool Scene::intersect_linear(const Ray& ray, HitRecord& hit_record) const
+{
+  if (ranges_.empty()) return false;
+
+  double t_max = ray.tMax();
+  return intersect_range<kCull>(ranges_.front(), ray, t_max, hit_record);
+}
+
+template <CullMode kCull>
+bool Scene::occluded_range(const PrimRange& range, const Ray& ray) const
+{
+  // Triangles first: they fill most leaves and are the cheapest to rule in.
+  if (occluded_blocks<kCull>(range, ray)) return true;
+  for (uint32_t s = range.first_sphere; s < range.first_sphere + range.sphere_count; ++s)
+  {
+    if (spheres_[s].occludes(ray)) return true;
+  }
+  for (uint32_t i = range.first_instance; i < range.first_instance + range.instance_count; ++i)
+  {
+    if (instances_[i]->occludes<kCull>(ray)) return true;
+  }
+  return false;
+}
+
+template <CullMode kCull>
+bool Scene::occluded_blocks(const PrimRange& range, const Ray& ray) const
+{
+  const bool single = precision_ == Precision::Single;
+  for (uint32_t b = range.first_block; b < range.first_block + range.block_count; ++b)
+  {
+    if (single ? moller_trumbore_block_occluded<kCull>(float_blocks_[b], ray, ray.tMax())
+               : moller_trumbore_block_occluded<kCull>(blocks_[b], ray, ray.tMax()))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <CullMode kCull>
+uint32_t Scene::occluded_range_packet(const PrimRange& range, const RayPacket& packet,
+                                      uint32_t mask) const
+{
+  // Same split as intersect_range_packet: few rays test whole blocks each, many rays take the
+  // triangles one at a time. Every ray found blocked is dropped from the tests that follow.
+  uint32_t hits = 0;
+  if (test_blocks_per_ray(range, mask))
+  {
+    for (uint32_t m = mask; m; m &= m - 1)
+    {
+      const int i = __builtin_ctz(m);
+      if (occluded_blocks<kCull>(range, packet.ray(i))) hits |= 1u << i;
+    }
+  }
+  else
+  {
+    alignas(64) double t_hit[RayPacket::kMaxSize];
+    for (uint32_t b = range.first_block; b < range.first_block + range.block_count && hits != mask;
+         ++b)
+    {
+      for (int lane = 0; lane < blocks_[b].count && hits != mask; ++lane)
+      {
+        hits |= moller_trumbore_packet<kCull>(blocks_[b], lane, packet, mask & ~hits, packet.t_max,
+                                              t_hit);
+      }
+    }
+  }
+
+  if (range.sphere_count == 0 && range.instance_count == 0) return hits;
+  for (uint32_t m = mask & ~hits; m; m &= m - 1)
+  {
+    const int i = __builtin_ctz(m);
+    const Ray ray = packet.ray(i);
+    PrimRange rest = range;
+    rest.block_count = 0;
+    if (occluded_range<kCull>(rest, ray)) hits |= 1u << i;
+  }
+  return hits;
+}
+
+template <CullMode kCull, typename Tree>
+bool Scene::intersect_bvh(const Tree& tree, const Ray& ray, HitRecord& hit_record) const
+{
+  // Each leaf narrows t_max to its closest hit, so later leaves and triangle tests reject
+  // anything further away. Wide trees hand over the binary tree's leaf indices, so all three
+  // share ranges_.
+  return tree.traverse(ray, ray.tMax(),
+                       [&](uint32_t leaf, double& t_max)
+                       { return intersect_range<kCull>(ranges_[leaf], ray, t_max, hit_record); });
 }
 
 int Scene::size() const
 {
-  return static_cast<int>(scene_.size());
+  return static_cast<int>(objects_.size() + mesh_offsets_.back());
 }
 }  // namespace percepto::core
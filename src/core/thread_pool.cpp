@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "percepto/common/thread_pool.h"
+
+namespace percepto::common
+{
+ThreadPool::ThreadPool(int thread_count)
+{
+  const int total = resolve_thread_count(thread_count);
+  workers_.reserve(total - 1);
+  for (int i = 0; i < total - 1; ++i)
+  {
+    workers_.emplace_back([this] { worker_loop(); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+int ThreadPool::resolve_thread_count(int thread_count)
+{
+  if (thread_count > 0) return thread_count;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::parallel_for(size_t task_count, const std::function<void(size_t)>& task)
+{
+  if (task_count == 0) return;
+
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    task_count_ = task_count;
+    next_task_.store(0, std::memory_order_relaxed);
+    error_ = nullptr;
+    busy_workers_ = static_cast<int>(workers_.size());
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  run_tasks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return busy_workers_ == 0; });
+  task_ = nullptr;
+
+  if (error_) std::rethrow_exception(error_);
+}
+
+void ThreadPool::worker_loop()
+{
+  size_t seen_generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+      if (stop_) return;
+      seen_generation = generation_;
+    }
+
+    run_tasks();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_workers_ == 0) done_.notify_one();
+  }
+}
+
+void ThreadPool::run_tasks()
+{
+  while (true)
+  {
+    const size_t index = next_task_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= task_count_) return;
+
+    try
+    {
+      (*task_)(index);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+      // Claim everything that is left so the other threads wind down.
+      next_task_.store(task_count_, std::memory_order_relaxed);
+    }
+  }
+}
+}  // namespace percepto::common
@@ -0,0 +1,202 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/math/intersection/moller_trumbore_block.h"
+
+using percepto::core::Ray, percepto::core::Transform, percepto::core::Vec3;
+using percepto::common::CullMode, percepto::common::HitRecord, percepto::common::TriangleHitResult;
+using percepto::math::intersection::moller_trumbore_block;
+using percepto::math::intersection::moller_trumbore_block_occluded;
+
+namespace percepto::geometry
+{
+percepto::accel::BvhBuildOptions InstancedMesh::default_bvh_options()
+{
+  percepto::accel::BvhBuildOptions options;
+  options.max_leaf_size = kTriangleBlockWidth;
+  options.intersection_cost = 0.5;
+  return options;
+}
+
+InstancedMesh::InstancedMesh(TriangleMesh mesh, const percepto::accel::BvhBuildOptions& options)
+    : mesh_(std::move(mesh))
+{
+  std::vector<AABB> prim_bounds;
+  prim_bounds.reserve(mesh_.triangle_count());
+  for (size_t t = 0; t < mesh_.triangle_count(); ++t)
+  {
+    prim_bounds.push_back(mesh_.bounds(t));
+    bounds_.expand(prim_bounds.back());
+  }
+  bvh_.build(prim_bounds, options);
+
+  // Pack every leaf's triangles in traversal order, one contiguous run of blocks per leaf.
+  const auto& nodes = bvh_.nodes();
+  ranges_.resize(nodes.size());
+  for (size_t n = 0; n < nodes.size(); ++n)
+  {
+    if (!nodes[n].is_leaf()) continue;
+    ranges_[n].first_block = static_cast<uint32_t>(blocks_.size());
+    for (uint32_t i = 0; i < nodes[n].count; ++i)
+    {
+      const uint32_t t = bvh_.prim_indices()[nodes[n].offset + i];
+      if (i % kTriangleBlockWidth == 0) blocks_.emplace_back();
+      blocks_.back().push(mesh_.triangle(t), t);
+    }
+    ranges_[n].block_count = static_cast<uint32_t>(blocks_.size()) - ranges_[n].first_block;
+  }
+}
+
+template <CullMode kCull>
+bool InstancedMesh::intersect(const Ray& ray, double& t_max, HitRecord& hit) const
+{
+  double t_closest = t_max;
+  const bool found = bvh_.traverse(
+      ray, t_max,
+      [&](uint32_t leaf, double& t_leaf)
+      {
+        bool leaf_hit = false;
+        const LeafRange& range = ranges_[leaf];
+        for (uint32_t b = range.first_block; b < range.first_block + range.block_count; ++b)
+        {
+          TriangleHitResult tri_hit;
+          const int lane = moller_trumbore_block<kCull>(blocks_[b], ray, t_leaf, tri_hit);
+          if (lane >= 0 && tri_hit.t < t_leaf)
+          {
+            t_leaf = tri_hit.t;
+            hit.mesh_triangle = blocks_[b].prim_id[lane];
+            hit.u = tri_hit.u;
+            hit.v = tri_hit.v;
+            leaf_hit = true;
+          }
+        }
+        if (leaf_hit) t_closest = t_leaf;
+        return leaf_hit;
+      });
+  if (!found) return false;
+
+  t_max = t_closest;
+  hit.t = t_closest;
+  return true;
+}
+
+template <CullMode kCull>
+bool InstancedMesh::occludes(const Ray& ray) const
+{
+  return bvh_.traverse_any(ray, ray.tMax(),
+                           [&](uint32_t leaf)
+                           {
+                             const LeafRange& range = ranges_[leaf];
+                             for (uint32_t b = range.first_block;
+                                  b < range.first_block + range.block_count; ++b)
+                             {
+                               if (moller_trumbore_block_occluded<kCull>(blocks_[b], ray,
+                                                                         ray.tMax()))
+                               {
+                                 return true;
+                               }
+                             }
+                             return false;
+                           });
+}
+
+template bool InstancedMesh::intersect<CullMode::Back>(const Ray&, double&, HitRecord&) const;
+template bool InstancedMesh::intersect<CullMode::None>(const Ray&, double&, HitRecord&) const;
+template bool InstancedMesh::occludes<CullMode::Back>(const Ray&) const;
+template bool InstancedMesh::occludes<CullMode::None>(const Ray&) const;
+
+size_t InstancedMesh::acceleration_bytes() const noexcept
+{
+  return bvh_.nodes().size() * sizeof(percepto::accel::BvhNode) +
+         bvh_.prim_indices().size() * sizeof(uint32_t) + blocks_.capacity() * sizeof(Block) +
+         ranges_.capacity() * sizeof(LeafRange);
+}
+
+Instance::Instance(std::shared_ptr<const InstancedMesh> mesh, const Transform& object_to_world)
+    : mesh_(std::move(mesh)), world_to_object_(object_to_world.inverse())
+{
+  if (!mesh_) throw std::invalid_argument("Instance needs a mesh.");
+}
+
+template <CullMode kCull>
+bool Instance::intersect(const Ray& ray, const Transform& world_to_object, double& t_max,
+                         HitRecord& hit_record) const
+{
+  // The mesh-space direction is not renormalized, so t means the same distance on both rays.
+  const Ray local =
+      Ray::fromUnitDirection(world_to_object.point(ray.origin()),
+                             world_to_object.vector(ray.direction()), ray.tMin(), t_max);
+  HitRecord local_hit;
+  if (!mesh_->intersect<kCull>(local, t_max, local_hit)) return false;
+
+  hit_record.t = local_hit.t;
+  hit_record.mesh_triangle = local_hit.mesh_triangle;
+  hit_record.u = local_hit.u;
+  hit_record.v = local_hit.v;
+  return true;
+}
+
+template <CullMode kCull>
+bool Instance::occludes(const Ray& ray, const Transform& world_to_object) const
+{
+  return mesh_->occludes<kCull>(Ray::fromUnitDirection(world_to_object.point(ray.origin()),
+                                                world_to_object.vector(ray.direction()),
+                                                ray.tMin(), ray.tMax()));
+}
+
+template bool Instance::intersect<CullMode::Back>(const Ray&, const Transform&, double&,
+                                                 HitRecord&) const;
+template bool Instance::intersect<CullMode::None>(const Ray&, const Transform&, double&,
+                                                 HitRecord&) const;
+template bool Instance::occludes<CullMode::Back>(const Ray&, const Transform&) const;
+template bool Instance::occludes<CullMode::None>(const Ray&, const Transform&) const;
+
+AABB Instance::bounds() const
+{
+  const AABB& local = mesh_->bounds();
+  AABB box;
+  if (local.empty()) return box;
+
+  const Transform object_to_world = world_to_object_.inverse();
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    box.expand(object_to_world.point(Vec3(corner & 1 ? local.max.x : local.min.x,
+                                          corner & 2 ? local.max.y : local.min.y,
+                                          corner & 4 ? local.max.z : local.min.z)));
+  }
+  // The forward transform is recovered by inversion, which may move the corners by an ulp or
+  // two; widen the box so it still encloses every hit found in mesh space.
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const double pad = 1e-12 * (std::abs(box.min[axis]) + std::abs(box.max[axis]));
+    box.min[axis] -= pad;
+    box.max[axis] += pad;
+  }
+  return box;
+}
+
+Vec3 Instance::normal(uint32_t triangle) const
+{
+  // Normals carry over with the inverse transpose, which keeps the culled side behind them even
+  // under a mirroring transform.
+  const Triangle local = mesh_->mesh().triangle(triangle);
+  const Vec3 n = (local.v1() - local.v0()).cross(local.v2() - local.v0());
+  const Transform& m = world_to_object_;
+  return Vec3(m(0, 0) * n.x + m(1, 0) * n.y + m(2, 0) * n.z,
+              m(0, 1) * n.x + m(1, 1) * n.y + m(2, 1) * n.z,
+              m(0, 2) * n.x + m(1, 2) * n.y + m(2, 2) * n.z)
+      .normalized();
+}
+}  // namespace percepto::geometry
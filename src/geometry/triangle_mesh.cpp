@@ -0,0 +1,77 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/triangle_mesh.h"
+
+using percepto::core::Vec3;
+
+namespace percepto::geometry
+{
+TriangleMesh::TriangleMesh(std::vector<Vec3> vertices, std::vector<uint32_t> indices)
+    : vertices_(std::move(vertices)), indices_(std::move(indices))
+{
+  if (indices_.size() % 3 != 0)
+  {
+    throw std::invalid_argument("Triangle mesh index count " + std::to_string(indices_.size()) +
+                                " is not a multiple of 3");
+  }
+  for (size_t i = 0; i < indices_.size(); ++i)
+  {
+    if (indices_[i] >= vertices_.size())
+    {
+      throw std::invalid_argument("Triangle " + std::to_string(i / 3) + " references vertex " +
+                                  std::to_string(indices_[i]) + " of " +
+                                  std::to_string(vertices_.size()));
+    }
+  }
+}
+
+size_t TriangleMeshBuilder::VertexKeyHash::operator()(const VertexKey& key) const noexcept
+{
+  // FNV-1a over the three coordinate bit patterns.
+  uint64_t h = 1469598103934665603ull;
+  for (uint64_t b : key.bits) h = (h ^ b) * 1099511628211ull;
+  return static_cast<size_t>(h ^ (h >> 32));
+}
+
+void TriangleMeshBuilder::reserve(size_t triangle_count)
+{
+  // Closed meshes have about half as many vertices as triangles.
+  indices_.reserve(3 * triangle_count);
+  vertices_.reserve(triangle_count / 2 + 3);
+  vertex_ids_.reserve(triangle_count / 2 + 3);
+}
+
+uint32_t TriangleMeshBuilder::add_vertex(const Vec3& v)
+{
+  VertexKey key;
+  std::memcpy(&key.bits[0], &v.x, sizeof(double));
+  std::memcpy(&key.bits[1], &v.y, sizeof(double));
+  std::memcpy(&key.bits[2], &v.z, sizeof(double));
+
+  auto [it, inserted] = vertex_ids_.try_emplace(key, static_cast<uint32_t>(vertices_.size()));
+  if (inserted) vertices_.push_back(v);
+  return it->second;
+}
+
+void TriangleMeshBuilder::add_triangle(const Vec3& v0, const Vec3& v1, const Vec3& v2)
+{
+  indices_.push_back(add_vertex(v0));
+  indices_.push_back(add_vertex(v1));
+  indices_.push_back(add_vertex(v2));
+}
+
+TriangleMesh TriangleMeshBuilder::build()
+{
+  vertex_ids_.clear();
+  vertices_.shrink_to_fit();
+  TriangleMesh mesh(std::move(vertices_), std::move(indices_));
+  vertices_.clear();
+  indices_.clear();
+  return mesh;
+}
+}  // namespace percepto::geometry
@@ -0,0 +1,292 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/io/binary_scene.h"
+#include "percepto/io/logger.h"
+#include "percepto/io/mapped_file.h"
+
+using percepto::accel::Bvh, percepto::accel::BvhNode;
+using percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::Triangle, percepto::geometry::TriangleMesh;
+using percepto::geometry::TriangleMeshBuilder;
+
+namespace percepto::io
+{
+namespace
+{
+constexpr char kMagic[8] = {'P', 'R', 'C', 'P', 'S', 'C', 'N', '\0'};
+constexpr uint32_t kByteOrderMark = 0x01020304;  // Reads differently on a foreign-endian host.
+constexpr uint32_t kFlagBvh = 1u << 0;
+constexpr uint64_t kSectionAlignment = 64;
+
+struct FileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  uint32_t byte_order;
+  uint32_t reserved;
+  uint64_t vertex_count;
+  uint64_t vertex_offset;
+  uint64_t triangle_count;
+  uint64_t index_offset;
+  uint64_t bvh_node_count;
+  uint64_t bvh_node_offset;
+  uint64_t bvh_prim_count;
+  uint64_t bvh_prim_offset;
+  uint64_t file_size;
+};
+static_assert(sizeof(FileHeader) == 96, "FileHeader layout is part of the file format");
+
+struct FileBvhNode
+{
+  double min[3];
+  double max[3];
+  uint32_t offset;
+  uint32_t count;
+};
+static_assert(sizeof(FileBvhNode) == 56, "FileBvhNode layout is part of the file format");
+
+uint64_t align_up(uint64_t offset)
+{
+  return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+// True if `count` elements of `size` bytes starting at `offset` fit in a file of `file_size`.
+bool section_fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size)
+{
+  if (offset % alignof(double) != 0 || offset > file_size) return false;
+  return count <= (file_size - offset) / size;
+}
+
+FileHeader read_header(const MappedFile& file, const std::string& filename)
+{
+  FileHeader header;
+  if (file.size() < sizeof(FileHeader) ||
+      std::memcmp(file.data(), kMagic, sizeof(kMagic)) != 0)
+  {
+    throw std::runtime_error("Not a Percepto binary scene: " + filename);
+  }
+  std::memcpy(&header, file.data(), sizeof(FileHeader));
+
+  if (header.byte_order != kByteOrderMark)
+  {
+    throw std::runtime_error("Binary scene was written with a different byte order: " + filename);
+  }
+  if (header.version != kBinarySceneVersion)
+  {
+    throw std::runtime_error("Unsupported binary scene version " + std::to_string(header.version) +
+                             " (expected " + std::to_string(kBinarySceneVersion) +
+                             "): " + filename);
+  }
+
+  const uint64_t size = file.size();
+  const bool has_bvh = header.flags & kFlagBvh;
+  if (header.file_size != size ||
+      !section_fits(header.vertex_offset, header.vertex_count, 3 * sizeof(double), size) ||
+      !section_fits(header.index_offset, header.triangle_count, 3 * sizeof(uint32_t), size) ||
+      (has_bvh &&
+       (!section_fits(header.bvh_node_offset, header.bvh_node_count, sizeof(FileBvhNode), size) ||
+        !section_fits(header.bvh_prim_offset, header.bvh_prim_count, sizeof(uint32_t), size))))
+  {
+    throw std::runtime_error("Truncated binary scene: " + filename);
+  }
+  return header;
+}
+
+BinarySceneInfo info_of(const FileHeader& header)
+{
+  BinarySceneInfo info;
+  info.version = header.version;
+  info.vertex_count = header.vertex_count;
+  info.triangle_count = header.triangle_count;
+  info.has_bvh = header.flags & kFlagBvh;
+  info.file_bytes = header.file_size;
+  return info;
+}
+}  // namespace
+
+BinarySceneInfo BinarySceneWriter::write(const Scene& scene, const std::string& filename,
+                                         bool include_bvh)
+{
+  // Index every triangle, free or from a mesh, in primitive order; shared vertices go in once.
+  static_assert(sizeof(Vec3) == 3 * sizeof(double), "vertices are written as packed Vec3");
+  if (scene.moving_count() > 0)
+  {
+    throw std::runtime_error("Binary scenes store static geometry only: " + filename);
+  }
+  TriangleMeshBuilder builder;
+  builder.reserve(static_cast<size_t>(scene.size()));
+  for (Scene::ObjectHandle handle = 0; handle < scene.objects().size(); ++handle)
+  {
+    if (scene.is_removed(handle)) continue;
+    const auto* triangle = scene.objects().get_if<Triangle>(handle);
+    if (!triangle)
+    {
+      throw std::runtime_error("Binary scenes store triangles only: " + filename);
+    }
+    builder.add_triangle(*triangle);
+  }
+  for (const TriangleMesh& mesh : scene.meshes())
+  {
+    for (size_t t = 0; t < mesh.triangle_count(); ++t)
+    {
+      builder.add_triangle(mesh.vertex(t, 0), mesh.vertex(t, 1), mesh.vertex(t, 2));
+    }
+  }
+  const TriangleMesh mesh = builder.build();
+  const auto& vertices = mesh.vertices();
+  const auto& indices = mesh.indices();
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kBinarySceneVersion;
+  header.byte_order = kByteOrderMark;
+  header.vertex_count = mesh.vertex_count();
+  header.triangle_count = mesh.triangle_count();
+
+  std::vector<FileBvhNode> nodes;
+  Bvh bvh;
+  bool with_bvh = false;
+  // Primitive ids would count removed objects, which the file leaves out; let the reader build
+  // a tree over the compacted triangles instead.
+  if (include_bvh && !mesh.empty() && scene.removed_count() == 0)
+  {
+    // Built apart from the scene's own trees, so its accelerator and commit state are untouched.
+    std::vector<percepto::geometry::AABB> bounds;
+    bounds.reserve(mesh.triangle_count());
+    for (size_t t = 0; t < mesh.triangle_count(); ++t) bounds.push_back(mesh.bounds(t));
+    bvh.build(bounds, scene.bvh_options());
+
+    nodes.reserve(bvh.nodes().size());
+    for (const BvhNode& node : bvh.nodes())
+    {
+      nodes.push_back({{node.bounds.min.x, node.bounds.min.y, node.bounds.min.z},
+                       {node.bounds.max.x, node.bounds.max.y, node.bounds.max.z},
+                       node.offset,
+                       node.count});
+    }
+    header.flags |= kFlagBvh;
+    with_bvh = true;
+    header.bvh_node_count = nodes.size();
+    header.bvh_prim_count = bvh.prim_indices().size();
+  }
+
+  header.vertex_offset = align_up(sizeof(FileHeader));
+  header.index_offset = align_up(header.vertex_offset + vertices.size() * sizeof(Vec3));
+  uint64_t end = header.index_offset + indices.size() * sizeof(uint32_t);
+  if (with_bvh)
+  {
+    header.bvh_node_offset = align_up(end);
+    header.bvh_prim_offset =
+        align_up(header.bvh_node_offset + nodes.size() * sizeof(FileBvhNode));
+    end = header.bvh_prim_offset + header.bvh_prim_count * sizeof(uint32_t);
+  }
+  header.file_size = end;
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) throw std::runtime_error("Cannot open file for writing: " + filename);
+
+  uint64_t written = 0;
+  auto write_at = [&](uint64_t offset, const void* bytes, uint64_t count)
+  {
+    static const char kPadding[kSectionAlignment] = {};
+    out.write(kPadding, static_cast<std::streamsize>(offset - written));
+    out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(count));
+    written = offset + count;
+  };
+  write_at(0, &header, sizeof(header));
+  write_at(header.vertex_offset, vertices.data(), vertices.size() * sizeof(Vec3));
+  write_at(header.index_offset, indices.data(), indices.size() * sizeof(uint32_t));
+  if (with_bvh)
+  {
+    write_at(header.bvh_node_offset, nodes.data(), nodes.size() * sizeof(FileBvhNode));
+    write_at(header.bvh_prim_offset, bvh.prim_indices().data(),
+             bvh.prim_indices().size() * sizeof(uint32_t));
+  }
+
+  out.close();
+  if (!out) throw std::runtime_error("Failed to write binary scene: " + filename);
+
+  get_percepto_logger()->info("Wrote {} triangles ({} vertices{}) to {}", header.triangle_count,
+                              header.vertex_count, with_bvh ? ", BVH" : "", filename);
+  return info_of(header);
+}
+
+BinarySceneInfo BinarySceneParser::read_info(const std::string& filename)
+{
+  const MappedFile file(filename);
+  return info_of(read_header(file, filename));
+}
+
+std::unique_ptr<Scene> BinarySceneParser::load_scene_from_binary(const std::string& filename)
+{
+  get_percepto_logger()->info("Loading binary scene from file " + filename);
+
+  const MappedFile file(filename);
+  const FileHeader header = read_header(file, filename);
+
+  // One copy out of the mapping into the mesh buffers; no per-triangle objects are created.
+  std::vector<Vec3> vertices(header.vertex_count);
+  std::memcpy(vertices.data(), file.data() + header.vertex_offset,
+              header.vertex_count * sizeof(Vec3));
+  std::vector<uint32_t> indices(3 * header.triangle_count);
+  std::memcpy(indices.data(), file.data() + header.index_offset,
+              indices.size() * sizeof(uint32_t));
+
+  auto scene = std::make_unique<Scene>();
+  try
+  {
+    scene->add_mesh(TriangleMesh(std::move(vertices), std::move(indices)));
+  }
+  catch (const std::invalid_argument& e)
+  {
+    throw std::runtime_error(std::string("Corrupt binary scene: ") + e.what() + ": " + filename);
+  }
+
+  if (header.flags & kFlagBvh)
+  {
+    const auto* file_nodes =
+        reinterpret_cast<const FileBvhNode*>(file.data() + header.bvh_node_offset);
+    const auto* file_prims =
+        reinterpret_cast<const uint32_t*>(file.data() + header.bvh_prim_offset);
+
+    std::vector<BvhNode> nodes(header.bvh_node_count);
+    for (uint64_t n = 0; n < header.bvh_node_count; ++n)
+    {
+      const FileBvhNode& in = file_nodes[n];
+      nodes[n].bounds = percepto::geometry::AABB(Vec3(in.min[0], in.min[1], in.min[2]),
+                                                 Vec3(in.max[0], in.max[1], in.max[2]));
+      nodes[n].offset = in.offset;
+      nodes[n].count = in.count;
+    }
+    std::vector<uint32_t> prims(file_prims, file_prims + header.bvh_prim_count);
+    if (!Bvh::valid_layout(nodes.data(), nodes.size(), prims.data(), prims.size(),
+                           header.triangle_count))
+    {
+      throw std::runtime_error(
+          "Corrupt binary scene: the stored BVH is not a valid tree over its triangles: " +
+          filename);
+    }
+
+    Bvh bvh;
+    bvh.assign(std::move(nodes), std::move(prims));
+    scene->set_prebuilt_bvh(std::move(bvh));
+  }
+
+  return scene;
+}
+}  // namespace percepto::io
@@ -0,0 +1,319 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/hash.h"
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/io/bvh_cache.h"
+#include "percepto/io/logger.h"
+#include "percepto/io/mapped_file.h"
+
+using percepto::accel::Bvh, percepto::accel::BvhNode, percepto::common::Hasher;
+using percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::Instance, percepto::geometry::InstancedMesh, percepto::geometry::Sphere,
+    percepto::geometry::Triangle, percepto::geometry::TriangleMesh;
+
+namespace percepto::io
+{
+namespace
+{
+constexpr char kMagic[8] = {'P', 'R', 'C', 'P', 'B', 'V', 'H', '\0'};
+constexpr uint32_t kByteOrderMark = 0x01020304;  // Reads differently on a foreign-endian host.
+constexpr uint64_t kSectionAlignment = 64;
+
+// Nodes are stored exactly as they sit in memory, so loading is one copy per section.
+static_assert(std::is_trivially_copyable_v<BvhNode> && sizeof(BvhNode) == 56,
+              "BvhNode layout is part of the cache file format");
+
+struct FileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t content_hash;
+  uint64_t options_hash;
+  uint64_t primitive_count;
+  uint64_t node_count;
+  uint64_t node_offset;
+  uint64_t prim_count;
+  uint64_t prim_offset;
+  uint64_t payload_hash;  // Nodes then primitive indices.
+  uint64_t file_size;
+};
+static_assert(sizeof(FileHeader) == 88, "FileHeader layout is part of the file format");
+
+uint64_t align_up(uint64_t offset)
+{
+  return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+bool section_fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size)
+{
+  if (offset % kSectionAlignment != 0 || offset > file_size) return false;
+  return count <= (file_size - offset) / size;
+}
+
+uint64_t payload_hash(const void* nodes, uint64_t node_count, const void* prims,
+                      uint64_t prim_count)
+{
+  return Hasher()
+      .add(nodes, node_count * sizeof(BvhNode))
+      .add(prims, prim_count * sizeof(uint32_t))
+      .digest();
+}
+
+const char* status_name(BvhCacheStatus status)
+{
+  switch (status)
+  {
+    case BvhCacheStatus::Hit:
+      return "hit";
+    case BvhCacheStatus::Missing:
+      return "missing";
+    case BvhCacheStatus::Stale:
+      return "stale";
+    case BvhCacheStatus::Corrupt:
+      return "corrupt";
+    case BvhCacheStatus::Unused:
+    default:
+      return "unused";
+  }
+}
+}  // namespace
+
+BvhCacheKey bvh_cache_key(const Scene& scene)
+{
+  static_assert(sizeof(Vec3) == 3 * sizeof(double), "vertices are hashed as packed Vec3");
+
+  auto mesh_hash = [](const TriangleMesh& mesh)
+  {
+    return Hasher()
+        .add(mesh.vertices().data(), mesh.vertices().size() * sizeof(Vec3))
+        .add(mesh.indices().data(), mesh.indices().size() * sizeof(uint32_t))
+        .digest();
+  };
+  // Instances of one mesh hash its geometry once. Only the top-level tree is cached; an
+  // instanced mesh builds its own tree when it is created.
+  std::unordered_map<const InstancedMesh*, uint64_t> instanced_hashes;
+
+  // A type tag per object keeps a sphere from hashing like the start of a triangle.
+  Hasher content;
+  const Scene::Objects& objects = scene.objects();
+  for (Scene::ObjectHandle handle = 0; handle < objects.size(); ++handle)
+  {
+    if (const auto* tri = objects.get_if<Triangle>(handle))
+    {
+      const Vec3 data[3] = {tri->v0(), tri->v1(), tri->v2()};
+      content.add_value('T').add(data, sizeof(data));
+    }
+    else if (const auto* instance = objects.get_if<Instance>(handle))
+    {
+      auto [it, inserted] = instanced_hashes.try_emplace(&instance->mesh(), 0);
+      if (inserted) it->second = mesh_hash(instance->mesh().mesh());
+      content.add_value('I').add_value(it->second).add_value(instance->world_to_object());
+    }
+    else
+    {
+      const Sphere& sphere = *objects.get_if<Sphere>(handle);
+      content.add_value('S').add_value(sphere.centre()).add_value(sphere.radius());
+    }
+  }
+  for (const auto& mesh : scene.meshes())
+  {
+    content.add_value('M').add_value(mesh_hash(mesh));
+  }
+
+  // Thread count is left out: every thread count builds the same tree.
+  const auto& options = scene.bvh_options();
+  Hasher settings;
+  settings.add_value(static_cast<int32_t>(options.builder))
+      .add_value(options.bin_count)
+      .add_value(options.max_leaf_size)
+      .add_value(options.traversal_cost)
+      .add_value(options.intersection_cost)
+      .add_value(options.morton_bits)
+      .add_value(options.treelet_optimization);
+
+  BvhCacheKey key;
+  key.content_hash = content.digest();
+  key.options_hash = settings.digest();
+  key.primitive_count = static_cast<uint64_t>(scene.size());
+  return key;
+}
+
+std::string bvh_cache_path(const std::string& scene_file)
+{
+  return scene_file + kBvhCacheExtension;
+}
+
+BvhCacheStatus read_bvh_cache(const std::string& path, const BvhCacheKey& key, Bvh& bvh)
+{
+  std::error_code ec;
+  if (!std::filesystem::exists(path, ec)) return BvhCacheStatus::Missing;
+
+  std::unique_ptr<MappedFile> file;
+  try
+  {
+    file = std::make_unique<MappedFile>(path);
+  }
+  catch (const std::runtime_error&)
+  {
+    return BvhCacheStatus::Corrupt;
+  }
+
+  FileHeader header;
+  if (file->size() < sizeof(FileHeader) ||
+      std::memcmp(file->data(), kMagic, sizeof(kMagic)) != 0)
+  {
+    return BvhCacheStatus::Corrupt;
+  }
+  std::memcpy(&header, file->data(), sizeof(FileHeader));
+  if (header.byte_order != kByteOrderMark) return BvhCacheStatus::Corrupt;
+  if (header.version != kBvhCacheVersion) return BvhCacheStatus::Stale;
+
+  const BvhCacheKey file_key{header.content_hash, header.options_hash, header.primitive_count};
+  if (file_key != key) return BvhCacheStatus::Stale;
+
+  const uint64_t size = file->size();
+  if (header.file_size != size ||
+      !section_fits(header.node_offset, header.node_count, sizeof(BvhNode), size) ||
+      !section_fits(header.prim_offset, header.prim_count, sizeof(uint32_t), size))
+  {
+    return BvhCacheStatus::Corrupt;
+  }
+
+  const auto* nodes = reinterpret_cast<const BvhNode*>(file->data() + header.node_offset);
+  const auto* prims = reinterpret_cast<const uint32_t*>(file->data() + header.prim_offset);
+  if (payload_hash(nodes, header.node_count, prims, header.prim_count) != header.payload_hash ||
+      !Bvh::valid_layout(nodes, header.node_count, prims, header.prim_count,
+                         key.primitive_count))
+  {
+    return BvhCacheStatus::Corrupt;
+  }
+
+  std::vector<BvhNode> node_array(header.node_count);
+  std::memcpy(node_array.data(), nodes, header.node_count * sizeof(BvhNode));
+  std::vector<uint32_t> prim_array(prims, prims + header.prim_count);
+  bvh.assign(std::move(node_array), std::move(prim_array));
+  return BvhCacheStatus::Hit;
+}
+
+void write_bvh_cache(const std::string& path, const BvhCacheKey& key, const Bvh& bvh)
+{
+  const auto& nodes = bvh.nodes();
+  const auto& prims = bvh.prim_indices();
+
+  FileHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kBvhCacheVersion;
+  header.byte_order = kByteOrderMark;
+  header.content_hash = key.content_hash;
+  header.options_hash = key.options_hash;
+  header.primitive_count = key.primitive_count;
+  header.node_count = nodes.size();
+  header.node_offset = align_up(sizeof(FileHeader));
+  header.prim_count = prims.size();
+  header.prim_offset = align_up(header.node_offset + nodes.size() * sizeof(BvhNode));
+  header.payload_hash = payload_hash(nodes.data(), nodes.size(), prims.data(), prims.size());
+  header.file_size = header.prim_offset + prims.size() * sizeof(uint32_t);
+
+  // Unique per process and thread, so concurrent writers never share a temporary file.
+  const size_t writer =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+      static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  const std::string temp_path = path + ".tmp" + std::to_string(writer);
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) throw std::runtime_error("Cannot open file for writing: " + temp_path);
+
+    uint64_t written = 0;
+    auto write_at = [&](uint64_t offset, const void* bytes, uint64_t count)
+    {
+      static const char kPadding[kSectionAlignment] = {};
+      out.write(kPadding, static_cast<std::streamsize>(offset - written));
+      out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(count));
+      written = offset + count;
+    };
+    write_at(0, &header, sizeof(header));
+    write_at(header.node_offset, nodes.data(), nodes.size() * sizeof(BvhNode));
+    write_at(header.prim_offset, prims.data(), prims.size() * sizeof(uint32_t));
+
+    out.close();
+    if (!out)
+    {
+      std::error_code ec;
+      std::filesystem::remove(temp_path, ec);
+      throw std::runtime_error("Failed to write BVH cache: " + temp_path);
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec)
+  {
+    std::filesystem::remove(temp_path, ec);
+    throw std::runtime_error("Failed to replace BVH cache: " + path);
+  }
+}
+
+BvhCacheStatus commit_with_bvh_cache(Scene& scene, const std::string& path)
+{
+  if (!percepto::common::uses_bvh(scene.accelerator()) || scene.has_prebuilt_bvh() ||
+      scene.size() == 0 || scene.removed_count() > 0 || scene.moving_count() > 0)
+  {
+    scene.commit();
+    return BvhCacheStatus::Unused;
+  }
+
+  auto logger = get_percepto_logger();
+  const BvhCacheKey key = bvh_cache_key(scene);
+  Bvh bvh;
+  const BvhCacheStatus status = read_bvh_cache(path, key, bvh);
+  if (status == BvhCacheStatus::Hit)
+  {
+    scene.set_prebuilt_bvh(std::move(bvh));
+    scene.commit();
+    logger->info("Loaded BVH from cache {}", path);
+    return status;
+  }
+
+  if (status == BvhCacheStatus::Corrupt)
+  {
+    logger->warn("Ignoring corrupt BVH cache {}; rebuilding", path);
+  }
+  else
+  {
+    logger->info("BVH cache {} is {}; building", path, status_name(status));
+  }
+  scene.commit();
+
+  try
+  {
+    write_bvh_cache(path, key, scene.bvh());
+  }
+  catch (const std::exception& e)
+  {
+    logger->warn("Could not write BVH cache: {}", e.what());
+  }
+  return status;
+}
+}  // namespace percepto::io
@@ -1,23 +1,123 @@
 #include "csv.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <string>
 #include <system_error>
+#include <vector>
 
+#include "percepto/common/thread_pool.h"
 #include "percepto/core/scene.h"
 #include "percepto/core/vec3.h"
 #include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
 #include "percepto/io/csv_parser.h"
 #include "percepto/io/logger.h"
+#include "percepto/io/mapped_file.h"
 
 using namespace csv;
+using percepto::geometry::TriangleMeshBuilder;
 
 namespace percepto::io
 {
 namespace fs = std::filesystem;
 
+namespace
+{
+constexpr size_t kFieldsPerRow = 9;
+
+// Per-row messages shared by both loaders, so a bad row reads the same whichever path found it.
+std::string field_count_error(size_t row_num, size_t found)
+{
+  return "Error parsing row " + std::to_string(row_num) + ": expected " +
+         std::to_string(kFieldsPerRow) + " fields, but found " + std::to_string(found);
+}
+
+std::string conversion_error(size_t row_num, size_t field, const std::string& reason)
+{
+  return "Error parsing row " + std::to_string(row_num) + ", field " + std::to_string(field) +
+         ": cannot convert to double (" + reason + ")";
+}
+
+// What csv-parser's CSVField::get<double>() reports for a non-numeric field.
+constexpr const char* kNotANumber = "Not a number.";
+
+// Parses one field, ignoring surrounding blanks like csv-parser does.
+bool parse_double(const char* first, const char* last, double& out)
+{
+  while (first < last && (*first == ' ' || *first == '\t')) ++first;
+  while (last > first && (last[-1] == ' ' || last[-1] == '\t')) --last;
+  if (first < last && *first == '+') ++first;
+  if (first == last) return false;
+
+  const auto [ptr, ec] = std::from_chars(first, last, out);
+  return ec == std::errc() && ptr == last && std::isfinite(out);
+}
+
+/// Outcome of parsing one newline-aligned chunk of the file.
+struct ChunkResult
+{
+  size_t rows = 0;         // Rows written before the first bad one.
+  bool failed = false;     // Set at the first bad row; `rows` + 1 is its index in the chunk.
+  size_t error_field = 0;  // 1-based field that failed to convert; 0 for a wrong field count.
+  size_t found_fields = 0;
+};
+
+// Parses the rows in [begin, end) into `coords`, kFieldsPerRow doubles per row. Empty lines are
+// skipped. Stops at the first malformed row.
+void parse_chunk(const char* begin, const char* end, double* coords, ChunkResult& result)
+{
+  const char* line = begin;
+  while (line < end)
+  {
+    const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    if (!eol) eol = end;
+    const char* next = eol < end ? eol + 1 : end;
+    if (eol > line && eol[-1] == '\r') --eol;
+
+    if (eol == line)
+    {
+      line = next;
+      continue;
+    }
+
+    double* row = coords + result.rows * kFieldsPerRow;
+    size_t field = 0;
+    const char* cursor = line;
+    while (true)
+    {
+      const char* comma = static_cast<const char*>(std::memchr(cursor, ',', eol - cursor));
+      const char* field_end = comma ? comma : eol;
+      if (field < kFieldsPerRow && !parse_double(cursor, field_end, row[field]))
+      {
+        // A wrong field count takes precedence, as in the row-by-row loader.
+        result.error_field = field + 1;
+      }
+      ++field;
+      if (!comma) break;
+      cursor = comma + 1;
+    }
+
+    if (field != kFieldsPerRow || result.error_field != 0)
+    {
+      result.failed = true;
+      result.found_fields = field;
+      if (field != kFieldsPerRow) result.error_field = 0;
+      return;
+    }
+
+    ++result.rows;
+    line = next;
+  }
+}
+}  // namespace
+
 /**
  * @brief Ensures that a given path refers to an existing, regular file that can be opened for
  * reading.
@@ -72,16 +172,13 @@ void percepto::io::CsvParser::ensure_file_readable(const std::string& filename)
 percepto::geometry::Triangle percepto::io::CsvParser::parse_triangle_from_csv_row(
     const csv::CSVRow& row, size_t row_num)
 {
-  constexpr size_t expected_fields = 9;
-  if (row.size() != expected_fields)
+  if (row.size() != kFieldsPerRow)
   {
-    throw std::runtime_error("Error parsing row " + std::to_string(row_num) + ": expected " +
-                             std::to_string(expected_fields) + " fields, but found " +
-                             std::to_string(row.size()));
+    throw std::runtime_error(field_count_error(row_num, row.size()));
   }
 
-  double coords[9];
-  for (size_t i = 0; i < expected_fields; ++i)
+  double coords[kFieldsPerRow];
+  for (size_t i = 0; i < kFieldsPerRow; ++i)
   {
     try
     {
@@ -89,9 +186,7 @@ percepto::geometry::Triangle percepto::io::CsvParser::parse_triangle_from_csv_ro
     }
     catch (const std::exception& e)
     {
-      throw std::runtime_error("Error parsing row " + std::to_string(row_num) + ", field " +
-                               std::to_string(i + 1) + ": cannot convert to double (" + e.what() +
-                               ")");
+      throw std::runtime_error(conversion_error(row_num, i + 1, e.what()));
     }
   }
 
@@ -104,33 +199,150 @@ percepto::geometry::Triangle percepto::io::CsvParser::parse_triangle_from_csv_ro
 /**
  * @brief Load a Scene by parsing each CSV row as a triangle (9 doubles per row).
  *
- * Parsing stops the moment a row fails to parse (throws a std::runtime_error).
- * Subsequent rows are not examined.
+ * The first line is a header and is skipped. With `CsvLoadOptions::memory_mapped` the file is
+ * mapped, cut into newline-aligned chunks and parsed in parallel: a counting pass sizes one
+ * coordinate buffer, then every chunk converts its rows with std::from_chars straight into its
+ * slice of it. A malformed row fails the load with the same message the CSVReader path gives;
+ * if several rows are malformed, the first one is reported.
  *
  * @param filename Path to a CSV file where each row is "x0,y0,z0,x1,y1,z1,x2,y2,z2".
- * @return std::unique_ptr<percepto::core::Scene> owning all triangles parsed up to the failure.
- * @throws std::runtime_error as soon as any row is malformed or cannot be read.
+ * @return std::unique_ptr<percepto::core::Scene> holding every parsed triangle in one indexed
+ *         mesh, vertices shared between rows stored once.
+ * @throws std::runtime_error if the file cannot be read, is empty or any row is malformed.
  */
 std::unique_ptr<percepto::core::Scene> percepto::io::CsvParser::load_scene_from_csv(
     const std::string& filename)
 {
   this->ensure_file_readable(filename);
+  // Both loaders expect a header row, which an empty file does not have.
+  if (std::filesystem::file_size(filename) == 0)
+  {
+    throw std::runtime_error("Missing header row: " + filename);
+  }
+  if (!options_.memory_mapped) return load_with_csv_reader(filename);
+
+  const MappedFile file(filename);
+  const char* const data = file.data();
+  const char* const file_end = data + file.size();
 
+  // Quoting is the one CSV feature the fast path does not implement.
+  if (std::memchr(data, '"', file.size())) return load_with_csv_reader(filename);
+
+  auto scene_ptr = std::make_unique<percepto::core::Scene>();
+
+  const char* body = static_cast<const char*>(std::memchr(data, '\n', file.size()));
+  if (!body) return scene_ptr;  // Header only.
+  ++body;
+
+  const int threads = percepto::common::ThreadPool::resolve_thread_count(options_.thread_count);
+  const size_t body_size = static_cast<size_t>(file_end - body);
+
+  // A few chunks per thread so uneven rows still balance; every boundary follows a newline.
+  const size_t target_chunks =
+      std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(threads) * 4, body_size >> 16));
+  std::vector<const char*> bounds{body};
+  for (size_t c = 1; c < target_chunks; ++c)
+  {
+    const char* cut = body + body_size * c / target_chunks;
+    if (cut <= bounds.back()) continue;
+    const char* eol = static_cast<const char*>(std::memchr(cut, '\n', file_end - cut));
+    if (!eol) break;
+    if (eol + 1 > bounds.back() && eol + 1 < file_end) bounds.push_back(eol + 1);
+  }
+  bounds.push_back(file_end);
+  const size_t chunk_count = bounds.size() - 1;
+
+  std::unique_ptr<percepto::common::ThreadPool> pool;
+  if (threads > 1 && chunk_count > 1)
+  {
+    pool = std::make_unique<percepto::common::ThreadPool>(threads);
+  }
+  auto for_each_chunk = [&](const std::function<void(size_t)>& fn)
+  {
+    if (pool)
+    {
+      pool->parallel_for(chunk_count, fn);
+    }
+    else
+    {
+      for (size_t c = 0; c < chunk_count; ++c) fn(c);
+    }
+  };
+
+  // Pass 1: upper bound on the rows of each chunk, one per line.
+  std::vector<size_t> first_row(chunk_count + 1, 0);
+  for_each_chunk(
+      [&](size_t c)
+      {
+        const char* begin = bounds[c];
+        const char* end = bounds[c + 1];
+        size_t lines = static_cast<size_t>(std::count(begin, end, '\n'));
+        if (end > begin && end[-1] != '\n') ++lines;
+        first_row[c + 1] = lines;
+      });
+  for (size_t c = 0; c < chunk_count; ++c) first_row[c + 1] += first_row[c];
+
+  // Pass 2: parse every chunk into its own slice of the coordinate buffer.
+  std::vector<double> coords(first_row.back() * kFieldsPerRow);
+  std::vector<ChunkResult> results(chunk_count);
+  for_each_chunk(
+      [&](size_t c)
+      {
+        parse_chunk(bounds[c], bounds[c + 1], coords.data() + first_row[c] * kFieldsPerRow,
+                    results[c]);
+      });
+
+  size_t total_rows = 0;
+  for (const auto& result : results)
+  {
+    if (result.failed)
+    {
+      const size_t row_num = total_rows + result.rows + 1;
+      if (result.error_field == 0)
+      {
+        throw std::runtime_error(field_count_error(row_num, result.found_fields));
+      }
+      throw std::runtime_error(conversion_error(row_num, result.error_field, kNotANumber));
+    }
+    total_rows += result.rows;
+  }
+
+  TriangleMeshBuilder mesh;
+  mesh.reserve(total_rows);
+  for (size_t c = 0; c < chunk_count; ++c)
+  {
+    const double* row = coords.data() + first_row[c] * kFieldsPerRow;
+    for (size_t r = 0; r < results[c].rows; ++r, row += kFieldsPerRow)
+    {
+      mesh.add_triangle(Vec3(row[0], row[1], row[2]), Vec3(row[3], row[4], row[5]),
+                        Vec3(row[6], row[7], row[8]));
+    }
+  }
+  scene_ptr->add_mesh(mesh.build());
+
+  return scene_ptr;
+}
+
+std::unique_ptr<percepto::core::Scene> percepto::io::CsvParser::load_with_csv_reader(
+    const std::string& filename)
+{
   auto scene_ptr = std::make_unique<percepto::core::Scene>();
 
   CSVFormat format;
   format.variable_columns(VariableColumnPolicy::THROW);
 
   CSVReader reader(filename, format);
+  TriangleMeshBuilder mesh;
   size_t row_num = 0;
   for (CSVRow& row : reader)
   {
     ++row_num;
 
     percepto::geometry::Triangle triangle = this->parse_triangle_from_csv_row(row, row_num);
-    scene_ptr->add_object(triangle);
+    mesh.add_triangle(triangle);
   }
+  scene_ptr->add_mesh(mesh.build());
 
   return scene_ptr;
 }
-}  // namespace percepto::io
\ No newline at end of file
+}  // namespace percepto::io
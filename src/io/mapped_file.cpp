@@ -0,0 +1,61 @@
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PERCEPTO_HAVE_MMAP 1
+#else
+#define PERCEPTO_HAVE_MMAP 0
+#endif
+
+#include "percepto/io/mapped_file.h"
+
+namespace percepto::io
+{
+MappedFile::MappedFile(const std::string& filename)
+{
+#if PERCEPTO_HAVE_MMAP
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("Cannot open file for reading: " + filename);
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    throw std::runtime_error("Cannot open file for reading: " + filename);
+  }
+
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0)
+  {
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      ::close(fd);
+      throw std::runtime_error("Cannot map file for reading: " + filename);
+    }
+    ::madvise(mapping, size_, MADV_WILLNEED);
+    data_ = static_cast<const char*>(mapping);
+  }
+  ::close(fd);  // The mapping stays valid without the descriptor.
+#else
+  std::ifstream in(filename, std::ios::binary);
+  if (!in.is_open()) throw std::runtime_error("Cannot open file for reading: " + filename);
+  buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  size_ = buffer_.size();
+  if (size_ > 0) data_ = buffer_.data();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if PERCEPTO_HAVE_MMAP
+  if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+}
+}  // namespace percepto::io
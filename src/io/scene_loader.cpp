@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "percepto/common/types.h"
+#include "percepto/io/binary_scene.h"
+#include "percepto/io/csv_parser.h"
+#include "percepto/io/scene_loader.h"
+
+using percepto::common::SceneFormat;
+
+namespace percepto::io
+{
+SceneFormat scene_format_from_path(const std::string& filename)
+{
+  std::string extension = std::filesystem::path(filename).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+  if (extension == ".csv") return SceneFormat::CSV;
+  if (extension == ".obj") return SceneFormat::OBJ;
+  if (extension == ".gltf" || extension == ".glb") return SceneFormat::GLTF;
+  if (extension == ".json") return SceneFormat::JSON;
+  if (extension == kBinarySceneExtension) return SceneFormat::Binary;
+  throw std::runtime_error("Unrecognised scene file extension '" + extension + "': " + filename);
+}
+
+std::unique_ptr<percepto::core::Scene> load_scene(const std::string& filename)
+{
+  switch (scene_format_from_path(filename))
+  {
+    case SceneFormat::CSV:
+      return CsvParser().load_scene_from_csv(filename);
+    case SceneFormat::Binary:
+      return BinarySceneParser().load_scene_from_binary(filename);
+    default:
+      throw std::runtime_error("No loader for this scene format yet: " + filename);
+  }
+}
+}  // namespace percepto::io
@@ -2,22 +2,128 @@
 #include <cmath>
 #include <stdexcept>
 #include <system_error>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #include "percepto/common/config_loader.h"
+#include "percepto/common/cpu_features.h"
 #include "percepto/core/ray.h"
 #include "percepto/core/vec3.h"
 #include "percepto/io/logger.h"
 #include "percepto/lidar/emitter.h"
 
+using percepto::common::Isa;
 using percepto::lidar::LidarEmitter;
 
+namespace
+{
+#if PERCEPTO_X86_SIMD
+// Channels [j, j + 4) of one azimuth column, with the scalar loop's operations in its order, so
+// each lane rounds exactly as Vec3::normalized does.
+PERCEPTO_TARGET_AVX2 inline void direction_lanes_avx2(const double* cos_elev,
+                                                      const double* sin_elev, size_t j,
+                                                      double cos_az, double sin_az, double* x,
+                                                      double* y, double* z)
+{
+  const __m256d ce = _mm256_loadu_pd(cos_elev + j);
+  const __m256d dx = _mm256_mul_pd(ce, _mm256_set1_pd(cos_az));
+  const __m256d dy = _mm256_mul_pd(ce, _mm256_set1_pd(sin_az));
+  const __m256d dz = _mm256_loadu_pd(sin_elev + j);
+  const __m256d len = _mm256_sqrt_pd(_mm256_add_pd(
+      _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz)));
+  const __m256d positive = _mm256_cmp_pd(len, _mm256_setzero_pd(), _CMP_GT_OQ);
+  _mm256_storeu_pd(x + j, _mm256_and_pd(positive, _mm256_div_pd(dx, len)));
+  _mm256_storeu_pd(y + j, _mm256_and_pd(positive, _mm256_div_pd(dy, len)));
+  _mm256_storeu_pd(z + j, _mm256_and_pd(positive, _mm256_div_pd(dz, len)));
+}
+
+PERCEPTO_TARGET_AVX512 inline void direction_lanes_avx512(const double* cos_elev,
+                                                          const double* sin_elev, size_t j,
+                                                          double cos_az, double sin_az,
+                                                          double* x, double* y, double* z)
+{
+  const __m512d ce = _mm512_loadu_pd(cos_elev + j);
+  const __m512d dx = _mm512_mul_pd(ce, _mm512_set1_pd(cos_az));
+  const __m512d dy = _mm512_mul_pd(ce, _mm512_set1_pd(sin_az));
+  const __m512d dz = _mm512_loadu_pd(sin_elev + j);
+  const __m512d len = _mm512_sqrt_pd(_mm512_add_pd(
+      _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)), _mm512_mul_pd(dz, dz)));
+  const __mmask8 positive = _mm512_cmp_pd_mask(len, _mm512_setzero_pd(), _CMP_GT_OQ);
+  _mm512_storeu_pd(x + j, _mm512_maskz_div_pd(positive, dx, len));
+  _mm512_storeu_pd(y + j, _mm512_maskz_div_pd(positive, dy, len));
+  _mm512_storeu_pd(z + j, _mm512_maskz_div_pd(positive, dz, len));
+}
+#endif
+
+// One azimuth column of the direction table, in the form common::dispatch_isa runs.
+struct DirectionColumn
+{
+  template <Isa kIsa>
+  static void run(const std::vector<double>& cos_elev, const std::vector<double>& sin_elev,
+                  double cos_az, double sin_az, double* x, double* y, double* z)
+  {
+    const size_t M = cos_elev.size();
+    size_t j = 0;
+#if PERCEPTO_X86_SIMD
+    if constexpr (kIsa == Isa::Avx512)
+    {
+      for (; j + 8 <= M; j += 8)
+      {
+        direction_lanes_avx512(cos_elev.data(), sin_elev.data(), j, cos_az, sin_az, x, y, z);
+      }
+    }
+    if constexpr (kIsa != Isa::Scalar)
+    {
+      for (; j + 4 <= M; j += 4)
+      {
+        direction_lanes_avx2(cos_elev.data(), sin_elev.data(), j, cos_az, sin_az, x, y, z);
+      }
+    }
+#endif
+    for (; j < M; ++j)
+    {
+      // Exactly what get_ray feeds the Ray constructor, normalized the same way, so table rays
+      // are bit-identical to computed ones.
+      const percepto::core::Vec3 dir =
+          percepto::core::Vec3(cos_elev[j] * cos_az, cos_elev[j] * sin_az, sin_elev[j])
+              .normalized();
+      x[j] = dir.x;
+      y[j] = dir.y;
+      z[j] = dir.z;
+    }
+  }
+};
+}  // namespace
+
 namespace percepto::lidar
 {
 LidarEmitter::LidarEmitter(percepto::common::LiDARConfig lidar_cfg)
-    : elevation_angles_(std::move(lidar_cfg.elevation_angles))
 {
-  if (elevation_angles_.empty()) throw std::invalid_argument("elevation_angles cannot be empty");
+  configure(std::move(lidar_cfg));
+}
 
+void LidarEmitter::configure(percepto::common::LiDARConfig lidar_cfg)
+{
+  if (lidar_cfg.elevation_angles.empty())
+  {
+    throw std::invalid_argument("elevation_angles cannot be empty");
+  }
+  if (!(lidar_cfg.rotation_rate > 0.0) || !std::isfinite(lidar_cfg.rotation_rate))
+  {
+    throw std::invalid_argument("rotation_rate must be positive");
+  }
+  rotation_rate_ = lidar_cfg.rotation_rate;
+  if (lidar_cfg.azimuth_steps == azimuth_steps() && lidar_cfg.elevation_angles == elevation_angles_)
+  {
+    return;
+  }
+
+  elevation_angles_ = std::move(lidar_cfg.elevation_angles);
+  cos_elev_.clear();
+  sin_elev_.clear();
   cos_elev_.reserve(elevation_angles_.size());
   sin_elev_.reserve(elevation_angles_.size());
 
@@ -29,21 +135,71 @@ LidarEmitter::LidarEmitter(percepto::common::LiDARConfig lidar_cfg)
 
   // Precompute evenly spaced azimuth angles over a full 360° (2π radians)
   // for all scan steps. These angles are reused across all scan revolutions.
+  azimuth_angles_.clear();
   azimuth_angles_.reserve(lidar_cfg.azimuth_steps);
   for (int i = 0; i < lidar_cfg.azimuth_steps; i++)
   {
     azimuth_angles_.emplace_back(TWO_PI * double(i) / double(lidar_cfg.azimuth_steps));
   }
+
+  if (use_direction_table_) build_direction_table();
+}
+
+void LidarEmitter::enable_direction_table()
+{
+  if (use_direction_table_) return;
+  use_direction_table_ = true;
+  build_direction_table();
+}
+
+void LidarEmitter::disable_direction_table()
+{
+  use_direction_table_ = false;
+  directions_ = DirectionTable{};
+}
+
+void LidarEmitter::build_direction_table()
+{
+  const size_t N = azimuth_angles_.size();
+  const size_t M = elevation_angles_.size();
+  directions_.x.resize(N * M);
+  directions_.y.resize(N * M);
+  directions_.z.resize(N * M);
+
+  for (size_t i = 0; i < N; ++i)
+  {
+    const size_t k = i * M;
+    common::dispatch_isa<DirectionColumn>(cos_elev_, sin_elev_, std::cos(azimuth_angles_[i]),
+                                          std::sin(azimuth_angles_[i]), directions_.x.data() + k,
+                                          directions_.y.data() + k, directions_.z.data() + k);
+  }
+}
+
+void LidarEmitter::rays(size_t first, size_t count, std::vector<percepto::core::Ray>& out) const
+{
+  assert(use_direction_table_ && first + count <= directions_.size());
+  const double* x = directions_.x.data() + first;
+  const double* y = directions_.y.data() + first;
+  const double* z = directions_.z.data() + first;
+  out.clear();
+  out.reserve(count);
+  const size_t M = elevation_angles_.size();
+  for (size_t k = 0; k < count; ++k)
+  {
+    out.push_back(percepto::core::Ray::fromUnitDirection(default_origin,
+                                                         percepto::core::Vec3(x[k], y[k], z[k])));
+    out.back().setTime(firing_phase(static_cast<int>((first + k) / M)));
+  }
 }
 
 percepto::core::Ray LidarEmitter::get_ray(const int i, const int j)
 {
-  if (i < 0 || i >= azimuth_angles_.size())
+  if (i < 0 || i >= static_cast<int>(azimuth_angles_.size()))
   {
     throw std::out_of_range("Azimuth index 'i' out of bounds.");
   }
 
-  if (j < 0 || j >= elevation_angles_.size())
+  if (j < 0 || j >= static_cast<int>(elevation_angles_.size()))
   {
     throw std::out_of_range("Elevation index 'j' out of bounds.");
   }
@@ -58,7 +214,9 @@ percepto::core::Ray LidarEmitter::get_ray(const int i, const int j)
   percepto::core::Vec3 dir{cos_el * std::cos(current_azimuth_angle),
                            cos_el * std::sin(current_azimuth_angle), sin_el};
 
-  return percepto::core::Ray{default_origin, dir};
+  percepto::core::Ray ray{default_origin, dir};
+  ray.setTime(firing_phase(i));
+  return ray;
 }
 
-}  // namespace percepto::lidar
\ No newline at end of file
+}  // namespace percepto::lidar
@@ -0,0 +1,239 @@
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "percepto/accel/angular_footprint.h"
+#include "percepto/common/frame_scan.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/lidar/emitter.h"
+#include "percepto/lidar/scan_rasterizer.h"
+
+using percepto::accel::AngleTable, percepto::accel::angular_footprint;
+using percepto::core::Ray, percepto::core::Transform, percepto::core::Vec3;
+
+namespace percepto::lidar
+{
+void ScanRasterizer::update_beams(const LidarEmitter& emitter)
+{
+  if (emitter.azimuth_angles() == azimuths_ && emitter.elevation_angles() == elevations_) return;
+
+  azimuths_ = emitter.azimuth_angles();
+  elevations_ = emitter.elevation_angles();
+  azimuth_table_ = AngleTable(azimuths_);
+  elevation_table_ = AngleTable(elevations_);
+
+  const std::vector<double>& cos_el = emitter.elevation_cosines();
+  const std::vector<double>& sin_el = emitter.elevation_sines();
+  const int N = static_cast<int>(azimuths_.size());
+  const int M = static_cast<int>(elevations_.size());
+
+  // Same directions `LidarEmitter::get_ray` gives each beam.
+  directions_.resize(static_cast<size_t>(N) * M);
+  for (int i = 0; i < N; ++i)
+  {
+    const double cos_az = std::cos(azimuths_[i]);
+    const double sin_az = std::sin(azimuths_[i]);
+    for (int j = 0; j < M; ++j)
+    {
+      directions_[static_cast<size_t>(i) * M + j] =
+          Vec3(cos_el[j] * cos_az, cos_el[j] * sin_az, sin_el[j]).normalized();
+    }
+  }
+}
+
+int ScanRasterizer::rasterize(const percepto::core::Scene& scene, const LidarEmitter& emitter,
+                              percepto::common::FrameScan& scan)
+{
+  const Vec3& origin = emitter.origin();
+  const int N = emitter.azimuth_steps();
+  const int M = static_cast<int>(emitter.elevation_angles().size());
+
+  // Emitter rays carry Ray's default valid interval.
+  const Ray probe(origin, Vec3(0.0, 0.0, 1.0));
+  const double t_min = probe.tMin();
+  const double t_max = probe.tMax();
+
+  // Without culling a back face is hit wherever the same face wound the other way would be.
+  const bool double_sided = scene.cull_mode() == percepto::common::CullMode::None;
+
+  update_beams(emitter);
+  depth_.assign(static_cast<size_t>(N) * M, std::numeric_limits<double>::infinity());
+
+  auto beam = [&](int i, int j) -> const Vec3&
+  { return directions_[static_cast<size_t>(i) * M + j]; };
+
+  auto for_each_beam = [&](const percepto::geometry::AABB& bounds, auto&& fn)
+  {
+    const auto fp = angular_footprint(bounds, origin);
+    azimuth_table_.for_each_azimuth(
+        fp, [&](int i) { elevation_table_.for_each_elevation(fp, [&](int j) { fn(i, j); }); });
+  };
+
+  auto rasterize_triangle = [&](const Triangle& tri)
+  {
+    const Vec3 a = tri.v0() - origin;
+    Vec3 b = tri.v1() - origin;
+    Vec3 c = tri.v2() - origin;
+    Vec3 normal = (b - a).cross(c - a);
+
+    // Back-face cull once per triangle: only faces turned towards the sensor can be hit, unless
+    // the scene is double-sided, in which case a back face is turned around.
+    double plane = -normal.dot(a);
+    if (plane < 0.0)
+    {
+      if (!double_sided) return;
+      std::swap(b, c);
+      normal = -normal;
+      plane = -plane;
+    }
+
+    // A beam passes through the triangle iff it lies on the inner side of the three planes
+    // spanned by the origin and each edge.
+    const Vec3 edge_ab = a.cross(b);
+    const Vec3 edge_bc = b.cross(c);
+    const Vec3 edge_ca = c.cross(a);
+
+    if (plane == 0.0)
+    {
+      // The sensor lies in the triangle's plane. If it lies on the triangle itself,
+      // moller_trumbore reports a hit at range 0 for every beam on the front side, or on either
+      // side of a double-sided scene.
+      const double ab = edge_ab.dot(normal), bc = edge_bc.dot(normal), ca = edge_ca.dot(normal);
+      const bool on_triangle = (ab >= 0.0 && bc >= 0.0 && ca >= 0.0) ||
+                               (double_sided && ab <= 0.0 && bc <= 0.0 && ca <= 0.0);
+      if (!on_triangle || t_min > 0.0) return;
+
+      for (int i = 0; i < N; ++i)
+      {
+        for (int j = 0; j < M; ++j)
+        {
+          const double det = -normal.dot(beam(i, j));
+          if ((double_sided ? std::abs(det) : det) >= percepto::common::EPSILON)
+          {
+            depth_[static_cast<size_t>(i) * M + j] = 0.0;
+          }
+        }
+      }
+      return;
+    }
+
+    for_each_beam(tri.bounds(),
+                  [&](int i, int j)
+                  {
+                    const Vec3 d = beam(i, j);
+                    if (d.dot(edge_ab) > 0.0 || d.dot(edge_bc) > 0.0 || d.dot(edge_ca) > 0.0)
+                    {
+                      return;
+                    }
+
+                    // -normal·d is moller_trumbore's determinant: reject grazing beams alike.
+                    const double det = -normal.dot(d);
+                    if (det < percepto::common::EPSILON) return;
+
+                    const double t = plane / det;
+                    double& depth = depth_[static_cast<size_t>(i) * M + j];
+                    if (t >= t_min && t <= t_max && t < depth) depth = t;
+                  });
+  };
+
+  auto rasterize_sphere = [&](const Sphere& sphere)
+  {
+    for_each_beam(sphere.bounds(),
+                  [&](int i, int j)
+                  {
+                    HitRecord rec;
+                    double& depth = depth_[static_cast<size_t>(i) * M + j];
+                    if (sphere.intersect(Ray(origin, beam(i, j), t_min, t_max), rec) &&
+                        rec.t < depth)
+                    {
+                      depth = rec.t;
+                    }
+                  });
+  };
+
+  // The ray tracer culls an instance's back faces in mesh space, so a mirrored instance keeps its
+  // faces pointing outward; reversing the winding of its world triangles does the same here.
+  auto rasterize_instance = [&](const percepto::geometry::Instance& instance)
+  {
+    const Transform to_world = instance.object_to_world();
+    const bool mirrored = to_world.determinant() < 0.0;
+    const auto& mesh = instance.mesh().mesh();
+    for (size_t t = 0; t < mesh.triangle_count(); ++t)
+    {
+      const Vec3 v0 = to_world.point(mesh.vertex(t, 0));
+      const Vec3 v1 = to_world.point(mesh.vertex(t, 1));
+      const Vec3 v2 = to_world.point(mesh.vertex(t, 2));
+      rasterize_triangle(mirrored ? Triangle(v0, v2, v1) : Triangle(v0, v1, v2));
+    }
+  };
+
+  auto rasterize_object = [&](const auto& obj)
+  {
+    using Type = std::decay_t<decltype(obj)>;
+    if constexpr (std::is_same_v<Type, Triangle>)
+    {
+      rasterize_triangle(obj);
+    }
+    else if constexpr (std::is_same_v<Type, percepto::geometry::Instance>)
+    {
+      rasterize_instance(obj);
+    }
+    else
+    {
+      rasterize_sphere(obj);
+    }
+  };
+
+  for (percepto::core::Scene::ObjectHandle handle = 0; handle < scene.objects().size();
+       ++handle)
+  {
+    if (scene.is_removed(handle)) continue;
+    if (scene.is_moving(handle))
+    {
+      // An instance flattened at mid-frame by a mirroring motion has nothing to draw.
+      try
+      {
+        std::visit(rasterize_object, scene.object_at(handle, 0.5));
+      }
+      catch (const std::invalid_argument&)
+      {
+      }
+    }
+    else
+    {
+      scene.objects().visit(handle, rasterize_object);
+    }
+  }
+  for (const auto& mesh : scene.meshes())
+  {
+    for (size_t t = 0; t < mesh.triangle_count(); ++t) rasterize_triangle(mesh.triangle(t));
+  }
+
+  // Resolve the z-buffer into the frame.
+  int hits = 0;
+  for (int i = 0; i < N; ++i)
+  {
+    for (int j = 0; j < M; ++j)
+    {
+      const double t = depth_[static_cast<size_t>(i) * M + j];
+      if (t == std::numeric_limits<double>::infinity()) continue;
+
+      ++hits;
+      scan.range(i, j) = static_cast<float>(t);
+      scan.point(i, j) = origin + t * beam(i, j);
+    }
+  }
+  return hits;
+}
+}  // namespace percepto::lidar
@@ -1,8 +1,14 @@
+#include <algorithm>
+#include <chrono>
 #include <limits>
+#include <memory>
+#include <numeric>
 #include <vector>
 
+#include "percepto/common/thread_pool.h"
 #include "percepto/common/types.h"
 #include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
 #include "percepto/core/vec3.h"
 #include "percepto/io/logger.h"
 #include "percepto/lidar/simulator.h"
@@ -11,7 +17,130 @@ namespace percepto::lidar
 {
 using namespace percepto::lidar;
 
+void LidarSimulator::set_scan_options(const ScanOptions& options)
+{
+  options_ = options;
+  options_.azimuth_tile_size = std::max(1, options_.azimuth_tile_size);
+  options_.packet_size = std::clamp(options_.packet_size, 0, core::RayPacket::kMaxSize);
+
+  const int threads = common::ThreadPool::resolve_thread_count(options_.thread_count);
+  if (threads <= 1)
+  {
+    pool_.reset();
+  }
+  else if (!pool_ || pool_->size() != threads)
+  {
+    pool_ = std::make_unique<common::ThreadPool>(threads);
+  }
+
+#if PERCEPTO_ENABLE_RAY_TRACE
+  ray_logger_ = options_.trace_rays ? get_percepto_ray_logger(options_.ray_trace_file) : nullptr;
+#endif
+}
+
+int LidarSimulator::trace_azimuth_range(common::FrameScan& scan, int rev, int first, int last)
+{
+  auto& le = emitter();
+  auto& sc = scene();
+  const int M = scan.channel_count;
+  const bool table = le.has_direction_table();
+
+  int hits = 0;
+  for (int i = first; i < last; ++i)
+  {
+    for (int j = 0; j < M; ++j)
+    {
+      auto ray = table ? le.ray(i, j) : le.get_ray(i, j);
+
+      HitRecord rec;
+      bool hit = sc.intersect_sensor_ray(i, j, ray, rec);
+
+      if (hit)
+      {
+        hits++;
+        scan.range(i, j) = rec.t;
+        scan.point(i, j) = ray.at(rec.t);
+      }
+
+      PERCEPTO_RAY_TRACE(ray_logger_, "rev={} azimuth_index={} channel={} azimuth={:.6f} "
+                         "elevation={:.6f} hit={} range={:.4f}",
+                         rev, i, j, scan.azimuth_angles[i], scan.elevation_angles[j], hit,
+                         hit ? rec.t : 0.0);
+    }
+  }
+  return hits;
+}
+
+int LidarSimulator::trace_azimuth_range_packets(common::FrameScan& scan, int rev, int first,
+                                                int last)
+{
+  auto& le = emitter();
+  auto& sc = scene();
+  const int M = scan.channel_count;
+  const int P = options_.packet_size;
+  const bool table = le.has_direction_table();
+
+  core::RayPacket packet;
+  HitRecord records[core::RayPacket::kMaxSize];
+  int hits = 0;
+
+  // Traces the `count` beams starting at (i0, j0) and stepping by (di, dj) as one packet. All
+  // beams share the sensor origin, so any run of neighbouring beams is a valid packet.
+  auto trace_packet = [&](int i0, int j0, int di, int dj, int count)
+  {
+    packet.clear();
+    for (int k = 0; k < count; ++k)
+    {
+      const int i = i0 + k * di, j = j0 + k * dj;
+      packet.push(table ? le.ray(i, j) : le.get_ray(i, j));
+    }
+
+    const uint32_t hit_mask = sc.intersect_packet(packet, records);
+    for (int k = 0; k < count; ++k)
+    {
+      const int i = i0 + k * di, j = j0 + k * dj;
+      const bool hit = hit_mask & (1u << k);
+      if (hit)
+      {
+        hits++;
+        scan.range(i, j) = records[k].t;
+        scan.point(i, j) = packet.ray(k).at(records[k].t);
+      }
+
+      PERCEPTO_RAY_TRACE(ray_logger_, "rev={} azimuth_index={} channel={} azimuth={:.6f} "
+                         "elevation={:.6f} hit={} range={:.4f}",
+                         rev, i, j, scan.azimuth_angles[i], scan.elevation_angles[j], hit,
+                         hit ? records[k].t : 0.0);
+    }
+  };
+
+  if (options_.packet_layout == common::PacketLayout::Column)
+  {
+    for (int i = first; i < last; ++i)
+    {
+      for (int j0 = 0; j0 < M; j0 += P) trace_packet(i, j0, 0, 1, std::min(P, M - j0));
+    }
+  }
+  else
+  {
+    // Azimuth steps are usually far closer together than channels, so runs along a row keep
+    // the packet tighter than a column does.
+    for (int j = 0; j < M; ++j)
+    {
+      for (int i0 = first; i0 < last; i0 += P) trace_packet(i0, j, 1, 0, std::min(P, last - i0));
+    }
+  }
+  return hits;
+}
+
 std::vector<common::FrameScan> LidarSimulator::run_scan(int revs)
+{
+  std::vector<common::FrameScan> frames;
+  run_scan(revs, frames);
+  return frames;
+}
+
+void LidarSimulator::run_scan(int revs, std::vector<common::FrameScan>& frames)
 {
   auto logger = get_percepto_logger();
 
@@ -21,46 +150,106 @@ std::vector<common::FrameScan> LidarSimulator::run_scan(int revs)
   int N = le.azimuth_steps();
   int M = int(le.elevation_angles().size());
 
-  float inf = std::numeric_limits<float>::infinity();
-  Vec3 invalid{inf, inf, inf};
+  frame_pool_.release(frames);
+  frames.reserve(revs);
+
+  // The rasterizer reads the scene's objects directly and needs none of its ray structures.
+  const bool rasterize = options_.backend == common::ScanBackend::Rasterize;
+  if (!rasterize)
+  {
+    // Built once; later revolutions and scans reuse it until the emitter is reconfigured.
+    if (options_.direction_table)
+    {
+      le.enable_direction_table();
+    }
+    else
+    {
+      le.disable_direction_table();
+    }
+
+    // The emitter's origin and angle tables are fixed, so the scene can bin its primitives per
+    // ray. The layout is only copied in when it changed.
+    if (options_.angular_grid)
+    {
+      const auto& layout = sc.angular_grid_layout();
+      if (!sc.has_angular_grid() || !(layout.origin == le.origin()) ||
+          layout.azimuth_angles != le.azimuth_angles() ||
+          layout.elevation_angles != le.elevation_angles())
+      {
+        sc.set_angular_grid({le.origin(), le.azimuth_angles(), le.elevation_angles()});
+      }
+    }
+    else
+    {
+      sc.clear_angular_grid();
+    }
+
+    // Build the acceleration structures up front: worker threads must only read the scene.
+    sc.commit();
+  }
 
-  std::vector<common::FrameScan> scans;
-  scans.reserve(revs);
+  // The angular grid already narrows every ray to its own cell; packets only pay off through the
+  // shared acceleration structure.
+  const bool packets = options_.packet_size > 1 && !options_.angular_grid;
+  const int tile_size = options_.azimuth_tile_size;
+  const int tile_count = (N + tile_size - 1) / tile_size;
+  tile_hits_.resize(tile_count);
 
   for (int rev = 0; rev < revs; ++rev)
   {
-    common::FrameScan scan(N, M);
+    const auto frame_start = std::chrono::steady_clock::now();
+
+    common::FrameScan scan = frame_pool_.acquire(N, M);
     scan.azimuth_angles = le.azimuth_angles();
     scan.elevation_angles = le.elevation_angles();
+    // Revolutions follow one another without gaps; rays carry their firing phase themselves.
+    scan.timestamp = scan_clock_;
+    for (int i = 0; i < N; ++i) scan.firing_times[i] = scan.timestamp + le.firing_time(i);
+    scan_clock_ += le.revolution_period();
 
-    logger->info("Revolution {}/{} complete", rev + 1, revs);
-    for (int i = 0; i < N; ++i)
+    if (rasterize)
+    {
+      scan.hits = rasterizer_.rasterize(sc, le, scan);
+    }
+    else
     {
-      for (int j = 0; j < M; ++j)
+      // Every ray writes only its own cell and hits are summed per tile, so the frame is
+      // identical whichever thread traces which tile.
+      std::fill(tile_hits_.begin(), tile_hits_.end(), 0);
+      auto trace_tile = [&](size_t tile)
       {
-        auto ray = le.get_ray(i, j);
-
-        HitRecord rec;
-        bool hit = sc.intersect(ray, rec);
-
-        if (hit)
-        {
-          scan.hits++;
-          scan.ranges[i][j] = rec.t;
-          scan.points[i][j] = rec.point;
+        const int first = static_cast<int>(tile) * tile_size;
+        const int last = std::min(N, first + tile_size);
+        tile_hits_[tile] = packets ? trace_azimuth_range_packets(scan, rev, first, last)
+                                   : trace_azimuth_range(scan, rev, first, last);
+      };
 
-          logger->info("Hit @ azimuth={:.2f}°, channel={} (elev={:.2f}°) → distance={:.3f} m",
-                       scan.azimuth_angles[i], j, le.elevation_angles()[j], rec.t);
-        }
+      if (pool_)
+      {
+        // Captures a single pointer, so the std::function stores it inline without allocating.
+        auto* task = &trace_tile;
+        pool_->parallel_for(tile_count, [task](size_t tile) { (*task)(tile); });
+      }
+      else
+      {
+        for (int tile = 0; tile < tile_count; ++tile) trace_tile(tile);
       }
+      scan.hits = std::accumulate(tile_hits_.begin(), tile_hits_.end(), 0);
     }
 
-    scans.push_back(std::move(scan));
+    // One structured record per frame instead of a line per hit.
+    const double runtime_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - frame_start).count();
+    const long rays = static_cast<long>(N) * M;
+    logger->info("frame rev={}/{} backend={} rays={} hits={} runtime_ms={:.3f} "
+                 "rays_per_sec={:.0f}",
+                 rev + 1, revs, rasterize ? "rasterize" : "raytrace", rays, scan.hits,
+                 runtime_s * 1e3, runtime_s > 0.0 ? rays / runtime_s : 0.0);
+    frames.push_back(std::move(scan));
   }
 
+  if (ray_logger_) ray_logger_->flush();
   logger->info("Simulation complete");
-
-  return scans;
 }
 
-}  // namespace percepto::lidar
\ No newline at end of file
+}  // namespace percepto::lidar
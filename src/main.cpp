@@ -8,11 +8,14 @@
 #include <tuple>
 #include <vector>
 
+#include "percepto/accel/bvh.h"
 #include "percepto/common/config_loader.h"
+#include "percepto/common/cpu_features.h"
 #include "percepto/core/scene.h"
 #include "percepto/geometry/triangle.h"
-#include "percepto/io/csv_parser.h"
+#include "percepto/io/bvh_cache.h"
 #include "percepto/io/logger.h"
+#include "percepto/io/scene_loader.h"
 #include "percepto/lidar/emitter.h"
 #include "percepto/lidar/simulator.h"
 
@@ -30,13 +33,19 @@ int main(int argc, char** argv)
   // ----------------------------------------
   CLI::App app{
       "Percepto LiDAR Ray Tracing Simulator.\n"
-      "Simulates realistic LiDAR scans from triangle mesh scenes (.csv/.obj)."};
+      "Simulates realistic LiDAR scans from triangle mesh scenes (.csv/.pscn)."};
 
   std::string filepath;
   app.add_option("-f,--filepath", filepath,
-                 "Path to the input geometry file (.csv or .obj) to convert into triangle mesh")
+                 "Path to the input geometry file (.csv, or .pscn written by percepto_convert)")
       ->required();
 
+  std::string isa;
+  app.add_option("--isa", isa,
+                 "Run the SIMD kernels with this instruction set instead of the best one the CPU "
+                 "supports, e.g. to benchmark them against each other")
+      ->check(CLI::IsMember({"scalar", "avx2", "avx512"}));
+
   try
   {
     app.parse(argc, argv);
@@ -48,14 +57,29 @@ int main(int argc, char** argv)
 
   auto logger = get_percepto_logger();
 
+  if (!isa.empty())
+  {
+    try
+    {
+      percepto::common::set_isa(percepto::common::parse_isa(isa));
+    }
+    catch (const std::exception& e)
+    {
+      logger->error("{}", e.what());
+      return EXIT_FAILURE;
+    }
+  }
+  logger->info("SIMD kernels: {} (detected {})",
+               percepto::common::isa_name(percepto::common::active_isa()),
+               percepto::common::isa_name(percepto::common::detect_isa()));
+
   // ----------------------------------------
   // 🧱 Scene Loading
   // ----------------------------------------
   std::unique_ptr<percepto::core::Scene> scene_ptr;
   try
   {
-    percepto::io::CsvParser parser;
-    scene_ptr = parser.load_scene_from_csv(filepath);
+    scene_ptr = percepto::io::load_scene(filepath);
     logger->info("Parsed {} objects from '{}'", scene_ptr->size(), filepath);
   }
   catch (const std::exception& e)
@@ -68,9 +92,11 @@ int main(int argc, char** argv)
   // ⚙️ Configuration Loading
   // ----------------------------------------
   percepto::common::LiDARConfig lidar_cfg;
+  percepto::common::RayTracerConfig tracer_cfg;
   try
   {
     lidar_cfg = percepto::common::ConfigLoader::loadLiDARConfig();
+    tracer_cfg = percepto::common::ConfigLoader::loadRayTracerConfig();
   }
   catch (const std::exception& e)
   {
@@ -81,14 +107,65 @@ int main(int argc, char** argv)
   logger->info("Loaded config: azimuth_steps = {}", lidar_cfg.azimuth_steps);
   logger->info("Elevation angles: [{}]", fmt::join(lidar_cfg.elevation_angles, ", "));
 
+  scene_ptr->set_accelerator(tracer_cfg.accelerator);
+  scene_ptr->set_cull_mode(tracer_cfg.cull_mode);
+  scene_ptr->set_precision(tracer_cfg.precision);
+  auto bvh_options = scene_ptr->bvh_options();
+  bvh_options.builder = tracer_cfg.bvh_builder;
+  // Treelets only apply to LBVH; leaving them alone for SAH keeps a prebuilt tree's options.
+  if (tracer_cfg.bvh_builder == percepto::common::BvhBuilder::Lbvh)
+  {
+    bvh_options.treelet_optimization = tracer_cfg.bvh_treelets;
+  }
+  scene_ptr->set_bvh_options(bvh_options);
+  if (tracer_cfg.bvh_cache)
+  {
+    percepto::io::commit_with_bvh_cache(*scene_ptr, percepto::io::bvh_cache_path(filepath));
+  }
+  else
+  {
+    scene_ptr->commit();
+  }
+  const auto memory = scene_ptr->memory_usage();
+  logger->info("Scene memory: {:.1f} MB geometry, {:.1f} MB acceleration",
+               memory.geometry() / (1024.0 * 1024.0), memory.acceleration / (1024.0 * 1024.0));
+  if (percepto::common::uses_bvh(tracer_cfg.accelerator))
+  {
+    logger->info("Built BVH: {} nodes, depth {}", scene_ptr->bvh().nodes().size(),
+                 scene_ptr->bvh().depth());
+  }
+  const bool single = tracer_cfg.precision == percepto::common::Precision::Single;
+  if (tracer_cfg.accelerator == percepto::common::AcceleratorType::Bvh4)
+  {
+    logger->info("Collapsed to {} 4-wide nodes",
+                 single ? scene_ptr->bvh4f().nodes().size() : scene_ptr->bvh4().nodes().size());
+  }
+  if (tracer_cfg.accelerator == percepto::common::AcceleratorType::Bvh8)
+  {
+    logger->info("Collapsed to {} 8-wide nodes",
+                 single ? scene_ptr->bvh8f().nodes().size() : scene_ptr->bvh8().nodes().size());
+  }
+
   // ----------------------------------------
   // 📡 LiDAR Setup & Simulation
   // ----------------------------------------
   auto emitter = std::make_unique<percepto::lidar::LidarEmitter>(std::move(lidar_cfg));
   percepto::lidar::LidarSimulator simulator(std::move(emitter), std::move(scene_ptr));
+  percepto::lidar::ScanOptions scan_options;
+  scan_options.thread_count = tracer_cfg.thread_count;
+  scan_options.azimuth_tile_size = tracer_cfg.azimuth_tile_size;
+  scan_options.angular_grid = tracer_cfg.angular_grid;
+  scan_options.direction_table = tracer_cfg.direction_table;
+  scan_options.packet_size = tracer_cfg.packet_size;
+  scan_options.packet_layout = tracer_cfg.packet_layout;
+  scan_options.backend = tracer_cfg.scan_backend;
+  scan_options.trace_rays = tracer_cfg.trace_rays;
+  scan_options.ray_trace_file = tracer_cfg.ray_trace_file;
+  simulator.set_scan_options(scan_options);
 
   auto scans = simulator.run_scan();
   logger->info("Scan complete");
 
+  spdlog::shutdown();  // Drain the asynchronous ray trace before exiting.
   return EXIT_SUCCESS;
 }
@@ -1,4 +1,4 @@
-#include <optional>
+#include <cmath>
 
 #include "percepto/common/types.h"
 #include "percepto/core/ray.h"
@@ -11,62 +11,97 @@ namespace percepto::math::intersection
 {
 
 /**
- * @brief   Compute ray–triangle intersection using the Möller–Trumbore algorithm (back-face culling
- * enabled).
+ * @brief   Compute ray–triangle intersection using the Möller–Trumbore algorithm.
  *
  * Given three triangle vertices `v0, v1, v2` (assumed CCW for front face) and a `ray`, this
- * function returns a `Hit` containing `(t, u, v)` if the ray intersects the triangle’s front face.
- * If the ray is nearly parallel to the triangle, strikes its back face, or the triangle is
- * degenerate, the function returns `std::nullopt`.
+ * function reports `(t, u, v)` if the ray intersects the triangle. If the ray is nearly parallel
+ * to the triangle, strikes its back face while `kCull` culls back faces, or the triangle is
+ * degenerate, there is no hit.
  *
  * Algorithm details:
  * 1. Compute edges: `edge1 = v1 – v0`, `edge2 = v2 – v0`.
  * 2. Form `p = ray.direction() × edge2`.
  * 3. Compute determinant `det = edge1 · p`.
  *    - If `|det| < EPSILON`, ray is parallel or triangle is degenerate → no hit.
- *    - If `det < EPSILON`, ray is hitting the back face (or nearly parallel from the other side) →
- * no hit.
+ *    - If `det < EPSILON` with back faces culled, ray is hitting the back face → no hit.
  * 4. Compute `invDet = 1/det`.
  * 5. Compute barycentric `u = ( (ray.origin() – v0) · p ) * invDet`. If `u < 0 || u > 1`, no hit.
  * 6. Compute `q = (ray.origin() – v0) × edge1`.
  * 7. Compute barycentric `v = ( ray.direction() · q ) * invDet`. If `v < 0 || (u + v) > 1`, no hit.
- * 8. Compute `t = ( edge2 · q ) * invDet`. If `t < EPSILON` (behind origin or too close), no hit.
- * 9. Otherwise, return `Hit{t, u, v}`.
+ * 8. Compute `t = ( edge2 · q ) * invDet`. If `t` is outside [tMin, tMax], no hit.
+ * 9. Otherwise, report `(t, u, v)`.
  *
- * @param[in]  v0, v1, v2   The triangle’s three vertices (wound CCW on the front face).
- * @param[in]  ray         The ray to test (origin, direction).
- * @return `std::optional<Hit>` containing `(t, u, v)` if a valid front-face intersection occurs;
- *         `std::nullopt` otherwise.
+ * A back-face hit divides by a negative determinant, so u, v and t come out just as they do for
+ * the front face. The steps are written per component, in the order `moller_trumbore_block`
+ * evaluates them, so that every kernel returns bit-identical hits in double precision.
  */
-std::optional<TriangleHitResult> moller_trumbore(const Vec3& v0, const Vec3& v1, const Vec3& v2,
-                                                 const Ray& ray)
+template <common::CullMode kCull, common::HitQuery kQuery, typename T>
+bool moller_trumbore_test(const Vec3& v0, const Vec3& v1, const Vec3& v2, const Ray& ray,
+                          TriangleHitResult& hit)
 {
-  Vec3 edgeAB = v1 - v0;  // A→B
-  Vec3 edgeAC = v2 - v0;  // A→C
+  const T ax = static_cast<T>(v0.x), ay = static_cast<T>(v0.y), az = static_cast<T>(v0.z);
+  const T dx = static_cast<T>(ray.direction().x), dy = static_cast<T>(ray.direction().y),
+          dz = static_cast<T>(ray.direction().z);
 
-  Vec3 originToA = ray.origin() - v0;
+  // Edges A→B and A→C.
+  const T e1x = static_cast<T>(v1.x) - ax, e1y = static_cast<T>(v1.y) - ay,
+          e1z = static_cast<T>(v1.z) - az;
+  const T e2x = static_cast<T>(v2.x) - ax, e2y = static_cast<T>(v2.y) - ay,
+          e2z = static_cast<T>(v2.z) - az;
 
-  // Calculate p = D × edgeAC, which is perpendicular to edgeAB
-  Vec3 p = ray.direction().cross(edgeAC);
-  double det = edgeAB.dot(p);
+  // p = D × edgeAC, which is perpendicular to edgeAB
+  const T px = dy * e2z - dz * e2y;
+  const T py = dz * e2x - dx * e2z;
+  const T pz = dx * e2y - dy * e2x;
+  const T det = e1x * px + e1y * py + e1z * pz;
 
   // If det is near zero, the ray is parallel to the triangle plane
-  if (det < common::EPSILON) return std::nullopt;
+  const T epsilon = static_cast<T>(common::EPSILON);
+  if constexpr (kCull == common::CullMode::Back)
+  {
+    if (det < epsilon) return false;
+  }
+  else
+  {
+    if (std::abs(det) < epsilon) return false;
+  }
 
-  double invDet = 1.0 / det;
+  const T inv_det = T(1) / det;
+  const T sx = static_cast<T>(ray.origin().x) - ax, sy = static_cast<T>(ray.origin().y) - ay,
+          sz = static_cast<T>(ray.origin().z) - az;
 
-  double u = originToA.dot(p) * invDet;
-  if (u < 0.0 || u > 1.0) return std::nullopt;  // Intersection outside the triangle
+  const T u = (sx * px + sy * py + sz * pz) * inv_det;
+  if (u < T(0) || u > T(1)) return false;  // Intersection outside the triangle
 
-  Vec3 q = originToA.cross(edgeAB);
+  const T qx = sy * e1z - sz * e1y;
+  const T qy = sz * e1x - sx * e1z;
+  const T qz = sx * e1y - sy * e1x;
 
-  double v = ray.direction().dot(q) * invDet;
-  if (v < 0.0 || u + v > 1.0) return std::nullopt;  // Intersection outside the triangle
+  const T v = (dx * qx + dy * qy + dz * qz) * inv_det;
+  if (v < T(0) || u + v > T(1)) return false;  // Intersection outside the triangle
 
-  double t = edgeAC.dot(q) * invDet;
-  if (t < ray.tMin() || t > ray.tMax())
-    return std::nullopt;  // t is outside the valid [tMin, tMax] range (behind origin or too far)
+  // t is outside the valid [tMin, tMax] range (behind origin or too far)
+  const T t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+  if (t < static_cast<T>(ray.tMin()) || t > static_cast<T>(ray.tMax())) return false;
 
-  return TriangleHitResult{t, u, v};
+  if constexpr (kQuery == common::HitQuery::Closest) hit = TriangleHitResult{t, u, v};
+  return true;
 }
+
+template bool moller_trumbore_test<common::CullMode::Back, common::HitQuery::Closest, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::Back, common::HitQuery::Any, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::None, common::HitQuery::Closest, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::None, common::HitQuery::Any, double>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::Back, common::HitQuery::Closest, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::Back, common::HitQuery::Any, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::None, common::HitQuery::Closest, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
+template bool moller_trumbore_test<common::CullMode::None, common::HitQuery::Any, float>(
+    const Vec3&, const Vec3&, const Vec3&, const Ray&, TriangleHitResult&);
 }  // namespace percepto::math::intersection
@@ -0,0 +1,677 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "percepto/common/cpu_features.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/core/vec3f.h"
+#include "percepto/geometry/triangle_block.h"
+#include "percepto/math/intersection/moller_trumbore_block.h"
+
+using percepto::common::CullMode, percepto::common::HitQuery, percepto::common::Isa,
+    percepto::common::TriangleHitResult;
+using percepto::core::Ray, percepto::core::Vec3, percepto::core::Vec3f;
+using percepto::geometry::FloatTriangleBlock, percepto::geometry::TriangleBlock;
+
+namespace percepto::math::intersection
+{
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr float kInfF = std::numeric_limits<float>::infinity();
+
+// Single-precision barycentrics may stray this far outside [0, 1] and still hit. Rounding can
+// push a ray through the edge two triangles share just outside both; the slack, about 80 float
+// ulps of 1, lets one of them catch it, and widens each triangle by a negligible rim.
+constexpr float kEdgeSlack = 1e-5f;
+
+/**
+ * Per-lane outputs of one block test. Lanes that miss get t = +inf, so the closest hit is a
+ * plain minimum over `t`.
+ */
+template <int W>
+struct alignas(64) LaneResults
+{
+  double t[W];
+  double u[W];
+  double v[W];
+};
+
+// The lane tests below return the mask of lanes hit. The closest-hit kernel also has them store
+// every lane's (t, u, v); the any-hit kernel passes HitQuery::Any and no results, and only reads
+// the mask. Without culling the determinant test takes its magnitude, so back faces pass too.
+
+// Scalar reference for one lane; mirrors moller_trumbore() operation for operation.
+template <HitQuery kQuery, CullMode kCull, int W>
+inline uint32_t test_lane_scalar(const TriangleBlock<W>& b, int lane, const Vec3& o,
+                                 const Vec3& d, double t_min, double t_max, LaneResults<W>* out)
+{
+  if constexpr (kQuery == HitQuery::Closest) out->t[lane] = kInf;
+
+  const double e1x = b.e1x[lane], e1y = b.e1y[lane], e1z = b.e1z[lane];
+  const double e2x = b.e2x[lane], e2y = b.e2y[lane], e2z = b.e2z[lane];
+
+  const double px = d.y * e2z - d.z * e2y;
+  const double py = d.z * e2x - d.x * e2z;
+  const double pz = d.x * e2y - d.y * e2x;
+  const double det = e1x * px + e1y * py + e1z * pz;
+  if ((kCull == CullMode::Back ? det : std::abs(det)) < common::EPSILON) return 0;
+
+  const double inv_det = 1.0 / det;
+  const double sx = o.x - b.v0x[lane], sy = o.y - b.v0y[lane], sz = o.z - b.v0z[lane];
+
+  const double u = (sx * px + sy * py + sz * pz) * inv_det;
+  if (u < 0.0 || u > 1.0) return 0;
+
+  const double qx = sy * e1z - sz * e1y;
+  const double qy = sz * e1x - sx * e1z;
+  const double qz = sx * e1y - sy * e1x;
+
+  const double v = (d.x * qx + d.y * qy + d.z * qz) * inv_det;
+  if (v < 0.0 || u + v > 1.0) return 0;
+
+  const double t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+  if (t < t_min || t > t_max) return 0;
+
+  if constexpr (kQuery == HitQuery::Closest)
+  {
+    out->t[lane] = t;
+    out->u[lane] = u;
+    out->v[lane] = v;
+  }
+  return 1u << lane;
+}
+
+#if PERCEPTO_X86_SIMD
+// Tests lanes [base, base + 8).
+template <HitQuery kQuery, CullMode kCull, int W>
+PERCEPTO_TARGET_AVX512 inline uint32_t test_lanes_avx512(const TriangleBlock<W>& b, int base,
+                                                         const Vec3& o, const Vec3& d, double t_min,
+                                                         double t_max, LaneResults<W>* out)
+{
+  const __m512d dx = _mm512_set1_pd(d.x), dy = _mm512_set1_pd(d.y), dz = _mm512_set1_pd(d.z);
+  const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0);
+
+  const __m512d e1x = _mm512_loadu_pd(b.e1x + base), e1y = _mm512_loadu_pd(b.e1y + base),
+                e1z = _mm512_loadu_pd(b.e1z + base);
+  const __m512d e2x = _mm512_loadu_pd(b.e2x + base), e2y = _mm512_loadu_pd(b.e2y + base),
+                e2z = _mm512_loadu_pd(b.e2z + base);
+
+  const __m512d px = _mm512_sub_pd(_mm512_mul_pd(dy, e2z), _mm512_mul_pd(dz, e2y));
+  const __m512d py = _mm512_sub_pd(_mm512_mul_pd(dz, e2x), _mm512_mul_pd(dx, e2z));
+  const __m512d pz = _mm512_sub_pd(_mm512_mul_pd(dx, e2y), _mm512_mul_pd(dy, e2x));
+  const __m512d det = _mm512_add_pd(
+      _mm512_add_pd(_mm512_mul_pd(e1x, px), _mm512_mul_pd(e1y, py)), _mm512_mul_pd(e1z, pz));
+  __mmask8 ok = _mm512_cmp_pd_mask(kCull == CullMode::Back ? det : _mm512_abs_pd(det),
+                                   _mm512_set1_pd(common::EPSILON), _CMP_GE_OQ);
+
+  const __m512d inv_det = _mm512_div_pd(one, det);
+  const __m512d sx = _mm512_sub_pd(_mm512_set1_pd(o.x), _mm512_loadu_pd(b.v0x + base));
+  const __m512d sy = _mm512_sub_pd(_mm512_set1_pd(o.y), _mm512_loadu_pd(b.v0y + base));
+  const __m512d sz = _mm512_sub_pd(_mm512_set1_pd(o.z), _mm512_loadu_pd(b.v0z + base));
+
+  const __m512d u = _mm512_mul_pd(
+      _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(sx, px), _mm512_mul_pd(sy, py)),
+                    _mm512_mul_pd(sz, pz)),
+      inv_det);
+  ok &= _mm512_cmp_pd_mask(u, zero, _CMP_GE_OQ) & _mm512_cmp_pd_mask(u, one, _CMP_LE_OQ);
+  if (!ok)
+  {
+    if constexpr (kQuery == HitQuery::Closest)
+    {
+      _mm512_storeu_pd(out->t + base, _mm512_set1_pd(kInf));
+    }
+    return 0;
+  }
+
+  const __m512d qx = _mm512_sub_pd(_mm512_mul_pd(sy, e1z), _mm512_mul_pd(sz, e1y));
+  const __m512d qy = _mm512_sub_pd(_mm512_mul_pd(sz, e1x), _mm512_mul_pd(sx, e1z));
+  const __m512d qz = _mm512_sub_pd(_mm512_mul_pd(sx, e1y), _mm512_mul_pd(sy, e1x));
+
+  const __m512d v = _mm512_mul_pd(
+      _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, qx), _mm512_mul_pd(dy, qy)),
+                    _mm512_mul_pd(dz, qz)),
+      inv_det);
+  ok &= _mm512_cmp_pd_mask(v, zero, _CMP_GE_OQ) &
+        _mm512_cmp_pd_mask(_mm512_add_pd(u, v), one, _CMP_LE_OQ);
+
+  const __m512d t = _mm512_mul_pd(
+      _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(e2x, qx), _mm512_mul_pd(e2y, qy)),
+                    _mm512_mul_pd(e2z, qz)),
+      inv_det);
+  ok &= _mm512_cmp_pd_mask(t, _mm512_set1_pd(t_min), _CMP_GE_OQ) &
+        _mm512_cmp_pd_mask(t, _mm512_set1_pd(t_max), _CMP_LE_OQ);
+
+  if constexpr (kQuery == HitQuery::Closest)
+  {
+    _mm512_storeu_pd(out->t + base, _mm512_mask_blend_pd(ok, _mm512_set1_pd(kInf), t));
+    _mm512_storeu_pd(out->u + base, u);
+    _mm512_storeu_pd(out->v + base, v);
+  }
+  return static_cast<uint32_t>(ok) << base;
+}
+
+// Tests lanes [base, base + 4).
+template <HitQuery kQuery, CullMode kCull, int W>
+PERCEPTO_TARGET_AVX2 inline uint32_t test_lanes_avx2(const TriangleBlock<W>& b, int base,
+                                                     const Vec3& o, const Vec3& d, double t_min,
+                                                     double t_max, LaneResults<W>* out)
+{
+  const __m256d dx = _mm256_set1_pd(d.x), dy = _mm256_set1_pd(d.y), dz = _mm256_set1_pd(d.z);
+  const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+
+  const __m256d e1x = _mm256_loadu_pd(b.e1x + base), e1y = _mm256_loadu_pd(b.e1y + base),
+                e1z = _mm256_loadu_pd(b.e1z + base);
+  const __m256d e2x = _mm256_loadu_pd(b.e2x + base), e2y = _mm256_loadu_pd(b.e2y + base),
+                e2z = _mm256_loadu_pd(b.e2z + base);
+
+  const __m256d px = _mm256_sub_pd(_mm256_mul_pd(dy, e2z), _mm256_mul_pd(dz, e2y));
+  const __m256d py = _mm256_sub_pd(_mm256_mul_pd(dz, e2x), _mm256_mul_pd(dx, e2z));
+  const __m256d pz = _mm256_sub_pd(_mm256_mul_pd(dx, e2y), _mm256_mul_pd(dy, e2x));
+  const __m256d det = _mm256_add_pd(
+      _mm256_add_pd(_mm256_mul_pd(e1x, px), _mm256_mul_pd(e1y, py)), _mm256_mul_pd(e1z, pz));
+  __m256d ok = _mm256_cmp_pd(
+      kCull == CullMode::Back ? det : _mm256_andnot_pd(_mm256_set1_pd(-0.0), det),
+      _mm256_set1_pd(common::EPSILON), _CMP_GE_OQ);
+
+  const __m256d inv_det = _mm256_div_pd(one, det);
+  const __m256d sx = _mm256_sub_pd(_mm256_set1_pd(o.x), _mm256_loadu_pd(b.v0x + base));
+  const __m256d sy = _mm256_sub_pd(_mm256_set1_pd(o.y), _mm256_loadu_pd(b.v0y + base));
+  const __m256d sz = _mm256_sub_pd(_mm256_set1_pd(o.z), _mm256_loadu_pd(b.v0z + base));
+
+  const __m256d u = _mm256_mul_pd(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(sx, px), _mm256_mul_pd(sy, py)),
+                    _mm256_mul_pd(sz, pz)),
+      inv_det);
+  ok = _mm256_and_pd(ok, _mm256_and_pd(_mm256_cmp_pd(u, zero, _CMP_GE_OQ),
+                                       _mm256_cmp_pd(u, one, _CMP_LE_OQ)));
+  if (_mm256_movemask_pd(ok) == 0)
+  {
+    if constexpr (kQuery == HitQuery::Closest)
+    {
+      _mm256_storeu_pd(out->t + base, _mm256_set1_pd(kInf));
+    }
+    return 0;
+  }
+
+  const __m256d qx = _mm256_sub_pd(_mm256_mul_pd(sy, e1z), _mm256_mul_pd(sz, e1y));
+  const __m256d qy = _mm256_sub_pd(_mm256_mul_pd(sz, e1x), _mm256_mul_pd(sx, e1z));
+  const __m256d qz = _mm256_sub_pd(_mm256_mul_pd(sx, e1y), _mm256_mul_pd(sy, e1x));
+
+  const __m256d v = _mm256_mul_pd(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, qx), _mm256_mul_pd(dy, qy)),
+                    _mm256_mul_pd(dz, qz)),
+      inv_det);
+  ok = _mm256_and_pd(ok, _mm256_and_pd(_mm256_cmp_pd(v, zero, _CMP_GE_OQ),
+                                       _mm256_cmp_pd(_mm256_add_pd(u, v), one, _CMP_LE_OQ)));
+
+  const __m256d t = _mm256_mul_pd(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(e2x, qx), _mm256_mul_pd(e2y, qy)),
+                    _mm256_mul_pd(e2z, qz)),
+      inv_det);
+  ok = _mm256_and_pd(ok, _mm256_and_pd(_mm256_cmp_pd(t, _mm256_set1_pd(t_min), _CMP_GE_OQ),
+                                       _mm256_cmp_pd(t, _mm256_set1_pd(t_max), _CMP_LE_OQ)));
+
+  if constexpr (kQuery == HitQuery::Closest)
+  {
+    _mm256_storeu_pd(out->t + base, _mm256_blendv_pd(_mm256_set1_pd(kInf), t, ok));
+    _mm256_storeu_pd(out->u + base, u);
+    _mm256_storeu_pd(out->v + base, v);
+  }
+  return static_cast<uint32_t>(_mm256_movemask_pd(ok)) << base;
+}
+#endif
+
+// Single-precision lane tests: the same steps on a FloatTriangleBlock, with `o` the ray's start
+// relative to the block's anchor and the edge tests widened by kEdgeSlack.
+template <int W>
+struct alignas(64) FloatLaneResults
+{
+  float t[W];
+  float u[W];
+  float v[W];
+};
+
+template <HitQuery kQuery, CullMode kCull, int W>
+inline uint32_t test_float_lane_scalar(const FloatTriangleBlock<W>& b, int lane, const Vec3f& o,
+                                 const Vec3f& d, float t_min, float t_max,
+                                 FloatLaneResults<W>* out)
+{
+  if constexpr (kQuery == HitQuery::Closest) out->t[lane] = kInfF;
+
+  const float e1x = b.e1x[lane], e1y = b.e1y[lane], e1z = b.e1z[lane];
+  const float e2x = b.e2x[lane], e2y = b.e2y[lane], e2z = b.e2z[lane];
+
+  const float px = d.y * e2z - d.z * e2y;
+  const float py = d.z * e2x - d.x * e2z;
+  const float pz = d.x * e2y - d.y * e2x;
+  const float det = e1x * px + e1y * py + e1z * pz;
+  if ((kCull == CullMode::Back ? det : std::abs(det)) < static_cast<float>(common::EPSILON))
+  {
+    return 0;
+  }
+
+  const float inv_det = 1.0f / det;
+  const float sx = o.x - b.v0x[lane], sy = o.y - b.v0y[lane], sz = o.z - b.v0z[lane];
+
+  const float u = (sx * px + sy * py + sz * pz) * inv_det;
+  if (u < -kEdgeSlack || u > 1.0f + kEdgeSlack) return 0;
+
+  const float qx = sy * e1z - sz * e1y;
+  const float qy = sz * e1x - sx * e1z;
+  const float qz = sx * e1y - sy * e1x;
+
+  const float v = (d.x * qx + d.y * qy + d.z * qz) * inv_det;
+  if (v < -kEdgeSlack || u + v > 1.0f + kEdgeSlack) return 0;
+
+  const float t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+  if (t < t_min || t > t_max) return 0;
+
+  if constexpr (kQuery == HitQuery::Closest)
+  {
+    out->t[lane] = t;
+    out->u[lane] = u;
+    out->v[lane] = v;
+  }
+  return 1u << lane;
+}
+
+#if PERCEPTO_X86_SIMD
+// Tests all 16 lanes of a block.
+template <HitQuery kQuery, CullMode kCull>
+PERCEPTO_TARGET_AVX512 inline uint32_t test_float_lanes_avx512(const FloatTriangleBlock<16>& b,
+                                                               const Vec3f& o, const Vec3f& d,
+                                                               float t_min, float t_max,
+                                                               FloatLaneResults<16>* out)
+{
+  const __m512 dx = _mm512_set1_ps(d.x), dy = _mm512_set1_ps(d.y), dz = _mm512_set1_ps(d.z);
+  const __m512 lo = _mm512_set1_ps(-kEdgeSlack), hi = _mm512_set1_ps(1.0f + kEdgeSlack);
+
+  const __m512 e1x = _mm512_load_ps(b.e1x), e1y = _mm512_load_ps(b.e1y),
+               e1z = _mm512_load_ps(b.e1z);
+  const __m512 e2x = _mm512_load_ps(b.e2x), e2y = _mm512_load_ps(b.e2y),
+               e2z = _mm512_load_ps(b.e2z);
+
+  const __m512 px = _mm512_sub_ps(_mm512_mul_ps(dy, e2z), _mm512_mul_ps(dz, e2y));
+  const __m512 py = _mm512_sub_ps(_mm512_mul_ps(dz, e2x), _mm512_mul_ps(dx, e2z));
+  const __m512 pz = _mm512_sub_ps(_mm512_mul_ps(dx, e2y), _mm512_mul_ps(dy, e2x));
+  const __m512 det = _mm512_add_ps(
+      _mm512_add_ps(_mm512_mul_ps(e1x, px), _mm512_mul_ps(e1y, py)), _mm512_mul_ps(e1z, pz));
+  __mmask16 ok =
+      _mm512_cmp_ps_mask(kCull == CullMode::Back ? det : _mm512_abs_ps(det),
+                         _mm512_set1_ps(static_cast<float>(common::EPSILON)), _CMP_GE_OQ);
+
+  const __m512 inv_det = _mm512_div_ps(_mm512_set1_ps(1.0f), det);
+  const __m512 sx = _mm512_sub_ps(_mm512_set1_ps(o.x), _mm512_load_ps(b.v0x));
+  const __m512 sy = _mm512_sub_ps(_mm512_set1_ps(o.y), _mm512_load_ps(b.v0y));
+  const __m512 sz = _mm512_sub_ps(_mm512_set1_ps(o.z), _mm512_load_ps(b.v0z));
+
+  const __m512 u = _mm512_mul_ps(
+      _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(sx, px), _mm512_mul_ps(sy, py)),
+                    _mm512_mul_ps(sz, pz)),
+      inv_det);
+  ok &= _mm512_cmp_ps_mask(u, lo, _CMP_GE_OQ) & _mm512_cmp_ps_mask(u, hi, _CMP_LE_OQ);
+  if (!ok)
+  {
+    if constexpr (kQuery == HitQuery::Closest) _mm512_store_ps(out->t, _mm512_set1_ps(kInfF));
+    return 0;
+  }
+
+  const __m512 qx = _mm512_sub_ps(_mm512_mul_ps(sy, e1z), _mm512_mul_ps(sz, e1y));
+  const __m512 qy = _mm512_sub_ps(_mm512_mul_ps(sz, e1x), _mm512_mul_ps(sx, e1z));
+  const __m512 qz = _mm512_sub_ps(_mm512_mul_ps(sx, e1y), _mm512_mul_ps(sy, e1x));
+
+  const __m512 v = _mm512_mul_ps(
+      _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, qx), _mm512_mul_ps(dy, qy)),
+                    _mm512_mul_ps(dz, qz)),
+      inv_det);
+  ok &= _mm512_cmp_ps_mask(v, lo, _CMP_GE_OQ) &
+        _mm512_cmp_ps_mask(_mm512_add_ps(u, v), hi, _CMP_LE_OQ);
+
+  const __m512 t = _mm512_mul_ps(
+      _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(e2x, qx), _mm512_mul_ps(e2y, qy)),
+                    _mm512_mul_ps(e2z, qz)),
+      inv_det);
+  ok &= _mm512_cmp_ps_mask(t, _mm512_set1_ps(t_min), _CMP_GE_OQ) &
+        _mm512_cmp_ps_mask(t, _mm512_set1_ps(t_max), _CMP_LE_OQ);
+
+  if constexpr (kQuery == HitQuery::Closest)
+  {
+    _mm512_store_ps(out->t, _mm512_mask_blend_ps(ok, _mm512_set1_ps(kInfF), t));
+    _mm512_store_ps(out->u, u);
+    _mm512_store_ps(out->v, v);
+  }
+  return ok;
+}
+
+// Tests lanes [base, base + 8).
+template <HitQuery kQuery, CullMode kCull, int W>
+PERCEPTO_TARGET_AVX2 inline uint32_t test_float_lanes_avx2(const FloatTriangleBlock<W>& b,
+                                                           int base, const Vec3f& o,
+                                                           const Vec3f& d, float t_min,
+                                                           float t_max, FloatLaneResults<W>* out)
+{
+  const __m256 dx = _mm256_set1_ps(d.x), dy = _mm256_set1_ps(d.y), dz = _mm256_set1_ps(d.z);
+  const __m256 lo = _mm256_set1_ps(-kEdgeSlack), hi = _mm256_set1_ps(1.0f + kEdgeSlack);
+
+  const __m256 e1x = _mm256_load_ps(b.e1x + base), e1y = _mm256_load_ps(b.e1y + base),
+               e1z = _mm256_load_ps(b.e1z + base);
+  const __m256 e2x = _mm256_load_ps(b.e2x + base), e2y = _mm256_load_ps(b.e2y + base),
+               e2z = _mm256_load_ps(b.e2z + base);
+
+  const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+  const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+  const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+  const __m256 det = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+  __m256 ok = _mm256_cmp_ps(
+      kCull == CullMode::Back ? det : _mm256_andnot_ps(_mm256_set1_ps(-0.0f), det),
+      _mm256_set1_ps(static_cast<float>(common::EPSILON)), _CMP_GE_OQ);
+
+  const __m256 inv_det = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+  const __m256 sx = _mm256_sub_ps(_mm256_set1_ps(o.x), _mm256_load_ps(b.v0x + base));
+  const __m256 sy = _mm256_sub_ps(_mm256_set1_ps(o.y), _mm256_load_ps(b.v0y + base));
+  const __m256 sz = _mm256_sub_ps(_mm256_set1_ps(o.z), _mm256_load_ps(b.v0z + base));
+
+  const __m256 u = _mm256_mul_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)),
+                    _mm256_mul_ps(sz, pz)),
+      inv_det);
+  ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(u, lo, _CMP_GE_OQ),
+                                       _mm256_cmp_ps(u, hi, _CMP_LE_OQ)));
+  if (_mm256_movemask_ps(ok) == 0)
+  {
+    if constexpr (kQuery == HitQuery::Closest)
+    {
+      _mm256_store_ps(out->t + base, _mm256_set1_ps(kInfF));
+    }
+    return 0;
+  }
+
+  const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+  const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+  const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+
+  const __m256 v = _mm256_mul_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)),
+                    _mm256_mul_ps(dz, qz)),
+      inv_det);
+  ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(v, lo, _CMP_GE_OQ),
+                                       _mm256_cmp_ps(_mm256_add_ps(u, v), hi, _CMP_LE_OQ)));
+
+  const __m256 t = _mm256_mul_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)),
+                    _mm256_mul_ps(e2z, qz)),
+      inv_det);
+  ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(t, _mm256_set1_ps(t_min), _CMP_GE_OQ),
+                                       _mm256_cmp_ps(t, _mm256_set1_ps(t_max), _CMP_LE_OQ)));
+
+  if constexpr (kQuery == HitQuery::Closest)
+  {
+    _mm256_store_ps(out->t + base, _mm256_blendv_ps(_mm256_set1_ps(kInfF), t, ok));
+    _mm256_store_ps(out->u + base, u);
+    _mm256_store_ps(out->v + base, v);
+  }
+  return static_cast<uint32_t>(_mm256_movemask_ps(ok)) << base;
+}
+#endif
+
+// Distance along the ray to the point nearest the block's anchor. The float test starts the ray
+// there, so every float value it rounds is of the block's size, not of the distance travelled.
+template <int W>
+inline double anchor_distance(const FloatTriangleBlock<W>& block, const Ray& ray)
+{
+  return (block.anchor - ray.origin()).dot(ray.direction());
+}
+
+// Runs the `kIsa` lane tests over lanes [0, end) of a float block, stopping at the first vector
+// with a hit when `kQuery` is HitQuery::Any. Returns the mask of lanes hit; their `t` are
+// measured from `t0`, the ray's anchor distance.
+template <Isa kIsa, HitQuery kQuery, CullMode kCull, int W>
+inline uint32_t test_float_block(const FloatTriangleBlock<W>& block, int end, const Ray& ray,
+                                 double t0, double t_max, FloatLaneResults<W>* out)
+{
+  // Rounded once each, after the shift is taken in double.
+  const Vec3f o(ray.origin() + ray.direction() * t0 - block.anchor);
+  const Vec3f d(ray.direction());
+  const auto t_min = static_cast<float>(ray.tMin() - t0);
+  const auto t_far = static_cast<float>(t_max - t0);
+
+  uint32_t mask = 0;
+  int base = 0;
+#if PERCEPTO_X86_SIMD
+  if constexpr (kIsa == Isa::Avx512 && W == 16)
+  {
+    mask = test_float_lanes_avx512<kQuery, kCull>(block, o, d, t_min, t_far, out);
+    base = W;
+  }
+  if constexpr (kIsa != Isa::Scalar)
+  {
+    for (; base < end; base += 8)
+    {
+      mask |= test_float_lanes_avx2<kQuery, kCull>(block, base, o, d, t_min, t_far, out);
+      if (kQuery == HitQuery::Any && mask) return mask;
+    }
+  }
+#endif
+  for (; base < end; ++base)
+  {
+    mask |= test_float_lane_scalar<kQuery, kCull>(block, base, o, d, t_min, t_far, out);
+    if (kQuery == HitQuery::Any && mask) return mask;
+  }
+  return mask;
+}
+
+// The public kernels, in the form common::dispatch_isa runs: `run<kIsa>` uses the widest lane
+// tests of `kIsa` that fit the block, then the next narrower ones for what is left.
+template <CullMode kCull, int W>
+struct BlockClosest
+{
+  template <Isa kIsa>
+  static int run(const TriangleBlock<W>& block, const Ray& ray, double t_max,
+                 TriangleHitResult& hit)
+  {
+    const Vec3& o = ray.origin();
+    const Vec3& d = ray.direction();
+    const double t_min = ray.tMin();
+
+    LaneResults<W> lanes;
+    int base = 0;
+#if PERCEPTO_X86_SIMD
+    if constexpr (kIsa == Isa::Avx512 && W % 8 == 0)
+    {
+      for (; base < W; base += 8)
+      {
+        test_lanes_avx512<HitQuery::Closest, kCull>(block, base, o, d, t_min, t_max, &lanes);
+      }
+    }
+    if constexpr (kIsa != Isa::Scalar)
+    {
+      for (; base < W; base += 4)
+      {
+        test_lanes_avx2<HitQuery::Closest, kCull>(block, base, o, d, t_min, t_max, &lanes);
+      }
+    }
+#endif
+    for (; base < W; ++base)
+    {
+      test_lane_scalar<HitQuery::Closest, kCull>(block, base, o, d, t_min, t_max, &lanes);
+    }
+
+    int best = -1;
+    double best_t = kInf;
+    for (int lane = 0; lane < W; ++lane)
+    {
+      if (lanes.t[lane] < best_t)
+      {
+        best_t = lanes.t[lane];
+        best = lane;
+      }
+    }
+
+    if (best >= 0) hit = TriangleHitResult{lanes.t[best], lanes.u[best], lanes.v[best]};
+    return best;
+  }
+};
+
+template <CullMode kCull, int W>
+struct BlockOccluded
+{
+  template <Isa kIsa>
+  static bool run(const TriangleBlock<W>& block, const Ray& ray, double t_max)
+  {
+    const Vec3& o = ray.origin();
+    const Vec3& d = ray.direction();
+    const double t_min = ray.tMin();
+
+    // Chunks past the occupied lanes hold only padding, and the first lane hit settles it.
+    const int end = block.count;
+    int base = 0;
+#if PERCEPTO_X86_SIMD
+    if constexpr (kIsa == Isa::Avx512 && W % 8 == 0)
+    {
+      for (; base < end; base += 8)
+      {
+        if (test_lanes_avx512<HitQuery::Any, kCull, W>(block, base, o, d, t_min, t_max, nullptr))
+        {
+          return true;
+        }
+      }
+    }
+    if constexpr (kIsa != Isa::Scalar)
+    {
+      for (; base < end; base += 4)
+      {
+        if (test_lanes_avx2<HitQuery::Any, kCull, W>(block, base, o, d, t_min, t_max, nullptr))
+        {
+          return true;
+        }
+      }
+    }
+#endif
+    for (; base < end; ++base)
+    {
+      if (test_lane_scalar<HitQuery::Any, kCull, W>(block, base, o, d, t_min, t_max, nullptr))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+template <CullMode kCull, int W>
+struct FloatBlockClosest
+{
+  template <Isa kIsa>
+  static int run(const FloatTriangleBlock<W>& block, const Ray& ray, double t_max,
+                 TriangleHitResult& hit)
+  {
+    FloatLaneResults<W> lanes;
+    const double t0 = anchor_distance(block, ray);
+    if (!test_float_block<kIsa, HitQuery::Closest, kCull>(block, W, ray, t0, t_max, &lanes))
+    {
+      return -1;
+    }
+
+    int best = 0;
+    for (int lane = 1; lane < W; ++lane)
+    {
+      if (lanes.t[lane] < lanes.t[best]) best = lane;
+    }
+    hit = TriangleHitResult{t0 + lanes.t[best], lanes.u[best], lanes.v[best]};
+    return best;
+  }
+};
+
+template <CullMode kCull, int W>
+struct FloatBlockOccluded
+{
+  template <Isa kIsa>
+  static bool run(const FloatTriangleBlock<W>& block, const Ray& ray, double t_max)
+  {
+    return test_float_block<kIsa, HitQuery::Any, kCull, W>(
+               block, block.count, ray, anchor_distance(block, ray), t_max, nullptr) != 0;
+  }
+};
+}  // namespace
+
+template <CullMode kCull, int W>
+int moller_trumbore_block(const TriangleBlock<W>& block, const Ray& ray, double t_max,
+                          TriangleHitResult& hit)
+{
+  return common::dispatch_isa<BlockClosest<kCull, W>>(block, ray, t_max, hit);
+}
+
+template <CullMode kCull, int W>
+bool moller_trumbore_block_occluded(const TriangleBlock<W>& block, const Ray& ray, double t_max)
+{
+  return common::dispatch_isa<BlockOccluded<kCull, W>>(block, ray, t_max);
+}
+
+template <CullMode kCull, int W>
+int moller_trumbore_block(const FloatTriangleBlock<W>& block, const Ray& ray, double t_max,
+                          TriangleHitResult& hit)
+{
+  return common::dispatch_isa<FloatBlockClosest<kCull, W>>(block, ray, t_max, hit);
+}
+
+template <CullMode kCull, int W>
+bool moller_trumbore_block_occluded(const FloatTriangleBlock<W>& block, const Ray& ray,
+                                    double t_max)
+{
+  return common::dispatch_isa<FloatBlockOccluded<kCull, W>>(block, ray, t_max);
+}
+
+const char* moller_trumbore_block_isa()
+{
+  return common::isa_name(common::active_isa());
+}
+
+template int moller_trumbore_block<CullMode::Back, 4>(const TriangleBlock<4>&, const Ray&,
+                                                      double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::Back, 8>(const TriangleBlock<8>&, const Ray&,
+                                                      double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::Back, 16>(const TriangleBlock<16>&, const Ray&,
+                                                       double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::None, 4>(const TriangleBlock<4>&, const Ray&,
+                                                      double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::None, 8>(const TriangleBlock<8>&, const Ray&,
+                                                      double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::None, 16>(const TriangleBlock<16>&, const Ray&,
+                                                       double, TriangleHitResult&);
+template bool moller_trumbore_block_occluded<CullMode::Back, 4>(const TriangleBlock<4>&,
+                                                                const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::Back, 8>(const TriangleBlock<8>&,
+                                                                const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::Back, 16>(const TriangleBlock<16>&,
+                                                                 const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::None, 4>(const TriangleBlock<4>&,
+                                                                const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::None, 8>(const TriangleBlock<8>&,
+                                                                const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::None, 16>(const TriangleBlock<16>&,
+                                                                 const Ray&, double);
+template int moller_trumbore_block<CullMode::Back, 8>(const FloatTriangleBlock<8>&, const Ray&,
+                                                      double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::Back, 16>(const FloatTriangleBlock<16>&, const Ray&,
+                                                       double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::None, 8>(const FloatTriangleBlock<8>&, const Ray&,
+                                                      double, TriangleHitResult&);
+template int moller_trumbore_block<CullMode::None, 16>(const FloatTriangleBlock<16>&, const Ray&,
+                                                       double, TriangleHitResult&);
+template bool moller_trumbore_block_occluded<CullMode::Back, 8>(
+    const FloatTriangleBlock<8>&, const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::Back, 16>(
+    const FloatTriangleBlock<16>&, const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::None, 8>(
+    const FloatTriangleBlock<8>&, const Ray&, double);
+template bool moller_trumbore_block_occluded<CullMode::None, 16>(
+    const FloatTriangleBlock<16>&, const Ray&, double);
+}  // namespace percepto::math::intersection
@@ -0,0 +1,266 @@
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "percepto/common/cpu_features.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/geometry/triangle_block.h"
+#include "percepto/math/intersection/moller_trumbore_packet.h"
+
+using percepto::common::CullMode, percepto::common::Isa, percepto::core::RayPacket,
+    percepto::geometry::TriangleBlock;
+
+namespace percepto::math::intersection
+{
+namespace
+{
+// Per-triangle terms that do not depend on the ray direction, hence are shared by the packet.
+struct SharedTerms
+{
+  double e1x, e1y, e1z;
+  double e2x, e2y, e2z;
+  double sx, sy, sz;  // origin - v0
+  double qx, qy, qz;  // s × e1
+  double t_num;       // e2 · q
+};
+
+// Scalar reference for one ray; mirrors moller_trumbore() operation for operation.
+template <CullMode kCull>
+inline bool test_ray_scalar(const SharedTerms& k, const RayPacket& p, int i, double t_max,
+                            double& t_hit, double* u_hit, double* v_hit)
+{
+  const double dx = p.dir_x[i], dy = p.dir_y[i], dz = p.dir_z[i];
+
+  const double px = dy * k.e2z - dz * k.e2y;
+  const double py = dz * k.e2x - dx * k.e2z;
+  const double pz = dx * k.e2y - dy * k.e2x;
+  const double det = k.e1x * px + k.e1y * py + k.e1z * pz;
+  if ((kCull == CullMode::Back ? det : std::abs(det)) < common::EPSILON) return false;
+
+  const double inv_det = 1.0 / det;
+  const double u = (k.sx * px + k.sy * py + k.sz * pz) * inv_det;
+  if (u < 0.0 || u > 1.0) return false;
+
+  const double v = (dx * k.qx + dy * k.qy + dz * k.qz) * inv_det;
+  if (v < 0.0 || u + v > 1.0) return false;
+
+  const double t = k.t_num * inv_det;
+  if (t < p.t_min[i] || t > t_max) return false;
+
+  t_hit = t;
+  if (u_hit)
+  {
+    u_hit[i] = u;
+    v_hit[i] = v;
+  }
+  return true;
+}
+
+#if PERCEPTO_X86_SIMD
+// Tests rays [base, base + 8).
+template <CullMode kCull>
+PERCEPTO_TARGET_AVX512 inline uint32_t test_rays_avx512(const SharedTerms& k, const RayPacket& p,
+                                                        int base, const double* t_max,
+                                                        double* t_hit, double* u_hit,
+                                                        double* v_hit)
+{
+  const __m512d dx = _mm512_loadu_pd(p.dir_x + base), dy = _mm512_loadu_pd(p.dir_y + base),
+                dz = _mm512_loadu_pd(p.dir_z + base);
+  const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0);
+  const __m512d e2x = _mm512_set1_pd(k.e2x), e2y = _mm512_set1_pd(k.e2y),
+                e2z = _mm512_set1_pd(k.e2z);
+
+  const __m512d px = _mm512_sub_pd(_mm512_mul_pd(dy, e2z), _mm512_mul_pd(dz, e2y));
+  const __m512d py = _mm512_sub_pd(_mm512_mul_pd(dz, e2x), _mm512_mul_pd(dx, e2z));
+  const __m512d pz = _mm512_sub_pd(_mm512_mul_pd(dx, e2y), _mm512_mul_pd(dy, e2x));
+  const __m512d det =
+      _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(k.e1x), px),
+                                  _mm512_mul_pd(_mm512_set1_pd(k.e1y), py)),
+                    _mm512_mul_pd(_mm512_set1_pd(k.e1z), pz));
+  __mmask8 ok = _mm512_cmp_pd_mask(kCull == CullMode::Back ? det : _mm512_abs_pd(det),
+                                   _mm512_set1_pd(common::EPSILON), _CMP_GE_OQ);
+
+  const __m512d inv_det = _mm512_div_pd(one, det);
+  const __m512d u = _mm512_mul_pd(
+      _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(k.sx), px),
+                                  _mm512_mul_pd(_mm512_set1_pd(k.sy), py)),
+                    _mm512_mul_pd(_mm512_set1_pd(k.sz), pz)),
+      inv_det);
+  ok &= _mm512_cmp_pd_mask(u, zero, _CMP_GE_OQ) & _mm512_cmp_pd_mask(u, one, _CMP_LE_OQ);
+  if (!ok) return 0;
+
+  const __m512d v = _mm512_mul_pd(
+      _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, _mm512_set1_pd(k.qx)),
+                                  _mm512_mul_pd(dy, _mm512_set1_pd(k.qy))),
+                    _mm512_mul_pd(dz, _mm512_set1_pd(k.qz))),
+      inv_det);
+  ok &= _mm512_cmp_pd_mask(v, zero, _CMP_GE_OQ) &
+        _mm512_cmp_pd_mask(_mm512_add_pd(u, v), one, _CMP_LE_OQ);
+
+  const __m512d t = _mm512_mul_pd(_mm512_set1_pd(k.t_num), inv_det);
+  ok &= _mm512_cmp_pd_mask(t, _mm512_loadu_pd(p.t_min + base), _CMP_GE_OQ) &
+        _mm512_cmp_pd_mask(t, _mm512_loadu_pd(t_max + base), _CMP_LE_OQ);
+
+  _mm512_storeu_pd(t_hit + base, t);
+  if (u_hit)
+  {
+    _mm512_storeu_pd(u_hit + base, u);
+    _mm512_storeu_pd(v_hit + base, v);
+  }
+  return static_cast<uint32_t>(ok) << base;
+}
+
+// Tests rays [base, base + 4).
+template <CullMode kCull>
+PERCEPTO_TARGET_AVX2 inline uint32_t test_rays_avx2(const SharedTerms& k, const RayPacket& p,
+                                                    int base, const double* t_max, double* t_hit,
+                                                    double* u_hit, double* v_hit)
+{
+  const __m256d dx = _mm256_loadu_pd(p.dir_x + base), dy = _mm256_loadu_pd(p.dir_y + base),
+                dz = _mm256_loadu_pd(p.dir_z + base);
+  const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+  const __m256d e2x = _mm256_set1_pd(k.e2x), e2y = _mm256_set1_pd(k.e2y),
+                e2z = _mm256_set1_pd(k.e2z);
+
+  const __m256d px = _mm256_sub_pd(_mm256_mul_pd(dy, e2z), _mm256_mul_pd(dz, e2y));
+  const __m256d py = _mm256_sub_pd(_mm256_mul_pd(dz, e2x), _mm256_mul_pd(dx, e2z));
+  const __m256d pz = _mm256_sub_pd(_mm256_mul_pd(dx, e2y), _mm256_mul_pd(dy, e2x));
+  const __m256d det =
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(k.e1x), px),
+                                  _mm256_mul_pd(_mm256_set1_pd(k.e1y), py)),
+                    _mm256_mul_pd(_mm256_set1_pd(k.e1z), pz));
+  __m256d ok = _mm256_cmp_pd(
+      kCull == CullMode::Back ? det : _mm256_andnot_pd(_mm256_set1_pd(-0.0), det),
+      _mm256_set1_pd(common::EPSILON), _CMP_GE_OQ);
+
+  const __m256d inv_det = _mm256_div_pd(one, det);
+  const __m256d u = _mm256_mul_pd(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(k.sx), px),
+                                  _mm256_mul_pd(_mm256_set1_pd(k.sy), py)),
+                    _mm256_mul_pd(_mm256_set1_pd(k.sz), pz)),
+      inv_det);
+  ok = _mm256_and_pd(ok, _mm256_and_pd(_mm256_cmp_pd(u, zero, _CMP_GE_OQ),
+                                       _mm256_cmp_pd(u, one, _CMP_LE_OQ)));
+  if (_mm256_movemask_pd(ok) == 0) return 0;
+
+  const __m256d v = _mm256_mul_pd(
+      _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, _mm256_set1_pd(k.qx)),
+                                  _mm256_mul_pd(dy, _mm256_set1_pd(k.qy))),
+                    _mm256_mul_pd(dz, _mm256_set1_pd(k.qz))),
+      inv_det);
+  ok = _mm256_and_pd(ok, _mm256_and_pd(_mm256_cmp_pd(v, zero, _CMP_GE_OQ),
+                                       _mm256_cmp_pd(_mm256_add_pd(u, v), one, _CMP_LE_OQ)));
+
+  const __m256d t = _mm256_mul_pd(_mm256_set1_pd(k.t_num), inv_det);
+  ok = _mm256_and_pd(
+      ok, _mm256_and_pd(_mm256_cmp_pd(t, _mm256_loadu_pd(p.t_min + base), _CMP_GE_OQ),
+                        _mm256_cmp_pd(t, _mm256_loadu_pd(t_max + base), _CMP_LE_OQ)));
+
+  _mm256_storeu_pd(t_hit + base, t);
+  if (u_hit)
+  {
+    _mm256_storeu_pd(u_hit + base, u);
+    _mm256_storeu_pd(v_hit + base, v);
+  }
+  return static_cast<uint32_t>(_mm256_movemask_pd(ok)) << base;
+}
+#endif
+
+// moller_trumbore_packet in the form common::dispatch_isa runs.
+template <CullMode kCull, int W>
+struct PacketKernel
+{
+  template <Isa kIsa>
+  static uint32_t run(const TriangleBlock<W>& block, int lane, const RayPacket& packet,
+                      uint32_t active, const double* t_max, double* t_hit, double* u_hit,
+                      double* v_hit)
+  {
+    SharedTerms k;
+    k.e1x = block.e1x[lane], k.e1y = block.e1y[lane], k.e1z = block.e1z[lane];
+    k.e2x = block.e2x[lane], k.e2y = block.e2y[lane], k.e2z = block.e2z[lane];
+    k.sx = packet.origin.x - block.v0x[lane];
+    k.sy = packet.origin.y - block.v0y[lane];
+    k.sz = packet.origin.z - block.v0z[lane];
+    k.qx = k.sy * k.e1z - k.sz * k.e1y;
+    k.qy = k.sz * k.e1x - k.sx * k.e1z;
+    k.qz = k.sx * k.e1y - k.sy * k.e1x;
+    k.t_num = k.e2x * k.qx + k.e2y * k.qy + k.e2z * k.qz;
+
+    uint32_t hits = 0;
+    int base = 0;
+    const int end = packet.count;
+#if PERCEPTO_X86_SIMD
+    if constexpr (kIsa == Isa::Avx512)
+    {
+      for (; base < end; base += 8)
+      {
+        if ((active >> base) & 0xFFu)
+        {
+          hits |= test_rays_avx512<kCull>(k, packet, base, t_max, t_hit, u_hit, v_hit);
+        }
+      }
+    }
+    else if constexpr (kIsa == Isa::Avx2)
+    {
+      for (; base < end; base += 4)
+      {
+        if ((active >> base) & 0xFu)
+        {
+          hits |= test_rays_avx2<kCull>(k, packet, base, t_max, t_hit, u_hit, v_hit);
+        }
+      }
+    }
+#endif
+    for (; base < end; ++base)
+    {
+      if ((active >> base) & 1u &&
+          test_ray_scalar<kCull>(k, packet, base, t_max[base], t_hit[base], u_hit, v_hit))
+      {
+        hits |= 1u << base;
+      }
+    }
+    return hits & active;
+  }
+};
+}  // namespace
+
+template <CullMode kCull, int W>
+uint32_t moller_trumbore_packet(const TriangleBlock<W>& block, int lane, const RayPacket& packet,
+                                uint32_t active, const double* t_max, double* t_hit,
+                                double* u_hit, double* v_hit)
+{
+  return common::dispatch_isa<PacketKernel<kCull, W>>(block, lane, packet, active, t_max, t_hit,
+                                                      u_hit, v_hit);
+}
+
+int moller_trumbore_packet_width()
+{
+  switch (common::active_isa())
+  {
+    case Isa::Avx512:
+      return 8;
+    case Isa::Avx2:
+      return 4;
+    case Isa::Scalar:
+      break;
+  }
+  return 1;
+}
+
+template uint32_t moller_trumbore_packet<CullMode::Back, 4>(const TriangleBlock<4>&, int,
+    const RayPacket&, uint32_t, const double*, double*, double*, double*);
+template uint32_t moller_trumbore_packet<CullMode::Back, 8>(const TriangleBlock<8>&, int,
+    const RayPacket&, uint32_t, const double*, double*, double*, double*);
+template uint32_t moller_trumbore_packet<CullMode::Back, 16>(const TriangleBlock<16>&, int,
+    const RayPacket&, uint32_t, const double*, double*, double*, double*);
+template uint32_t moller_trumbore_packet<CullMode::None, 4>(const TriangleBlock<4>&, int,
+    const RayPacket&, uint32_t, const double*, double*, double*, double*);
+template uint32_t moller_trumbore_packet<CullMode::None, 8>(const TriangleBlock<8>&, int,
+    const RayPacket&, uint32_t, const double*, double*, double*, double*);
+template uint32_t moller_trumbore_packet<CullMode::None, 16>(const TriangleBlock<16>&, int,
+    const RayPacket&, uint32_t, const double*, double*, double*, double*);
+}  // namespace percepto::math::intersection
@@ -0,0 +1,64 @@
+#include <cmath>
+#include <utility>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/math/intersection/ray_sphere.h"
+
+using percepto::common::HitQuery, percepto::core::Ray, percepto::core::Vec3;
+
+namespace percepto::math::intersection
+{
+// Operations run in the order of computeQuadraticCoefficients and solveQuadratic, so the double
+// form returns what Sphere has always returned.
+template <HitQuery kQuery, typename T>
+bool ray_sphere_test(const Vec3& centre, double radius, const Ray& ray, double& t_hit)
+{
+  const T dx = static_cast<T>(ray.direction().x), dy = static_cast<T>(ray.direction().y),
+          dz = static_cast<T>(ray.direction().z);
+  const T ox = static_cast<T>(ray.origin().x) - static_cast<T>(centre.x),
+          oy = static_cast<T>(ray.origin().y) - static_cast<T>(centre.y),
+          oz = static_cast<T>(ray.origin().z) - static_cast<T>(centre.z);
+  const T r = static_cast<T>(radius);
+
+  const T a = dx * dx + dy * dy + dz * dz;
+  const T b = T(2) * (ox * dx + oy * dy + oz * dz);
+  const T c = ox * ox + oy * oy + oz * oz - r * r;
+  // c > 0: the origin is outside; b > 0: the centre lies behind it. Both roots are negative.
+  if constexpr (kQuery == HitQuery::Any)
+  {
+    if (c > T(0) && b > T(0)) return false;
+  }
+
+  const T disc = b * b - T(4) * a * c;
+  if (disc < T(0)) return false;
+  const T sqrt_disc = std::sqrt(disc);
+  T t0 = (-b - sqrt_disc) / (T(2) * a);
+  T t1 = (-b + sqrt_disc) / (T(2) * a);
+  if (t0 > t1) std::swap(t0, t1);
+
+  const T t_min = static_cast<T>(ray.tMin()), t_max = static_cast<T>(ray.tMax());
+  if constexpr (kQuery == HitQuery::Any)
+  {
+    return (t0 >= t_min && t0 <= t_max) || (t1 >= t_min && t1 <= t_max);
+  }
+  else
+  {
+    if (t0 < T(0))
+    {
+      // If the nearest root is negative, try the farther root
+      t0 = t1;
+      if (t0 < t_min || t0 > t_max) return false;
+    }
+    t_hit = t0;
+    return true;
+  }
+}
+
+template bool ray_sphere_test<HitQuery::Closest, double>(const Vec3&, double, const Ray&,
+                                                         double&);
+template bool ray_sphere_test<HitQuery::Any, double>(const Vec3&, double, const Ray&, double&);
+template bool ray_sphere_test<HitQuery::Closest, float>(const Vec3&, double, const Ray&, double&);
+template bool ray_sphere_test<HitQuery::Any, float>(const Vec3&, double, const Ray&, double&);
+}  // namespace percepto::math::intersection
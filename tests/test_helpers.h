@@ -1,14 +1,24 @@
 #pragma once
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
 #include <system_error>
 #include <vector>
 
 #include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/sphere.h"
 #include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "percepto/io/csv_parser.h"
 
 using percepto::core::Ray, percepto::core::Vec3, percepto::geometry::Triangle;
 
@@ -173,4 +183,217 @@ class CsvParserTestFixture : public ::testing::Test
   FileTestFixture fs;
 };
 
-}  // namespace percepto::test
\ No newline at end of file
+// The furnished room the binary scene and BVH cache tests round-trip.
+constexpr const char* kRoomFixture = "fixtures/data/room.csv";
+
+inline std::unique_ptr<percepto::core::Scene> load_room()
+{
+  return percepto::io::CsvParser().load_scene_from_csv(kRoomFixture);
+}
+
+// Overwrites `size` bytes at `offset`, e.g. to corrupt one field of a file a test just wrote.
+inline void patch_file(const std::filesystem::path& path, std::streamoff offset, const void* bytes,
+                       size_t size)
+{
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(offset);
+  file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+}
+
+// Random small triangles scattered on a spherical shell around the origin, `radius / 2` to
+// `radius` out, wound to face it.
+inline std::vector<Triangle> make_shell(int count, double radius, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.6, 0.6),
+      r(radius * 0.5, radius);
+  auto point = [](double a, double e, double d)
+  { return Vec3(d * std::cos(e) * std::cos(a), d * std::cos(e) * std::sin(a), d * std::sin(e)); };
+
+  std::vector<Triangle> tris;
+  for (int i = 0; i < count; ++i)
+  {
+    const double a = az(rng), e = el(rng), d = r(rng);
+    tris.emplace_back(point(a, e, d), point(a, e + 0.05, d), point(a + 0.05, e, d));
+  }
+  return tris;
+}
+
+// Rays from the origin in random directions through the band `make_shell` fills.
+inline std::vector<Ray> make_rays(int count, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.6, 0.6);
+  std::vector<Ray> rays;
+  for (int i = 0; i < count; ++i)
+  {
+    const double a = az(rng), e = el(rng);
+    rays.emplace_back(Vec3(0, 0, 0),
+                      Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a), std::sin(e)), 0.0,
+                      1000.0);
+  }
+  return rays;
+}
+
+// ––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––
+//  Random scenes shared by the scene tests
+// ––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––
+
+// The unit cube as 12 outward-facing triangles, to instance.
+inline std::shared_ptr<const percepto::geometry::InstancedMesh> unit_box_mesh()
+{
+  percepto::geometry::TriangleMeshBuilder box;
+  const Vec3 c[8] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+                     {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+  const int faces[6][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4},
+                           {2, 3, 7, 6}, {1, 2, 6, 5}, {0, 4, 7, 3}};
+  for (const auto& f : faces)
+  {
+    box.add_triangle(c[f[0]], c[f[1]], c[f[2]]);
+    box.add_triangle(c[f[0]], c[f[2]], c[f[3]]);
+  }
+  return std::make_shared<const percepto::geometry::InstancedMesh>(box.build());
+}
+
+// The band around `center` that random objects are placed in.
+struct Shell
+{
+  Vec3 center;
+  double min_distance = 10.0;
+  double max_distance = 40.0;
+  double min_elevation = -0.3;
+  double max_elevation = 0.3;
+
+  Vec3 sample(std::mt19937& rng) const
+  {
+    std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(min_elevation, max_elevation),
+        r(min_distance, max_distance);
+    const double a = az(rng), e = el(rng), d = r(rng);
+    return center +
+           Vec3(d * std::cos(e) * std::cos(a), d * std::cos(e) * std::sin(a), d * std::sin(e));
+  }
+};
+
+struct RingObject
+{
+  percepto::core::Scene::ObjectHandle handle;
+  Vec3 position;
+};
+
+// `count` objects at random points of `shell`, cycling through an upright triangle facing the
+// centre, a sphere and an instance of `mesh`.
+inline std::vector<RingObject> add_object_ring(
+    percepto::core::Scene& scene, std::mt19937& rng, const Shell& shell, int count,
+    const std::shared_ptr<const percepto::geometry::InstancedMesh>& mesh,
+    double sphere_radius = 0.5)
+{
+  std::vector<RingObject> ring;
+  for (int i = 0; i < count; ++i)
+  {
+    const Vec3 p = shell.sample(rng);
+    const double a = std::atan2(p.y - shell.center.y, p.x - shell.center.x);
+    percepto::core::Scene::ObjectHandle h;
+    if (i % 3 == 0)
+    {
+      h = scene.add_object(
+          Triangle(p, p + Vec3(-std::sin(a), std::cos(a), 0.0), p + Vec3(0, 0, 1)));
+    }
+    else if (i % 3 == 1)
+    {
+      h = scene.add_object(percepto::geometry::Sphere(p, sphere_radius));
+    }
+    else
+    {
+      h = scene.add_object(
+          percepto::geometry::Instance(mesh, percepto::core::Transform::translation(p)));
+    }
+    ring.push_back({h, p});
+  }
+  return ring;
+}
+
+// A mesh of `cells` by `cells` squares `cell_size` wide, facing up and centred below `center`;
+// `height(x, y)` gives each vertex's height relative to `center` from its offset in the plane.
+inline void add_ground(percepto::core::Scene& scene, const Vec3& center, int cells,
+                       double cell_size, const std::function<double(double, double)>& height)
+{
+  percepto::geometry::TriangleMeshBuilder ground;
+  auto vertex = [&](int i, int j)
+  {
+    const double x = (i - 0.5 * cells) * cell_size, y = (j - 0.5 * cells) * cell_size;
+    return center + Vec3(x, y, height(x, y));
+  };
+  for (int j = 0; j < cells; ++j)
+  {
+    for (int i = 0; i < cells; ++i)
+    {
+      ground.add_triangle(vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1));
+      ground.add_triangle(vertex(i, j), vertex(i + 1, j + 1), vertex(i, j + 1));
+    }
+  }
+  scene.add_mesh(ground.build());
+}
+
+// Open geometry of random winding over `shell`: `triangles` free triangles, five spheres, `quads`
+// instances of the unit square at random tilts, one triangle rising a unit over the interval and
+// a mesh of `mesh_triangles` more. `both_sides` adds every face a second time with the opposite
+// winding, which is how double-sided geometry used to be loaded.
+inline void add_open_geometry(percepto::core::Scene& scene, std::mt19937& rng, const Shell& shell,
+                              int triangles, int quads, int mesh_triangles,
+                              bool both_sides = false)
+{
+  using percepto::core::Transform;
+  std::uniform_real_distribution<double> jitter(-1.0, 1.0), angle(0.0, 2.0 * M_PI);
+  auto corners = [&](const Vec3& p)
+  {
+    return std::vector<Vec3>{p, p + Vec3(jitter(rng), jitter(rng), jitter(rng)),
+                             p + Vec3(jitter(rng), jitter(rng), jitter(rng))};
+  };
+
+  for (int i = 0; i < triangles; ++i)
+  {
+    const auto v = corners(shell.sample(rng));
+    scene.add_object(Triangle(v[0], v[1], v[2]));
+    if (both_sides) scene.add_object(Triangle(v[0], v[2], v[1]));
+  }
+  for (int i = 0; i < 5; ++i) scene.add_object(percepto::geometry::Sphere(shell.sample(rng), 0.5));
+
+  percepto::geometry::TriangleMeshBuilder quad;
+  const Vec3 q[4] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+  quad.add_triangle(q[0], q[1], q[2]);
+  quad.add_triangle(q[0], q[2], q[3]);
+  if (both_sides)
+  {
+    quad.add_triangle(q[0], q[2], q[1]);
+    quad.add_triangle(q[0], q[3], q[2]);
+  }
+  auto quad_mesh = std::make_shared<const percepto::geometry::InstancedMesh>(quad.build());
+  for (int i = 0; i < quads; ++i)
+  {
+    scene.add_object(percepto::geometry::Instance(
+        quad_mesh, Transform::translation(shell.sample(rng)) *
+                       Transform::rotation(Vec3(1.0, 0.0, 0.0), angle(rng))));
+  }
+
+  const auto moving = corners(shell.sample(rng));
+  const Transform rise = Transform::translation(Vec3(0.0, 0.0, 1.0));
+  scene.set_object_motion(scene.add_object(Triangle(moving[0], moving[1], moving[2])),
+                          Transform(), rise);
+  if (both_sides)
+  {
+    scene.set_object_motion(scene.add_object(Triangle(moving[0], moving[2], moving[1])),
+                            Transform(), rise);
+  }
+
+  if (mesh_triangles == 0) return;
+  percepto::geometry::TriangleMeshBuilder mesh;
+  for (int i = 0; i < mesh_triangles; ++i)
+  {
+    const auto v = corners(shell.sample(rng));
+    mesh.add_triangle(v[0], v[1], v[2]);
+    if (both_sides) mesh.add_triangle(v[0], v[2], v[1]);
+  }
+  scene.add_mesh(mesh.build());
+}
+
+}  // namespace percepto::test
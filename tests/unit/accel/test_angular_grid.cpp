@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "percepto/accel/angular_grid.h"
+#include "percepto/common/config_loader.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/lidar/emitter.h"
+#include "percepto/lidar/simulator.h"
+#include "test_helpers.h"
+
+using percepto::accel::AngularGrid, percepto::accel::AngularGridLayout;
+using percepto::common::HitRecord, percepto::common::LiDARConfig;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::Sphere, percepto::geometry::Triangle;
+using percepto::lidar::LidarEmitter, percepto::lidar::LidarSimulator;
+
+namespace
+{
+std::vector<uint32_t> cell_contents(const AngularGrid& grid, int azimuth, int elevation)
+{
+  const size_t cell = grid.cell_index(azimuth, elevation);
+  return {grid.cell_begin(cell), grid.cell_end(cell)};
+}
+
+// Random small triangles on a spherical shell around the origin, wound to face it.
+std::unique_ptr<Scene> make_shell_scene(int count, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI);
+  std::uniform_real_distribution<double> el(-0.6, 0.6);
+  std::uniform_real_distribution<double> r(20.0, 40.0);
+
+  auto point = [](double a, double e, double d)
+  { return Vec3(d * std::cos(e) * std::cos(a), d * std::cos(e) * std::sin(a), d * std::sin(e)); };
+
+  auto scene = std::make_unique<Scene>();
+  for (int i = 0; i < count; ++i)
+  {
+    double a = az(rng), e = el(rng), d = r(rng);
+    scene->add_object(Triangle(point(a, e, d), point(a, e + 0.08, d), point(a + 0.08, e, d)));
+  }
+  scene->add_object(Sphere(Vec3(0, 15, 0), 3.0));
+  return scene;
+}
+}  // namespace
+
+TEST(AngularGridTest, EmptySceneHasEmptyCells)
+{
+  AngularGrid grid;
+  grid.build({Vec3(0, 0, 0), {0.0, M_PI}, {0.0}}, {});
+  EXPECT_EQ(grid.entry_count(), 0u);
+  EXPECT_TRUE(cell_contents(grid, 0, 0).empty());
+  EXPECT_TRUE(cell_contents(grid, 1, 0).empty());
+}
+
+TEST(AngularGridTest, BinsAcrossTheAzimuthWrapAround)
+{
+  // A box straddling the +x axis covers azimuths on both sides of 0 / 2π.
+  const AngularGridLayout layout{
+      Vec3(0, 0, 0), {0.0, M_PI / 2, M_PI, 3 * M_PI / 2, 6.2}, {0.0, 0.5}};
+  AngularGrid grid;
+  grid.build(layout, {AABB(Vec3(10, -1, -1), Vec3(10.5, 1, 1))});
+
+  for (int a = 0; a < grid.azimuth_count(); ++a)
+  {
+    const bool covered = a == 0 || a == 4;
+    EXPECT_EQ(cell_contents(grid, a, 0).size(), covered ? 1u : 0u) << "azimuth " << a;
+    EXPECT_TRUE(cell_contents(grid, a, 1).empty()) << "azimuth " << a;
+  }
+}
+
+TEST(AngularGridTest, BoxOverTheSensorCoversEveryAzimuth)
+{
+  const AngularGridLayout layout{Vec3(0, 0, 0), {0.0, 1.0, 2.0, 4.0}, {0.0, 1.4}};
+  AngularGrid grid;
+  grid.build(layout, {AABB(Vec3(-1, -1, 5), Vec3(1, 1, 6))});
+
+  for (int a = 0; a < grid.azimuth_count(); ++a)
+  {
+    EXPECT_TRUE(cell_contents(grid, a, 0).empty()) << "azimuth " << a;
+    EXPECT_EQ(cell_contents(grid, a, 1), std::vector<uint32_t>{0}) << "azimuth " << a;
+  }
+}
+
+TEST(AngularGridTest, SensorRaysMatchGeneralAccelerator)
+{
+  auto scene = make_shell_scene(3000, 11);
+  LidarEmitter emitter(LiDARConfig{720, {-0.55, -0.3, -0.1, 0.0, 0.02, 0.2, 0.45, 0.58}});
+  scene->set_angular_grid({emitter.origin(), emitter.azimuth_angles(), emitter.elevation_angles()});
+  scene->commit();
+
+  const AngularGrid& grid = scene->angular_grid();
+  ASSERT_FALSE(grid.empty());
+  // Each ray should only see a small fraction of the scene.
+  EXPECT_LT(grid.entry_count(), static_cast<size_t>(720 * 8 * 20));
+
+  int hits = 0;
+  for (int i = 0; i < emitter.azimuth_steps(); ++i)
+  {
+    for (int j = 0; j < static_cast<int>(emitter.elevation_angles().size()); ++j)
+    {
+      const Ray ray = emitter.get_ray(i, j);
+      HitRecord expected, actual;
+      const bool expected_hit = scene->intersect(ray, expected);
+      const bool actual_hit = scene->intersect_sensor_ray(i, j, ray, actual);
+
+      ASSERT_EQ(expected_hit, actual_hit) << "i=" << i << " j=" << j;
+      if (expected_hit)
+      {
+        ++hits;
+        ASSERT_EQ(expected.t, actual.t) << "i=" << i << " j=" << j;
+        ASSERT_TRUE(scene->resolve(ray, expected).point == scene->resolve(ray, actual).point)
+            << "i=" << i << " j=" << j;
+      }
+    }
+  }
+  EXPECT_GT(hits, 0);
+}
+
+TEST(AngularGridTest, FallsBackWhenOriginMoves)
+{
+  Scene scene;
+  scene.add_object(Triangle(Vec3(-1, 10, -1), Vec3(1, 10, -1), Vec3(0, 10, 1)));
+  scene.set_angular_grid({Vec3(0, 0, 0), {0.0, M_PI / 2}, {0.0}});
+
+  // From the grid origin the triangle is only binned under the +y azimuth.
+  HitRecord rec;
+  EXPECT_FALSE(scene.intersect_sensor_ray(0, 0, Ray(Vec3(0, 0, 0), Vec3(1, 0, 0)), rec));
+  EXPECT_TRUE(scene.intersect_sensor_ray(1, 0, Ray(Vec3(0, 0, 0), Vec3(0, 1, 0)), rec));
+
+  // A ray from elsewhere is traced through the general accelerator, whatever cell it names.
+  ASSERT_TRUE(scene.intersect_sensor_ray(0, 0, Ray(Vec3(0, 5, 0), Vec3(0, 1, 0)), rec));
+  EXPECT_NEAR(rec.t, 5.0, 1e-9);
+}
+
+TEST(AngularGridTest, ScanMatchesScanWithoutGrid)
+{
+  const LiDARConfig cfg{400, {-0.5, -0.2, 0.0, 0.1, 0.4}};
+  LidarSimulator plain(std::make_unique<LidarEmitter>(cfg), make_shell_scene(1500, 5));
+  LidarSimulator gridded(std::make_unique<LidarEmitter>(cfg), make_shell_scene(1500, 5));
+  gridded.set_scan_options({2, 16, true});
+
+  const auto expected = plain.run_scan(1)[0];
+  const auto actual = gridded.run_scan(1)[0];
+  ASSERT_TRUE(gridded.scene().has_angular_grid());
+  ASSERT_GT(expected.hits, 0);
+  EXPECT_EQ(actual.hits, expected.hits);
+  for (int i = 0; i < cfg.azimuth_steps; ++i)
+  {
+    for (size_t j = 0; j < cfg.elevation_angles.size(); ++j)
+    {
+      ASSERT_EQ(actual.range(i, j), expected.range(i, j)) << "i=" << i << " j=" << j;
+    }
+  }
+}
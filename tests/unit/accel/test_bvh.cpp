@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle.h"
+#include "test_helpers.h"
+
+using percepto::accel::Bvh, percepto::accel::BvhBuildOptions, percepto::accel::BvhNode;
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::Sphere, percepto::geometry::Triangle;
+using percepto::test::make_rays, percepto::test::make_shell;
+
+TEST(BvhTest, EmptyBuildHasNoNodesAndNeverHits)
+{
+  Bvh bvh;
+  bvh.build({});
+  EXPECT_TRUE(bvh.empty());
+  EXPECT_EQ(bvh.depth(), 0);
+
+  Ray ray(Vec3(0, 0, 0), Vec3(1, 0, 0));
+  bool called = false;
+  EXPECT_FALSE(bvh.traverse(ray, ray.tMax(), [&](uint32_t, double&) { return called = true; }));
+  EXPECT_FALSE(called);
+}
+
+TEST(BvhTest, NodesCoverEveryPrimitiveExactlyOnce)
+{
+  auto tris = make_shell(2000, 100.0, 7);
+  std::vector<AABB> bounds;
+  for (const auto& t : tris) bounds.push_back(t.bounds());
+
+  BvhBuildOptions options;
+  options.max_leaf_size = 4;
+  Bvh bvh;
+  bvh.build(bounds, options);
+
+  std::vector<int> seen(tris.size(), 0);
+  const auto& nodes = bvh.nodes();
+  for (size_t n = 0; n < nodes.size(); ++n)
+  {
+    const BvhNode& node = nodes[n];
+    if (node.is_leaf())
+    {
+      EXPECT_LE(node.count, 4u);
+      for (uint32_t i = 0; i < node.count; ++i)
+      {
+        uint32_t prim = bvh.prim_indices()[node.offset + i];
+        seen[prim]++;
+        EXPECT_TRUE(node.bounds.contains(bounds[prim]));
+      }
+    }
+    else
+    {
+      EXPECT_TRUE(node.bounds.contains(nodes[n + 1].bounds));
+      EXPECT_TRUE(node.bounds.contains(nodes[node.offset].bounds));
+    }
+  }
+
+  for (size_t i = 0; i < seen.size(); ++i) EXPECT_EQ(seen[i], 1) << "primitive " << i;
+  EXPECT_LT(bvh.depth(), Bvh::kMaxDepth);
+}
+
+TEST(BvhTest, IdenticalPrimitivesStillBuild)
+{
+  // All centroids coincide, so the builder has to fall back to count splits.
+  std::vector<AABB> bounds(100, AABB(Vec3(0, 0, 0), Vec3(1, 1, 1)));
+  Bvh bvh;
+  bvh.build(bounds);
+  EXPECT_FALSE(bvh.empty());
+  EXPECT_EQ(bvh.prim_indices().size(), bounds.size());
+}
+
+TEST(BvhTest, SceneBvhMatchesBruteForce)
+{
+  auto tris = make_shell(5000, 100.0, 42);
+
+  Scene linear, accelerated;
+  linear.set_accelerator(AcceleratorType::None);
+  accelerated.set_accelerator(AcceleratorType::Bvh);
+  for (const auto& t : tris)
+  {
+    linear.add_object(t);
+    accelerated.add_object(t);
+  }
+  linear.add_object(Sphere(Vec3(30, 0, 0), 5.0));
+  accelerated.add_object(Sphere(Vec3(30, 0, 0), 5.0));
+  accelerated.commit();
+  ASSERT_FALSE(accelerated.bvh().empty());
+
+  int hits = 0;
+  for (const Ray& ray : make_rays(2000, 3))
+  {
+    HitRecord expected, actual;
+    bool expected_hit = linear.intersect(ray, expected);
+    bool actual_hit = accelerated.intersect(ray, actual);
+
+    ASSERT_EQ(expected_hit, actual_hit);
+    if (expected_hit)
+    {
+      ++hits;
+      EXPECT_DOUBLE_EQ(expected.t, actual.t);
+      EXPECT_VEC3_EQ(linear.resolve(ray, expected).normal,
+                     accelerated.resolve(ray, actual).normal);
+    }
+  }
+  EXPECT_GT(hits, 0);
+}
+
+TEST(BvhTest, SceneRebuildsAfterAddObject)
+{
+  Scene scene;
+  scene.add_object(Triangle(Vec3(0, 0, -2), Vec3(1, 0, -2), Vec3(0, 1, -2)));
+
+  Ray ray(Vec3(0.25, 0.25, 1.0), Vec3(0.0, 0.0, -1.0), 0.0, 100.0);
+  HitRecord rec;
+  ASSERT_TRUE(scene.intersect(ray, rec));
+  EXPECT_NEAR(rec.t, 3.0, 1e-9);
+
+  scene.add_object(Triangle(Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0)));
+  ASSERT_TRUE(scene.intersect(ray, rec));
+  EXPECT_NEAR(rec.t, 1.0, 1e-9);
+}
+
+TEST(BvhTest, RefitAndSubtreeRebuildKeepTheTreeValid)
+{
+  auto tris = make_shell(2000, 100.0, 11);
+  std::vector<AABB> bounds;
+  for (const auto& t : tris) bounds.push_back(t.bounds());
+  Bvh bvh;
+  bvh.build(bounds);
+
+  auto expect_valid = [&]()
+  {
+    std::vector<int> seen(bounds.size(), 0);
+    const auto& nodes = bvh.nodes();
+    for (size_t n = 0; n < nodes.size(); ++n)
+    {
+      if (!nodes[n].is_leaf())
+      {
+        ASSERT_TRUE(nodes[n].bounds.contains(nodes[n + 1].bounds)) << "node " << n;
+        ASSERT_TRUE(nodes[n].bounds.contains(nodes[nodes[n].offset].bounds)) << "node " << n;
+        continue;
+      }
+      for (uint32_t i = nodes[n].offset; i < nodes[n].offset + nodes[n].count; ++i)
+      {
+        ++seen[bvh.prim_indices()[i]];
+        ASSERT_TRUE(nodes[n].bounds.contains(bounds[bvh.prim_indices()[i]])) << "node " << n;
+      }
+    }
+    for (size_t i = 0; i < seen.size(); ++i) ASSERT_EQ(seen[i], 1) << "primitive " << i;
+  };
+
+  // Move a primitive of the leftmost leaf across the scene and refit.
+  uint32_t leaf = 0;
+  while (!bvh.nodes()[leaf].is_leaf()) ++leaf;
+  const uint32_t moved = bvh.prim_indices()[bvh.nodes()[leaf].offset];
+  bounds[moved] = AABB(Vec3(-120, -120, -5), Vec3(-119, -119, -4));
+  const double before = bvh.sah_area();
+  std::vector<uint32_t> changed;
+  const double delta = bvh.refit_leaf(
+      leaf, [&](uint32_t prim) { return bounds[prim]; }, changed);
+  EXPECT_FALSE(changed.empty());
+  EXPECT_NEAR(bvh.sah_area(), before + delta, 1e-9 * before);
+  expect_valid();
+
+  // Rebuild the root's left subtree, which holds the moved primitive; the right one moves along.
+  EXPECT_EQ(bvh.common_ancestor(leaf, bvh.nodes()[0].offset), 0u);
+  EXPECT_EQ(bvh.common_ancestor(leaf, 1), 1u);
+  const uint32_t subtree = 1;
+  const auto [first, count] = bvh.subtree_prims(subtree);
+  std::vector<AABB> run;
+  for (uint32_t i = first; i < first + count; ++i) run.push_back(bounds[bvh.prim_indices()[i]]);
+  ASSERT_TRUE(bvh.rebuild_subtree(subtree, run, BvhBuildOptions()));
+  expect_valid();
+  EXPECT_LT(bvh.depth(), Bvh::kMaxDepth);
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/lbvh.h"
+#include "percepto/common/thread_pool.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle.h"
+#include "test_helpers.h"
+
+using percepto::accel::Bvh, percepto::accel::BvhBuildOptions, percepto::accel::BvhNode;
+using percepto::accel::morton_code30, percepto::accel::morton_code63;
+using percepto::common::AcceleratorType, percepto::common::BvhBuilder, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::Triangle;
+
+namespace
+{
+// Small triangles on a ground plane with some walls: flat and clustered, like street scenes.
+std::vector<Triangle> make_street(int count, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> xy(-100.0, 100.0), size(0.2, 1.0);
+  std::vector<Triangle> tris;
+  for (int i = 0; i < count; ++i)
+  {
+    const double x = xy(rng), y = xy(rng), s = size(rng);
+    if (i % 4)
+    {
+      tris.emplace_back(Vec3(x, y, -2.0), Vec3(x + s, y, -2.0), Vec3(x, y + s, -2.0));
+    }
+    else
+    {
+      const double wall = std::round(x / 25.0) * 25.0;
+      tris.emplace_back(Vec3(wall, y, s), Vec3(wall, y + s, s), Vec3(wall, y, 2.0 * s));
+    }
+  }
+  return tris;
+}
+
+std::vector<AABB> bounds_of(const std::vector<Triangle>& tris)
+{
+  std::vector<AABB> bounds;
+  for (const auto& t : tris) bounds.push_back(t.bounds());
+  return bounds;
+}
+
+// Expected SAH cost per ray of a tree, for unit traversal and intersection costs.
+double sah_cost(const Bvh& bvh)
+{
+  const auto& nodes = bvh.nodes();
+  double cost = 0.0;
+  for (const BvhNode& node : nodes)
+  {
+    cost += node.bounds.surface_area() * (node.is_leaf() ? node.count : 1.0);
+  }
+  return cost / nodes[0].bounds.surface_area();
+}
+
+void expect_valid(const Bvh& bvh, const std::vector<AABB>& bounds, uint32_t max_leaf_size)
+{
+  std::vector<int> seen(bounds.size(), 0);
+  const auto& nodes = bvh.nodes();
+  for (size_t n = 0; n < nodes.size(); ++n)
+  {
+    const BvhNode& node = nodes[n];
+    if (node.is_leaf())
+    {
+      EXPECT_LE(node.count, max_leaf_size);
+      for (uint32_t i = 0; i < node.count; ++i)
+      {
+        const uint32_t prim = bvh.prim_indices()[node.offset + i];
+        seen[prim]++;
+        EXPECT_TRUE(node.bounds.contains(bounds[prim]));
+      }
+    }
+    else
+    {
+      ASSERT_LT(node.offset, nodes.size());
+      EXPECT_TRUE(node.bounds.contains(nodes[n + 1].bounds));
+      EXPECT_TRUE(node.bounds.contains(nodes[node.offset].bounds));
+    }
+  }
+  for (size_t i = 0; i < seen.size(); ++i) EXPECT_EQ(seen[i], 1) << "primitive " << i;
+  EXPECT_LT(bvh.depth(), Bvh::kMaxDepth);
+}
+}  // namespace
+
+TEST(LbvhTest, MortonCodesInterleaveAxesWithXHighest)
+{
+  EXPECT_EQ(morton_code30(1, 0, 0), 4u);
+  EXPECT_EQ(morton_code30(0, 1, 0), 2u);
+  EXPECT_EQ(morton_code30(0, 0, 1), 1u);
+  EXPECT_EQ(morton_code30(2, 0, 3), 0b101'001u);
+  EXPECT_EQ(morton_code30(1023, 1023, 1023), (1u << 30) - 1);
+  EXPECT_EQ(morton_code63(0, 0, 1u << 20), uint64_t{1} << 60);
+  EXPECT_EQ(morton_code63(0x1FFFFF, 0x1FFFFF, 0x1FFFFF), (uint64_t{1} << 63) - 1);
+}
+
+TEST(LbvhTest, RadixSortIsStableWithAndWithoutThreads)
+{
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<uint64_t> key(0, (uint64_t{1} << 30) - 1);
+  std::vector<uint64_t> keys(50000);
+  for (size_t i = 0; i < keys.size(); ++i) keys[i] = i % 3 ? key(rng) : key(rng) & 0xFF;
+
+  std::vector<uint32_t> expected(keys.size());
+  std::iota(expected.begin(), expected.end(), 0u);
+  std::stable_sort(expected.begin(), expected.end(),
+                   [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+  percepto::common::ThreadPool pool(4);
+  for (auto* p : {static_cast<percepto::common::ThreadPool*>(nullptr), &pool})
+  {
+    auto sorted_keys = keys;
+    std::vector<uint32_t> values(keys.size());
+    std::iota(values.begin(), values.end(), 0u);
+    percepto::accel::radix_sort_pairs(sorted_keys, values, 30, p);
+    ASSERT_EQ(values, expected);
+    EXPECT_TRUE(std::is_sorted(sorted_keys.begin(), sorted_keys.end()));
+  }
+}
+
+TEST(LbvhTest, NodesCoverEveryPrimitiveExactlyOnce)
+{
+  const auto bounds = bounds_of(make_street(3000, 11));
+  for (int bits : {30, 63})
+  {
+    for (bool treelets : {false, true})
+    {
+      SCOPED_TRACE("bits=" + std::to_string(bits) + " treelets=" + std::to_string(treelets));
+      BvhBuildOptions options;
+      options.builder = BvhBuilder::Lbvh;
+      options.morton_bits = bits;
+      options.treelet_optimization = treelets;
+      Bvh bvh;
+      bvh.build(bounds, options);
+      expect_valid(bvh, bounds, options.max_leaf_size);
+    }
+  }
+}
+
+TEST(LbvhTest, TinyAndDegenerateInputsBuild)
+{
+  BvhBuildOptions options;
+  options.builder = BvhBuilder::Lbvh;
+  options.treelet_optimization = true;
+  Bvh bvh;
+
+  bvh.build({}, options);
+  EXPECT_TRUE(bvh.empty());
+
+  for (size_t count : {1, 2, 3, 100})
+  {
+    // All centroids coincide, so only the primitive order tells the Morton keys apart.
+    const std::vector<AABB> bounds(count, AABB(Vec3(0, 0, 0), Vec3(1, 1, 1)));
+    bvh.build(bounds, options);
+    expect_valid(bvh, bounds, count == 100 ? 4 : count);
+  }
+}
+
+TEST(LbvhTest, TreeletsRecoverSahQuality)
+{
+  const auto bounds = bounds_of(make_street(20000, 3));
+  BvhBuildOptions options;
+  Bvh sah, lbvh, optimized;
+  sah.build(bounds, options);
+  options.builder = BvhBuilder::Lbvh;
+  lbvh.build(bounds, options);
+  options.treelet_optimization = true;
+  optimized.build(bounds, options);
+
+  EXPECT_LT(sah_cost(optimized), sah_cost(lbvh));
+  EXPECT_LT(sah_cost(optimized), 1.1 * sah_cost(sah));
+}
+
+TEST(LbvhTest, ParallelBuildMatchesSerialBuild)
+{
+  const auto bounds = bounds_of(make_street(40000, 8));
+  BvhBuildOptions options;
+  options.builder = BvhBuilder::Lbvh;
+  options.treelet_optimization = true;
+  Bvh serial, parallel;
+  options.thread_count = 1;
+  serial.build(bounds, options);
+  options.thread_count = 4;
+  parallel.build(bounds, options);
+
+  ASSERT_EQ(serial.nodes().size(), parallel.nodes().size());
+  EXPECT_EQ(serial.prim_indices(), parallel.prim_indices());
+  for (size_t n = 0; n < serial.nodes().size(); ++n)
+  {
+    ASSERT_EQ(serial.nodes()[n].offset, parallel.nodes()[n].offset) << "node " << n;
+    ASSERT_EQ(serial.nodes()[n].count, parallel.nodes()[n].count) << "node " << n;
+  }
+}
+
+TEST(LbvhTest, SceneLbvhMatchesBruteForce)
+{
+  const auto tris = make_street(20000, 42);
+  Scene linear, accelerated;
+  linear.set_accelerator(AcceleratorType::None);
+  accelerated.set_accelerator(AcceleratorType::Bvh8);
+  BvhBuildOptions options;
+  options.builder = BvhBuilder::Lbvh;
+  options.treelet_optimization = true;
+  accelerated.set_bvh_options(options);
+  for (const auto& t : tris)
+  {
+    linear.add_object(t);
+    accelerated.add_object(t);
+  }
+
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.5, 0.2);
+  int hits = 0;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const double a = az(rng), e = el(rng);
+    const Ray ray(Vec3(0, 0, 0), Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a),
+                                      std::sin(e)));
+    HitRecord expected, actual;
+    const bool expected_hit = linear.intersect(ray, expected);
+    ASSERT_EQ(accelerated.intersect(ray, actual), expected_hit) << "ray " << i;
+    if (expected_hit)
+    {
+      ++hits;
+      EXPECT_DOUBLE_EQ(actual.t, expected.t);
+      EXPECT_VEC3_EQ(accelerated.resolve(ray, actual).normal,
+                     linear.resolve(ray, expected).normal);
+    }
+  }
+  EXPECT_GT(hits, 50);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/accel/motion_bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/sphere.h"
+
+using percepto::accel::BvhNode, percepto::accel::MotionBvh;
+using percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::Sphere;
+
+namespace
+{
+// Small spheres on a shell around the origin, each travelling up to 6 units in a random direction.
+struct MovingSpheres
+{
+  std::vector<Vec3> start, end;
+  double radius = 0.3;
+
+  Sphere at(uint32_t id, double time) const
+  {
+    return Sphere((1.0 - time) * start[id] + time * end[id], radius);
+  }
+  std::vector<AABB> bounds(double time) const
+  {
+    std::vector<AABB> boxes;
+    for (uint32_t id = 0; id < start.size(); ++id) boxes.push_back(at(id, time).bounds());
+    return boxes;
+  }
+};
+
+MovingSpheres make_spheres(int count, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.5, 0.5), r(10.0, 30.0);
+  std::uniform_real_distribution<double> step(-3.0, 3.0);
+  MovingSpheres spheres;
+  for (int i = 0; i < count; ++i)
+  {
+    const double a = az(rng), e = el(rng), d = r(rng);
+    const Vec3 p(d * std::cos(e) * std::cos(a), d * std::cos(e) * std::sin(a), d * std::sin(e));
+    spheres.start.push_back(p);
+    spheres.end.push_back(p + Vec3(step(rng), step(rng), step(rng)));
+  }
+  return spheres;
+}
+
+bool contains(const AABB& outer, const AABB& inner)
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (inner.min[axis] < outer.min[axis] || inner.max[axis] > outer.max[axis]) return false;
+  }
+  return true;
+}
+}  // namespace
+
+TEST(MotionBvhTest, RejectsMismatchedBoundsAndClears)
+{
+  MotionBvh tree;
+  EXPECT_THROW(tree.build({AABB()}, {}), std::invalid_argument);
+
+  const MovingSpheres spheres = make_spheres(50, 3);
+  tree.build(spheres.bounds(0.0), spheres.bounds(1.0));
+  EXPECT_FALSE(tree.empty());
+  EXPECT_GT(tree.memory_bytes(), 0u);
+  tree.clear();
+  EXPECT_TRUE(tree.empty());
+  EXPECT_FALSE(tree.traverse(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0)), 100.0,
+                             [](uint32_t, double&) { return true; }));
+}
+
+TEST(MotionBvhTest, BlendedBoxesEncloseTheirPrimitivesThroughout)
+{
+  const MovingSpheres spheres = make_spheres(500, 7);
+  MotionBvh tree;
+  tree.build(spheres.bounds(0.0), spheres.bounds(1.0));
+  const auto& nodes = tree.nodes();
+
+  for (double time : {0.0, 0.1, 0.37, 0.5, 0.83, 1.0})
+  {
+    for (uint32_t n = 0; n < nodes.size(); ++n)
+    {
+      const AABB box = tree.bounds_at(n, time);
+      const BvhNode& node = nodes[n];
+      if (!node.is_leaf())
+      {
+        EXPECT_TRUE(contains(box, tree.bounds_at(n + 1, time))) << "node " << n;
+        EXPECT_TRUE(contains(box, tree.bounds_at(node.offset, time))) << "node " << n;
+        continue;
+      }
+      for (uint32_t i = 0; i < node.count; ++i)
+      {
+        const uint32_t id = tree.prim_indices()[node.offset + i];
+        EXPECT_TRUE(contains(box, spheres.at(id, time).bounds())) << "prim " << id;
+      }
+    }
+  }
+}
+
+TEST(MotionBvhTest, TraversalAtEachRayTimeMatchesBruteForce)
+{
+  const MovingSpheres spheres = make_spheres(800, 11);
+  MotionBvh tree;
+  tree.build(spheres.bounds(0.0), spheres.bounds(1.0));
+
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.5, 0.5), when(0.0, 1.0);
+  int hits = 0;
+  for (int k = 0; k < 2000; ++k)
+  {
+    const double a = az(rng), e = el(rng);
+    Ray ray(Vec3(0, 0, 0), Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a), std::sin(e)),
+            0.0, 100.0);
+    ray.setTime(when(rng));
+
+    double expected = ray.tMax();
+    for (uint32_t id = 0; id < spheres.start.size(); ++id)
+    {
+      HitRecord rec;
+      if (spheres.at(id, ray.time()).intersect(ray, rec) && rec.t < expected) expected = rec.t;
+    }
+
+    double closest = ray.tMax();
+    const bool hit = tree.traverse(ray, ray.tMax(),
+                                   [&](uint32_t leaf, double& t_max)
+                                   {
+                                     bool found = false;
+                                     const BvhNode& node = tree.nodes()[leaf];
+                                     for (uint32_t i = 0; i < node.count; ++i)
+                                     {
+                                       const uint32_t id = tree.prim_indices()[node.offset + i];
+                                       HitRecord rec;
+                                       if (spheres.at(id, ray.time()).intersect(ray, rec) &&
+                                           rec.t < t_max)
+                                       {
+                                         t_max = rec.t;
+                                         found = true;
+                                       }
+                                     }
+                                     if (found) closest = t_max;
+                                     return found;
+                                   });
+    ASSERT_EQ(hit, expected < ray.tMax()) << "ray " << k;
+    if (!hit) continue;
+    ++hits;
+    EXPECT_DOUBLE_EQ(closest, expected) << "ray " << k;
+  }
+  EXPECT_GT(hits, 100);
+}
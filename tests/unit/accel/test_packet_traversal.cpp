@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "percepto/accel/packet_traversal.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "test_helpers.h"
+
+using percepto::accel::intersect_packet_box, percepto::accel::PacketFrustum;
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+Vec3 spherical(double az, double el)
+{
+  return Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el));
+}
+}  // namespace
+
+TEST(PacketTraversalTest, BoxTestMatchesAabbAndFrustumIsConservative)
+{
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> u(-3.0, 3.0);
+  auto random_vec = [&] { return Vec3(u(rng), u(rng), u(rng)); };
+
+  int hits = 0, culled = 0;
+  for (int trial = 0; trial < 500; ++trial)
+  {
+    // Integer origins and boxes put some rays exactly on slab planes, and the axis-parallel
+    // directions then give 0 * inf slab distances.
+    const Vec3 origin = trial % 4 ? random_vec() : Vec3(0, 0, 0);
+    RayPacket packet;
+    const Vec3 base = random_vec();
+    for (int i = 0; i < RayPacket::kMaxSize; ++i)
+    {
+      Vec3 dir = base + 0.2 * random_vec();
+      if (trial % 4 == 0 && i < 3)
+      {
+        dir = i == 0 ? Vec3(1, 0, 0) : i == 1 ? Vec3(0, 1, 0) : Vec3(0, 0, -1);
+      }
+      packet.push(Ray(origin, dir, 0.0, 1.0 + trial % 5));
+    }
+    const AABB box = trial % 4 ? AABB(random_vec(), random_vec() + Vec3(3, 3, 3))
+                               : AABB(Vec3(0, -1, -1), Vec3(2, 1, 0));
+    const uint32_t active = trial % 3 ? packet.lanes() : 0x0F0Fu;
+
+    const uint32_t mask = intersect_packet_box(box, packet, active, packet.t_max);
+    for (int i = 0; i < packet.count; ++i)
+    {
+      const Ray ray = packet.ray(i);
+      const Vec3 inv(1.0 / ray.direction().x, 1.0 / ray.direction().y, 1.0 / ray.direction().z);
+      double t_entry;
+      const bool expected =
+          (active >> i & 1u) && box.intersect(origin, inv, ray.tMin(), ray.tMax(), t_entry);
+      ASSERT_EQ(bool(mask >> i & 1u), expected) << "trial " << trial << " ray " << i;
+      hits += expected;
+    }
+
+    const bool may_hit = PacketFrustum(packet, active, packet.t_max).may_hit(box);
+    if (mask)
+    {
+      EXPECT_TRUE(may_hit) << "trial " << trial;
+    }
+    culled += !may_hit;
+  }
+  EXPECT_GT(hits, 0);
+  EXPECT_GT(culled, 0);
+}
+
+TEST(PacketTraversalTest, ScenePacketsMatchSingleRays)
+{
+  // A band of free triangles, the same band again as a mesh further out, and a few spheres.
+  auto point = [](int a, int e, double r)
+  { return r * spherical(2.0 * M_PI * a / 120, -0.6 + 1.2 * e / 8); };
+  percepto::geometry::TriangleMeshBuilder builder;
+  std::vector<Scene::Object> objects;
+  for (int a = 0; a < 120; ++a)
+  {
+    for (int e = 0; e < 8; ++e)
+    {
+      if ((a + e) % 3)
+      {
+        objects.emplace_back(Triangle(point(a, e, 20), point(a, e + 1, 20), point(a + 1, e, 20)));
+      }
+      builder.add_triangle(point(a, e, 30), point(a, e + 1, 30), point(a + 1, e, 30));
+      builder.add_triangle(point(a + 1, e, 30), point(a, e + 1, 30), point(a + 1, e + 1, 30));
+    }
+  }
+  for (int s = 0; s < 6; ++s) objects.emplace_back(Sphere(12.0 * spherical(s, 0.1 * s), 1.5));
+  const auto mesh = builder.build();
+
+  for (auto accelerator :
+       {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh4, AcceleratorType::Bvh8})
+  {
+    SCOPED_TRACE(static_cast<int>(accelerator));
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    for (const auto& object : objects) scene.add_object(object);
+    scene.add_mesh(mesh);
+
+    int hits = 0;
+    for (int column = 0; column < 300; ++column)
+    {
+      // One sensor column; channel 7 is exactly horizontal, and packets vary in size.
+      RayPacket packet;
+      const double az = 2.0 * M_PI * column / 300;
+      const int count = 1 + column % RayPacket::kMaxSize;
+      for (int j = 0; j < count; ++j)
+      {
+        const double t_max = column % 7 ? 2000 : 25;
+        packet.push(Ray(Vec3(0, 0, 0), spherical(az, 0.04 * (j - 7)), 0.0, t_max));
+      }
+
+      HitRecord records[RayPacket::kMaxSize];
+      const uint32_t mask = scene.intersect_packet(packet, records);
+      for (int j = 0; j < count; ++j)
+      {
+        HitRecord expected;
+        const bool expected_hit = scene.intersect(packet.ray(j), expected);
+        ASSERT_EQ(bool(mask >> j & 1u), expected_hit) << "column " << column << " ray " << j;
+        if (expected_hit)
+        {
+          ++hits;
+          ASSERT_EQ(records[j].t, expected.t) << "column " << column << " ray " << j;
+          ASSERT_TRUE(scene.resolve(packet.ray(j), records[j]).point ==
+                      scene.resolve(packet.ray(j), expected).point);
+        }
+      }
+    }
+    EXPECT_GT(hits, 1000);
+  }
+}
@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/accel/wide_bvh.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/triangle.h"
+#include "test_helpers.h"
+
+using percepto::accel::Bvh, percepto::accel::TraversalStats, percepto::accel::WideBvh;
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::AABB, percepto::geometry::Sphere, percepto::geometry::Triangle;
+using percepto::test::make_rays, percepto::test::make_shell;
+
+namespace
+{
+Bvh build_binary(const std::vector<Triangle>& tris)
+{
+  std::vector<AABB> bounds;
+  for (const auto& t : tris) bounds.push_back(t.bounds());
+  Bvh bvh;
+  bvh.build(bounds);
+  return bvh;
+}
+
+template <int W>
+void expect_collapse_covers_every_leaf(const Bvh& binary)
+{
+  WideBvh<W> wide;
+  wide.build(binary);
+  ASSERT_FALSE(wide.empty());
+
+  std::vector<int> seen(binary.nodes().size(), 0);
+  for (const auto& node : wide.nodes())
+  {
+    ASSERT_GE(node.child_count, 1u);
+    ASSERT_LE(node.child_count, static_cast<uint32_t>(W));
+    for (uint32_t c = 0; c < node.child_count; ++c)
+    {
+      if (!WideBvh<W>::Node::is_leaf(node.child[c])) continue;
+      const uint32_t leaf = WideBvh<W>::Node::leaf_index(node.child[c]);
+      ASSERT_TRUE(binary.nodes()[leaf].is_leaf());
+      ++seen[leaf];
+      // Child boxes are the binary tree's own, bit for bit.
+      EXPECT_EQ(node.min_x[c], binary.nodes()[leaf].bounds.min.x);
+      EXPECT_EQ(node.max_z[c], binary.nodes()[leaf].bounds.max.z);
+    }
+  }
+  for (size_t n = 0; n < binary.nodes().size(); ++n)
+  {
+    EXPECT_EQ(seen[n], binary.nodes()[n].is_leaf() ? 1 : 0) << "node " << n;
+  }
+}
+}  // namespace
+
+TEST(WideBvhTest, CollapseReferencesEveryBinaryLeafOnce)
+{
+  const Bvh binary = build_binary(make_shell(3000, 100.0, 7));
+  expect_collapse_covers_every_leaf<4>(binary);
+  expect_collapse_covers_every_leaf<8>(binary);
+
+  // Nodes are filled: far fewer wide nodes than binary interior nodes.
+  WideBvh<8> wide;
+  wide.build(binary);
+  EXPECT_LT(wide.nodes().size() * 3, binary.nodes().size() / 2);
+}
+
+TEST(WideBvhTest, SlabTestMatchesAabbIncludingAxisParallelRays)
+{
+  percepto::accel::WideBvhNode<8> node;
+  const std::vector<AABB> boxes = {
+      AABB(Vec3(1, -1, -1), Vec3(2, 1, 1)),    AABB(Vec3(-2, -1, -1), Vec3(-1, 1, 1)),
+      AABB(Vec3(0, 0, 0), Vec3(1, 1, 1)),      AABB(Vec3(0, 0, 5), Vec3(3, 3, 5)),
+      AABB(Vec3(-1, -1, 0), Vec3(1, 1, 0)),    AABB(Vec3(5, 5, 5), Vec3(6, 6, 6)),
+      AABB(Vec3(-9, -9, -9), Vec3(9, 9, 9)),   AABB(Vec3(0.5, 0, 0), Vec3(0.5, 2, 2)),
+  };
+  node.child_count = static_cast<uint32_t>(boxes.size());
+  for (size_t c = 0; c < boxes.size(); ++c)
+  {
+    node.min_x[c] = boxes[c].min.x;
+    node.min_y[c] = boxes[c].min.y;
+    node.min_z[c] = boxes[c].min.z;
+    node.max_x[c] = boxes[c].max.x;
+    node.max_y[c] = boxes[c].max.y;
+    node.max_z[c] = boxes[c].max.z;
+  }
+
+  // Origins on slab planes with axis-parallel directions produce 0 * inf = NaN slab distances.
+  std::vector<std::pair<Vec3, Vec3>> rays = {
+      {Vec3(0, 0, 0), Vec3(1, 0, 0)},  {Vec3(0, 0, 0), Vec3(0, 0, 1)},
+      {Vec3(0, 1, 0), Vec3(1, 0, 0)},  {Vec3(0, 0, 5), Vec3(1, 0, 0)},
+      {Vec3(1, 1, 1), Vec3(-1, 0, 0)}, {Vec3(0.5, 0, 0), Vec3(0, 1, 0)},
+      {Vec3(0, 0, 0), Vec3(1, 1, 1)},  {Vec3(-3, 0.5, 0.5), Vec3(1, 0, 0)},
+  };
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> u(-3.0, 3.0);
+  for (int i = 0; i < 200; ++i)
+  {
+    rays.push_back({Vec3(u(rng), u(rng), u(rng)), Vec3(u(rng), u(rng), u(rng))});
+  }
+
+  for (const auto& [origin, dir] : rays)
+  {
+    const Vec3 inv{1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z};
+    for (double t_max : {std::numeric_limits<double>::infinity(), 1.5})
+    {
+      alignas(64) double t_entry[8];
+      const uint32_t mask =
+          percepto::accel::intersect_children(node, origin, inv, 0.0, t_max, t_entry);
+      for (size_t c = 0; c < boxes.size(); ++c)
+      {
+        double expected_entry = 0.0;
+        const bool expected = boxes[c].intersect(origin, inv, 0.0, t_max, expected_entry);
+        ASSERT_EQ(bool(mask & (1u << c)), expected) << "child " << c;
+        if (expected)
+        {
+          EXPECT_EQ(t_entry[c], expected_entry) << "child " << c;
+        }
+      }
+    }
+  }
+}
+
+TEST(WideBvhTest, SceneWideAcceleratorsMatchBruteForce)
+{
+  const auto tris = make_shell(5000, 100.0, 42);
+  Scene linear;
+  linear.set_accelerator(AcceleratorType::None);
+  for (const auto& t : tris) linear.add_object(t);
+  linear.add_object(Sphere(Vec3(30, 0, 0), 5.0));
+
+  for (auto accelerator : {AcceleratorType::Bvh4, AcceleratorType::Bvh8})
+  {
+    SCOPED_TRACE(accelerator == AcceleratorType::Bvh4 ? "bvh4" : "bvh8");
+    Scene wide;
+    wide.set_accelerator(accelerator);
+    for (const auto& t : tris) wide.add_object(t);
+    wide.add_object(Sphere(Vec3(30, 0, 0), 5.0));
+    wide.commit();
+    ASSERT_FALSE(accelerator == AcceleratorType::Bvh4 ? wide.bvh4().empty()
+                                                      : wide.bvh8().empty());
+
+    int hits = 0;
+    for (const Ray& ray : make_rays(2000, 3))
+    {
+      HitRecord expected, actual;
+      const bool expected_hit = linear.intersect(ray, expected);
+      ASSERT_EQ(expected_hit, wide.intersect(ray, actual));
+      if (expected_hit)
+      {
+        ++hits;
+        EXPECT_EQ(expected.t, actual.t);
+        EXPECT_VEC3_EQ(linear.resolve(ray, expected).normal, wide.resolve(ray, actual).normal);
+      }
+    }
+    EXPECT_GT(hits, 0);
+  }
+}
+
+TEST(WideBvhTest, WideTraversalVisitsFewerNodes)
+{
+  const auto tris = make_shell(20000, 100.0, 11);
+  const Bvh binary = build_binary(tris);
+  WideBvh<4> wide4;
+  WideBvh<8> wide8;
+  wide4.build(binary);
+  wide8.build(binary);
+
+  // Brute-force leaves, so all three trees report the same closest hit.
+  auto leaf_test = [&](const Ray& ray, HitRecord& rec)
+  {
+    return [&](uint32_t leaf, double& t_max)
+    {
+      const auto& node = binary.nodes()[leaf];
+      bool hit = false;
+      for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+      {
+        Ray clipped = ray;
+        clipped.setTMax(t_max);
+        HitRecord tmp;
+        if (tris[binary.prim_indices()[i]].intersect(clipped, tmp) && tmp.t < t_max)
+        {
+          t_max = tmp.t;
+          rec = tmp;
+          hit = true;
+        }
+      }
+      return hit;
+    };
+  };
+
+  TraversalStats s2, s4, s8;
+  for (const Ray& ray : make_rays(1000, 9))
+  {
+    HitRecord r2, r4, r8;
+    const bool h2 = binary.traverse(ray, ray.tMax(), leaf_test(ray, r2), &s2);
+    ASSERT_EQ(h2, wide4.traverse(ray, ray.tMax(), leaf_test(ray, r4), &s4));
+    ASSERT_EQ(h2, wide8.traverse(ray, ray.tMax(), leaf_test(ray, r8), &s8));
+    if (h2)
+    {
+      EXPECT_EQ(r2.t, r4.t);
+      EXPECT_EQ(r2.t, r8.t);
+    }
+  }
+  EXPECT_LT(s4.nodes, s2.nodes);
+  EXPECT_LT(s8.nodes, s4.nodes);
+}
+
+TEST(WideBvhTest, SingleLeafAndEmptyScenes)
+{
+  Scene empty;
+  empty.set_accelerator(AcceleratorType::Bvh8);
+  HitRecord rec;
+  EXPECT_FALSE(empty.intersect(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0)), rec));
+
+  Scene single;
+  single.set_accelerator(AcceleratorType::Bvh4);
+  single.add_object(Triangle(Vec3(2, 1, -1), Vec3(2, -1, -1), Vec3(2, 0, 1)));
+  single.commit();
+  ASSERT_EQ(single.bvh4().nodes().size(), 1u);
+  EXPECT_EQ(single.bvh4().nodes()[0].child_count, 1u);
+  ASSERT_TRUE(single.intersect(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0)), rec));
+  EXPECT_NEAR(rec.t, 2.0, 1e-12);
+}
+
+TEST(WideBvhTest, FloatBoundsNeverSkipALeafTheDoubleTreeVisits)
+{
+  // Far from the world origin, as map-frame scenes are, with rays aimed at triangle corners:
+  // those graze the leaf boxes, where rounding to float would first lose a leaf.
+  const Vec3 offset(4.0e5, -3.0e5, 120.0);
+  std::vector<Triangle> tris;
+  for (const Triangle& tri : make_shell(5000, 100.0, 13))
+  {
+    tris.emplace_back(tri.v0() + offset, tri.v1() + offset, tri.v2() + offset);
+  }
+  const Bvh binary = build_binary(tris);
+  WideBvh<4> wide4;
+  WideBvh<8> wide8;
+  WideBvh<4, float> float4;
+  WideBvh<8, float> float8;
+  wide4.build(binary);
+  wide8.build(binary);
+  float4.build(binary);
+  float8.build(binary);
+  EXPECT_GT(float8.padding(), 0.0);
+  EXPECT_LT(float8.padding(), 1e-2);
+  EXPECT_LT(float8.memory_bytes(), wide8.memory_bytes());
+
+  // Leaves each tree would visit with no hit to narrow the search.
+  auto visited = [](const auto& tree, const Ray& ray)
+  {
+    std::vector<uint32_t> leaves;
+    tree.traverse_any(ray, ray.tMax(),
+                      [&](uint32_t leaf)
+                      {
+                        leaves.push_back(leaf);
+                        return false;
+                      });
+    std::sort(leaves.begin(), leaves.end());
+    return leaves;
+  };
+
+  size_t double_leaves = 0, float_leaves = 0;
+  for (size_t i = 0; i < tris.size(); i += 7)
+  {
+    for (const Vec3& corner : {tris[i].v0(), tris[i].v1(), tris[i].v2()})
+    {
+      const Ray ray(offset, corner - offset, 0.0, 1000.0);
+      const auto expected4 = visited(wide4, ray), expected8 = visited(wide8, ray);
+      const auto actual4 = visited(float4, ray), actual8 = visited(float8, ray);
+      ASSERT_TRUE(std::includes(actual4.begin(), actual4.end(), expected4.begin(), expected4.end()))
+          << "triangle " << i;
+      ASSERT_TRUE(std::includes(actual8.begin(), actual8.end(), expected8.begin(), expected8.end()))
+          << "triangle " << i;
+      double_leaves += expected8.size();
+      float_leaves += actual8.size();
+    }
+  }
+  // Even for rays grazing the boxes, the padding adds only a few percent of leaf visits.
+  EXPECT_GT(double_leaves, 0u);
+  EXPECT_LT(float_leaves, double_leaves + double_leaves / 10);
+}
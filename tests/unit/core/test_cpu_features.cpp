@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/common/cpu_features.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/lidar/emitter.h"
+
+using percepto::common::AcceleratorType, percepto::common::CullMode, percepto::common::HitRecord,
+    percepto::common::Isa, percepto::common::Precision;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+// Every instruction set this CPU runs, narrowest first.
+std::vector<Isa> supported_isas()
+{
+  std::vector<Isa> isas;
+  for (Isa isa : {Isa::Scalar, Isa::Avx2, Isa::Avx512})
+  {
+    if (isa <= percepto::common::detect_isa()) isas.push_back(isa);
+  }
+  return isas;
+}
+
+// Puts the detected instruction set back when a test ends.
+class CpuFeaturesTest : public ::testing::Test
+{
+ protected:
+  void TearDown() override { percepto::common::set_isa(percepto::common::detect_isa()); }
+};
+
+struct Trace
+{
+  std::vector<bool> hits;
+  std::vector<HitRecord> records;
+  std::vector<uint32_t> packet_masks;
+  std::vector<HitRecord> packet_records;
+  std::vector<uint32_t> occluded;
+};
+
+Trace trace(Scene& scene)
+{
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> dir(-1.0, 1.0);
+  Trace out;
+  for (int p = 0; p < 200; ++p)
+  {
+    RayPacket packet;
+    for (int k = 0; k < RayPacket::kMaxSize; ++k)
+    {
+      const Ray ray(Vec3(0.0, 0.0, 0.0), Vec3(dir(rng), dir(rng), dir(rng)));
+      packet.push(ray);
+      HitRecord record;
+      out.hits.push_back(scene.intersect(ray, record));
+      out.records.push_back(record);
+    }
+    HitRecord records[RayPacket::kMaxSize];
+    out.packet_masks.push_back(scene.intersect_packet(packet, records));
+    out.packet_records.insert(out.packet_records.end(), records, records + packet.count);
+    out.occluded.push_back(scene.occluded_packet(packet));
+  }
+  return out;
+}
+
+void expect_same(const Trace& a, const Trace& b)
+{
+  ASSERT_EQ(a.hits, b.hits);
+  ASSERT_EQ(a.packet_masks, b.packet_masks);
+  EXPECT_EQ(a.occluded, b.occluded);
+  for (size_t k = 0; k < a.records.size(); ++k)
+  {
+    if (!a.hits[k]) continue;
+    EXPECT_EQ(a.records[k].t, b.records[k].t);
+    EXPECT_EQ(a.records[k].primitive, b.records[k].primitive);
+  }
+  for (size_t k = 0; k < a.packet_records.size(); ++k)
+  {
+    if (!(a.packet_masks[k / RayPacket::kMaxSize] >> (k % RayPacket::kMaxSize) & 1u)) continue;
+    EXPECT_EQ(a.packet_records[k].t, b.packet_records[k].t);
+    EXPECT_EQ(a.packet_records[k].primitive, b.packet_records[k].primitive);
+  }
+}
+}  // namespace
+
+TEST_F(CpuFeaturesTest, NamesRoundTripAndUnknownNamesThrow)
+{
+  for (Isa isa : {Isa::Scalar, Isa::Avx2, Isa::Avx512})
+  {
+    EXPECT_EQ(percepto::common::parse_isa(percepto::common::isa_name(isa)), isa);
+  }
+  EXPECT_THROW(percepto::common::parse_isa("sse4"), std::invalid_argument);
+  EXPECT_THROW(percepto::common::parse_isa(""), std::invalid_argument);
+}
+
+TEST_F(CpuFeaturesTest, SetIsaAcceptsOnlyWhatTheCpuRuns)
+{
+  EXPECT_EQ(percepto::common::active_isa(), percepto::common::detect_isa());
+  for (Isa isa : supported_isas())
+  {
+    percepto::common::set_isa(isa);
+    EXPECT_EQ(percepto::common::active_isa(), isa);
+  }
+  if (percepto::common::detect_isa() != Isa::Avx512)
+  {
+    EXPECT_THROW(percepto::common::set_isa(Isa::Avx512), std::invalid_argument);
+  }
+}
+
+TEST_F(CpuFeaturesTest, EveryInstructionSetTracesTheSameHits)
+{
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> pos(-20.0, 20.0), jitter(-1.5, 1.5);
+  Scene scene;
+  for (int i = 0; i < 500; ++i)
+  {
+    const Vec3 p(pos(rng), pos(rng), pos(rng));
+    scene.add_object(Triangle(p, p + Vec3(jitter(rng), jitter(rng), jitter(rng)),
+                              p + Vec3(jitter(rng), jitter(rng), jitter(rng))));
+  }
+  scene.add_object(Sphere(Vec3(3.0, -4.0, 2.0), 1.0));
+
+  for (AcceleratorType accel : {AcceleratorType::None, AcceleratorType::Bvh,
+                                AcceleratorType::Bvh4, AcceleratorType::Bvh8})
+  {
+    for (Precision precision : {Precision::Double, Precision::Single})
+    {
+      for (CullMode cull : {CullMode::Back, CullMode::None})
+      {
+        scene.set_accelerator(accel);
+        scene.set_precision(precision);
+        scene.set_cull_mode(cull);
+        percepto::common::set_isa(Isa::Scalar);
+        const Trace reference = trace(scene);
+        ASSERT_GT(std::count(reference.hits.begin(), reference.hits.end(), true), 100);
+        for (Isa isa : supported_isas())
+        {
+          SCOPED_TRACE(percepto::common::isa_name(isa));
+          percepto::common::set_isa(isa);
+          expect_same(trace(scene), reference);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(CpuFeaturesTest, EveryInstructionSetBuildsTheSameDirectionTable)
+{
+  // 13 channels: a full AVX-512 group, a full AVX2 group and a scalar tail.
+  std::vector<double> elevations;
+  for (int j = 0; j < 13; ++j) elevations.push_back(-0.4 + 0.065 * j);
+  for (Isa isa : supported_isas())
+  {
+    SCOPED_TRACE(percepto::common::isa_name(isa));
+    percepto::common::set_isa(isa);
+    percepto::lidar::LidarEmitter e(percepto::common::LiDARConfig{90, elevations});
+    e.enable_direction_table();
+    const auto& table = e.direction_table();
+    for (int i = 0; i < 90; ++i)
+    {
+      for (int j = 0; j < 13; ++j)
+      {
+        const Vec3 d = e.get_ray(i, j).direction();
+        const size_t k = i * 13 + j;
+        ASSERT_EQ(table.x[k], d.x);
+        ASSERT_EQ(table.y[k], d.y);
+        ASSERT_EQ(table.z[k], d.z);
+      }
+    }
+  }
+}
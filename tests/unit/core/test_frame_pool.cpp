@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+#include "percepto/common/frame_pool.h"
+#include "percepto/common/frame_scan.h"
+#include "percepto/core/vec3.h"
+
+using percepto::common::FramePool, percepto::common::FrameScan;
+using percepto::core::Vec3;
+
+TEST(FrameScanTest, BeamsAreStoredRowMajor)
+{
+  FrameScan frame(4, 3);
+  ASSERT_EQ(frame.ranges.size(), 12u);
+  ASSERT_EQ(frame.points.size(), 12u);
+  ASSERT_EQ(frame.intensities.size(), 12u);
+  EXPECT_EQ(frame.azimuth_angles.size(), 4u);
+
+  frame.range(2, 1) = 5.0f;
+  frame.point(2, 1) = Vec3(1.0, 2.0, 3.0);
+  frame.intensity(3, 2) = 0.5f;
+
+  EXPECT_EQ(frame.index(2, 1), 7u);
+  EXPECT_EQ(frame.ranges[7], 5.0f);
+  EXPECT_TRUE(frame.points[7] == Vec3(1.0, 2.0, 3.0));
+  EXPECT_EQ(frame.intensities[11], 0.5f);
+
+  const FrameScan& view = frame;
+  EXPECT_EQ(view.range(2, 1), 5.0f);
+  EXPECT_TRUE(view.point(2, 1) == Vec3(1.0, 2.0, 3.0));
+}
+
+TEST(FrameScanTest, ResetZeroesBeamsAndKeepsBuffers)
+{
+  FrameScan frame(8, 2);
+  frame.range(1, 1) = 3.0f;
+  frame.point(1, 1) = Vec3(1.0, 1.0, 1.0);
+  frame.intensity(0, 0) = 1.0f;
+  frame.hits = 1;
+  frame.timestamp = 2.5;
+  const float* ranges = frame.ranges.data();
+
+  frame.reset();
+
+  EXPECT_EQ(frame.ranges.data(), ranges);
+  EXPECT_EQ(frame.range(1, 1), 0.0f);
+  EXPECT_TRUE(frame.point(1, 1) == Vec3());
+  EXPECT_EQ(frame.intensity(0, 0), 0.0f);
+  EXPECT_EQ(frame.hits, 0);
+  EXPECT_EQ(frame.timestamp, 0.0);
+}
+
+TEST(FramePoolTest, ReusesReleasedFrames)
+{
+  FramePool pool;
+  FrameScan frame = pool.acquire(16, 4);
+  frame.range(3, 3) = 7.0f;
+  frame.hits = 1;
+  const float* ranges = frame.ranges.data();
+  const Vec3* points = frame.points.data();
+
+  pool.release(std::move(frame));
+  EXPECT_EQ(pool.size(), 1u);
+
+  FrameScan reused = pool.acquire(16, 4);
+  EXPECT_EQ(pool.size(), 0u);
+  EXPECT_EQ(reused.ranges.data(), ranges);
+  EXPECT_EQ(reused.points.data(), points);
+  EXPECT_EQ(reused.range(3, 3), 0.0f);
+  EXPECT_EQ(reused.hits, 0);
+}
+
+TEST(FramePoolTest, OnlyHandsOutFramesOfTheRequestedShape)
+{
+  FramePool pool;
+  pool.release(FrameScan(16, 4));
+  pool.release(FrameScan(8, 4));
+
+  FrameScan frame = pool.acquire(16, 4);
+  EXPECT_EQ(frame.azimuth_steps, 16);
+  EXPECT_EQ(frame.channel_count, 4);
+  EXPECT_EQ(pool.size(), 1u);
+
+  FrameScan fresh = pool.acquire(4, 4);
+  EXPECT_EQ(fresh.ranges.size(), 16u);
+  EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST(FramePoolTest, ReleasingAVectorEmptiesIt)
+{
+  FramePool pool;
+  std::vector<FrameScan> frames;
+  for (int k = 0; k < 3; ++k) frames.push_back(pool.acquire(4, 2));
+  const size_t capacity = frames.capacity();
+
+  pool.release(frames);
+
+  EXPECT_TRUE(frames.empty());
+  EXPECT_EQ(frames.capacity(), capacity);
+  EXPECT_EQ(pool.size(), 3u);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/primitive_store.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+
+using percepto::common::HitRecord;
+using percepto::core::PrimitiveStore, percepto::core::Ray, percepto::core::Vec3;
+using percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+using Store = PrimitiveStore<Sphere, Triangle>;
+
+Triangle triangle_at(double x)
+{
+  return Triangle(Vec3(x, 0, 5), Vec3(x, 1, 5), Vec3(x + 1, 0, 5));
+}
+}  // namespace
+
+TEST(PrimitiveStoreTest, KeepsEachTypeInItsOwnArray)
+{
+  Store store;
+  EXPECT_TRUE(store.empty());
+  EXPECT_EQ(store.push(Sphere(Vec3(0, 0, 0), 1.0)), 0u);
+  EXPECT_EQ(store.push(triangle_at(1)), 1u);
+  EXPECT_EQ(store.push(Sphere(Vec3(2, 0, 0), 2.0)), 2u);
+  EXPECT_EQ(store.push(triangle_at(3)), 3u);
+
+  ASSERT_EQ(store.size(), 4u);
+  EXPECT_EQ(Store::type_index<Sphere>(), 0);
+  EXPECT_EQ(Store::type_index<Triangle>(), 1);
+  EXPECT_EQ(store.type(1), Store::type_index<Triangle>());
+  EXPECT_EQ(store.items<Sphere>().size(), 2u);
+  EXPECT_EQ(store.ids<Triangle>(), (std::vector<uint32_t>{1, 3}));
+  EXPECT_EQ(store.items<Triangle>()[1].v0(), Vec3(3, 0, 5));
+
+  EXPECT_EQ(store.get_if<Triangle>(0), nullptr);
+  ASSERT_NE(store.get_if<Sphere>(2), nullptr);
+  EXPECT_EQ(store.get_if<Sphere>(2)->radius(), 2.0);
+  EXPECT_EQ(std::get<Triangle>(store[3]).v0(), Vec3(3, 0, 5));
+  EXPECT_EQ(store.visit(2, [](const auto& object) { return object.bounds().max.x; }), 4.0);
+
+  // The CRTP base dispatches to each type's own test.
+  HitRecord rec;
+  const Ray ray(Vec3(1.2, 0.2, 0), Vec3(0, 0, 1));
+  EXPECT_TRUE(store.visit(1, [&](const auto& object) { return object.intersect(ray, rec); }));
+  EXPECT_DOUBLE_EQ(rec.t, 5.0);
+}
+
+TEST(PrimitiveStoreTest, ReplacingWithAnotherTypeMovesTheObject)
+{
+  Store store;
+  for (int i = 0; i < 4; ++i) store.push(triangle_at(i));
+
+  store.assign(2, triangle_at(20));
+  EXPECT_EQ(store.get_if<Triangle>(2)->v0(), Vec3(20, 0, 5));
+
+  // The last triangle fills the hole, so the array stays contiguous and numbers keep meaning.
+  store.assign(1, Sphere(Vec3(0, 0, 0), 3.0));
+  EXPECT_EQ(store.items<Triangle>().size(), 3u);
+  EXPECT_EQ(store.items<Sphere>().size(), 1u);
+  EXPECT_EQ(store.get_if<Sphere>(1)->radius(), 3.0);
+  for (uint32_t id : {0u, 2u, 3u})
+  {
+    ASSERT_NE(store.get_if<Triangle>(id), nullptr) << id;
+    const double x = id == 2 ? 20.0 : id;
+    EXPECT_EQ(store.get_if<Triangle>(id)->v0(), Vec3(x, 0, 5)) << id;
+  }
+
+  store.assign(3, Sphere(Vec3(1, 1, 1), 1.0));
+  EXPECT_EQ(store.ids<Sphere>(), (std::vector<uint32_t>{1, 3}));
+  EXPECT_EQ(store.ids<Triangle>().size(), 2u);
+}
+
+TEST(PrimitiveStoreTest, ObjectsTakeTheirOwnSize)
+{
+  Store store;
+  store.reserve(1000);
+  for (int i = 0; i < 1000; ++i) store.push(triangle_at(i));
+  // Slot and id per object on top of the triangle itself, which a variant would pad instead.
+  EXPECT_LE(store.memory_bytes(), 1000 * (sizeof(Triangle) + 12) + 4096);
+  EXPECT_THROW(store.assign(1000, triangle_at(0)), std::out_of_range);
+}
@@ -48,4 +48,17 @@ TEST_F(CoreTestFixture, RayTest_AccessorsReturnCorrectValues)
   EXPECT_VEC3_EQ(ray.origin(), origin);
   EXPECT_DOUBLE_EQ(ray.tMin(), t_min);
   EXPECT_DOUBLE_EQ(ray.tMax(), t_max);
-}
\ No newline at end of file
+}
+
+TEST_F(CoreTestFixture, RayTest_FromUnitDirectionKeepsDirectionAsIs)
+{
+  const Vec3 unit = Vec3(1.0, 2.0, 2.0).normalized();
+  const Ray fast = Ray::fromUnitDirection(origin, unit, t_min, t_max);
+  const Ray checked(origin, unit, t_min, t_max);
+
+  EXPECT_TRUE(fast.direction() == unit);
+  EXPECT_VEC3_EQ(fast.direction(), checked.direction());
+  EXPECT_VEC3_EQ(fast.origin(), origin);
+  EXPECT_DOUBLE_EQ(fast.tMin(), t_min);
+  EXPECT_DOUBLE_EQ(fast.tMax(), t_max);
+}
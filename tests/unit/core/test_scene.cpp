@@ -5,8 +5,11 @@
 #include "percepto/common/types.h"
 #include "percepto/core/ray.h"
 #include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
 #include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
 #include "test_helpers.h"
 
 using namespace percepto::core;
@@ -90,3 +93,62 @@ TEST_F(SceneTestFixture, Intersect_Degenerate_Object_ReturnsFalse)
   HitRecord hit_record;
   EXPECT_FALSE(scene.intersect(ray, hit_record));
 }
+
+TEST_F(SceneTestFixture, Resolve_TriangleFaces)
+{
+  Scene scene;
+  scene.add_object(unit_right_triangle);
+  scene.set_cull_mode(percepto::common::CullMode::None);
+
+  const Ray from_front(Vec3(0.25, 0.25, 2.0), Vec3(0.0, 0.0, -1.0), 0.0, 100.0);
+  HitRecord hit_record;
+  ASSERT_TRUE(scene.intersect(from_front, hit_record));
+  auto surface = scene.resolve(from_front, hit_record);
+  EXPECT_VEC3_EQ(surface.point, Vec3(0.25, 0.25, 0.0));
+  EXPECT_VEC3_EQ(surface.normal, Vec3(0.0, 0.0, 1.0));
+  EXPECT_TRUE(surface.front_face);
+
+  // The back face is only hit double-sided; its normal still faces the ray.
+  const Ray from_behind(Vec3(0.25, 0.25, -2.0), Vec3(0.0, 0.0, 1.0), 0.0, 100.0);
+  ASSERT_TRUE(scene.intersect(from_behind, hit_record));
+  surface = scene.resolve(from_behind, hit_record);
+  EXPECT_VEC3_EQ(surface.normal, Vec3(0.0, 0.0, -1.0));
+  EXPECT_FALSE(surface.front_face);
+}
+
+TEST_F(SceneTestFixture, Resolve_SpheresMeshesAndMovingObjects)
+{
+  Scene scene;
+  scene.add_object(Sphere(Vec3(0.0, 0.0, 0.0), 2.0));
+  const auto moving = scene.add_object(Sphere(Vec3(10.0, 0.0, 0.0), 1.0));
+  scene.set_object_motion(moving, Transform(), Transform::translation(Vec3(0.0, 4.0, 0.0)));
+  percepto::geometry::TriangleMeshBuilder builder;
+  builder.add_triangle(Vec3(0.0, -5.0, -1.0), Vec3(0.0, -5.0, 1.0), Vec3(0.0, -7.0, 0.0));
+  scene.add_mesh(builder.build());
+
+  // From inside the sphere: the far side, seen from within.
+  const Ray inside(Vec3(0.0, 0.0, 0.0), Vec3(0.0, 0.0, 1.0), 0.0, 100.0);
+  HitRecord hit_record;
+  ASSERT_TRUE(scene.intersect(inside, hit_record));
+  auto surface = scene.resolve(inside, hit_record);
+  EXPECT_VEC3_NEAR(surface.point, Vec3(0.0, 0.0, 2.0), 1e-12);
+  EXPECT_VEC3_NEAR(surface.normal, Vec3(0.0, 0.0, -1.0), 1e-12);
+  EXPECT_FALSE(surface.front_face);
+
+  // The moving sphere is resolved where the ray met it: at y = 2 halfway through its motion.
+  Ray at_half(Vec3(10.0, 2.0, 5.0), Vec3(0.0, 0.0, -1.0), 0.0, 100.0);
+  at_half.setTime(0.5);
+  ASSERT_TRUE(scene.intersect(at_half, hit_record));
+  EXPECT_EQ(hit_record.primitive, moving);
+  surface = scene.resolve(at_half, hit_record);
+  EXPECT_VEC3_NEAR(surface.normal, Vec3(0.0, 0.0, 1.0), 1e-12);
+  EXPECT_TRUE(surface.front_face);
+
+  const Ray at_mesh(Vec3(3.0, -6.0, 0.0), Vec3(-1.0, 0.0, 0.0), 0.0, 100.0);
+  ASSERT_TRUE(scene.intersect(at_mesh, hit_record));
+  EXPECT_EQ(hit_record.primitive, 2u);
+  surface = scene.resolve(at_mesh, hit_record);
+  EXPECT_VEC3_NEAR(surface.point, Vec3(0.0, -6.0, 0.0), 1e-12);
+  EXPECT_VEC3_NEAR(surface.normal, Vec3(1.0, 0.0, 0.0), 1e-12);
+  EXPECT_TRUE(surface.front_face);
+}
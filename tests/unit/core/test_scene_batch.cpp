@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "percepto/common/thread_pool.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_batch.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::common::ThreadPool;
+using percepto::core::HitBatch, percepto::core::Ray, percepto::core::RayBatch;
+using percepto::core::Scene, percepto::core::Vec3;
+using percepto::geometry::Instance, percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+// Free triangles, spheres and box instances on a shell, plus a bumpy ground mesh below.
+void populate(Scene& scene, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  percepto::test::add_object_ring(scene, rng, {Vec3(), 10.0, 30.0, -0.3, 0.5}, 450,
+                                  percepto::test::unit_box_mesh(), 0.6);
+  percepto::test::add_ground(scene, Vec3(), 80, 1.0, [](double x, double y)
+                             { return -3.0 + 0.2 * std::sin(0.7 * x) * std::sin(0.5 * y); });
+}
+
+// Structure-of-arrays storage for a batch: runs of rays from a few sensors mixed with rays from
+// scattered origins.
+struct Rays
+{
+  std::vector<double> ox, oy, oz, dx, dy, dz, t_min, t_max;
+
+  explicit Rays(size_t count, unsigned seed)
+  {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.6, 0.5), pos(-3.0, 3.0);
+    std::uniform_int_distribution<int> run_length(1, 24);
+    Vec3 origin;
+    int left = 0;
+    for (size_t k = 0; k < count; ++k)
+    {
+      if (left-- <= 0)
+      {
+        origin = Vec3(pos(rng), pos(rng), pos(rng) * 0.3);
+        left = run_length(rng) - 1;
+      }
+      const double a = az(rng), e = el(rng);
+      ox.push_back(origin.x), oy.push_back(origin.y), oz.push_back(origin.z);
+      dx.push_back(std::cos(e) * std::cos(a));
+      dy.push_back(std::cos(e) * std::sin(a));
+      dz.push_back(std::sin(e));
+      t_min.push_back(k % 7 == 0 ? 5.0 : 0.0);
+      t_max.push_back(k % 5 == 0 ? 15.0 : 100.0);
+    }
+  }
+
+  RayBatch batch() const
+  {
+    RayBatch b;
+    b.count = ox.size();
+    b.origin_x = ox.data(), b.origin_y = oy.data(), b.origin_z = oz.data();
+    b.dir_x = dx.data(), b.dir_y = dy.data(), b.dir_z = dz.data();
+    b.t_min = t_min.data(), b.t_max = t_max.data();
+    return b;
+  }
+};
+
+struct Hits
+{
+  std::vector<double> t, u, v;
+  std::vector<uint32_t> primitive;
+
+  explicit Hits(size_t count) : t(count), u(count), v(count), primitive(count) {}
+  HitBatch batch() { return HitBatch{t.data(), primitive.data(), u.data(), v.data()}; }
+};
+}  // namespace
+
+TEST(SceneBatchTest, MatchesIntersectRayForRay)
+{
+  const Rays rays(20000, 3);
+  ThreadPool pool(4);
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh8})
+  {
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    populate(scene, 5);
+
+    for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool})
+    {
+      Hits hits(rays.ox.size());
+      scene.intersect_batch(rays.batch(), hits.batch(), p);
+
+      int hit_count = 0;
+      for (size_t k = 0; k < rays.ox.size(); ++k)
+      {
+        HitRecord expected;
+        const bool hit = scene.intersect(rays.batch().ray(k), expected);
+        ASSERT_EQ(hits.primitive[k] != HitRecord::kNoPrimitive, hit) << "ray " << k;
+        if (!hit)
+        {
+          EXPECT_TRUE(std::isinf(hits.t[k]));
+          continue;
+        }
+        ++hit_count;
+        EXPECT_EQ(hits.t[k], expected.t) << "ray " << k;
+        EXPECT_EQ(hits.primitive[k], expected.primitive) << "ray " << k;
+        EXPECT_NEAR(hits.u[k], expected.u, 1e-12) << "ray " << k;
+        EXPECT_NEAR(hits.v[k], expected.v, 1e-12) << "ray " << k;
+      }
+      EXPECT_GT(hit_count, 2000);
+    }
+  }
+}
+
+TEST(SceneBatchTest, PrimitiveAndBarycentricsLocateTheHit)
+{
+  Scene scene;
+  populate(scene, 7);
+  const Rays rays(5000, 8);
+  Hits hits(rays.ox.size());
+  scene.intersect_batch(rays.batch(), hits.batch());
+
+  int triangles = 0, spheres = 0, instances = 0;
+  for (size_t k = 0; k < rays.ox.size(); ++k)
+  {
+    if (hits.primitive[k] == HitRecord::kNoPrimitive) continue;
+    const Vec3 point = rays.batch().ray(k).at(hits.t[k]);
+    const Scene::Object prim = scene.primitive(hits.primitive[k]);
+    if (const auto* tri = std::get_if<Triangle>(&prim))
+    {
+      ++triangles;
+      const double u = hits.u[k], v = hits.v[k];
+      EXPECT_VEC3_NEAR((1.0 - u - v) * tri->v0() + u * tri->v1() + v * tri->v2(), point, 1e-9);
+    }
+    else if (const auto* sphere = std::get_if<Sphere>(&prim))
+    {
+      ++spheres;
+      EXPECT_NEAR((point - sphere->centre()).length(), sphere->radius(), 1e-9);
+    }
+    else
+    {
+      ++instances;
+      const percepto::geometry::AABB box = std::get<Instance>(prim).bounds();
+      EXPECT_TRUE(box.contains(percepto::geometry::AABB(point, point))) << "ray " << k;
+    }
+  }
+  EXPECT_GT(triangles, 100);
+  EXPECT_GT(spheres, 10);
+  EXPECT_GT(instances, 10);
+}
+
+TEST(SceneBatchTest, RejectsMissingArraysAndAcceptsEmptyBatches)
+{
+  Scene scene;
+  scene.add_object(Sphere(Vec3(0, 0, 10), 1.0));
+  Rays rays(4, 1);
+  Hits hits(4);
+
+  RayBatch no_t_max = rays.batch();
+  no_t_max.t_max = nullptr;
+  EXPECT_THROW(scene.intersect_batch(no_t_max, hits.batch()), std::invalid_argument);
+  HitBatch no_u = hits.batch();
+  no_u.u = nullptr;
+  EXPECT_THROW(scene.intersect_batch(rays.batch(), no_u), std::invalid_argument);
+  EXPECT_NO_THROW(scene.intersect_batch(RayBatch(), HitBatch()));
+}
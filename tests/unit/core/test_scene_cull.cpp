@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "percepto/accel/angular_grid.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::CullMode, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene;
+using percepto::core::Vec3;
+
+namespace
+{
+// Open geometry of random winding around the origin; `duplicate` adds every face a second time
+// with the opposite winding.
+void populate(Scene& scene, bool duplicate)
+{
+  std::mt19937 rng(2024);
+  percepto::test::add_open_geometry(scene, rng, {Vec3(), 5.0, 30.0, -0.4, 0.4}, 300, 40, 200,
+                                    duplicate);
+}
+
+constexpr int kAzimuths = 360;
+const std::vector<double> kElevations = {-0.3, -0.15, 0.0, 0.15, 0.3};
+
+Ray sensor_ray(int i, int j)
+{
+  const double a = 2.0 * M_PI * i / kAzimuths, e = kElevations[j];
+  Ray ray(Vec3(), Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a), std::sin(e)), 0.0,
+          100.0);
+  ray.setTime(0.5);
+  return ray;
+}
+
+// Both scenes see the same surfaces at the same distances; ids differ as the duplicate has more.
+void expect_same_hit(bool hit, const HitRecord& record, bool expected_hit,
+                     const HitRecord& expected, int i, int j)
+{
+  ASSERT_EQ(hit, expected_hit) << "i=" << i << " j=" << j;
+  if (hit)
+  {
+    EXPECT_NEAR(record.t, expected.t, 1e-9 * expected.t) << "i=" << i << " j=" << j;
+  }
+}
+
+class SceneCullTest : public ::testing::TestWithParam<AcceleratorType>
+{
+};
+}  // namespace
+
+TEST_P(SceneCullTest, DoubleSidedSceneMatchesDuplicatedFaces)
+{
+  Scene double_sided, duplicated;
+  populate(double_sided, false);
+  populate(duplicated, true);
+  double_sided.set_cull_mode(CullMode::None);
+  double_sided.set_accelerator(GetParam());
+  duplicated.set_accelerator(GetParam());
+
+  int hits = 0;
+  for (int i = 0; i < kAzimuths; ++i)
+  {
+    RayPacket packet;
+    for (int j = 0; j < static_cast<int>(kElevations.size()); ++j)
+    {
+      const Ray ray = sensor_ray(i, j);
+      packet.push(ray);
+      HitRecord record, expected;
+      const bool expected_hit = duplicated.intersect(ray, expected);
+      expect_same_hit(double_sided.intersect(ray, record), record, expected_hit, expected, i, j);
+      EXPECT_EQ(double_sided.occluded(ray), duplicated.occluded(ray));
+      hits += expected_hit;
+    }
+
+    HitRecord records[RayPacket::kMaxSize], expected[RayPacket::kMaxSize];
+    const uint32_t mask = double_sided.intersect_packet(packet, records);
+    const uint32_t expected_mask = duplicated.intersect_packet(packet, expected);
+    for (int j = 0; j < packet.count; ++j)
+    {
+      expect_same_hit(mask >> j & 1u, records[j], expected_mask >> j & 1u, expected[j], i, j);
+    }
+    EXPECT_EQ(double_sided.occluded_packet(packet), duplicated.occluded_packet(packet));
+  }
+  EXPECT_GT(hits, 200);
+
+  // Culling back faces again hides part of what the duplicate still shows.
+  double_sided.set_cull_mode(CullMode::Back);
+  int culled_hits = 0;
+  for (int i = 0; i < kAzimuths; ++i)
+  {
+    HitRecord record;
+    for (int j = 0; j < static_cast<int>(kElevations.size()); ++j)
+    {
+      culled_hits += double_sided.intersect(sensor_ray(i, j), record);
+    }
+  }
+  EXPECT_LT(culled_hits, hits);
+}
+
+INSTANTIATE_TEST_SUITE_P(Accelerators, SceneCullTest,
+                         ::testing::Values(AcceleratorType::None, AcceleratorType::Bvh,
+                                           AcceleratorType::Bvh4, AcceleratorType::Bvh8));
+
+TEST(SceneCullTest, AngularGridHonoursCullMode)
+{
+  Scene double_sided, duplicated;
+  populate(double_sided, false);
+  populate(duplicated, true);
+  double_sided.set_cull_mode(CullMode::None);
+
+  percepto::accel::AngularGridLayout layout;
+  for (int i = 0; i < kAzimuths; ++i) layout.azimuth_angles.push_back(2.0 * M_PI * i / kAzimuths);
+  layout.elevation_angles = kElevations;
+  double_sided.set_angular_grid(layout);
+  duplicated.set_angular_grid(layout);
+
+  for (int i = 0; i < kAzimuths; ++i)
+  {
+    for (int j = 0; j < static_cast<int>(kElevations.size()); ++j)
+    {
+      const Ray ray = sensor_ray(i, j);
+      HitRecord record, expected;
+      const bool expected_hit = duplicated.intersect_sensor_ray(i, j, ray, expected);
+      expect_same_hit(double_sided.intersect_sensor_ray(i, j, ray, record), record, expected_hit,
+                      expected, i, j);
+    }
+  }
+}
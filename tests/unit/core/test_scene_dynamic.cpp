@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "percepto/accel/angular_grid.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::Scene, percepto::core::Transform, percepto::core::Vec3;
+using percepto::geometry::Instance, percepto::geometry::InstancedMesh;
+using percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+namespace
+{
+constexpr int kObjectCount = 600;
+
+// Small triangles, spheres and box-shaped instances scattered on a ring around the origin, so
+// rays from the origin hit a mix of all three.
+std::vector<Scene::Object> make_objects(unsigned seed)
+{
+  percepto::geometry::TriangleMeshBuilder box;
+  const Vec3 c[8] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+                     {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+  const int faces[6][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4},
+                           {2, 3, 7, 6}, {1, 2, 6, 5}, {0, 4, 7, 3}};
+  for (const auto& f : faces)
+  {
+    box.add_triangle(c[f[0]], c[f[1]], c[f[2]]);
+    box.add_triangle(c[f[0]], c[f[2]], c[f[3]]);
+  }
+  auto mesh = std::make_shared<const InstancedMesh>(box.build());
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> az(0.0, 2.0 * M_PI), el(-0.3, 0.3), r(20.0, 40.0);
+  std::vector<Scene::Object> objects;
+  for (int i = 0; i < kObjectCount; ++i)
+  {
+    const double a = az(rng), e = el(rng), d = r(rng);
+    const Vec3 p(d * std::cos(e) * std::cos(a), d * std::cos(e) * std::sin(a), d * std::sin(e));
+    if (i % 3 == 0)
+    {
+      objects.push_back(Triangle(p, p + Vec3(-std::sin(a), std::cos(a), 0.0), p + Vec3(0, 0, 1)));
+    }
+    else if (i % 3 == 1)
+    {
+      objects.push_back(Sphere(p, 0.4));
+    }
+    else
+    {
+      objects.push_back(Instance(mesh, Transform::translation(p)));
+    }
+  }
+  return objects;
+}
+
+std::vector<Ray> make_rays(int count)
+{
+  std::vector<Ray> rays;
+  for (int k = 0; k < count; ++k)
+  {
+    const double a = 2.0 * M_PI * k / count, e = 0.3 * std::sin(0.61 * k);
+    rays.emplace_back(Vec3(0, 0, 0),
+                      Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a), std::sin(e)), 0.0,
+                      100.0);
+  }
+  return rays;
+}
+
+// `scene` must trace exactly like a scene built from scratch over its live objects.
+void expect_matches_fresh_build(Scene& scene, AcceleratorType accelerator)
+{
+  Scene fresh;
+  fresh.set_accelerator(AcceleratorType::None);
+  for (Scene::ObjectHandle h = 0; h < scene.objects().size(); ++h)
+  {
+    if (!scene.is_removed(h)) fresh.add_object(scene.objects()[h]);
+  }
+
+  int hits = 0;
+  for (const Ray& ray : make_rays(2000))
+  {
+    HitRecord expected, got;
+    const bool hit = fresh.intersect(ray, expected);
+    ASSERT_EQ(scene.intersect(ray, got), hit) << "accelerator " << static_cast<int>(accelerator);
+    if (!hit) continue;
+    ++hits;
+    EXPECT_DOUBLE_EQ(got.t, expected.t);
+  }
+  EXPECT_GT(hits, 100);
+}
+
+// Moves a tenth of the objects a little, as one frame of traffic would.
+void step(Scene& scene, std::mt19937& rng)
+{
+  std::uniform_int_distribution<Scene::ObjectHandle> pick(0, kObjectCount - 1);
+  std::uniform_real_distribution<double> offset(-0.5, 0.5);
+  for (int i = 0; i < kObjectCount / 10; ++i)
+  {
+    const Scene::ObjectHandle h = pick(rng);
+    if (scene.is_removed(h)) continue;
+    scene.transform_object(h, Transform::translation(Vec3(offset(rng), offset(rng), 0.0)));
+  }
+}
+}  // namespace
+
+TEST(SceneDynamicTest, MovedObjectsTraceLikeAFreshBuild)
+{
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh4,
+                           AcceleratorType::Bvh8})
+  {
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    for (const auto& object : make_objects(5)) scene.add_object(object);
+    scene.commit();
+
+    std::mt19937 rng(9);
+    for (int frame = 0; frame < 8; ++frame)
+    {
+      step(scene, rng);
+      scene.commit();
+    }
+    expect_matches_fresh_build(scene, accelerator);
+  }
+}
+
+TEST(SceneDynamicTest, RemovedObjectsAreNoLongerHit)
+{
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh8})
+  {
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    for (const auto& object : make_objects(6)) scene.add_object(object);
+    scene.commit();
+
+    for (Scene::ObjectHandle h = 0; h < kObjectCount; h += 4) scene.remove_object(h);
+    EXPECT_EQ(scene.removed_count(), static_cast<size_t>(kObjectCount / 4));
+    EXPECT_TRUE(scene.is_removed(0));
+    EXPECT_FALSE(scene.is_removed(1));
+    expect_matches_fresh_build(scene, accelerator);
+
+    // A full rebuild leaves the removed objects out of the tree altogether.
+    scene.set_bvh_options(scene.bvh_options());
+    scene.commit();
+    if (accelerator != AcceleratorType::None)
+    {
+      EXPECT_EQ(scene.bvh().prim_indices().size(), static_cast<size_t>(kObjectCount * 3 / 4));
+    }
+    expect_matches_fresh_build(scene, accelerator);
+  }
+}
+
+TEST(SceneDynamicTest, ReplacingAnObjectWithAnotherTypeRebuilds)
+{
+  Scene scene;
+  for (const auto& object : make_objects(7)) scene.add_object(object);
+  scene.commit();
+  for (Scene::ObjectHandle h = 0; h < kObjectCount; h += 3)
+  {
+    const Triangle tri = *scene.objects().get_if<Triangle>(h);
+    scene.update_object(h, Sphere(tri.v0(), 0.3));
+  }
+  scene.update_object(1, Sphere(Vec3(30, 0, 0), 0.5));
+  expect_matches_fresh_build(scene, AcceleratorType::Bvh);
+}
+
+TEST(SceneDynamicTest, DegradedTreesAreRebuilt)
+{
+  // The ring around the sensor is jumbled over a few frames while two copies of it further out
+  // stay put, so only the subtree over the near ring degrades.
+  auto scatter = [](Scene& scene)
+  {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> offset(-6.0, 6.0);
+    for (int frame = 0; frame < 4; ++frame)
+    {
+      for (Scene::ObjectHandle h = 0; h < kObjectCount; ++h)
+      {
+        scene.transform_object(h, Transform::translation(Vec3(offset(rng), offset(rng), 0.0)));
+      }
+      scene.commit();
+    }
+  };
+
+  Scene refit_only, rebuilt;
+  auto options = refit_only.bvh_options();
+  options.rebuild_ratio = std::numeric_limits<double>::infinity();
+  refit_only.set_bvh_options(options);
+  rebuilt.set_accelerator(AcceleratorType::Bvh8);
+  for (const Vec3& offset : {Vec3(0, 0, 0), Vec3(150, 0, 0), Vec3(0, 150, 0)})
+  {
+    for (const auto& object : make_objects(8))
+    {
+      Scene::ObjectHandle h = refit_only.add_object(object);
+      refit_only.transform_object(h, Transform::translation(offset));
+      h = rebuilt.add_object(object);
+      rebuilt.transform_object(h, Transform::translation(offset));
+    }
+  }
+  refit_only.commit();
+  rebuilt.commit();
+  const double built = rebuilt.bvh().sah_area();
+
+  scatter(refit_only);
+  scatter(rebuilt);
+  EXPECT_GT(refit_only.bvh().sah_area(), rebuilt.bvh_options().rebuild_ratio * built);
+  EXPECT_LT(rebuilt.bvh().sah_area(), refit_only.bvh().sah_area());
+  expect_matches_fresh_build(rebuilt, AcceleratorType::Bvh8);
+  expect_matches_fresh_build(refit_only, AcceleratorType::Bvh);
+}
+
+TEST(SceneDynamicTest, SensorRaysSeeMovedAndRemovedObjects)
+{
+  Scene scene;
+  for (const auto& object : make_objects(10)) scene.add_object(object);
+  percepto::accel::AngularGridLayout layout;
+  for (int a = 0; a < 720; ++a) layout.azimuth_angles.push_back(2.0 * M_PI * a / 720);
+  for (int e = 0; e < 16; ++e) layout.elevation_angles.push_back(-0.3 + 0.04 * e);
+  scene.set_angular_grid(layout);
+  scene.commit();
+
+  std::mt19937 rng(4);
+  step(scene, rng);
+  for (Scene::ObjectHandle h = 1; h < kObjectCount; h += 5) scene.remove_object(h);
+  scene.commit();
+
+  int hits = 0;
+  for (int a = 0; a < 720; ++a)
+  {
+    for (int e = 0; e < 16; ++e)
+    {
+      const double az = layout.azimuth_angles[a], el = layout.elevation_angles[e];
+      const Ray ray(Vec3(0, 0, 0),
+                    Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)),
+                    0.0, 100.0);
+      HitRecord expected, got;
+      const bool hit = scene.intersect(ray, expected);
+      ASSERT_EQ(scene.intersect_sensor_ray(a, e, ray, got), hit) << a << ", " << e;
+      if (hit)
+      {
+        EXPECT_DOUBLE_EQ(got.t, expected.t);
+      }
+      hits += hit;
+    }
+  }
+  EXPECT_GT(hits, 100);
+}
+
+TEST(SceneDynamicTest, RejectsUnknownAndRemovedHandles)
+{
+  Scene scene;
+  const auto h = scene.add_object(Sphere(Vec3(0, 0, 5), 1.0));
+  EXPECT_EQ(h, 0u);
+  EXPECT_THROW(scene.update_object(1, Sphere(Vec3(), 1.0)), std::out_of_range);
+  scene.remove_object(h);
+  EXPECT_THROW(scene.remove_object(h), std::out_of_range);
+  EXPECT_THROW(scene.transform_object(h, Transform()), std::out_of_range);
+
+  HitRecord rec;
+  EXPECT_FALSE(scene.intersect(Ray(Vec3(0, 0, 0), Vec3(0, 0, 1), 0.0, 100.0), rec));
+}
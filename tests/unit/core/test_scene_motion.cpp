@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/accel/angular_grid.h"
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene;
+using percepto::core::Transform, percepto::core::Vec3;
+using percepto::geometry::Instance, percepto::geometry::InstancedMesh;
+using percepto::geometry::Sphere;
+
+namespace
+{
+constexpr int kObjectCount = 450;
+
+// Triangles, spheres and box-shaped instances on a ring around the origin; every other one drives
+// a few units sideways over the interval, some turning and growing as they go.
+void populate(Scene& scene, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  const auto ring = percepto::test::add_object_ring(scene, rng, {Vec3(), 20.0, 40.0}, kObjectCount,
+                                                    percepto::test::unit_box_mesh(), 0.4);
+  std::uniform_real_distribution<double> drive(-4.0, 4.0);
+  for (size_t i = 0; i < ring.size(); i += 2)
+  {
+    // Turns and scales about the object's own position, so it stays near the ring.
+    const Vec3& p = ring[i].position;
+    const Transform about_p = Transform::translation(p) *
+                              Transform::rotation(Vec3(0, 0, 1), 0.2 * (i % 5)) *
+                              Transform::scaling(Vec3(1.0 + 0.1 * (i % 4), 1.0, 1.0)) *
+                              Transform::translation(-1.0 * p);
+    scene.set_object_motion(ring[i].handle, Transform(),
+                            Transform::translation(Vec3(drive(rng), drive(rng), 0.0)) * about_p);
+  }
+}
+
+// The objects of `scene` posed at `time`, in a scene with no motion at all.
+Scene snapshot(const Scene& scene, double time)
+{
+  Scene frozen;
+  frozen.set_accelerator(AcceleratorType::None);
+  for (Scene::ObjectHandle h = 0; h < scene.objects().size(); ++h)
+  {
+    if (!scene.is_removed(h)) frozen.add_object(scene.object_at(h, time));
+  }
+  return frozen;
+}
+
+Ray ray_at(int k, int count, double time)
+{
+  const double a = 2.0 * M_PI * k / count, e = 0.3 * std::sin(0.61 * k);
+  Ray ray(Vec3(0, 0, 0), Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a), std::sin(e)),
+          0.0, 100.0);
+  ray.setTime(time);
+  return ray;
+}
+}  // namespace
+
+TEST(SceneMotionTest, RaysSeeMovingObjectsAtTheirOwnTime)
+{
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh4,
+                           AcceleratorType::Bvh8})
+  {
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    populate(scene, 5);
+    scene.commit();
+    EXPECT_EQ(scene.moving_count(), static_cast<size_t>((kObjectCount + 1) / 2));
+
+    for (double time : {0.0, 0.3, 0.5, 0.9, 1.0})
+    {
+      Scene frozen = snapshot(scene, time);
+      int hits = 0;
+      for (int k = 0; k < 1500; ++k)
+      {
+        const Ray ray = ray_at(k, 1500, time);
+        HitRecord expected, got;
+        const bool hit = frozen.intersect(ray, expected);
+        ASSERT_EQ(scene.intersect(ray, got), hit) << "accelerator " << static_cast<int>(accelerator)
+                                                  << ", time " << time << ", ray " << k;
+        if (!hit) continue;
+        ++hits;
+        EXPECT_NEAR(got.t, expected.t, 1e-9);
+      }
+      EXPECT_GT(hits, 100);
+    }
+  }
+}
+
+TEST(SceneMotionTest, PacketsOfMixedTimesMatchSingleRays)
+{
+  Scene scene;
+  populate(scene, 6);
+  int hits = 0;
+  for (int first = 0; first < 1440; first += RayPacket::kMaxSize)
+  {
+    RayPacket packet;
+    for (int i = 0; i < RayPacket::kMaxSize; ++i)
+    {
+      packet.push(ray_at(first + i, 1440, double(first + i) / 1440));
+    }
+
+    HitRecord records[RayPacket::kMaxSize];
+    const uint32_t mask = scene.intersect_packet(packet, records);
+    for (int i = 0; i < RayPacket::kMaxSize; ++i)
+    {
+      EXPECT_EQ(packet.ray(i).time(), double(first + i) / 1440);
+      HitRecord expected;
+      const bool hit = scene.intersect(packet.ray(i), expected);
+      ASSERT_EQ(bool(mask & (1u << i)), hit) << "ray " << first + i;
+      if (hit)
+      {
+        EXPECT_EQ(records[i].t, expected.t) << "ray " << first + i;
+      }
+      hits += hit;
+    }
+  }
+  EXPECT_GT(hits, 50);
+}
+
+TEST(SceneMotionTest, SensorRaysSeeMovingObjects)
+{
+  Scene scene;
+  populate(scene, 7);
+  percepto::accel::AngularGridLayout layout;
+  for (int a = 0; a < 720; ++a) layout.azimuth_angles.push_back(2.0 * M_PI * a / 720);
+  for (int e = 0; e < 16; ++e) layout.elevation_angles.push_back(-0.3 + 0.04 * e);
+  scene.set_angular_grid(layout);
+  scene.commit();
+
+  int hits = 0;
+  for (int a = 0; a < 720; ++a)
+  {
+    for (int e = 0; e < 16; ++e)
+    {
+      const double az = layout.azimuth_angles[a], el = layout.elevation_angles[e];
+      Ray ray(Vec3(0, 0, 0),
+              Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)), 0.0,
+              100.0);
+      ray.setTime(a / 720.0);
+      HitRecord expected, got;
+      const bool hit = scene.intersect(ray, expected);
+      ASSERT_EQ(scene.intersect_sensor_ray(a, e, ray, got), hit) << a << ", " << e;
+      if (hit)
+      {
+        EXPECT_DOUBLE_EQ(got.t, expected.t);
+      }
+      hits += hit;
+    }
+  }
+  EXPECT_GT(hits, 100);
+}
+
+TEST(SceneMotionTest, ObjectsMoveOnStraightLines)
+{
+  Scene scene;
+  const auto sphere = scene.add_object(Sphere(Vec3(10, 0, 0), 1.0));
+  scene.set_object_motion(sphere, Transform(),
+                          Transform::translation(Vec3(0, 4, 0)) *
+                              Transform::scaling(Vec3(1.0, 1.0, 1.0) * 2.0));
+  const Sphere posed = std::get<Sphere>(scene.object_at(sphere, 0.25));
+  EXPECT_VEC3_NEAR(posed.centre(), Vec3(12.5, 1.0, 0.0), 1e-12);
+  EXPECT_NEAR(posed.radius(), 1.25, 1e-12);
+
+  // A ray straight down the x axis meets the sphere only while it is still near the axis.
+  HitRecord rec;
+  Ray ray(Vec3(0, 0, 0), Vec3(1, 0, 0), 0.0, 100.0);
+  EXPECT_TRUE(scene.intersect(ray, rec));
+  EXPECT_NEAR(rec.t, 9.0, 1e-12);
+  ray.setTime(1.0);
+  EXPECT_FALSE(scene.intersect(ray, rec));
+}
+
+TEST(SceneMotionTest, ClearingMotionRestoresTheStaticObject)
+{
+  Scene scene;
+  populate(scene, 8);
+  scene.commit();
+  for (Scene::ObjectHandle h = 0; h < kObjectCount; h += 2) scene.clear_object_motion(h);
+  EXPECT_EQ(scene.moving_count(), 0u);
+  EXPECT_FALSE(scene.is_moving(0));
+
+  Scene frozen = snapshot(scene, 0.7);
+  for (int k = 0; k < 1000; ++k)
+  {
+    const Ray ray = ray_at(k, 1000, 0.7);
+    HitRecord expected, got;
+    const bool hit = frozen.intersect(ray, expected);
+    ASSERT_EQ(scene.intersect(ray, got), hit) << "ray " << k;
+    if (hit)
+    {
+      EXPECT_DOUBLE_EQ(got.t, expected.t);
+    }
+  }
+}
+
+TEST(SceneMotionTest, RejectsSingularInstancePosesAndUnknownHandles)
+{
+  percepto::geometry::TriangleMeshBuilder builder;
+  builder.add_triangle(Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0));
+  auto mesh = std::make_shared<const InstancedMesh>(builder.build());
+
+  Scene scene;
+  const auto h = scene.add_object(Instance(mesh, Transform()));
+  EXPECT_THROW(scene.set_object_motion(h, Transform(), Transform::scaling(Vec3(0, 1, 1))),
+               std::invalid_argument);
+  EXPECT_FALSE(scene.is_moving(h));
+  EXPECT_THROW(scene.set_object_motion(h + 1, Transform(), Transform()), std::out_of_range);
+
+  // Moving objects that are later removed leave the motion tree.
+  scene.set_object_motion(h, Transform(), Transform::translation(Vec3(0, 0, 1)));
+  EXPECT_TRUE(scene.is_moving(h));
+  scene.remove_object(h);
+  EXPECT_EQ(scene.moving_count(), 0u);
+  HitRecord rec;
+  EXPECT_FALSE(scene.intersect(Ray(Vec3(0.2, 0.2, 5), Vec3(0, 0, -1), 0.0, 100.0), rec));
+}
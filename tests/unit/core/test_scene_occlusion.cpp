@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene;
+using percepto::core::Transform, percepto::core::Vec3;
+using percepto::geometry::Sphere;
+
+namespace
+{
+// Free triangles, spheres and box instances around the origin, plus a rolling ground mesh.
+void populate(Scene& scene, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  percepto::test::add_object_ring(scene, rng, {Vec3(), 10.0, 40.0, -0.2, 0.4}, 600,
+                                  percepto::test::unit_box_mesh());
+  percepto::test::add_ground(scene, Vec3(), 100, 1.0, [](double x, double y)
+                             { return -2.0 + 0.5 * std::sin(0.3 * x) * std::cos(0.2 * y); });
+}
+
+// Line-of-sight rays from a point above the ground towards random targets, each ending there.
+std::vector<Ray> sight_lines(int count, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> xy(-45.0, 45.0), z(-1.0, 8.0);
+  std::vector<Ray> rays;
+  const Vec3 eye(0.5, -0.3, 1.5);
+  for (int k = 0; k < count; ++k)
+  {
+    const Vec3 to = Vec3(xy(rng), xy(rng), z(rng)) - eye;
+    rays.emplace_back(eye, to, 0.0, to.length());
+  }
+  return rays;
+}
+
+void expect_matches_closest_hit(Scene& scene, const std::vector<Ray>& rays)
+{
+  int blocked = 0;
+  for (size_t k = 0; k < rays.size(); ++k)
+  {
+    HitRecord rec;
+    const bool hit = scene.intersect(rays[k], rec);
+    ASSERT_EQ(scene.occluded(rays[k]), hit) << "ray " << k;
+    blocked += hit;
+  }
+  // Both outcomes must be well represented.
+  EXPECT_GT(blocked, static_cast<int>(rays.size() / 10));
+  EXPECT_LT(blocked, static_cast<int>(rays.size() * 9 / 10));
+}
+}  // namespace
+
+TEST(SceneOcclusionTest, AgreesWithClosestHitForEveryAccelerator)
+{
+  const auto rays = sight_lines(3000, 2);
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh4,
+                           AcceleratorType::Bvh8})
+  {
+    SCOPED_TRACE(static_cast<int>(accelerator));
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    populate(scene, 3);
+    expect_matches_closest_hit(scene, rays);
+  }
+}
+
+TEST(SceneOcclusionTest, PacketsMatchSingleRays)
+{
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh})
+  {
+    Scene scene;
+    scene.set_accelerator(accelerator);
+    populate(scene, 4);
+    const auto rays = sight_lines(1024, 5);
+    for (size_t first = 0; first < rays.size(); first += RayPacket::kMaxSize)
+    {
+      RayPacket packet;
+      for (int i = 0; i < RayPacket::kMaxSize; ++i) packet.push(rays[first + i]);
+      const uint32_t mask = scene.occluded_packet(packet);
+      for (int i = 0; i < RayPacket::kMaxSize; ++i)
+      {
+        ASSERT_EQ(bool(mask & (1u << i)), scene.occluded(rays[first + i])) << first + i;
+      }
+    }
+  }
+}
+
+TEST(SceneOcclusionTest, SeesMovingAndIgnoresRemovedObjects)
+{
+  Scene scene;
+  populate(scene, 6);
+  scene.commit();
+  for (Scene::ObjectHandle h = 0; h < 600; h += 7) scene.remove_object(h);
+  for (Scene::ObjectHandle h = 1; h < 600; h += 5)
+  {
+    if (scene.is_removed(h)) continue;
+    scene.set_object_motion(h, Transform(), Transform::translation(Vec3(3.0, -2.0, 0.5)));
+  }
+
+  auto rays = sight_lines(3000, 7);
+  for (size_t k = 0; k < rays.size(); ++k) rays[k].setTime(double(k % 11) / 10);
+  expect_matches_closest_hit(scene, rays);
+}
+
+TEST(SceneOcclusionTest, RespectsTheRayInterval)
+{
+  Scene scene;
+  scene.add_object(Sphere(Vec3(10, 0, 0), 1.0));
+  EXPECT_TRUE(scene.occluded(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0), 0.0, 20.0)));
+  EXPECT_FALSE(scene.occluded(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0), 0.0, 8.5)));
+  EXPECT_FALSE(scene.occluded(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0), 11.5, 20.0)));
+  EXPECT_FALSE(Scene().occluded(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0))));
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::CullMode, percepto::common::HitRecord,
+    percepto::common::Precision;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Scene;
+using percepto::core::Vec3;
+
+namespace
+{
+// Sensor position, far from the world origin as in a map frame.
+const Vec3 kOrigin(2.0e4, -1.5e4, 35.0);
+
+// Every primitive kind around the sensor: free triangles, instances, spheres and one moving
+// triangle, plus a ground grid of adjacent triangles.
+void populate(Scene& scene)
+{
+  std::mt19937 rng(42);
+  percepto::test::add_open_geometry(scene, rng, {kOrigin, 5.0, 40.0}, 400, 30, 0);
+  // Ground 3 m below the sensor, facing up; rays through its shared edges must not leak.
+  percepto::test::add_ground(scene, kOrigin, 60, 2.0, [](double, double) { return -3.0; });
+}
+
+constexpr int kAzimuths = 720;
+constexpr int kChannels = 10;
+
+Ray sensor_ray(int i, int j)
+{
+  const double a = 2.0 * M_PI * i / kAzimuths, e = -0.35 + 0.07 * j;
+  Ray ray(kOrigin, Vec3(std::cos(e) * std::cos(a), std::cos(e) * std::sin(a), std::sin(e)), 0.0,
+          200.0);
+  ray.setTime(0.25);
+  return ray;
+}
+
+struct Agreement
+{
+  int rays = 0;
+  int hits = 0;
+  int mismatches = 0;  // Hit in one precision only, or at different distances.
+};
+
+void compare(bool hit, const HitRecord& record, bool expected_hit, const HitRecord& expected,
+             Agreement& agreement)
+{
+  ++agreement.rays;
+  agreement.hits += expected_hit;
+  if (hit != expected_hit)
+  {
+    ++agreement.mismatches;
+    return;
+  }
+  if (!hit) return;
+  // A ray along an edge two triangles share may take either; both lie at the same distance.
+  if (record.primitive != expected.primitive)
+  {
+    if (std::abs(record.t - expected.t) > 1e-6 * expected.t) ++agreement.mismatches;
+    return;
+  }
+  // Same primitive: the single-precision hit was refined in double, so t, u and v match exactly.
+  EXPECT_EQ(record.t, expected.t);
+  EXPECT_EQ(record.u, expected.u);
+  EXPECT_EQ(record.v, expected.v);
+}
+
+class ScenePrecisionTest : public ::testing::TestWithParam<AcceleratorType>
+{
+};
+}  // namespace
+
+TEST_P(ScenePrecisionTest, SingleMatchesDoubleBarGrazingRays)
+{
+  for (CullMode cull : {CullMode::Back, CullMode::None})
+  {
+    Scene reference, single;
+    populate(reference);
+    populate(single);
+    for (Scene* scene : {&reference, &single})
+    {
+      scene->set_accelerator(GetParam());
+      scene->set_cull_mode(cull);
+    }
+    single.set_precision(Precision::Single);
+
+    Agreement rays, packets;
+    int occlusion_mismatches = 0;
+    for (int i = 0; i < kAzimuths; ++i)
+    {
+      RayPacket packet;
+      for (int j = 0; j < kChannels; ++j)
+      {
+        const Ray ray = sensor_ray(i, j);
+        packet.push(ray);
+        HitRecord record, expected;
+        const bool expected_hit = reference.intersect(ray, expected);
+        compare(single.intersect(ray, record), record, expected_hit, expected, rays);
+        occlusion_mismatches += single.occluded(ray) != reference.occluded(ray);
+      }
+
+      HitRecord records[RayPacket::kMaxSize], expected[RayPacket::kMaxSize];
+      const uint32_t mask = single.intersect_packet(packet, records);
+      const uint32_t expected_mask = reference.intersect_packet(packet, expected);
+      for (int j = 0; j < packet.count; ++j)
+      {
+        compare(mask >> j & 1u, records[j], expected_mask >> j & 1u, expected[j], packets);
+      }
+      occlusion_mismatches +=
+          __builtin_popcount(single.occluded_packet(packet) ^ reference.occluded_packet(packet));
+    }
+
+    // At most one ray in a thousand, those through an edge, may resolve differently.
+    EXPECT_GT(rays.hits, rays.rays / 2);
+    EXPECT_LE(rays.mismatches * 1000, rays.rays);
+    EXPECT_LE(packets.mismatches * 1000, packets.rays);
+    EXPECT_LE(occlusion_mismatches * 500, rays.rays);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Accelerators, ScenePrecisionTest,
+                         ::testing::Values(AcceleratorType::None, AcceleratorType::Bvh,
+                                           AcceleratorType::Bvh4, AcceleratorType::Bvh8));
+
+TEST(ScenePrecisionTest, SinglePrecisionHalvesPackedTrianglesAndRebuildsOnChange)
+{
+  Scene scene;
+  populate(scene);
+  scene.set_accelerator(AcceleratorType::Bvh8);
+  scene.commit();
+  const auto double_memory = scene.memory_usage().acceleration;
+  EXPECT_FALSE(scene.bvh8().empty());
+  EXPECT_TRUE(scene.bvh8f().empty());
+
+  HitRecord before;
+  const Ray ray = sensor_ray(100, 2);
+  ASSERT_TRUE(scene.intersect(ray, before));
+
+  scene.set_precision(Precision::Single);
+  HitRecord single;
+  ASSERT_TRUE(scene.intersect(ray, single));
+  EXPECT_TRUE(scene.bvh8().empty());
+  EXPECT_FALSE(scene.bvh8f().empty());
+  EXPECT_LT(scene.memory_usage().acceleration, double_memory);
+  EXPECT_EQ(single.primitive, before.primitive);
+  EXPECT_EQ(single.t, before.t);
+
+  scene.set_precision(Precision::Double);
+  HitRecord after;
+  ASSERT_TRUE(scene.intersect(ray, after));
+  EXPECT_EQ(after.t, before.t);
+  EXPECT_TRUE(scene.bvh8f().empty());
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/common/thread_pool.h"
+
+using percepto::common::ThreadPool;
+
+TEST(ThreadPoolTest, RunsEveryTaskExactlyOnce)
+{
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.size(), 4);
+
+  std::vector<std::atomic<int>> counts(1000);
+  pool.parallel_for(counts.size(), [&](size_t i) { counts[i]++; });
+
+  for (size_t i = 0; i < counts.size(); ++i) EXPECT_EQ(counts[i].load(), 1) << "task " << i;
+}
+
+TEST(ThreadPoolTest, IsReusableAcrossJobs)
+{
+  ThreadPool pool(3);
+  std::atomic<int> total{0};
+  for (int job = 0; job < 50; ++job)
+  {
+    pool.parallel_for(20, [&](size_t) { total++; });
+  }
+  EXPECT_EQ(total.load(), 50 * 20);
+}
+
+TEST(ThreadPoolTest, ZeroTasksIsANoOp)
+{
+  ThreadPool pool(2);
+  bool called = false;
+  pool.parallel_for(0, [&](size_t) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(ThreadPoolTest, ResolvesAutomaticThreadCount)
+{
+  EXPECT_EQ(ThreadPool::resolve_thread_count(3), 3);
+  EXPECT_GE(ThreadPool::resolve_thread_count(0), 1);
+
+  ThreadPool single(1);
+  EXPECT_EQ(single.size(), 1);
+  int sum = 0;
+  single.parallel_for(10, [&](size_t i) { sum += static_cast<int>(i); });
+  EXPECT_EQ(sum, 45);
+}
+
+TEST(ThreadPoolTest, RethrowsTaskExceptionAndStaysUsable)
+{
+  ThreadPool pool(4);
+  EXPECT_THROW(pool.parallel_for(100,
+                                 [](size_t i)
+                                 {
+                                   if (i == 17) throw std::runtime_error("boom");
+                                 }),
+               std::runtime_error);
+
+  std::atomic<int> total{0};
+  pool.parallel_for(10, [&](size_t) { total++; });
+  EXPECT_EQ(total.load(), 10);
+}
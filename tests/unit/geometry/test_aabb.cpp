@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "test_helpers.h"
+
+using percepto::core::Ray, percepto::core::Vec3, percepto::geometry::AABB,
+    percepto::geometry::Sphere, percepto::geometry::Triangle;
+
+static Vec3 inverse(const Vec3& d)
+{
+  return Vec3(1.0 / d.x, 1.0 / d.y, 1.0 / d.z);
+}
+
+TEST(AABBTest, DefaultIsEmptyAndExpandGrows)
+{
+  AABB box;
+  EXPECT_TRUE(box.empty());
+  EXPECT_DOUBLE_EQ(box.surface_area(), 0.0);
+
+  box.expand(Vec3(1, 2, 3));
+  box.expand(Vec3(-1, 0, 5));
+  EXPECT_FALSE(box.empty());
+  EXPECT_VEC3_EQ(box.min, Vec3(-1, 0, 3));
+  EXPECT_VEC3_EQ(box.max, Vec3(1, 2, 5));
+  EXPECT_VEC3_EQ(box.centroid(), Vec3(0, 1, 4));
+  EXPECT_DOUBLE_EQ(box.surface_area(), 2.0 * (2 * 2 + 2 * 2 + 2 * 2));
+  EXPECT_EQ(box.largest_axis(), 0);
+}
+
+TEST(AABBTest, PrimitiveBoundsEncloseGeometry)
+{
+  Triangle tri(Vec3(0, 0, 0), Vec3(1, 2, 0), Vec3(-1, 0, 3));
+  AABB tb = tri.bounds();
+  EXPECT_VEC3_EQ(tb.min, Vec3(-1, 0, 0));
+  EXPECT_VEC3_EQ(tb.max, Vec3(1, 2, 3));
+
+  Sphere sphere(Vec3(1, 1, 1), 2.0);
+  AABB sb = sphere.bounds();
+  EXPECT_VEC3_EQ(sb.min, Vec3(-1, -1, -1));
+  EXPECT_VEC3_EQ(sb.max, Vec3(3, 3, 3));
+  EXPECT_TRUE(sb.contains(AABB(Vec3(0, 0, 0), Vec3(2, 2, 2))));
+}
+
+TEST(AABBTest, SlabTestHitsAndMisses)
+{
+  AABB box(Vec3(-1, -1, 4), Vec3(1, 1, 6));
+  double t_entry = 0.0;
+
+  Ray hit(Vec3(0, 0, 0), Vec3(0, 0, 1), 0.0, 100.0);
+  ASSERT_TRUE(
+      box.intersect(hit.origin(), inverse(hit.direction()), hit.tMin(), hit.tMax(), t_entry));
+  EXPECT_DOUBLE_EQ(t_entry, 4.0);
+
+  // Interval ends before the box.
+  EXPECT_FALSE(box.intersect(hit.origin(), inverse(hit.direction()), 0.0, 3.0, t_entry));
+
+  Ray miss(Vec3(0, 0, 0), Vec3(0, 1, 0), 0.0, 100.0);
+  EXPECT_FALSE(box.intersect(miss.origin(), inverse(miss.direction()), 0.0, 100.0, t_entry));
+
+  // Origin inside the box: entry is clamped to t_min.
+  Ray inside(Vec3(0, 0, 5), Vec3(1, 0, 0), 0.0, 100.0);
+  ASSERT_TRUE(box.intersect(inside.origin(), inverse(inside.direction()), 0.0, 100.0, t_entry));
+  EXPECT_DOUBLE_EQ(t_entry, 0.0);
+}
+
+TEST(AABBTest, SlabTestHandlesFlatBoxes)
+{
+  // A triangle lying in z = 2 has a zero-thickness box along z.
+  AABB flat(Vec3(-1, -1, 2), Vec3(1, 1, 2));
+  double t_entry = 0.0;
+  Ray ray(Vec3(0.5, 0.5, 0), Vec3(0, 0, 1), 0.0, 100.0);
+  ASSERT_TRUE(flat.intersect(ray.origin(), inverse(ray.direction()), 0.0, 100.0, t_entry));
+  EXPECT_DOUBLE_EQ(t_entry, 2.0);
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::RayPacket, percepto::core::Scene, percepto::core::Transform;
+using percepto::geometry::Instance, percepto::geometry::InstancedMesh;
+using percepto::geometry::TriangleMesh, percepto::geometry::TriangleMeshBuilder;
+
+namespace
+{
+// A lumpy closed shell of 2 × 16 × 8 triangles around the origin, about one unit across.
+TriangleMesh make_shell()
+{
+  TriangleMeshBuilder builder;
+  auto point = [](int a, int e)
+  {
+    const double az = 2.0 * M_PI * (a % 16) / 16;
+    const double el = -M_PI / 2 + M_PI * e / 8;
+    const double r = 0.5 + 0.1 * std::sin(3 * az) * std::cos(el);
+    return Vec3(r * std::cos(el) * std::cos(az), r * std::cos(el) * std::sin(az),
+                r * std::sin(el));
+  };
+  for (int a = 0; a < 16; ++a)
+  {
+    for (int e = 0; e < 8; ++e)
+    {
+      builder.add_triangle(point(a, e), point(a + 1, e), point(a, e + 1));
+      builder.add_triangle(point(a + 1, e), point(a + 1, e + 1), point(a, e + 1));
+    }
+  }
+  return builder.build();
+}
+
+// Placements on a ring around the sensor, each turned, scaled and some mirrored.
+std::vector<Transform> ring_placements(int count)
+{
+  std::vector<Transform> placements;
+  for (int k = 0; k < count; ++k)
+  {
+    const double az = 2.0 * M_PI * k / count;
+    placements.push_back(Transform::translation(Vec3(8.0 * std::cos(az), 8.0 * std::sin(az),
+                                                     0.3 * std::sin(5.0 * az))) *
+                         Transform::rotation(Vec3(0.2, 0.5, 1.0), 0.7 * k) *
+                         Transform::scaling(Vec3(k % 3 == 0 ? -1.0 : 1.0, 1.0 + 0.1 * k, 1.5)));
+  }
+  return placements;
+}
+
+// The placements flattened into one mesh, mirrored copies with their winding reversed.
+TriangleMesh flatten(const TriangleMesh& mesh, const std::vector<Transform>& placements)
+{
+  TriangleMeshBuilder builder;
+  for (const Transform& placement : placements)
+  {
+    const bool mirrored = placement.determinant() < 0.0;
+    for (size_t t = 0; t < mesh.triangle_count(); ++t)
+    {
+      const Vec3 v0 = placement.point(mesh.vertex(t, 0));
+      const Vec3 v1 = placement.point(mesh.vertex(t, 1));
+      const Vec3 v2 = placement.point(mesh.vertex(t, 2));
+      mirrored ? builder.add_triangle(v0, v2, v1) : builder.add_triangle(v0, v1, v2);
+    }
+  }
+  return builder.build();
+}
+
+std::unique_ptr<Scene> instanced_scene(const std::vector<Transform>& placements)
+{
+  auto mesh = std::make_shared<const InstancedMesh>(make_shell());
+  auto scene = std::make_unique<Scene>();
+  for (const Transform& placement : placements) scene->add_object(Instance(mesh, placement));
+  return scene;
+}
+
+Ray sensor_ray(int k)
+{
+  const double az = 2.0 * M_PI * k / 720, el = 0.12 * std::sin(0.37 * k);
+  return Ray(Vec3(0.0, 0.0, 0.1),
+             Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)), 0.0,
+             100.0);
+}
+}  // namespace
+
+TEST(TransformTest, ComposesRightToLeftAndInverts)
+{
+  const Transform move = Transform::translation(Vec3(1.0, 2.0, 3.0));
+  const Transform turn = Transform::rotation(Vec3(0.0, 0.0, 2.0), M_PI / 2);
+  EXPECT_VEC3_NEAR((move * turn).point(Vec3(1.0, 0.0, 0.0)), Vec3(1.0, 3.0, 3.0), 1e-12);
+  EXPECT_VEC3_NEAR((turn * move).point(Vec3(1.0, 0.0, 0.0)), Vec3(-2.0, 2.0, 3.0), 1e-12);
+  EXPECT_VEC3_NEAR(turn.vector(Vec3(1.0, 0.0, 0.0)), Vec3(0.0, 1.0, 0.0), 1e-12);
+
+  const Transform placement = ring_placements(7)[3];
+  const Transform round_trip = placement.inverse() * placement;
+  const Vec3 p(0.3, -1.7, 2.2);
+  EXPECT_VEC3_NEAR(round_trip.point(p), p, 1e-12);
+  EXPECT_LT(Transform::scaling(Vec3(-1.0, 1.0, 1.0)).determinant(), 0.0);
+  EXPECT_THROW(Transform::scaling(Vec3(1.0, 0.0, 1.0)).inverse(), std::invalid_argument);
+}
+
+TEST(InstanceTest, RejectsMissingMeshAndSingularTransform)
+{
+  auto mesh = std::make_shared<const InstancedMesh>(make_shell());
+  EXPECT_THROW(Instance(nullptr, Transform()), std::invalid_argument);
+  EXPECT_THROW(Instance(mesh, Transform::scaling(Vec3(0.0, 1.0, 1.0))), std::invalid_argument);
+}
+
+TEST(InstanceTest, BoundsEncloseTheTransformedMesh)
+{
+  auto mesh = std::make_shared<const InstancedMesh>(make_shell());
+  for (const Transform& placement : ring_placements(9))
+  {
+    const Instance instance(mesh, placement);
+    const auto box = instance.bounds();
+    for (const Vec3& v : mesh->mesh().vertices())
+    {
+      const Vec3 p = placement.point(v);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        EXPECT_LE(box.min[axis], p[axis]);
+        EXPECT_GE(box.max[axis], p[axis]);
+      }
+    }
+  }
+}
+
+TEST(InstanceTest, TracesLikeTheFlattenedScene)
+{
+  const auto placements = ring_placements(24);
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh, AcceleratorType::Bvh8})
+  {
+    auto instanced = instanced_scene(placements);
+    Scene flat;
+    flat.add_mesh(flatten(make_shell(), placements));
+    instanced->set_accelerator(accelerator);
+    flat.set_accelerator(accelerator);
+
+    int hits = 0;
+    for (int k = 0; k < 720; ++k)
+    {
+      const Ray ray = sensor_ray(k);
+      HitRecord expected, got;
+      const bool hit = flat.intersect(ray, expected);
+      ASSERT_EQ(instanced->intersect(ray, got), hit) << "ray " << k;
+      if (!hit) continue;
+      ++hits;
+      EXPECT_NEAR(got.t, expected.t, 1e-9) << "ray " << k;
+      // Mirrored placements keep their faces outward, as the flattened copies with reversed
+      // winding do.
+      const auto got_surface = instanced->resolve(ray, got);
+      const auto expected_surface = flat.resolve(ray, expected);
+      EXPECT_VEC3_NEAR(got_surface.point, expected_surface.point, 1e-9);
+      EXPECT_VEC3_NEAR(got_surface.normal, expected_surface.normal, 1e-9);
+      EXPECT_EQ(got_surface.front_face, expected_surface.front_face);
+    }
+    EXPECT_GT(hits, 100);
+  }
+}
+
+TEST(InstanceTest, PacketsMatchSingleRays)
+{
+  auto scene = instanced_scene(ring_placements(24));
+  for (int first = 0; first < 720; first += RayPacket::kMaxSize)
+  {
+    RayPacket packet;
+    for (int i = 0; i < RayPacket::kMaxSize; ++i) packet.push(sensor_ray(first + i));
+
+    HitRecord records[RayPacket::kMaxSize];
+    const uint32_t mask = scene->intersect_packet(packet, records);
+    for (int i = 0; i < RayPacket::kMaxSize; ++i)
+    {
+      HitRecord expected;
+      const bool hit = scene->intersect(sensor_ray(first + i), expected);
+      ASSERT_EQ(bool(mask & (1u << i)), hit) << "ray " << first + i;
+      if (hit)
+      {
+        EXPECT_EQ(records[i].t, expected.t) << "ray " << first + i;
+      }
+    }
+  }
+}
+
+TEST(InstanceTest, MemoryGrowsWithUniqueMeshesNotInstances)
+{
+  auto few = instanced_scene(ring_placements(10));
+  auto many = instanced_scene(ring_placements(1000));
+  few->commit();
+  many->commit();
+
+  // The shared mesh and its BVH are counted once, however many instances use them.
+  EXPECT_EQ(few->memory_usage().meshes, many->memory_usage().meshes);
+  const double per_instance =
+      double(many->memory_usage().total() - few->memory_usage().total()) / 990;
+  EXPECT_LT(per_instance, 512.0);
+
+  Scene flat;
+  flat.add_mesh(flatten(make_shell(), ring_placements(1000)));
+  flat.commit();
+  EXPECT_GT(flat.memory_usage().total(), 20 * many->memory_usage().total());
+}
@@ -34,12 +34,12 @@ TEST_F(GeometryTestFixture, SphereTest_RaySphereIntersection)
     // - Ray direction = normalized(center - origin)
     // - Using the ray-sphere equation: ||O + tD - C||^2 = r^2
     // - The solution yields t_hit ≈ 8.152946438562545
-    EXPECT_VEC3_EQ(hit_record.point, ray.at(hit_record.t));
+    EXPECT_VEC3_NEAR(sphere.normal(ray.at(hit_record.t)), -ray_direction, 1e-12);
     EXPECT_NEAR(hit_record.t, 8.152946438562545, 1e-9)
         << "Unexpected t_hit value. This indicates the intersection distance is incorrect.";
 
     // Validate that the computed hit point lies exactly on the sphere's surface
-    double distance_to_center = (hit_record.point - sphere_centre).length();
+    double distance_to_center = (ray.at(hit_record.t) - sphere_centre).length();
     EXPECT_NEAR(distance_to_center, sphere_radius, 1e-6)
         << "Hit point does not lie on the sphere's surface — distance to center != radius.";
   }
@@ -79,7 +79,7 @@ TEST_F(GeometryTestFixture, SphereTest_RaySphereIntersection)
     ASSERT_TRUE(hit) << "Expected a tangent hit, but got no intersection.";
 
     // Check: the hit point lies exactly on the sphere's surface
-    double d = (hit_record.point - center).length();
+    double d = (ray.at(hit_record.t) - center).length();
     EXPECT_NEAR(d, radius, 1e-6)
         << "Tangent hit point is not exactly on the surface of the sphere.";
 
@@ -98,4 +98,20 @@ TEST_F(GeometryTestFixture, SphereTest_RaySphereIntersection)
     EXPECT_DOUBLE_EQ(disc, 0.0) << "Expected discriminant to be zero for a tangent hit, but got "
                                 << disc;
   }
-}
\ No newline at end of file
+}
+
+TEST_F(GeometryTestFixture, SphereTest_OccludesWithinTheRayInterval)
+{
+  const Sphere sphere(Vec3(5.0, 0.0, 0.0), 1.0);
+  const Vec3 x(1.0, 0.0, 0.0);
+
+  EXPECT_TRUE(sphere.occludes(Ray(Vec3(0, 0, 0), x, 0.0, 100.0)));
+  // Ends in front of the sphere, starts behind it, or points away from it.
+  EXPECT_FALSE(sphere.occludes(Ray(Vec3(0, 0, 0), x, 0.0, 3.9)));
+  EXPECT_FALSE(sphere.occludes(Ray(Vec3(0, 0, 0), x, 6.1, 100.0)));
+  EXPECT_FALSE(sphere.occludes(Ray(Vec3(0, 0, 0), -1.0 * x, 0.0, 100.0)));
+  // From inside, the far wall blocks the ray if it is reached.
+  EXPECT_TRUE(sphere.occludes(Ray(Vec3(5, 0, 0), x, 0.0, 2.0)));
+  EXPECT_FALSE(sphere.occludes(Ray(Vec3(5, 0, 0), x, 0.0, 0.5)));
+  EXPECT_FALSE(sphere.occludes(Ray(Vec3(0, 1.5, 0), x, 0.0, 100.0)));
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_mesh.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::HitRecord;
+using percepto::core::Scene;
+using percepto::geometry::Sphere, percepto::geometry::TriangleMesh;
+using percepto::geometry::TriangleMeshBuilder;
+
+namespace
+{
+// A closed band of quads around the origin: every vertex is shared by six triangles.
+std::vector<Triangle> make_band(int az_cells, int el_cells)
+{
+  std::vector<Triangle> triangles;
+  auto point = [&](int a, int e)
+  {
+    const double az = 2.0 * M_PI * (a % az_cells) / az_cells;
+    const double el = -0.6 + 1.2 * e / el_cells;
+    return Vec3(20.0 * std::cos(el) * std::cos(az), 20.0 * std::cos(el) * std::sin(az),
+                20.0 * std::sin(el));
+  };
+  for (int a = 0; a < az_cells; ++a)
+  {
+    for (int e = 0; e < el_cells; ++e)
+    {
+      triangles.emplace_back(point(a, e), point(a, e + 1), point(a + 1, e));
+      triangles.emplace_back(point(a + 1, e), point(a, e + 1), point(a + 1, e + 1));
+    }
+  }
+  return triangles;
+}
+}  // namespace
+
+TEST(TriangleMeshTest, BuilderStoresSharedVerticesOnce)
+{
+  const auto triangles = make_band(12, 4);
+  TriangleMeshBuilder builder;
+  for (const auto& tri : triangles) builder.add_triangle(tri);
+  const TriangleMesh mesh = builder.build();
+
+  ASSERT_EQ(mesh.triangle_count(), triangles.size());
+  EXPECT_EQ(mesh.vertex_count(), 12u * 5u);  // The band wraps in azimuth.
+  for (size_t t = 0; t < triangles.size(); ++t)
+  {
+    AssertTriangleMatches(mesh.triangle(t),
+                          {triangles[t].v0(), triangles[t].v1(), triangles[t].v2()});
+  }
+  EXPECT_EQ(builder.triangle_count(), 0u);  // build() hands the buffers over.
+}
+
+TEST(TriangleMeshTest, IntersectMatchesTriangle)
+{
+  const TriangleMesh mesh({Vec3(0, -1, -1), Vec3(0, 1, -1), Vec3(0, 0, 1), Vec3(2, 0, 0)},
+                          {0, 1, 2, 2, 1, 3});
+  for (const Ray& ray : {Ray(Vec3(-5, 0, 0), Vec3(1, 0, 0)), Ray(Vec3(5, 0, 0), Vec3(-1, 0, 0)),
+                         Ray(Vec3(-5, 0.2, 0.1), Vec3(1, 0, 0)), Ray(Vec3(0, 5, 0), Vec3(0, 1, 0))})
+  {
+    for (size_t t = 0; t < mesh.triangle_count(); ++t)
+    {
+      HitRecord expected, actual;
+      ASSERT_EQ(mesh.triangle(t).intersect(ray, expected), mesh.intersect(t, ray, actual));
+      EXPECT_EQ(expected.t, actual.t);
+    }
+  }
+}
+
+TEST(TriangleMeshTest, RejectsInvalidIndexBuffers)
+{
+  EXPECT_THROW(TriangleMesh({Vec3(0, 0, 0), Vec3(1, 0, 0)}, {0, 1}), std::invalid_argument);
+  EXPECT_THROW(TriangleMesh({Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0)}, {0, 1, 3}),
+               std::invalid_argument);
+}
+
+TEST(TriangleMeshTest, SceneTracesMeshLikeFreeTriangles)
+{
+  const auto triangles = make_band(90, 6);
+  const Sphere sphere(Vec3(8, 3, 0), 1.5);
+
+  for (auto accelerator : {AcceleratorType::None, AcceleratorType::Bvh})
+  {
+    SCOPED_TRACE(accelerator == AcceleratorType::Bvh ? "bvh" : "brute force");
+    Scene objects, indexed;
+    objects.set_accelerator(accelerator);
+    indexed.set_accelerator(accelerator);
+
+    TriangleMeshBuilder builder;
+    for (const auto& tri : triangles)
+    {
+      objects.add_object(tri);
+      builder.add_triangle(tri);
+    }
+    objects.add_object(sphere);
+    indexed.add_object(sphere);
+    indexed.add_mesh(builder.build());
+    ASSERT_EQ(indexed.size(), objects.size());
+
+    for (int k = 0; k < 500; ++k)
+    {
+      const double az = 2.0 * M_PI * k / 500, el = 0.55 * std::sin(0.37 * k);
+      const Ray ray(Vec3(0, 0, 0),
+                    Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)));
+      HitRecord expected, actual;
+      ASSERT_EQ(objects.intersect(ray, expected), indexed.intersect(ray, actual)) << "ray " << k;
+      ASSERT_EQ(expected.t, actual.t) << "ray " << k;
+    }
+
+    // Shared vertices cut the geometry to a fraction of the per-triangle copies.
+    objects.commit();
+    indexed.commit();
+    EXPECT_LT(indexed.memory_usage().geometry() * 2, objects.memory_usage().geometry());
+  }
+}
+
+TEST(TriangleMeshTest, ScenePrimitivesNumberObjectsThenMeshes)
+{
+  Scene scene;
+  scene.add_mesh(TriangleMesh({Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0)}, {0, 1, 2}));
+  scene.add_mesh(TriangleMesh({Vec3(0, 0, 5), Vec3(1, 0, 5), Vec3(0, 1, 5)}, {0, 1, 2, 2, 1, 0}));
+  scene.add_object(Sphere(Vec3(0, 0, -5), 1.0));
+  ASSERT_EQ(scene.size(), 4);
+
+  EXPECT_TRUE(std::holds_alternative<Sphere>(scene.primitive(0)));
+  EXPECT_EQ(std::get<Triangle>(scene.primitive(1)).v0().z, 0.0);
+  EXPECT_EQ(std::get<Triangle>(scene.primitive(2)).v0().z, 5.0);
+  AssertTriangleMatches(std::get<Triangle>(scene.primitive(3)),
+                        {Vec3(0, 1, 5), Vec3(1, 0, 5), Vec3(0, 0, 5)});
+}
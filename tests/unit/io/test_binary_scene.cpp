@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/config_loader.h"
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/io/binary_scene.h"
+#include "percepto/io/scene_loader.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::BvhBuilder, percepto::common::HitRecord;
+using percepto::common::SceneFormat;
+using percepto::core::Scene;
+using percepto::geometry::Sphere;
+using percepto::io::BinarySceneParser, percepto::io::BinarySceneWriter;
+using percepto::test::FileTestFixture, percepto::test::kRoomFixture, percepto::test::load_room,
+    percepto::test::patch_file;
+
+namespace
+{
+std::filesystem::path temp_scene_path(const std::string& prefix)
+{
+  auto path = FileTestFixture::make_temp_file_name(prefix);
+  path.replace_extension(".pscn");
+  return path;
+}
+
+// Removes the file when the test ends, pass or fail.
+struct TempScene
+{
+  explicit TempScene(const std::string& prefix) : path(temp_scene_path(prefix)) {}
+  ~TempScene() { FileTestFixture::delete_if_exists(path); }
+  std::filesystem::path path;
+};
+
+}  // namespace
+
+TEST(BinarySceneTest, RoundTripPreservesTrianglesAndBvh)
+{
+  TempScene file("pscn_round_trip");
+  auto original = load_room();
+  const auto info = BinarySceneWriter().write(*original, file.path.string());
+  EXPECT_EQ(info.version, percepto::io::kBinarySceneVersion);
+  EXPECT_EQ(info.triangle_count, original->size());
+  EXPECT_TRUE(info.has_bvh);
+  EXPECT_EQ(info.file_bytes, std::filesystem::file_size(file.path));
+
+  auto loaded = BinarySceneParser().load_scene_from_binary(file.path.string());
+  ASSERT_EQ(loaded->size(), original->size());
+  for (int i = 0; i < original->size(); ++i)
+  {
+    const auto a = std::get<Triangle>(original->primitive(i));
+    const auto b = std::get<Triangle>(loaded->primitive(i));
+    ASSERT_TRUE(a.v0() == b.v0() && a.v1() == b.v1() && a.v2() == b.v2()) << "triangle " << i;
+  }
+
+  // The stored tree is used as is: same nodes and primitive order as the one built in memory.
+  original->commit();
+  loaded->commit();
+  ASSERT_EQ(loaded->bvh().nodes().size(), original->bvh().nodes().size());
+  EXPECT_EQ(loaded->bvh().prim_indices(), original->bvh().prim_indices());
+  for (size_t n = 0; n < original->bvh().nodes().size(); ++n)
+  {
+    const auto& a = original->bvh().nodes()[n];
+    const auto& b = loaded->bvh().nodes()[n];
+    EXPECT_EQ(a.offset, b.offset);
+    EXPECT_EQ(a.count, b.count);
+    EXPECT_TRUE(a.bounds.min == b.bounds.min && a.bounds.max == b.bounds.max);
+  }
+
+  // Rays in every direction from the middle of the room find the same closest hits.
+  for (int k = 0; k < 64; ++k)
+  {
+    const double az = 2.0 * M_PI * k / 64, el = 0.8 * std::sin(k);
+    const Ray ray(Vec3(0.0, 0.0, 1.0),
+                  Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)),
+                  0.0, 1e3);
+    HitRecord expected, got;
+    ASSERT_EQ(original->intersect(ray, expected), loaded->intersect(ray, got)) << "ray " << k;
+    EXPECT_EQ(expected.t, got.t) << "ray " << k;
+  }
+}
+
+TEST(BinarySceneTest, LoadsWithoutStoredBvh)
+{
+  TempScene file("pscn_no_bvh");
+  auto original = load_room();
+  const auto info = BinarySceneWriter().write(*original, file.path.string(), false);
+  EXPECT_FALSE(info.has_bvh);
+
+  auto loaded = BinarySceneParser().load_scene_from_binary(file.path.string());
+  EXPECT_EQ(loaded->size(), original->size());
+  EXPECT_TRUE(loaded->bvh().nodes().empty());
+
+  loaded->set_accelerator(AcceleratorType::Bvh);
+  loaded->commit();
+  EXPECT_FALSE(loaded->bvh().nodes().empty());
+}
+
+TEST(BinarySceneTest, UnchangedBvhOptionsKeepTheStoredTree)
+{
+  TempScene file("pscn_same_options");
+  auto original = load_room();
+  BinarySceneWriter().write(*original, file.path.string());
+
+  // What main applies with the default configuration.
+  const percepto::common::RayTracerConfig config{};
+  auto loaded = BinarySceneParser().load_scene_from_binary(file.path.string());
+  auto options = loaded->bvh_options();
+  options.builder = config.bvh_builder;
+  if (config.bvh_builder == BvhBuilder::Lbvh) options.treelet_optimization = config.bvh_treelets;
+  loaded->set_bvh_options(options);
+  loaded->commit();
+  original->commit();
+  EXPECT_TRUE(loaded->has_prebuilt_bvh());
+  EXPECT_EQ(loaded->bvh().prim_indices(), original->bvh().prim_indices());
+
+  // Other options still discard it.
+  options.max_leaf_size = 1;
+  loaded->set_bvh_options(options);
+  EXPECT_FALSE(loaded->has_prebuilt_bvh());
+}
+
+TEST(BinarySceneTest, WritingLeavesTheSceneAcceleratorAlone)
+{
+  TempScene file("pscn_accelerator");
+  auto room = load_room();
+  room->set_accelerator(AcceleratorType::Bvh8);
+  room->commit();
+  const size_t bytes = room->bvh8().memory_bytes();
+
+  EXPECT_TRUE(BinarySceneWriter().write(*room, file.path.string()).has_bvh);
+  EXPECT_EQ(room->accelerator(), AcceleratorType::Bvh8);
+  EXPECT_EQ(room->bvh8().memory_bytes(), bytes);
+}
+
+TEST(BinarySceneTest, SharedVerticesAreStoredOnce)
+{
+  TempScene file("pscn_shared");
+  Scene scene;
+  // A quad split along its diagonal: four distinct corners.
+  scene.add_object(Triangle(Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(1, 1, 0)));
+  scene.add_object(Triangle(Vec3(0, 0, 0), Vec3(1, 1, 0), Vec3(0, 1, 0)));
+  BinarySceneWriter().write(scene, file.path.string());
+
+  const auto info = BinarySceneParser().read_info(file.path.string());
+  EXPECT_EQ(info.triangle_count, 2u);
+  EXPECT_EQ(info.vertex_count, 4u);
+}
+
+TEST(BinarySceneTest, RejectsMalformedFiles)
+{
+  TempScene file("pscn_malformed");
+  auto room = load_room();
+  BinarySceneWriter().write(*room, file.path.string());
+  const auto size = std::filesystem::file_size(file.path);
+  BinarySceneParser parser;
+
+  // Truncated: the sections no longer fit in the file.
+  std::filesystem::resize_file(file.path, size - 8);
+  EXPECT_THROW(parser.load_scene_from_binary(file.path.string()), std::runtime_error);
+
+  // Out-of-range vertex index in the first triangle.
+  BinarySceneWriter().write(*room, file.path.string());
+  uint64_t index_offset = 0;
+  {
+    std::ifstream in(file.path, std::ios::binary);
+    in.seekg(40);  // magic, version, flags, byte order, reserved, vertex count, vertex offset
+    in.read(reinterpret_cast<char*>(&index_offset), sizeof(index_offset));
+  }
+  const uint32_t bad_index = 0xFFFFFFFFu;
+  patch_file(file.path, static_cast<std::streamoff>(index_offset), &bad_index, sizeof(bad_index));
+  EXPECT_THROW(parser.load_scene_from_binary(file.path.string()), std::runtime_error);
+
+  // The BVH flag without a tree, or a tree listing fewer primitives than the scene has.
+  BinarySceneWriter().write(*room, file.path.string());
+  const uint64_t no_nodes = 0;
+  patch_file(file.path, 56, &no_nodes, sizeof(no_nodes));  // bvh_node_count
+  EXPECT_THROW(parser.load_scene_from_binary(file.path.string()), std::runtime_error);
+  BinarySceneWriter().write(*room, file.path.string());
+  const uint64_t missing_prim = room->size() - 1;
+  patch_file(file.path, 72, &missing_prim, sizeof(missing_prim));  // bvh_prim_count
+  EXPECT_THROW(parser.load_scene_from_binary(file.path.string()), std::runtime_error);
+
+  // Unsupported version.
+  BinarySceneWriter().write(*room, file.path.string());
+  const uint32_t future_version = percepto::io::kBinarySceneVersion + 1;
+  patch_file(file.path, 8, &future_version, sizeof(future_version));
+  EXPECT_THROW(parser.read_info(file.path.string()), std::runtime_error);
+
+  // Not a binary scene at all.
+  EXPECT_THROW(parser.load_scene_from_binary(kRoomFixture), std::runtime_error);
+}
+
+TEST(BinarySceneTest, RejectsTreesDeeperThanTheTraversalStack)
+{
+  // A terrain strip of 400 triangles, stored with its BVH replaced by a chain: one triangle
+  // split off per level, the rest in the deepest leaf.
+  Scene scene;
+  for (int i = 0; i < 400; ++i)
+  {
+    scene.add_object(Triangle(Vec3(i, 0, 0), Vec3(i + 1, 0, 0), Vec3(i, 1, 0)));
+  }
+  TempScene file("pscn_deep");
+  auto write_chain = [&](int depth)
+  {
+    BinarySceneWriter().write(scene, file.path.string());
+    struct FileNode
+    {
+      double min[3] = {-1.0, -1.0, -1.0};
+      double max[3] = {401.0, 2.0, 1.0};
+      uint32_t offset = 0;
+      uint32_t count = 0;
+    };
+    std::vector<FileNode> nodes(2 * depth - 1);
+    for (int level = 0; level + 1 < depth; ++level)
+    {
+      nodes[2 * level].offset = 2 * level + 2;
+      nodes[2 * level + 1] = {{-1.0, -1.0, -1.0}, {401.0, 2.0, 1.0}, uint32_t(level), 1};
+    }
+    nodes.back().offset = depth - 1;
+    nodes.back().count = 400 - (depth - 1);
+
+    uint64_t node_offset = 0;
+    {
+      std::ifstream in(file.path, std::ios::binary);
+      in.seekg(64);  // bvh_node_offset
+      in.read(reinterpret_cast<char*>(&node_offset), sizeof(node_offset));
+    }
+    std::vector<uint32_t> prims(400);
+    std::iota(prims.begin(), prims.end(), 0u);
+    uint64_t prim_offset = node_offset + nodes.size() * sizeof(FileNode);
+    prim_offset = (prim_offset + 63) / 64 * 64;
+    const uint64_t node_count = nodes.size();
+    const uint64_t file_size = prim_offset + prims.size() * sizeof(uint32_t);
+    std::filesystem::resize_file(file.path, file_size);
+    patch_file(file.path, static_cast<std::streamoff>(node_offset), nodes.data(),
+               nodes.size() * sizeof(FileNode));
+    patch_file(file.path, static_cast<std::streamoff>(prim_offset), prims.data(),
+               prims.size() * sizeof(uint32_t));
+    patch_file(file.path, 56, &node_count, sizeof(node_count));
+    patch_file(file.path, 80, &prim_offset, sizeof(prim_offset));
+    patch_file(file.path, 88, &file_size, sizeof(file_size));
+  };
+
+  // As deep as traversal allows: loads and traces.
+  write_chain(percepto::accel::Bvh::kMaxDepth);
+  auto loaded = BinarySceneParser().load_scene_from_binary(file.path.string());
+  loaded->commit();
+  EXPECT_EQ(loaded->bvh().depth(), percepto::accel::Bvh::kMaxDepth);
+  HitRecord hit;
+  EXPECT_TRUE(loaded->intersect(Ray(Vec3(350.2, 0.2, 1.0), Vec3(0, 0, -1), 0.0, 10.0), hit));
+
+  // One level more would overflow the traversal stack.
+  write_chain(percepto::accel::Bvh::kMaxDepth + 1);
+  EXPECT_THROW(BinarySceneParser().load_scene_from_binary(file.path.string()),
+               std::runtime_error);
+}
+
+TEST(BinarySceneTest, WriterRejectsNonTriangleObjects)
+{
+  TempScene file("pscn_sphere");
+  Scene scene;
+  scene.add_object(Sphere(Vec3(0, 0, 0), 1.0));
+  EXPECT_THROW(BinarySceneWriter().write(scene, file.path.string()), std::runtime_error);
+}
+
+TEST(SceneLoaderTest, PicksFormatFromExtension)
+{
+  EXPECT_EQ(percepto::io::scene_format_from_path("a/b/room.csv"), SceneFormat::CSV);
+  EXPECT_EQ(percepto::io::scene_format_from_path("room.CSV"), SceneFormat::CSV);
+  EXPECT_EQ(percepto::io::scene_format_from_path("room.pscn"), SceneFormat::Binary);
+  EXPECT_EQ(percepto::io::scene_format_from_path("room.obj"), SceneFormat::OBJ);
+  EXPECT_THROW(percepto::io::scene_format_from_path("room.txt"), std::runtime_error);
+
+  TempScene file("pscn_loader");
+  auto room = load_room();
+  BinarySceneWriter().write(*room, file.path.string());
+  EXPECT_EQ(percepto::io::load_scene(file.path.string())->size(), room->size());
+  EXPECT_EQ(percepto::io::load_scene(kRoomFixture)->size(), room->size());
+}
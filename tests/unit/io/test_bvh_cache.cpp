@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "percepto/accel/bvh.h"
+#include "percepto/common/hash.h"
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/aabb.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/io/bvh_cache.h"
+#include "test_helpers.h"
+
+using percepto::common::AcceleratorType, percepto::common::BvhBuilder;
+using percepto::common::HitRecord;
+using percepto::core::Scene;
+using percepto::geometry::Sphere;
+using percepto::io::BvhCacheStatus, percepto::io::commit_with_bvh_cache;
+using percepto::test::FileTestFixture, percepto::test::load_room, percepto::test::patch_file;
+
+namespace
+{
+// Removes the cache file when the test ends, pass or fail.
+struct TempCache
+{
+  explicit TempCache(const std::string& prefix)
+      : path(FileTestFixture::make_temp_file_name(prefix).replace_extension(".pbvh"))
+  {
+  }
+  ~TempCache() { FileTestFixture::delete_if_exists(path); }
+  std::string file() const { return path.string(); }
+  std::filesystem::path path;
+};
+
+void expect_same_tree(const percepto::accel::Bvh& a, const percepto::accel::Bvh& b)
+{
+  ASSERT_EQ(a.nodes().size(), b.nodes().size());
+  EXPECT_EQ(a.prim_indices(), b.prim_indices());
+  for (size_t n = 0; n < a.nodes().size(); ++n)
+  {
+    EXPECT_EQ(a.nodes()[n].offset, b.nodes()[n].offset);
+    EXPECT_EQ(a.nodes()[n].count, b.nodes()[n].count);
+    EXPECT_TRUE(a.nodes()[n].bounds.min == b.nodes()[n].bounds.min &&
+                a.nodes()[n].bounds.max == b.nodes()[n].bounds.max);
+  }
+}
+}  // namespace
+
+TEST(HashTest, MatchesReferenceValues)
+{
+  // XXH64 reference digests.
+  EXPECT_EQ(percepto::common::hash64("", 0), 0xEF46DB3751D8E999ull);
+  EXPECT_EQ(percepto::common::hash64("a", 1), 0xD24EC4F1A98C6E5Bull);
+  EXPECT_EQ(percepto::common::hash64("abc", 3), 0x44BC2CF5AD770999ull);
+}
+
+TEST(BvhCacheTest, MissThenHitReusesTheSameTree)
+{
+  TempCache cache("bvh_cache_hit");
+  auto built = load_room();
+  EXPECT_EQ(commit_with_bvh_cache(*built, cache.file()), BvhCacheStatus::Missing);
+  ASSERT_TRUE(std::filesystem::exists(cache.path));
+
+  auto loaded = load_room();
+  EXPECT_EQ(commit_with_bvh_cache(*loaded, cache.file()), BvhCacheStatus::Hit);
+  EXPECT_TRUE(loaded->has_prebuilt_bvh());
+  expect_same_tree(built->bvh(), loaded->bvh());
+
+  for (int k = 0; k < 64; ++k)
+  {
+    const double az = 2.0 * M_PI * k / 64, el = 0.8 * std::sin(k);
+    const Ray ray(Vec3(0.0, 0.0, 1.0),
+                  Vec3(std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el)),
+                  0.0, 1e3);
+    HitRecord expected, got;
+    ASSERT_EQ(built->intersect(ray, expected), loaded->intersect(ray, got)) << "ray " << k;
+    EXPECT_EQ(expected.t, got.t) << "ray " << k;
+  }
+}
+
+TEST(BvhCacheTest, ChangedGeometryIsStaleAndRewritten)
+{
+  TempCache cache("bvh_cache_geometry");
+  auto original = load_room();
+  commit_with_bvh_cache(*original, cache.file());
+
+  auto edited = load_room();
+  edited->add_object(Sphere(Vec3(0.0, 0.0, 1.0), 0.25));
+  EXPECT_NE(percepto::io::bvh_cache_key(*edited), percepto::io::bvh_cache_key(*original));
+  EXPECT_EQ(commit_with_bvh_cache(*edited, cache.file()), BvhCacheStatus::Stale);
+
+  // The rebuilt tree replaced the old file.
+  auto again = load_room();
+  again->add_object(Sphere(Vec3(0.0, 0.0, 1.0), 0.25));
+  EXPECT_EQ(commit_with_bvh_cache(*again, cache.file()), BvhCacheStatus::Hit);
+  expect_same_tree(edited->bvh(), again->bvh());
+}
+
+TEST(BvhCacheTest, ChangedBuildOptionsAreStale)
+{
+  TempCache cache("bvh_cache_options");
+  auto sah = load_room();
+  commit_with_bvh_cache(*sah, cache.file());
+
+  auto lbvh = load_room();
+  auto options = lbvh->bvh_options();
+  options.builder = BvhBuilder::Lbvh;
+  lbvh->set_bvh_options(options);
+  EXPECT_EQ(commit_with_bvh_cache(*lbvh, cache.file()), BvhCacheStatus::Stale);
+
+  // Thread count does not change the tree, so it does not invalidate the cache.
+  auto threaded = load_room();
+  options.thread_count = 3;
+  threaded->set_bvh_options(options);
+  EXPECT_EQ(commit_with_bvh_cache(*threaded, cache.file()), BvhCacheStatus::Hit);
+}
+
+TEST(BvhCacheTest, CorruptFilesAreRebuilt)
+{
+  TempCache cache("bvh_cache_corrupt");
+  auto scene = load_room();
+  commit_with_bvh_cache(*scene, cache.file());
+  const auto size = std::filesystem::file_size(cache.path);
+
+  // A flipped byte in the last primitive index fails the checksum.
+  const char flipped = 0x7f;
+  patch_file(cache.path, static_cast<std::streamoff>(size - 1), &flipped, 1);
+  auto flipped_scene = load_room();
+  EXPECT_EQ(commit_with_bvh_cache(*flipped_scene, cache.file()), BvhCacheStatus::Corrupt);
+  EXPECT_FALSE(flipped_scene->has_prebuilt_bvh());
+
+  // The rebuild overwrote the damaged file.
+  auto rebuilt = load_room();
+  EXPECT_EQ(commit_with_bvh_cache(*rebuilt, cache.file()), BvhCacheStatus::Hit);
+
+  std::filesystem::resize_file(cache.path, size / 2);
+  auto truncated = load_room();
+  EXPECT_EQ(commit_with_bvh_cache(*truncated, cache.file()), BvhCacheStatus::Corrupt);
+
+  std::filesystem::resize_file(cache.path, 16);
+  percepto::accel::Bvh bvh;
+  EXPECT_EQ(percepto::io::read_bvh_cache(cache.file(), percepto::io::bvh_cache_key(*scene), bvh),
+            BvhCacheStatus::Corrupt);
+  EXPECT_TRUE(bvh.nodes().empty());
+}
+
+TEST(BvhCacheTest, TreesDeeperThanTheTraversalStackAreCorrupt)
+{
+  // A chain that splits one triangle off per level, with a valid checksum.
+  using percepto::accel::Bvh, percepto::accel::BvhNode;
+  Scene scene;
+  for (int i = 0; i < 200; ++i)
+  {
+    scene.add_object(percepto::geometry::Triangle(percepto::core::Vec3(i, 0, 0),
+                                                  percepto::core::Vec3(i + 1, 0, 0),
+                                                  percepto::core::Vec3(i, 1, 0)));
+  }
+  const percepto::geometry::AABB bounds(percepto::core::Vec3(-1, -1, -1),
+                                        percepto::core::Vec3(201, 2, 1));
+  auto chain = [&](uint32_t depth)
+  {
+    std::vector<BvhNode> nodes(2 * depth - 1, BvhNode{bounds, 0, 0});
+    for (uint32_t level = 0; level + 1 < depth; ++level)
+    {
+      nodes[2 * level].offset = 2 * level + 2;
+      nodes[2 * level + 1] = BvhNode{bounds, level, 1};
+    }
+    nodes.back() = BvhNode{bounds, depth - 1, 200 - (depth - 1)};
+    std::vector<uint32_t> prims(200);
+    for (uint32_t i = 0; i < 200; ++i) prims[i] = i;
+    Bvh bvh;
+    bvh.assign(std::move(nodes), std::move(prims));
+    return bvh;
+  };
+
+  TempCache cache("bvh_cache_deep");
+  const auto key = percepto::io::bvh_cache_key(scene);
+  Bvh read;
+  percepto::io::write_bvh_cache(cache.file(), key, chain(Bvh::kMaxDepth));
+  EXPECT_EQ(percepto::io::read_bvh_cache(cache.file(), key, read), BvhCacheStatus::Hit);
+  EXPECT_EQ(read.depth(), Bvh::kMaxDepth);
+
+  percepto::io::write_bvh_cache(cache.file(), key, chain(Bvh::kMaxDepth + 1));
+  EXPECT_EQ(percepto::io::read_bvh_cache(cache.file(), key, read), BvhCacheStatus::Corrupt);
+}
+
+TEST(BvhCacheTest, UnusedWithoutABvh)
+{
+  TempCache cache("bvh_cache_unused");
+  auto scene = load_room();
+  scene->set_accelerator(AcceleratorType::None);
+  EXPECT_EQ(commit_with_bvh_cache(*scene, cache.file()), BvhCacheStatus::Unused);
+  EXPECT_FALSE(std::filesystem::exists(cache.path));
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <array>
+#include <cstddef>
 #include <fstream>
 #include <string>
 #include <variant>
@@ -38,15 +39,15 @@ TEST_F(CsvParserTestFixture, LoadsTriangle_FromCsv)
   auto scene = parser.load_scene_from_csv(fs.existing_file.string());
 
   ASSERT_EQ(scene->size(), 3u) << "Expected 3 triangles in the scene";
-  for (size_t i = 0; i < scene->objects().size(); ++i)
+  for (std::size_t i = 0; i < static_cast<std::size_t>(scene->size()); ++i)
   {
-    const auto& obj = scene->objects()[i];
+    const auto obj = scene->primitive(i);
     ASSERT_TRUE(std::holds_alternative<Triangle>(obj)) << "Object #" << i << " is not a Triangle";
   }
 
   for (size_t i = 0; i < 3; ++i)
   {
-    const Triangle& t = std::get<Triangle>(scene->objects()[i]);
+    const Triangle t = std::get<Triangle>(scene->primitive(i));
     AssertTriangleMatches(t, triangle_vertices[i]);
   }
 }
@@ -75,6 +76,7 @@ TEST_F(CsvParserTestFixture, Throws_OnTooManyOrTooFewColumns)
     ASSERT_TRUE(out.is_open()) << "Cannot open temp file";
     out << "x0,y0,z0,x1,y1,z1,x2,y2,z2\n";
     out << c.data_line << "\n";
+    out.close();
 
     percepto::io::CsvParser parser;
     EXPECT_THROW(parser.load_scene_from_csv(fs.existing_file.string()), std::runtime_error);
@@ -182,3 +184,129 @@ TEST_F(CsvParserTestFixture, EmptyCsvReturnsEmptyScene)
     EXPECT_TRUE(scene->objects().empty());
   });
 }
+
+// ––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––
+//  Memory-mapped parallel loader
+// ––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––––
+namespace
+{
+percepto::io::CsvParser mapped_parser(int threads)
+{
+  percepto::io::CsvLoadOptions options;
+  options.thread_count = threads;
+  return percepto::io::CsvParser(options);
+}
+
+// Writes `rows` triangles whose coordinates are derived from the row index.
+void write_rows(std::ofstream& out, int rows, int bad_row = 0, const char* bad_line = "")
+{
+  out << "x0,y0,z0,x1,y1,z1,x2,y2,z2\n";
+  out.precision(17);
+  for (int r = 1; r <= rows; ++r)
+  {
+    if (r == bad_row)
+    {
+      out << bad_line << "\n";
+      continue;
+    }
+    for (int k = 0; k < 9; ++k) out << (k ? ", " : "") << r * 0.001 + k * 1.5e-3;
+    out << (r % 2 ? "\r\n" : "\n");
+  }
+}
+}  // namespace
+
+TEST_F(CsvParserTestFixture, MappedLoaderMatchesCsvReaderOnFixture)
+{
+  percepto::io::CsvLoadOptions reader_options;
+  reader_options.memory_mapped = false;
+  auto expected = percepto::io::CsvParser(reader_options).load_scene_from_csv(
+      "fixtures/data/room.csv");
+  auto actual = mapped_parser(2).load_scene_from_csv("fixtures/data/room.csv");
+
+  ASSERT_EQ(actual->size(), expected->size());
+  for (int i = 0; i < expected->size(); ++i)
+  {
+    const auto a = std::get<Triangle>(actual->primitive(i));
+    const auto e = std::get<Triangle>(expected->primitive(i));
+    EXPECT_TRUE(a.v0() == e.v0() && a.v1() == e.v1() && a.v2() == e.v2()) << "row " << i + 1;
+  }
+}
+
+TEST_F(CsvParserTestFixture, MappedLoaderParsesLargeFilesInParallel)
+{
+  constexpr int kRows = 20000;  // Enough bytes to be cut into several chunks.
+  {
+    std::ofstream out(fs.existing_file);
+    ASSERT_TRUE(out.is_open());
+    write_rows(out, kRows);
+    out << "\n";  // Blank lines are skipped.
+    out << "+1, 2e0 ,3,4,5,6,7,8,9";  // No trailing newline.
+  }
+
+  for (int threads : {1, 4})
+  {
+    SCOPED_TRACE("threads=" + std::to_string(threads));
+    auto scene = mapped_parser(threads).load_scene_from_csv(fs.existing_file.string());
+    ASSERT_EQ(scene->size(), kRows + 1);
+
+    for (int r = 1; r <= kRows; r += 997)
+    {
+      const auto t = std::get<Triangle>(scene->primitive(r - 1));
+      EXPECT_EQ(t.v0().x, r * 0.001);
+      EXPECT_EQ(t.v1().y, r * 0.001 + 4 * 1.5e-3);
+      EXPECT_EQ(t.v2().z, r * 0.001 + 8 * 1.5e-3);
+    }
+    AssertTriangleMatches(std::get<Triangle>(scene->primitive(kRows)),
+                          {Vec3{1, 2, 3}, Vec3{4, 5, 6}, Vec3{7, 8, 9}});
+  }
+}
+
+TEST_F(CsvParserTestFixture, MappedLoaderReportsTheBadRowLikeTheReader)
+{
+  struct Case
+  {
+    const char* bad_line;
+    const char* message;
+  };
+  const std::vector<Case> cases = {
+      {"1,2,3,4,abc,6,7,8,9",
+       "Error parsing row 12345, field 5: cannot convert to double (Not a number.)"},
+      {"1,2,3,4,,6,7,8,9",
+       "Error parsing row 12345, field 5: cannot convert to double (Not a number.)"},
+      {"1,2,3,4,5,6,7,8", "Error parsing row 12345: expected 9 fields, but found 8"},
+      {"1,2,3,4,5,6,7,8,9,x", "Error parsing row 12345: expected 9 fields, but found 10"},
+  };
+
+  for (const auto& c : cases)
+  {
+    SCOPED_TRACE(c.bad_line);
+    {
+      std::ofstream out(fs.existing_file);
+      ASSERT_TRUE(out.is_open());
+      write_rows(out, 20000, 12345, c.bad_line);
+    }
+
+    try
+    {
+      mapped_parser(4).load_scene_from_csv(fs.existing_file.string());
+      FAIL() << "expected std::runtime_error";
+    }
+    catch (const std::runtime_error& e)
+    {
+      EXPECT_STREQ(e.what(), c.message);
+    }
+  }
+}
+
+TEST_F(CsvParserTestFixture, MappedLoaderThrowsOnEmptyFile)
+{
+  std::ofstream(fs.existing_file).close();
+  EXPECT_THROW(mapped_parser(4).load_scene_from_csv(fs.existing_file.string()),
+               std::runtime_error);
+
+  // The CSVReader path rejects it the same way.
+  percepto::io::CsvLoadOptions options;
+  options.memory_mapped = false;
+  EXPECT_THROW(percepto::io::CsvParser(options).load_scene_from_csv(fs.existing_file.string()),
+               std::runtime_error);
+}
@@ -1,15 +1,19 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cmath>
 #include <random>
 
+#include "percepto/common/types.h"
 #include "percepto/core/ray.h"
 #include "percepto/core/vec3.h"
 #include "percepto/math/intersection/moller_trumbore.h"
 #include "test_helpers.h"
 
+using percepto::common::CullMode;
 using percepto::core::Ray;
 using percepto::core::Vec3;
 using percepto::math::intersection::moller_trumbore;
+using percepto::math::intersection::moller_trumbore_occluded;
 using percepto::test::IntersectionTestFixture;
 
 // -----------------------------------------------------
@@ -210,6 +214,64 @@ TEST_F(IntersectionTestFixture, BackFace_WhenCullingEnabled_NoHit)
   EXPECT_FALSE(hit);
 }
 
+TEST_F(IntersectionTestFixture, BackFace_WithoutCulling_HitsLikeReversedWinding)
+{
+  Vec3 v0 = unit_right_triangle.v0();
+  Vec3 v1 = unit_right_triangle.v1();
+  Vec3 v2 = unit_right_triangle.v2();
+
+  // From below, the ray sees the back face; the same triangle wound the other way faces it.
+  Ray ray(Vec3(0.25, 0.125, -1.0), Vec3(0.1, 0.2, 1.0), 0.0, 100.0);
+  ASSERT_FALSE(moller_trumbore(v0, v1, v2, ray));
+  ASSERT_FALSE(moller_trumbore_occluded(v0, v1, v2, ray));
+
+  auto hit = moller_trumbore<CullMode::None>(v0, v1, v2, ray);
+  auto reversed = moller_trumbore(v0, v2, v1, ray);
+  ASSERT_TRUE(hit);
+  ASSERT_TRUE(reversed);
+  EXPECT_DOUBLE_EQ(hit->t, reversed->t);
+  // Swapping v1 and v2 swaps their barycentric weights.
+  EXPECT_DOUBLE_EQ(hit->u, reversed->v);
+  EXPECT_DOUBLE_EQ(hit->v, reversed->u);
+  EXPECT_TRUE(moller_trumbore_occluded<CullMode::None>(v0, v1, v2, ray));
+
+  // Front faces are hit exactly as with culling.
+  Ray front(Vec3(0.25, 0.125, 1.0), Vec3(0.1, 0.2, -1.0), 0.0, 100.0);
+  auto culled = moller_trumbore(v0, v1, v2, front);
+  auto unculled = moller_trumbore<CullMode::None>(v0, v1, v2, front);
+  ASSERT_TRUE(culled);
+  ASSERT_TRUE(unculled);
+  EXPECT_EQ(unculled->t, culled->t);
+  EXPECT_EQ(unculled->u, culled->u);
+  EXPECT_EQ(unculled->v, culled->v);
+}
+
+TEST_F(IntersectionTestFixture, FloatKernel_AgreesWithDouble)
+{
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0), depth(1.0, 5.0);
+  int hits = 0;
+  for (int trial = 0; trial < 4000; ++trial)
+  {
+    const Vec3 centre(coord(rng), coord(rng), depth(rng));
+    const Vec3 v0 = centre + Vec3(coord(rng), coord(rng), coord(rng));
+    const Vec3 v1 = centre + Vec3(coord(rng), coord(rng), coord(rng));
+    const Vec3 v2 = centre + Vec3(coord(rng), coord(rng), coord(rng));
+    Ray ray(Vec3(coord(rng), coord(rng), -1.0), Vec3(0.2 * coord(rng), 0.2 * coord(rng), 1.0), 0.0,
+            10.0);
+
+    auto exact = moller_trumbore<CullMode::None>(v0, v1, v2, ray);
+    auto single = moller_trumbore<CullMode::None, float>(v0, v1, v2, ray);
+    // Rays grazing an edge may fall either way in single precision; skip those.
+    if (exact && std::min({exact->u, exact->v, 1.0 - exact->u - exact->v}) < 1e-4) continue;
+    ASSERT_EQ(bool(single), bool(exact)) << trial;
+    if (!exact) continue;
+    ++hits;
+    EXPECT_NEAR(single->t, exact->t, 1e-4 * exact->t) << trial;
+  }
+  EXPECT_GT(hits, 100);
+}
+
 // -----------------------------------------------------
 // TEST BLOCK: Edge Hits on Unrotated Triangle
 // -----------------------------------------------------
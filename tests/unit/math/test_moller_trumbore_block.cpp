@@ -0,0 +1,390 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_block.h"
+#include "percepto/math/intersection/moller_trumbore.h"
+#include "percepto/math/intersection/moller_trumbore_block.h"
+#include "test_helpers.h"
+
+using percepto::common::CullMode, percepto::common::TriangleHitResult;
+using percepto::core::Ray, percepto::core::Vec3;
+using percepto::geometry::FloatTriangleBlock, percepto::geometry::Triangle,
+    percepto::geometry::TriangleBlock;
+using percepto::math::intersection::moller_trumbore;
+using percepto::math::intersection::moller_trumbore_block;
+using percepto::math::intersection::moller_trumbore_block_occluded;
+using percepto::math::intersection::moller_trumbore_occluded;
+using percepto::test::IntersectionTestFixture;
+
+template <typename T>
+class MollerTrumboreBlockTest : public ::testing::Test
+{
+};
+
+template <int W>
+struct Width
+{
+  static constexpr int value = W;
+};
+
+using BlockWidths = ::testing::Types<Width<4>, Width<8>, Width<16>>;
+TYPED_TEST_SUITE(MollerTrumboreBlockTest, BlockWidths);
+
+// Scalar reference: nearest lane (lowest on ties) among per-triangle moller_trumbore calls.
+template <CullMode kCull = CullMode::Back>
+static int reference_nearest(const std::vector<Triangle>& tris, const Ray& ray,
+                             TriangleHitResult& best)
+{
+  int best_lane = -1;
+  for (size_t i = 0; i < tris.size(); ++i)
+  {
+    auto hit = moller_trumbore<kCull>(tris[i].v0(), tris[i].v1(), tris[i].v2(), ray);
+    if (hit && (best_lane < 0 || hit->t < best.t))
+    {
+      best = *hit;
+      best_lane = static_cast<int>(i);
+    }
+  }
+  return best_lane;
+}
+
+TYPED_TEST(MollerTrumboreBlockTest, MatchesScalarKernelBitForBit)
+{
+  constexpr int W = TypeParam::value;
+
+  std::mt19937 rng(1234 + W);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0);
+  std::uniform_real_distribution<double> depth(1.0, 5.0);
+  auto random_vec = [&] { return Vec3(coord(rng), coord(rng), coord(rng)); };
+
+  int hits = 0;
+  for (int trial = 0; trial < 2000; ++trial)
+  {
+    // Vary the fill level so partially occupied blocks are covered too.
+    const int fill = 1 + trial % W;
+
+    std::vector<Triangle> tris;
+    TriangleBlock<W> block;
+    for (int lane = 0; lane < fill; ++lane)
+    {
+      Vec3 centre(coord(rng), coord(rng), depth(rng));
+      tris.emplace_back(centre + random_vec(), centre + random_vec(), centre + random_vec());
+      block.push(tris.back(), static_cast<uint32_t>(lane));
+    }
+    EXPECT_EQ(block.count, fill);
+
+    Ray ray(Vec3(coord(rng), coord(rng), -1.0), Vec3(0.2 * coord(rng), 0.2 * coord(rng), 1.0), 0.0,
+            10.0);
+
+    TriangleHitResult expected{}, actual{};
+    const int expected_lane = reference_nearest(tris, ray, expected);
+    const int actual_lane = moller_trumbore_block(block, ray, ray.tMax(), actual);
+
+    ASSERT_EQ(actual_lane, expected_lane) << "trial " << trial;
+    if (expected_lane >= 0)
+    {
+      ++hits;
+      EXPECT_EQ(actual.t, expected.t);
+      EXPECT_EQ(actual.u, expected.u);
+      EXPECT_EQ(actual.v, expected.v);
+      EXPECT_EQ(block.prim_id[actual_lane], static_cast<uint32_t>(expected_lane));
+    }
+  }
+  EXPECT_GT(hits, 100);
+}
+
+TYPED_TEST(MollerTrumboreBlockTest, WithoutCullingMatchesScalarKernel)
+{
+  constexpr int W = TypeParam::value;
+
+  // Random windings: about half of the triangles turn their back to the ray.
+  std::mt19937 rng(4321 + W);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0), depth(1.0, 5.0);
+  auto random_vec = [&] { return Vec3(coord(rng), coord(rng), coord(rng)); };
+
+  int hits = 0, back_hits = 0;
+  for (int trial = 0; trial < 2000; ++trial)
+  {
+    const int fill = 1 + trial % W;
+    std::vector<Triangle> tris;
+    TriangleBlock<W> block;
+    for (int lane = 0; lane < fill; ++lane)
+    {
+      Vec3 centre(coord(rng), coord(rng), depth(rng));
+      tris.emplace_back(centre + random_vec(), centre + random_vec(), centre + random_vec());
+      block.push(tris.back(), static_cast<uint32_t>(lane));
+    }
+
+    Ray ray(Vec3(coord(rng), coord(rng), -1.0), Vec3(0.2 * coord(rng), 0.2 * coord(rng), 1.0), 0.0,
+            10.0);
+
+    TriangleHitResult expected{}, actual{};
+    const int expected_lane = reference_nearest<CullMode::None>(tris, ray, expected);
+    const int actual_lane = moller_trumbore_block<CullMode::None>(block, ray, ray.tMax(), actual);
+    ASSERT_EQ(actual_lane, expected_lane) << "trial " << trial;
+    ASSERT_EQ(moller_trumbore_block_occluded<CullMode::None>(block, ray, ray.tMax()),
+              expected_lane >= 0)
+        << "trial " << trial;
+    if (expected_lane < 0) continue;
+    ++hits;
+    if (!moller_trumbore(tris[expected_lane].v0(), tris[expected_lane].v1(),
+                         tris[expected_lane].v2(), ray))
+    {
+      ++back_hits;
+    }
+    EXPECT_EQ(actual.t, expected.t);
+    EXPECT_EQ(actual.u, expected.u);
+    EXPECT_EQ(actual.v, expected.v);
+  }
+  EXPECT_GT(back_hits, 50);
+  EXPECT_GT(hits, back_hits);
+}
+
+TYPED_TEST(MollerTrumboreBlockTest, EmptyBlockNeverHits)
+{
+  constexpr int W = TypeParam::value;
+  TriangleBlock<W> block;
+  Ray ray(Vec3(0, 0, 0), Vec3(0, 0, 1), 0.0, 100.0);
+  TriangleHitResult hit{};
+  EXPECT_EQ(moller_trumbore_block(block, ray, ray.tMax(), hit), -1);
+}
+
+TYPED_TEST(MollerTrumboreBlockTest, RespectsCallerTMax)
+{
+  constexpr int W = TypeParam::value;
+  TriangleBlock<W> block;
+  // Two stacked triangles at z = 1 and z = 2, both facing the ray.
+  block.push(Triangle(Vec3(-1, -1, 2), Vec3(-1, 2, 2), Vec3(2, -1, 2)), 0);
+  block.push(Triangle(Vec3(-1, -1, 1), Vec3(-1, 2, 1), Vec3(2, -1, 1)), 1);
+
+  Ray ray(Vec3(0, 0, 0), Vec3(0, 0, 1), 0.0, 100.0);
+  TriangleHitResult hit{};
+  ASSERT_EQ(moller_trumbore_block(block, ray, ray.tMax(), hit), 1);
+  EXPECT_DOUBLE_EQ(hit.t, 1.0);
+
+  // With t_max below both surfaces nothing is reported.
+  EXPECT_EQ(moller_trumbore_block(block, ray, 0.5, hit), -1);
+}
+
+TYPED_TEST(MollerTrumboreBlockTest, AnyHitAgreesWithClosestHit)
+{
+  constexpr int W = TypeParam::value;
+
+  std::mt19937 rng(99 + W);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0), depth(1.0, 5.0), reach(0.5, 6.0);
+  auto random_vec = [&] { return Vec3(coord(rng), coord(rng), coord(rng)); };
+
+  int hits = 0;
+  for (int trial = 0; trial < 2000; ++trial)
+  {
+    const int fill = 1 + trial % W;
+    std::vector<Triangle> tris;
+    TriangleBlock<W> block;
+    for (int lane = 0; lane < fill; ++lane)
+    {
+      Vec3 centre(coord(rng), coord(rng), depth(rng));
+      tris.emplace_back(centre + random_vec(), centre + random_vec(), centre + random_vec());
+      block.push(tris.back(), static_cast<uint32_t>(lane));
+    }
+
+    // A random reach cuts some hits off, so t_max is exercised as well.
+    Ray ray(Vec3(coord(rng), coord(rng), -1.0), Vec3(0.2 * coord(rng), 0.2 * coord(rng), 1.0), 0.0,
+            reach(rng));
+    TriangleHitResult closest{};
+    const bool expected = moller_trumbore_block(block, ray, ray.tMax(), closest) >= 0;
+    ASSERT_EQ(moller_trumbore_block_occluded(block, ray, ray.tMax()), expected) << trial;
+
+    bool any_scalar = false;
+    for (const Triangle& tri : tris)
+    {
+      any_scalar |= moller_trumbore_occluded(tri.v0(), tri.v1(), tri.v2(), ray);
+    }
+    EXPECT_EQ(any_scalar, expected) << trial;
+    hits += expected;
+  }
+  EXPECT_GT(hits, 20);
+  const TriangleBlock<W> empty;
+  EXPECT_FALSE(moller_trumbore_block_occluded(empty, Ray(Vec3(), Vec3(0, 0, 1)), 1.0));
+}
+
+TEST_F(IntersectionTestFixture, BlockKernel_CullsBackFaces)
+{
+  TriangleBlock<4> block;
+  block.push(unit_right_triangle, 0);
+
+  // Front face (normal +z) hit from above, back face hit from below.
+  Ray front(Vec3(0.25, 0.25, 1.0), Vec3(0.0, 0.0, -1.0), 0.0, 100.0);
+  Ray back(Vec3(0.25, 0.25, -1.0), Vec3(0.0, 0.0, 1.0), 0.0, 100.0);
+
+  TriangleHitResult hit{};
+  EXPECT_EQ(moller_trumbore_block(block, front, front.tMax(), hit), 0);
+  EXPECT_EQ(moller_trumbore_block(block, back, back.tMax(), hit), -1);
+}
+
+template <typename T>
+class FloatTriangleBlockTest : public ::testing::Test
+{
+};
+
+using FloatBlockWidths = ::testing::Types<Width<8>, Width<16>>;
+TYPED_TEST_SUITE(FloatTriangleBlockTest, FloatBlockWidths);
+
+// How close `ray` passes to an edge of `tri`, in barycentric units, or 0 if it runs parallel.
+static double edge_margin(const Triangle& tri, const Ray& ray)
+{
+  const Vec3 e1 = tri.v1() - tri.v0(), e2 = tri.v2() - tri.v0();
+  const Vec3 p = ray.direction().cross(e2);
+  const double det = e1.dot(p);
+  if (std::abs(det) < 1e-9) return 0.0;
+  const Vec3 s = ray.origin() - tri.v0();
+  const double u = s.dot(p) / det, v = ray.direction().dot(s.cross(e1)) / det;
+  return std::min({std::abs(u), std::abs(v), std::abs(1.0 - u - v)});
+}
+
+TYPED_TEST(FloatTriangleBlockTest, AgreesWithDoubleKernelAwayFromEdges)
+{
+  constexpr int W = TypeParam::value;
+
+  std::mt19937 rng(777 + W);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0), depth(1.0, 5.0);
+  auto random_vec = [&] { return Vec3(coord(rng), coord(rng), coord(rng)); };
+
+  int hits = 0, compared = 0;
+  for (int trial = 0; trial < 3000; ++trial)
+  {
+    const int fill = 1 + trial % W;
+    std::vector<Triangle> tris;
+    FloatTriangleBlock<W> block;
+    for (int lane = 0; lane < fill; ++lane)
+    {
+      Vec3 centre(coord(rng), coord(rng), depth(rng));
+      tris.emplace_back(centre + random_vec(), centre + random_vec(), centre + random_vec());
+      block.push(tris.back(), static_cast<uint32_t>(lane));
+    }
+    Ray ray(Vec3(coord(rng), coord(rng), -1.0), Vec3(0.2 * coord(rng), 0.2 * coord(rng), 1.0), 0.0,
+            10.0);
+
+    // Within float error of an edge either answer is right.
+    bool grazing = false;
+    for (const Triangle& tri : tris) grazing |= edge_margin(tri, ray) < 1e-4;
+    if (grazing) continue;
+    ++compared;
+
+    for (CullMode cull : {CullMode::Back, CullMode::None})
+    {
+      TriangleHitResult expected{}, actual{};
+      const bool culling = cull == CullMode::Back;
+      const int expected_lane = culling ? reference_nearest(tris, ray, expected)
+                                        : reference_nearest<CullMode::None>(tris, ray, expected);
+      const int actual_lane =
+          culling ? moller_trumbore_block(block, ray, ray.tMax(), actual)
+                  : moller_trumbore_block<CullMode::None>(block, ray, ray.tMax(), actual);
+      const bool occluded =
+          culling ? moller_trumbore_block_occluded(block, ray, ray.tMax())
+                  : moller_trumbore_block_occluded<CullMode::None>(block, ray, ray.tMax());
+      ASSERT_EQ(actual_lane >= 0, expected_lane >= 0) << "trial " << trial;
+      ASSERT_EQ(occluded, expected_lane >= 0) << "trial " << trial;
+      if (expected_lane < 0) continue;
+      ++hits;
+      // Triangles that cross each other may swap places; their distances still agree, to float
+      // error at the block's scale of a few units.
+      EXPECT_NEAR(actual.t, expected.t, 2e-5) << "trial " << trial;
+      if (actual_lane == expected_lane)
+      {
+        EXPECT_NEAR(actual.u, expected.u, 1e-4);
+        EXPECT_NEAR(actual.v, expected.v, 1e-4);
+      }
+      EXPECT_EQ(block.prim_id[actual_lane], static_cast<uint32_t>(actual_lane));
+    }
+  }
+  EXPECT_GT(compared, 1000);
+  EXPECT_GT(hits, 300);
+}
+
+TYPED_TEST(FloatTriangleBlockTest, NoRayFallsBetweenTrianglesSharingAnEdge)
+{
+  constexpr int W = TypeParam::value;
+
+  // A triangulated 8 x 8 m patch far from the world origin, with rays aimed straight at its
+  // vertices and at points along every edge, where rounding is most likely to open a gap.
+  const Vec3 corner(3.0e5, -2.0e5, 40.0);
+  constexpr int kCells = 8;
+  std::vector<FloatTriangleBlock<W>> blocks(1);
+  auto vertex = [&](int i, int j)
+  { return corner + Vec3(i, j, 0.1 * std::sin(i + 2.0 * j)); };
+  for (int i = 0; i < kCells; ++i)
+  {
+    for (int j = 0; j < kCells; ++j)
+    {
+      // Wound to face down, towards the rays.
+      const Triangle lower(vertex(i, j), vertex(i, j + 1), vertex(i + 1, j));
+      const Triangle upper(vertex(i + 1, j), vertex(i, j + 1), vertex(i + 1, j + 1));
+      for (const Triangle& tri : {lower, upper})
+      {
+        if (blocks.back().full()) blocks.emplace_back();
+        blocks.back().push(tri, 0);
+      }
+    }
+  }
+
+  const Vec3 origin = corner + Vec3(kCells / 2.0 + 0.3, kCells / 2.0 - 0.2, -25.0);
+  int rays = 0;
+  for (int i = 1; i < kCells; ++i)
+  {
+    for (int j = 1; j < kCells; ++j)
+    {
+      for (double f : {0.0, 0.25, 0.5, 0.75})
+      {
+        // A vertex, a point on its edges along x, y and on the diagonal.
+        for (const Vec3& target :
+             {vertex(i, j), vertex(i, j) * (1 - f) + vertex(i + 1, j) * f,
+              vertex(i, j) * (1 - f) + vertex(i, j + 1) * f,
+              vertex(i + 1, j) * (1 - f) + vertex(i, j + 1) * f})
+        {
+          const Ray ray(origin, (target - origin).normalized(), 0.0, 100.0);
+          bool hit = false;
+          for (const auto& block : blocks)
+          {
+            TriangleHitResult result{};
+            hit |= moller_trumbore_block(block, ray, ray.tMax(), result) >= 0;
+          }
+          ASSERT_TRUE(hit) << "i=" << i << " j=" << j << " f=" << f;
+          ++rays;
+        }
+      }
+    }
+  }
+  EXPECT_EQ(rays, 49 * 16);
+}
+
+TYPED_TEST(FloatTriangleBlockTest, LargeCoordinatesKeepNearbyPrecision)
+{
+  constexpr int W = TypeParam::value;
+
+  // 100 km from the world origin a float step is 8 mm; relative to the block's anchor the
+  // ray's 30 m offset rounds to a few micrometres instead.
+  const Vec3 far(1.0e5, -6.0e4, 25.0);
+  const Triangle tri(far + Vec3(30, -2, -2), far + Vec3(30, 0, 3), far + Vec3(30, 3, -2));
+  FloatTriangleBlock<W> block;
+  block.push(tri, 7);
+
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> spread(-0.05, 0.05), aim(-0.02, 0.02);
+  for (int trial = 0; trial < 200; ++trial)
+  {
+    const Ray ray(far + Vec3(spread(rng), spread(rng), spread(rng)), Vec3(1.0, aim(rng), aim(rng)),
+                  0.0, 100.0);
+    const auto expected = moller_trumbore(tri.v0(), tri.v1(), tri.v2(), ray);
+    ASSERT_TRUE(expected);
+    TriangleHitResult actual{};
+    ASSERT_EQ(moller_trumbore_block(block, ray, ray.tMax(), actual), 0);
+    EXPECT_NEAR(actual.t, expected->t, 1e-4);
+  }
+}
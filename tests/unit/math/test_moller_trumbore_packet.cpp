@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "percepto/common/types.h"
+#include "percepto/core/ray.h"
+#include "percepto/core/ray_packet.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/triangle.h"
+#include "percepto/geometry/triangle_block.h"
+#include "percepto/math/intersection/moller_trumbore.h"
+#include "percepto/math/intersection/moller_trumbore_packet.h"
+
+using percepto::common::CullMode;
+using percepto::core::Ray, percepto::core::RayPacket, percepto::core::Vec3;
+using percepto::geometry::Triangle, percepto::geometry::TriangleBlock;
+using percepto::math::intersection::moller_trumbore;
+using percepto::math::intersection::moller_trumbore_packet;
+
+TEST(MollerTrumborePacketTest, MatchesScalarKernelBitForBit)
+{
+  std::mt19937 rng(77);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0), depth(1.0, 5.0), spread(-0.3, 0.3);
+  auto random_vec = [&] { return Vec3(coord(rng), coord(rng), coord(rng)); };
+
+  int hits = 0;
+  for (int trial = 0; trial < 1000; ++trial)
+  {
+    TriangleBlock<8> block;
+    const Vec3 centre(coord(rng), coord(rng), depth(rng));
+    const Triangle tri(centre + random_vec(), centre + random_vec(), centre + random_vec());
+    block.push(Triangle(Vec3(9, 9, 9), Vec3(9, 8, 9), Vec3(8, 9, 9)), 0);
+    block.push(tri, 1);
+
+    // A partial packet with every other ray masked out.
+    RayPacket packet;
+    const Vec3 origin(coord(rng), coord(rng), -1.0);
+    const int count = 1 + trial % RayPacket::kMaxSize;
+    for (int i = 0; i < count; ++i)
+    {
+      packet.push(Ray(origin, Vec3(spread(rng), spread(rng), 1.0), 0.0, 10.0));
+    }
+    const uint32_t active = packet.lanes() & (trial % 2 ? 0x5555u : 0xFFFFu);
+
+    double t_max[RayPacket::kMaxSize], t_hit[RayPacket::kMaxSize];
+    for (int i = 0; i < RayPacket::kMaxSize; ++i) t_max[i] = i % 3 ? packet.t_max[i] : 3.0;
+
+    const uint32_t mask = moller_trumbore_packet(block, 1, packet, active, t_max, t_hit);
+    for (int i = 0; i < count; ++i)
+    {
+      Ray ray = packet.ray(i);
+      ray.setTMax(t_max[i]);
+      const auto expected = moller_trumbore(tri.v0(), tri.v1(), tri.v2(), ray);
+      const bool expected_hit = (active >> i & 1u) && expected && expected->t <= t_max[i];
+      ASSERT_EQ(bool(mask >> i & 1u), expected_hit) << "trial " << trial << " ray " << i;
+      if (expected_hit)
+      {
+        ++hits;
+        EXPECT_EQ(t_hit[i], expected->t);
+      }
+    }
+  }
+  EXPECT_GT(hits, 50);
+}
+
+TEST(MollerTrumborePacketTest, CullsBackFaces)
+{
+  TriangleBlock<4> block;
+  block.push(Triangle(Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0)), 0);  // Normal +z.
+
+  RayPacket packet;
+  packet.push(Ray(Vec3(0.25, 0.25, 1.0), Vec3(0.0, 0.0, -1.0)));
+  packet.push(Ray(Vec3(0.25, 0.25, 1.0), Vec3(0.1, 0.0, -1.0)));
+  double t_hit[RayPacket::kMaxSize];
+  EXPECT_EQ(moller_trumbore_packet(block, 0, packet, packet.lanes(), packet.t_max, t_hit), 3u);
+
+  RayPacket below;
+  below.push(Ray(Vec3(0.25, 0.25, -1.0), Vec3(0.0, 0.0, 1.0)));
+  EXPECT_EQ(moller_trumbore_packet(block, 0, below, below.lanes(), below.t_max, t_hit), 0u);
+}
+
+TEST(MollerTrumborePacketTest, WithoutCullingMatchesScalarKernel)
+{
+  std::mt19937 rng(78);
+  std::uniform_real_distribution<double> coord(-2.0, 2.0), depth(1.0, 5.0), spread(-0.3, 0.3);
+  auto random_vec = [&] { return Vec3(coord(rng), coord(rng), coord(rng)); };
+
+  int hits = 0;
+  for (int trial = 0; trial < 1000; ++trial)
+  {
+    TriangleBlock<8> block;
+    const Vec3 centre(coord(rng), coord(rng), depth(rng));
+    const Triangle tri(centre + random_vec(), centre + random_vec(), centre + random_vec());
+    block.push(tri, 0);
+
+    RayPacket packet;
+    const Vec3 origin(coord(rng), coord(rng), -1.0);
+    for (int i = 0; i < RayPacket::kMaxSize; ++i)
+    {
+      packet.push(Ray(origin, Vec3(spread(rng), spread(rng), 1.0), 0.0, 10.0));
+    }
+
+    double t_hit[RayPacket::kMaxSize], u_hit[RayPacket::kMaxSize], v_hit[RayPacket::kMaxSize];
+    const uint32_t mask = moller_trumbore_packet<CullMode::None>(
+        block, 0, packet, packet.lanes(), packet.t_max, t_hit, u_hit, v_hit);
+    for (int i = 0; i < RayPacket::kMaxSize; ++i)
+    {
+      const auto expected =
+          moller_trumbore<CullMode::None>(tri.v0(), tri.v1(), tri.v2(), packet.ray(i));
+      ASSERT_EQ(bool(mask >> i & 1u), bool(expected)) << "trial " << trial << " ray " << i;
+      if (!expected) continue;
+      ++hits;
+      EXPECT_EQ(t_hit[i], expected->t);
+      EXPECT_EQ(u_hit[i], expected->u);
+      EXPECT_EQ(v_hit[i], expected->v);
+    }
+  }
+  EXPECT_GT(hits, 500);
+}
+
+TEST(RayPacketTest, RejectsRaysFromAnotherOrigin)
+{
+  RayPacket packet;
+  packet.push(Ray(Vec3(1, 2, 3), Vec3(1, 0, 0)));
+  EXPECT_THROW(packet.push(Ray(Vec3(0, 0, 0), Vec3(1, 0, 0))), std::invalid_argument);
+  for (int i = 1; i < RayPacket::kMaxSize; ++i) packet.push(Ray(Vec3(1, 2, 3), Vec3(0, 1, 0)));
+  EXPECT_THROW(packet.push(Ray(Vec3(1, 2, 3), Vec3(0, 1, 0))), std::length_error);
+  EXPECT_EQ(packet.lanes(), 0xFFFFu);
+}
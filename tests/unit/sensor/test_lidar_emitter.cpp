@@ -55,6 +55,7 @@ TEST(LidarEmitterTest, Construction_StoresParametersAndTrigTables)
 TEST(LidarEmitterTest, ThrowsOnInvalidConstructorArgs)
 {
   EXPECT_THROW(LidarEmitter emitter(LiDARConfig{0, {}}), std::invalid_argument);
+  EXPECT_THROW(LidarEmitter emitter(LiDARConfig{4, {0.0}, 0.0}), std::invalid_argument);
 }
 
 TEST(LidarEmitterTest, GetRay_ValidIndices)
@@ -100,7 +101,7 @@ TEST(LidarEmitterTest, DirectionsAreUnitLength)
 
   for (int i = 0; i < azimuth_steps; ++i)
   {
-    for (int j = 0; j < elevation_angles.size(); ++j)
+    for (int j = 0; j < static_cast<int>(elevation_angles.size()); ++j)
     {
       auto d = e.get_ray(i, j).direction();
       float len = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
@@ -108,3 +109,78 @@ TEST(LidarEmitterTest, DirectionsAreUnitLength)
     }
   }
 }
+
+TEST(LidarEmitterTest, DirectionTable_RaysAreBitIdenticalToGetRay)
+{
+  const LiDARConfig cfg{360, {-0.5332, -0.1156, 0.0005, 0.1863}};
+  LidarEmitter e(cfg);
+  EXPECT_FALSE(e.has_direction_table());
+  EXPECT_EQ(e.direction_table_bytes(), 0u);
+
+  e.enable_direction_table();
+  ASSERT_TRUE(e.has_direction_table());
+  ASSERT_EQ(e.direction_table().size(), 360u * 4u);
+
+  for (int i = 0; i < cfg.azimuth_steps; ++i)
+  {
+    for (int j = 0; j < 4; ++j)
+    {
+      const Ray expected = e.get_ray(i, j);
+      const Ray actual = e.ray(i, j);
+      ASSERT_TRUE(actual.direction() == expected.direction()) << "i=" << i << " j=" << j;
+      ASSERT_TRUE(actual.origin() == expected.origin());
+      ASSERT_EQ(actual.tMin(), expected.tMin());
+      ASSERT_EQ(actual.tMax(), expected.tMax());
+      ASSERT_EQ(actual.time(), expected.time());
+    }
+  }
+}
+
+TEST(LidarEmitterTest, RaysCarryTheirFiringPhase)
+{
+  LidarEmitter e(LiDARConfig{8, {-0.2, 0.2}, 5.0});
+  EXPECT_DOUBLE_EQ(e.revolution_period(), 0.2);
+  for (int i = 0; i < 8; ++i)
+  {
+    EXPECT_DOUBLE_EQ(e.get_ray(i, 1).time(), i / 8.0);
+    EXPECT_DOUBLE_EQ(e.firing_time(i), 0.2 * i / 8.0);
+  }
+}
+
+TEST(LidarEmitterTest, DirectionTable_BatchCoversOneAzimuthStep)
+{
+  LidarEmitter e(LiDARConfig{16, {-0.2, 0.0, 0.2}});
+  e.enable_direction_table();
+
+  std::vector<Ray> batch;
+  e.rays(5 * 3, 3, batch);
+  ASSERT_EQ(batch.size(), 3u);
+  for (int j = 0; j < 3; ++j) EXPECT_TRUE(batch[j].direction() == e.get_ray(5, j).direction());
+  for (int j = 0; j < 3; ++j) EXPECT_EQ(batch[j].time(), e.get_ray(5, j).time());
+
+  e.rays(0, 2, batch);
+  EXPECT_EQ(batch.size(), 2u);
+}
+
+TEST(LidarEmitterTest, DirectionTable_RebuiltOnlyWhenConfigChanges)
+{
+  const LiDARConfig cfg{100, {-0.2, 0.2}};
+  LidarEmitter e(cfg);
+  e.enable_direction_table();
+  EXPECT_EQ(e.direction_table_bytes(), 3u * 100u * 2u * sizeof(double));
+
+  const double* table = e.direction_table().x.data();
+  const double first = e.direction_table().z[0];
+  e.configure(cfg);
+  e.enable_direction_table();
+  EXPECT_EQ(e.direction_table().x.data(), table);
+
+  e.configure(LiDARConfig{50, {0.3, -0.3, 0.1}});
+  ASSERT_EQ(e.direction_table().size(), 150u);
+  EXPECT_NE(e.direction_table().z[0], first);
+  EXPECT_TRUE(e.ray(49, 2).direction() == e.get_ray(49, 2).direction());
+
+  e.disable_direction_table();
+  EXPECT_FALSE(e.has_direction_table());
+  EXPECT_EQ(e.direction_table_bytes(), 0u);
+}
@@ -1,20 +1,30 @@
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <string>
+#include <thread>
+#include <variant>
 #include <vector>
 
 #include "percepto/common/config_loader.h"
+#include "percepto/core/ray_packet.h"
 #include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
 #include "percepto/core/vec3.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/io/logger.h"
 #include "percepto/lidar/emitter.h"
 #include "percepto/lidar/simulator.h"
 #include "percepto/math/intersection/moller_trumbore.h"
 #include "test_helpers.h"
 
-using percepto::core::Scene, percepto::common::LiDARConfig;
+using percepto::core::Scene, percepto::common::LiDARConfig, percepto::common::PacketLayout;
 using percepto::core::Vec3, percepto::core::Ray, percepto::geometry::Triangle;
 using percepto::lidar::LidarEmitter;
 using percepto::lidar::LidarSimulator;
@@ -44,10 +54,11 @@ TEST(LidarSimulatorTest, SmokeTest)
   ASSERT_EQ(frame.channel_count, 2);
 
   Vec3 default_vec{0, 0, 0};
-  for (size_t i = 0; i < azimuth_steps; i++)
+  ASSERT_EQ(frame.points.size(), azimuth_steps * 2u);
+  ASSERT_TRUE(all_equal(frame.points, default_vec));
+  ASSERT_TRUE(all_equal(frame.ranges, 0.0f));
+  for (int i = 0; i < azimuth_steps; i++)
   {
-    ASSERT_TRUE(all_equal(frame.points[i], default_vec));
-    ASSERT_TRUE(all_equal(frame.ranges[i], 0.0f));
     ASSERT_NEAR(expected_azimuth_angles[i], frame.azimuth_angles[i], 1e-4);
   }
 }
@@ -75,12 +86,12 @@ TEST(LidarSimulatorTest, SingleHitAndMultipleRevolutions)
     constexpr size_t AZ = 1;  // 45° step
     constexpr float EXP_R = 4.1727f;
 
-    float r = frame.ranges[AZ][ELEV];
+    float r = frame.range(AZ, ELEV);
     EXPECT_NEAR(EXP_R, r, 1e-5f) << "range at elev=" << ELEV << " az=" << AZ;
 
     Vec3 dir = Vec3(7, 7, 8).normalized();
     Vec3 expect_pt = Ray{Vec3{0, 0, 0}, dir, 0, 100}.at(r);
-    Vec3 got_pt = frame.points[AZ][ELEV];
+    Vec3 got_pt = frame.point(AZ, ELEV);
 
     Vec3 d = got_pt - expect_pt;
     float geo_err = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
@@ -97,18 +108,259 @@ TEST(LidarSimulatorTest, SingleHitAndMultipleRevolutions)
     constexpr size_t ELEV = 0;
     constexpr size_t AZ_STEPS = 8;
 
-    for (size_t i = 0; i < revs; i++)
+    for (int i = 0; i < revs; i++)
     {
       auto frame = frames[i];
       EXPECT_EQ(frame.hits, 1);
 
-      // First revolution is in indices [0..7], second in [8..15]
+      // Every revolution sees the same ranges and points as the first.
       for (size_t az = 0; az < AZ_STEPS; az++)
       {
-        float r0 = frame.ranges[az][ELEV];
-        Vec3 p0 = frame.points[az][ELEV];
-        // TODO: Add Assertion
+        EXPECT_EQ(frame.range(az, ELEV), frames[0].range(az, ELEV)) << "rev " << i << " az " << az;
+        EXPECT_VEC3_EQ(frame.point(az, ELEV), frames[0].point(az, ELEV));
       }
     }
   }
-}
\ No newline at end of file
+}
+TEST(LidarSimulatorTest, ParallelScanIsBitIdenticalToSerial)
+{
+  // Triangles on a shell around the sensor so that most rays hit something.
+  auto make_scene = []
+  {
+    auto scene = std::make_unique<Scene>();
+    const int az_cells = 90, el_cells = 6;
+    const double radius = 20.0;
+    auto point = [&](double az, double el)
+    {
+      return Vec3(radius * std::cos(el) * std::cos(az), radius * std::cos(el) * std::sin(az),
+                  radius * std::sin(el));
+    };
+    for (int a = 0; a < az_cells; ++a)
+    {
+      double az0 = 2.0 * M_PI * a / az_cells, az1 = 2.0 * M_PI * (a + 1) / az_cells;
+      for (int e = 0; e < el_cells; ++e)
+      {
+        double el0 = -0.6 + 1.2 * e / el_cells, el1 = -0.6 + 1.2 * (e + 1) / el_cells;
+        scene->add_object(Triangle{point(az0, el0), point(az0, el1), point(az1, el0)});
+        scene->add_object(Triangle{point(az1, el0), point(az0, el1), point(az1, el1)});
+      }
+    }
+    return scene;
+  };
+
+  const LiDARConfig cfg{500, {-0.5, -0.3, -0.1, 0.0, 0.1, 0.3, 0.5}};
+  LidarSimulator serial(std::make_unique<LidarEmitter>(cfg), make_scene());
+  auto expected = serial.run_scan(1)[0];
+  ASSERT_GT(expected.hits, 0);
+
+  for (int threads : {2, 3, 8})
+  {
+    for (int tile : {1, 7, 64, 1000})
+    {
+      SCOPED_TRACE("threads=" + std::to_string(threads) + " tile=" + std::to_string(tile));
+
+      LidarSimulator parallel(std::make_unique<LidarEmitter>(cfg), make_scene());
+      parallel.set_scan_options({threads, tile});
+      auto frames = parallel.run_scan(2);
+      ASSERT_EQ(frames.size(), 2u);
+
+      for (const auto& frame : frames)
+      {
+        EXPECT_EQ(frame.hits, expected.hits);
+        for (int i = 0; i < cfg.azimuth_steps; ++i)
+        {
+          for (size_t j = 0; j < cfg.elevation_angles.size(); ++j)
+          {
+            // Bitwise equality: the parallel path must not change a single ULP.
+            ASSERT_EQ(frame.range(i, j), expected.range(i, j)) << "i=" << i << " j=" << j;
+            ASSERT_TRUE(frame.point(i, j) == expected.point(i, j)) << "i=" << i << " j=" << j;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(LidarSimulatorTest, PacketScanIsBitIdenticalToPerRayScan)
+{
+  // 20 channels: one full packet of 16 and a partial one, with a horizontal channel.
+  std::vector<double> elevations;
+  for (int j = 0; j < 20; ++j) elevations.push_back((j - 10) * 0.05);
+  const LiDARConfig cfg{360, elevations};
+
+  auto make_scene = [](percepto::common::AcceleratorType accelerator)
+  {
+    auto scene = std::make_unique<Scene>();
+    scene->set_accelerator(accelerator);
+    for (int a = 0; a < 60; ++a)
+    {
+      const double az0 = 2.0 * M_PI * a / 60, az1 = 2.0 * M_PI * (a + 1) / 60;
+      const double r = 15.0 + (a % 5);
+      auto point = [&](double az, double z) { return Vec3(r * std::cos(az), r * std::sin(az), z); };
+      scene->add_object(Triangle{point(az0, -8), point(az0, 8), point(az1, -8)});
+      scene->add_object(Triangle{point(az1, -8), point(az0, 8), point(az1, 8)});
+    }
+    scene->add_object(percepto::geometry::Sphere(Vec3(6, 2, 0), 1.0));
+    return scene;
+  };
+
+  for (auto accelerator : {percepto::common::AcceleratorType::None,
+                           percepto::common::AcceleratorType::Bvh,
+                           percepto::common::AcceleratorType::Bvh8})
+  {
+    LidarSimulator per_ray(std::make_unique<LidarEmitter>(cfg), make_scene(accelerator));
+    percepto::lidar::ScanOptions options;
+    options.packet_size = 0;
+    per_ray.set_scan_options(options);
+    const auto expected = per_ray.run_scan(1)[0];
+    ASSERT_GT(expected.hits, 0);
+
+    for (auto layout : {PacketLayout::Azimuth, PacketLayout::Column})
+    {
+      for (int packet_size : {8, 16, 64})
+      {
+        SCOPED_TRACE("layout=" + std::to_string(static_cast<int>(layout)) +
+                     " packet_size=" + std::to_string(packet_size));
+        LidarSimulator packets(std::make_unique<LidarEmitter>(cfg), make_scene(accelerator));
+        options.packet_size = packet_size;  // 64 is clamped to the largest packet.
+        options.packet_layout = layout;
+        packets.set_scan_options(options);
+        const auto frame = packets.run_scan(1)[0];
+
+        EXPECT_EQ(frame.hits, expected.hits);
+        for (int i = 0; i < cfg.azimuth_steps; ++i)
+        {
+          for (size_t j = 0; j < elevations.size(); ++j)
+          {
+            ASSERT_EQ(frame.range(i, j), expected.range(i, j)) << "i=" << i << " j=" << j;
+            ASSERT_TRUE(frame.point(i, j) == expected.point(i, j)) << "i=" << i << " j=" << j;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(LidarSimulatorTest, RepeatedScansReuseFrameBuffers)
+{
+  const LiDARConfig cfg{90, {-0.2, 0.0, 0.2}};
+  auto make_scene = []
+  {
+    auto scene = std::make_unique<Scene>();
+    scene->add_object(Triangle{Vec3(5, -5, -5), Vec3(5, 0, 5), Vec3(5, 5, -5)});
+    return scene;
+  };
+
+  LidarSimulator reference(std::make_unique<LidarEmitter>(cfg), make_scene());
+  const auto expected = reference.run_scan(1)[0];
+
+  LidarSimulator sim(std::make_unique<LidarEmitter>(cfg), make_scene());
+  std::vector<percepto::common::FrameScan> frames;
+  sim.run_scan(3, frames);
+  ASSERT_EQ(frames.size(), 3u);
+
+  std::vector<const float*> buffers;
+  for (const auto& frame : frames) buffers.push_back(frame.ranges.data());
+
+  sim.run_scan(3, frames);
+  ASSERT_EQ(frames.size(), 3u);
+  for (const auto& frame : frames)
+  {
+    // Every frame comes back out of the pool, cleared and rescanned.
+    EXPECT_NE(std::find(buffers.begin(), buffers.end(), frame.ranges.data()), buffers.end());
+    EXPECT_EQ(frame.hits, expected.hits);
+    EXPECT_EQ(frame.ranges, expected.ranges);
+  }
+}
+
+TEST(LidarSimulatorTest, FiringTimesSweepEachRevolution)
+{
+  LiDARConfig cfg{120, {-0.1, 0.0, 0.1}};
+  cfg.rotation_rate = 20.0;
+  LidarSimulator sim(std::make_unique<LidarEmitter>(cfg), std::make_unique<Scene>());
+  const auto frames = sim.run_scan(3);
+  ASSERT_EQ(frames.size(), 3u);
+
+  for (size_t f = 0; f < frames.size(); ++f)
+  {
+    const auto& times = frames[f].firing_times;
+    ASSERT_EQ(times.size(), 120u);
+    EXPECT_DOUBLE_EQ(frames[f].timestamp, 0.05 * f);
+    EXPECT_DOUBLE_EQ(times[0], frames[f].timestamp);
+    EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+    EXPECT_NEAR(times.back() - times.front(), 0.05 * 119 / 120, 1e-12);
+  }
+
+  // Later scans carry on the same clock.
+  EXPECT_DOUBLE_EQ(sim.run_scan(1)[0].timestamp, 0.15);
+}
+
+TEST(LidarSimulatorTest, MovingObjectsAreCapturedAtEachFiring)
+{
+  const LiDARConfig cfg{720, {-0.05, 0.0, 0.05}};
+  for (bool packets : {false, true})
+  {
+    // A ball crossing the sensor's left side more slowly than the beams sweep past it.
+    auto scene = std::make_unique<Scene>();
+    const auto ball = scene->add_object(percepto::geometry::Sphere(Vec3(4, 6, 0), 1.0));
+    scene->set_object_motion(ball, percepto::core::Transform(),
+                             percepto::core::Transform::translation(Vec3(-8, 0, 0)));
+
+    LidarSimulator sim(std::make_unique<LidarEmitter>(cfg), std::move(scene));
+    percepto::lidar::ScanOptions options;
+    options.packet_size = packets ? percepto::core::RayPacket::kMaxSize : 1;
+    options.angular_grid = false;
+    sim.set_scan_options(options);
+    const auto frame = sim.run_scan(1)[0];
+    ASSERT_GT(frame.hits, 0);
+
+    for (int i = 0; i < frame.azimuth_steps; ++i)
+    {
+      const auto posed =
+          std::get<percepto::geometry::Sphere>(sim.scene().object_at(ball, i / 720.0));
+      for (int j = 0; j < frame.channel_count; ++j)
+      {
+        if (frame.range(i, j) == 0.0f) continue;
+        EXPECT_NEAR((frame.point(i, j) - posed.centre()).length(), 1.0, 1e-9) << i << ", " << j;
+      }
+    }
+  }
+}
+
+#if PERCEPTO_ENABLE_RAY_TRACE
+TEST(LidarSimulatorTest, RayTraceWritesOneRecordPerRay)
+{
+  const auto path = std::filesystem::temp_directory_path() / "percepto_ray_trace_test.log";
+  const LiDARConfig cfg{12, {-0.2, 0.0, 0.2}};
+
+  auto scene_ptr = std::make_unique<Scene>();
+  scene_ptr->add_object(Triangle{Vec3(5, -5, -5), Vec3(5, 0, 5), Vec3(5, 5, -5)});
+  LidarSimulator sim(std::make_unique<LidarEmitter>(cfg), std::move(scene_ptr));
+
+  percepto::lidar::ScanOptions options;
+  options.trace_rays = true;
+  options.ray_trace_file = path.string();
+  sim.set_scan_options(options);
+  const auto frame = sim.run_scan(1)[0];
+  ASSERT_GT(frame.hits, 0);
+
+  // Records are written by spdlog's background thread; wait for all of them to land.
+  const int expected_records = cfg.azimuth_steps * static_cast<int>(cfg.elevation_angles.size());
+  std::vector<std::string> records;
+  for (int attempt = 0; attempt < 200 && static_cast<int>(records.size()) < expected_records;
+       ++attempt)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    records.clear();
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) records.push_back(line);
+  }
+
+  ASSERT_EQ(static_cast<int>(records.size()), expected_records);
+  const int hit_records = static_cast<int>(std::count_if(
+      records.begin(), records.end(),
+      [](const std::string& r) { return r.find("hit=true") != std::string::npos; }));
+  EXPECT_EQ(hit_records, frame.hits);
+  EXPECT_EQ(records.front().rfind("rev=0 azimuth_index=0 channel=0 ", 0), 0u) << records.front();
+}
+#endif
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "percepto/common/config_loader.h"
+#include "percepto/common/frame_scan.h"
+#include "percepto/common/types.h"
+#include "percepto/core/scene.h"
+#include "percepto/core/transform.h"
+#include "percepto/core/vec3.h"
+#include "percepto/geometry/instance.h"
+#include "percepto/geometry/sphere.h"
+#include "percepto/io/csv_parser.h"
+#include "percepto/lidar/emitter.h"
+#include "percepto/lidar/simulator.h"
+
+using percepto::common::FrameScan, percepto::common::LiDARConfig, percepto::common::ScanBackend;
+using percepto::core::Scene, percepto::core::Transform, percepto::core::Vec3;
+using percepto::geometry::Instance, percepto::geometry::InstancedMesh, percepto::geometry::Sphere;
+using percepto::io::CsvParser;
+using percepto::lidar::LidarEmitter, percepto::lidar::LidarSimulator;
+
+namespace
+{
+// A sensor with uneven channel spacing and a fine azimuth step, like the real configuration.
+const LiDARConfig kSensor{1440, {0.1863, 0.1166, 0.0470, 0.0005, -0.0459, -0.1156, -0.1852,
+                                 -0.2548, -0.3244, -0.3940, -0.4636, -0.5332}};
+
+std::unique_ptr<Scene> load_fixture(const std::string& name, bool with_sphere)
+{
+  CsvParser parser;
+  auto scene = parser.load_scene_from_csv("fixtures/data/" + name);
+  if (with_sphere) scene->add_object(Sphere(Vec3(-2.0, -5.0, 0.5), 1.2));
+  return scene;
+}
+
+// The room fixture as two instances: one in place, one turned, mirrored and pushed outward.
+std::unique_ptr<Scene> load_instanced_room()
+{
+  auto room = CsvParser().load_scene_from_csv("fixtures/data/room.csv");
+  auto mesh = std::make_shared<const InstancedMesh>(room->meshes().at(0));
+  auto scene = std::make_unique<Scene>();
+  scene->add_object(Instance(mesh, Transform()));
+  scene->add_object(Instance(mesh, Transform::translation(Vec3(3.0, 1.0, 0.0)) *
+                                       Transform::rotation(Vec3(0.0, 0.0, 1.0), 0.4) *
+                                       Transform::scaling(Vec3(-1.0, 1.2, 1.0))));
+  return scene;
+}
+
+FrameScan scan_with(ScanBackend backend, std::unique_ptr<Scene> scene)
+{
+  LidarSimulator sim(std::make_unique<LidarEmitter>(kSensor), std::move(scene));
+  percepto::lidar::ScanOptions options;
+  options.backend = backend;
+  sim.set_scan_options(options);
+  return sim.run_scan(1)[0];
+}
+
+// Ranges must agree to rounding. A beam running exactly along an edge may be reported by one
+// backend and not the other, so a handful of hit/miss disagreements are tolerated.
+void expect_frames_match(const FrameScan& traced, const FrameScan& rastered)
+{
+  ASSERT_EQ(traced.azimuth_steps, rastered.azimuth_steps);
+  ASSERT_EQ(traced.channel_count, rastered.channel_count);
+
+  int disagreements = 0;
+  for (int i = 0; i < traced.azimuth_steps; ++i)
+  {
+    for (int j = 0; j < traced.channel_count; ++j)
+    {
+      const float expected = traced.range(i, j);
+      const float actual = rastered.range(i, j);
+      if ((expected == 0.0f) != (actual == 0.0f))
+      {
+        ++disagreements;
+        continue;
+      }
+      EXPECT_NEAR(actual, expected, 1e-4f * expected) << "i=" << i << " j=" << j;
+      EXPECT_NEAR(rastered.point(i, j).x, traced.point(i, j).x, 1e-4);
+      EXPECT_NEAR(rastered.point(i, j).y, traced.point(i, j).y, 1e-4);
+      EXPECT_NEAR(rastered.point(i, j).z, traced.point(i, j).z, 1e-4);
+    }
+  }
+  EXPECT_LE(disagreements, traced.azimuth_steps * traced.channel_count / 1000);
+  EXPECT_NEAR(rastered.hits, traced.hits, disagreements);
+}
+}  // namespace
+
+TEST(ScanRasterizerTest, MatchesRayTracingOnTriangleFixture)
+{
+  const auto traced = scan_with(ScanBackend::RayTrace, load_fixture("triangles.csv", false));
+  const auto rastered = scan_with(ScanBackend::Rasterize, load_fixture("triangles.csv", false));
+  expect_frames_match(traced, rastered);
+}
+
+TEST(ScanRasterizerTest, MatchesRayTracingOnRoomFixture)
+{
+  const auto traced = scan_with(ScanBackend::RayTrace, load_fixture("room.csv", true));
+  const auto rastered = scan_with(ScanBackend::Rasterize, load_fixture("room.csv", true));
+
+  // The sensor sits inside a closed room, so every beam returns.
+  ASSERT_EQ(traced.hits, kSensor.azimuth_steps * static_cast<int>(kSensor.elevation_angles.size()));
+  expect_frames_match(traced, rastered);
+}
+
+TEST(ScanRasterizerTest, MatchesRayTracingOnInstances)
+{
+  const auto traced = scan_with(ScanBackend::RayTrace, load_instanced_room());
+  const auto rastered = scan_with(ScanBackend::Rasterize, load_instanced_room());
+  EXPECT_GT(traced.hits, 0);
+  expect_frames_match(traced, rastered);
+}
+
+TEST(ScanRasterizerTest, MatchesRayTracingWithoutCulling)
+{
+  auto double_sided = [](std::unique_ptr<Scene> scene)
+  {
+    scene->set_cull_mode(percepto::common::CullMode::None);
+    return scene;
+  };
+  const auto culled = scan_with(ScanBackend::RayTrace, load_fixture("triangles.csv", false));
+  const auto traced =
+      scan_with(ScanBackend::RayTrace, double_sided(load_fixture("triangles.csv", false)));
+  const auto rastered =
+      scan_with(ScanBackend::Rasterize, double_sided(load_fixture("triangles.csv", false)));
+
+  // Some of the fixture's triangles face away from the sensor.
+  EXPECT_GT(traced.hits, culled.hits);
+  expect_frames_match(traced, rastered);
+}
+
+TEST(ScanRasterizerTest, EmptySceneHasNoHits)
+{
+  const auto frame = scan_with(ScanBackend::Rasterize, std::make_unique<Scene>());
+  EXPECT_EQ(frame.hits, 0);
+  for (float range : frame.ranges) EXPECT_EQ(range, 0.0f);
+}
+
+TEST(ScanRasterizerTest, RepeatedRevolutionsAreIdentical)
+{
+  LidarSimulator sim(std::make_unique<LidarEmitter>(kSensor), load_fixture("room.csv", true));
+  percepto::lidar::ScanOptions options;
+  options.backend = ScanBackend::Rasterize;
+  sim.set_scan_options(options);
+
+  const auto frames = sim.run_scan(2);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0].hits, frames[1].hits);
+  EXPECT_EQ(frames[0].ranges, frames[1].ranges);
+}